@@ -0,0 +1,12 @@
+TEMPLATE = app
+TARGET = Ray-Casting-Bench
+CONFIG += console c++11 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+include(Ray-Casting.pri)
+
+SOURCES += bench/benchmark.cpp \
+    bench/microbench.cpp
+
+HEADERS += bench/microbench.h
@@ -0,0 +1,92 @@
+# Renderer sources shared by the app and the benchmark; keep RT_SOURCES in CMakeLists.txt in step.
+
+INCLUDEPATH += $$PWD
+
+# Sockets for the distributed render mode.
+win32: LIBS += -lws2_32
+
+SOURCES += \
+    appsrc/src/Math/sphere.cpp \
+    appsrc/src/Math/hittablelist.cpp \
+    appsrc/src/Math/camera.cpp \
+    appsrc/src/Math/material.cpp \
+    appsrc/src/Math/aabb.cpp \
+    appsrc/src/Math/bvh.cpp \
+    appsrc/src/Math/simd.cpp \
+    appsrc/src/Math/spheresoa.cpp \
+    appsrc/src/Math/raypacket.cpp \
+    appsrc/src/Math/scenearena.cpp \
+    appsrc/src/Math/sampler.cpp \
+    appsrc/src/Math/counters.cpp \
+    appsrc/src/Math/trace.cpp \
+    appsrc/src/Math/transform.cpp \
+    appsrc/src/Math/instance.cpp \
+    appsrc/src/Math/trianglemesh.cpp \
+    appsrc/src/Render/threadpool.cpp \
+    appsrc/src/Render/framebuffer.cpp \
+    appsrc/src/Render/tonemapper.cpp \
+    appsrc/src/Render/tilerenderer.cpp \
+    appsrc/src/Render/integrator.cpp \
+    appsrc/src/Render/lightlist.cpp \
+    appsrc/src/Render/tilesampler.cpp \
+    appsrc/src/Render/accumulationbuffer.cpp \
+    appsrc/src/Render/denoiser.cpp \
+    appsrc/src/Render/distributed.cpp \
+    appsrc/src/Render/renderer.cpp \
+    appsrc/src/Render/gpurenderer.cpp \
+    appsrc/src/IO/commandline.cpp \
+    appsrc/src/IO/imagereader.cpp \
+    appsrc/src/IO/imagewriter.cpp \
+    appsrc/src/IO/json.cpp \
+    appsrc/src/IO/mappedfile.cpp \
+    appsrc/src/IO/meshloader.cpp \
+    appsrc/src/IO/socket.cpp \
+    appsrc/src/Scene/randomscene.cpp \
+    appsrc/src/Scene/scene.cpp
+
+HEADERS += \
+    appsrc/include/Math/vec3.h \
+    appsrc/include/Math/vec3a.h \
+    appsrc/include/Math/ray.h \
+    appsrc/include/Math/hittable.h \
+    appsrc/include/Math/sphere.h \
+    appsrc/include/Math/hittablelist.h \
+    appsrc/include/Math/camera.h \
+    appsrc/include/Math/material.h \
+    appsrc/include/Math/random.h \
+    appsrc/include/Math/aabb.h \
+    appsrc/include/Math/bvh.h \
+    appsrc/include/Math/simd.h \
+    appsrc/include/Math/spheresoa.h \
+    appsrc/include/Math/raypacket.h \
+    appsrc/include/Math/scenearena.h \
+    appsrc/include/Math/sampler.h \
+    appsrc/include/Math/sampling.h \
+    appsrc/include/Math/counters.h \
+    appsrc/include/Math/trace.h \
+    appsrc/include/Math/transform.h \
+    appsrc/include/Math/instance.h \
+    appsrc/include/Math/trianglemesh.h \
+    appsrc/include/Render/threadpool.h \
+    appsrc/include/Render/framebuffer.h \
+    appsrc/include/Render/tonemapper.h \
+    appsrc/include/Render/tilerenderer.h \
+    appsrc/include/Render/integrator.h \
+    appsrc/include/Render/lightlist.h \
+    appsrc/include/Render/tilesampler.h \
+    appsrc/include/Render/accumulationbuffer.h \
+    appsrc/include/Render/denoiser.h \
+    appsrc/include/Render/distributed.h \
+    appsrc/include/Render/renderer.h \
+    appsrc/include/Render/gpukernel.h \
+    appsrc/include/Render/gpudevice.h \
+    appsrc/include/Render/gpurenderer.h \
+    appsrc/include/IO/commandline.h \
+    appsrc/include/IO/imagereader.h \
+    appsrc/include/IO/imagewriter.h \
+    appsrc/include/IO/json.h \
+    appsrc/include/IO/mappedfile.h \
+    appsrc/include/IO/meshloader.h \
+    appsrc/include/IO/socket.h \
+    appsrc/include/Scene/randomscene.h \
+    appsrc/include/Scene/scene.h
@@ -0,0 +1,47 @@
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <ostream>
+#include <string>
+
+// One command-line option, for the usage text and to tell switches from options with a value.
+struct CommandOption
+{
+    const char* m_pName;
+
+    // Placeholder for the value in the usage text, or null for a switch.
+    const char* m_pValue;
+
+    const char* m_pHelp;
+};
+
+// The option table of a program: looks options up, prints the usage text and parses the
+// numbers given as values, so a typo is refused instead of rendering with a zero.
+class CommandLine
+{
+public:
+    template <int N>
+    explicit CommandLine(const CommandOption (&a_oOptions)[N]) : m_pOptions(a_oOptions),
+                                                                 m_iCount(N)
+    {
+    }
+
+    // Null for a name that is not in the table.
+    const CommandOption* Find(const std::string& a_sName) const;
+
+    void PrintUsage(std::ostream& a_oOut, const char* a_pProgram) const;
+
+    // The whole of a_pText must be a number of at least a_iMin; a_iValue is left alone
+    // otherwise.
+    static bool ParseInt(const char* a_pText, int a_iMin, int& a_iValue);
+
+    static bool ParseFloat(const char* a_pText, float a_fMin, float& a_fValue);
+
+    static bool ParseDouble(const char* a_pText, double a_dMin, double& a_dValue);
+
+private:
+    const CommandOption* m_pOptions;
+    int m_iCount;
+};
+
+#endif // COMMANDLINE_H
@@ -0,0 +1,20 @@
+#ifndef IMAGEREADER_H
+#define IMAGEREADER_H
+
+#include <stddef.h>
+#include <string>
+#include "appsrc/include/Render/framebuffer.h"
+
+// Reads back the linear images ImageWriter stores, so a render kept as PFM can be tone
+// mapped again without tracing a ray.
+class ImageReader
+{
+public:
+    // Colour ("PF") or greyscale ("Pf") PFM of either byte order; grey is copied to all three
+    // channels. a_oImage is replaced, with one sample counted per pixel.
+    static bool ReadPfm(const std::string& a_sPath, FrameBuffer& a_oImage, std::string& a_sError);
+
+    static bool DecodePfm(const char* a_pData, size_t a_uSize, FrameBuffer& a_oImage, std::string& a_sError);
+};
+
+#endif // IMAGEREADER_H
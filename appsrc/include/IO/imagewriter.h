@@ -0,0 +1,42 @@
+#ifndef IMAGEWRITER_H
+#define IMAGEWRITER_H
+
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/framebuffer.h"
+#include "appsrc/include/Render/tonemapper.h"
+
+enum ImageFormat
+{
+    IMAGE_FORMAT_PPM = 0,   // binary P6
+    IMAGE_FORMAT_PPM_ASCII, // legacy P3
+    IMAGE_FORMAT_PNG,       // 8-bit RGB
+    IMAGE_FORMAT_PFM        // 32-bit float RGB, linear
+};
+
+// Encodes a whole image into one memory buffer and writes it with a single fwrite.
+class ImageWriter
+{
+public:
+    // Picks the format from the file extension; unknown extensions give binary PPM.
+    static ImageFormat FormatFromPath(const std::string& a_sPath);
+
+    // Accepts "ppm", "ppm-ascii", "png" and "pfm".
+    static bool ParseFormat(const std::string& a_sName, ImageFormat& a_eFormat);
+
+    // 8-bit formats go through a_oToneMap; PFM keeps the linear colour as it is.
+    static bool Write(const FrameBuffer& a_oFrameBuffer, const std::string& a_sPath, ImageFormat a_eFormat, const ToneMapSettings& a_oToneMap = ToneMapSettings());
+
+    // a_oRgb holds 8-bit RGB, top scanline first. PFM is not available from 8-bit data.
+    static bool WriteRgb8(const unsigned char* a_pRgb, int a_iWidth, int a_iHeight, const std::string& a_sPath, ImageFormat a_eFormat);
+
+    static void EncodePpm(const unsigned char* a_pRgb, int a_iWidth, int a_iHeight, bool a_bAscii, std::vector<unsigned char>& a_oOut);
+
+    static void EncodePng(const unsigned char* a_pRgb, int a_iWidth, int a_iHeight, std::vector<unsigned char>& a_oOut);
+
+    static void EncodePfm(const FrameBuffer& a_oFrameBuffer, std::vector<unsigned char>& a_oOut);
+
+    static bool WriteFile(const std::string& a_sPath, const std::vector<unsigned char>& a_oData);
+};
+
+#endif // IMAGEWRITER_H
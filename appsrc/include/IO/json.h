@@ -0,0 +1,61 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <vector>
+
+enum JsonType
+{
+    JSON_NULL = 0,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+};
+
+// Parsed JSON document node. Objects keep their members in file order; a repeated key
+// resolves to its first occurrence.
+class JsonValue
+{
+public:
+    JsonValue();
+
+    // On failure a_sError names the line and what was expected there.
+    static bool Parse(const std::string& a_sText, JsonValue& a_oValue, std::string& a_sError);
+
+    JsonType GetType() const;
+
+    bool GetBool() const;
+
+    double GetNumber() const;
+
+    const std::string& GetString() const;
+
+    // Elements of an array or values of an object.
+    int GetSize() const;
+
+    const JsonValue& GetItem(int a_iIndex) const;
+
+    const std::string& GetKey(int a_iIndex) const;
+
+    // Null when this is not an object or has no such member.
+    const JsonValue* Find(const std::string& a_sKey) const;
+
+private:
+    friend class JsonParser;
+
+    JsonType m_eType;
+
+    bool m_bBool;
+
+    double m_dNumber;
+
+    std::string m_sString;
+
+    std::vector<JsonValue> m_oItems;
+
+    std::vector<std::string> m_oKeys;
+};
+
+#endif // JSON_H
@@ -0,0 +1,40 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stddef.h>
+#include <string>
+
+// Read-only view of a whole file through the virtual memory system; pages are loaded on
+// first touch. The mapping is copy-on-write, so writes through GetData() stay private to
+// the process and never reach the file. The base address is page aligned.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string& a_sPath);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    char* GetData() const;
+
+    size_t GetSize() const;
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    char* m_pData;
+
+    size_t m_uSize;
+
+#if defined(_WIN32)
+    void* m_pFile;
+    void* m_pMapping;
+#endif
+};
+
+#endif // MAPPEDFILE_H
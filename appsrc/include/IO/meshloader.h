@@ -0,0 +1,28 @@
+#ifndef MESHLOADER_H
+#define MESHLOADER_H
+
+#include <string>
+#include "appsrc/include/Math/trianglemesh.h"
+
+// Streams Wavefront OBJ and PLY (ASCII or binary) files into a TriangleMesh. The file is
+// memory-mapped and parsed in place: a quick first pass counts vertices and faces so the
+// mesh arrays are reserved once, and the second writes straight into them, splitting
+// polygons into fans. Nothing is allocated per vertex or per triangle.
+//
+// Only positions and faces are read; normals, texture coordinates, materials and any
+// other PLY properties or elements are skipped.
+class MeshLoader
+{
+public:
+    // Picks the format from the extension, .obj or .ply. The mesh is cleared first and
+    // keeps its material.
+    static bool Load(const std::string& a_sPath, TriangleMesh& a_oMesh, std::string& a_sError);
+
+    static bool LoadObj(const std::string& a_sPath, TriangleMesh& a_oMesh, std::string& a_sError);
+
+    static bool LoadPly(const std::string& a_sPath, TriangleMesh& a_oMesh, std::string& a_sError);
+
+    static bool IsMeshPath(const std::string& a_sPath);
+};
+
+#endif // MESHLOADER_H
@@ -0,0 +1,51 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Blocking IPv4 TCP stream, over BSD sockets or Winsock. Send() and Receive() move whole
+// buffers and fail once the peer is gone, so callers only see complete messages.
+class Socket
+{
+public:
+    Socket();
+    ~Socket();
+
+    // Accepts connections on a_iPort of every interface.
+    bool Listen(int a_iPort, std::string& a_sError);
+
+    // Waits up to a_iTimeoutMs for a connection on a listening socket; false on timeout.
+    bool Accept(Socket& a_oClient, int a_iTimeoutMs);
+
+    bool Connect(const std::string& a_sHost, int a_iPort, std::string& a_sError);
+
+    bool Send(const void* a_pData, size_t a_uSize);
+
+    bool Receive(void* a_pData, size_t a_uSize);
+
+    // Makes Receive() fail after a_dSeconds without data; zero waits forever.
+    void SetReceiveTimeout(double a_dSeconds);
+
+    void Close();
+
+    bool IsOpen() const;
+
+    // "address:port" of the other end.
+    const std::string& GetPeerName() const;
+
+private:
+    Socket(const Socket&);
+    Socket& operator=(const Socket&);
+
+    // Disables Nagle's algorithm, so small headers are not held back.
+    void Configure();
+
+    // A SOCKET on Windows, a file descriptor elsewhere; -1 when closed.
+    intptr_t m_iHandle;
+
+    std::string m_sPeerName;
+};
+
+#endif // SOCKET_H
@@ -0,0 +1,36 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include "appsrc/include/Math/ray.h"
+
+class Aabb
+{
+public:
+    // Default box is empty (min > max) so the first Grow() takes it over.
+    Aabb();
+    Aabb(const Vec3& a_oMin, const Vec3& a_oMax);
+
+    void Grow(const Vec3& a_oPoint);
+
+    void Grow(const Aabb& a_oBox);
+
+    Vec3 Centroid() const;
+
+    Vec3 Extent() const;
+
+    float SurfaceArea() const;
+
+    int LongestAxis() const;
+
+    bool IsEmpty() const;
+
+    // Slab test; a_oInvDir holds 1 / direction per axis.
+    bool Hit(const Vec3& a_oOrigin, const Vec3& a_oInvDir, float a_fTMin, float a_fTMax) const;
+
+    Vec3 m_oMin;
+    Vec3 m_oMax;
+};
+
+Aabb Union(const Aabb& a_oLhs, const Aabb& a_oRhs);
+
+#endif // AABB_H
@@ -0,0 +1,184 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <stdint.h>
+#include <vector>
+#include "appsrc/include/Math/hittablelist.h"
+#include "appsrc/include/Math/spheresoa.h"
+#include "appsrc/include/Math/raypacket.h"
+#include "appsrc/include/Math/trianglemesh.h"
+
+// 32-byte node of a depth-first flattened BVH. The first child of an interior node is
+// always the next node in the array, so only the second child needs an offset.
+struct BvhNode
+{
+    float m_fMin[3];
+    float m_fMax[3];
+
+    // Leaf: index of the first primitive. Interior: index of the second child.
+    uint32_t m_uOffset;
+
+    // Number of primitives, zero for interior nodes.
+    uint16_t m_uCount;
+
+    // Split axis, used to pick the near child during traversal.
+    uint8_t m_uAxis;
+
+    uint8_t m_uPad;
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode must stay 32 bytes");
+
+struct BvhTraversalStats
+{
+    BvhTraversalStats();
+
+    uint64_t m_uRays;
+    uint64_t m_uNodesVisited;
+    uint64_t m_uPrimitiveTests;
+};
+
+// Binned-SAH builder shared by every BVH flavour. Fills a_oNodes in depth-first order and
+// a_oOrder with the primitive permutation the leaves expect. a_fIntersectionCost is the
+// cost of one primitive test relative to one node test.
+class BvhBuilder
+{
+public:
+    // Levels of a tree, root included, and so the entries a traversal stack needs. Splits
+    // turn even wherever SAH could go deeper than this.
+    static const int MAX_DEPTH = 64;
+
+    static void Build(const std::vector<Aabb>& a_oBoxes, int a_iMaxLeafSize, std::vector<BvhNode>& a_oNodes, std::vector<int>& a_oOrder, float a_fIntersectionCost = 1.0f);
+
+private:
+    static void BuildRange(int a_iBegin, int a_iEnd, int a_iDepth, int a_iMaxLeafSize, float a_fIntersectionCost, const std::vector<Aabb>& a_oBoxes, std::vector<int>& a_oOrder, std::vector<BvhNode>& a_oNodes);
+};
+
+// Bounding volume hierarchy over the primitives of a HittableList, stored as one
+// contiguous node array and traversed iteratively, near child first. When every
+// primitive is a Sphere the leaves are a SphereSoA range tested with the SIMD kernel;
+// over a TriangleMesh they are a triangle range tested in batches the same way.
+class Bvh : public Hittable
+{
+public:
+    // A leaf size of zero picks 4 for generic primitives and the SIMD width for spheres.
+    explicit Bvh(const HittableList& a_oList, int a_iMaxLeafSize = 0);
+
+    // Builds over a_oSpheres and keeps its own copy of them in leaf order. Moving spheres
+    // are bounded over [a_fTimeBegin, a_fTimeEnd], e.g. the shutter of the first frame.
+    explicit Bvh(const SphereSoA& a_oSpheres, int a_iMaxLeafSize = 0, float a_fTimeBegin = 0.0f, float a_fTimeEnd = 0.0f);
+
+    // Builds over a_oMesh and reorders its triangles into leaf order in place instead of
+    // copying them, since meshes are large; the mesh must outlive the Bvh. A leaf size of
+    // zero picks the mesh kernel's batch width.
+    explicit Bvh(TriangleMesh& a_oMesh, int a_iMaxLeafSize = 0);
+
+    // Wraps a prebuilt hierarchy, e.g. one read from a scene cache, whose leaves index
+    // a_oSpheres directly. Neither the nodes nor the spheres are copied, so both must
+    // outlive the Bvh.
+    Bvh(const BvhNode* a_pNodes, int a_iNodeCount, const SphereSoA& a_oSpheres);
+
+    virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const;
+
+    // Stops at the first leaf with a hit and never fills a record.
+    virtual bool Occluded(const Ray& a_oRay, float a_fTMin, float a_fTMax) const;
+
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
+    // Closest hit for every lane of a_oPacket, using masked 8-wide traversal when the leaves
+    // are spheres and AVX2 is available. Returns a bitmask of the lanes that hit.
+    uint32_t HitPacket(const RayPacket& a_oPacket, float a_fTMin, float a_fTMax, HitRecord* a_oRecords) const;
+
+    // Sorts the rays by direction and traces them as packets. a_oRecords and a_uHits are
+    // indexed like a_oRays.
+    void HitStream(const Ray* a_oRays, int a_iCount, float a_fTMin, float a_fTMax, HitRecord* a_oRecords, uint8_t* a_uHits) const;
+
+    // Recomputes every node's bounds from its primitives and keeps the topology, which is
+    // far cheaper than a rebuild while the primitives move only a little between calls.
+    // Sphere leaves are bounded over their motion in [a_fTimeBegin, a_fTimeEnd]; triangles
+    // and generic primitives report their own current bounds. A wrapped prebuilt hierarchy is copied
+    // into owned storage on the first refit.
+    void Refit(float a_fTimeBegin = 0.0f, float a_fTimeEnd = 0.0f);
+
+    // Refit(), then a full build over the same primitives if the refit left the SAH cost
+    // of the root, or of any subtree holding an eighth of the primitives or more, above 1.5
+    // times what it was right after the last build, as happens once moving spheres have
+    // drifted far from where the topology grouped them. Subtrees are judged on their own
+    // because one huge primitive, like a ground sphere, would otherwise hide them in the
+    // root's area. Mesh leaves never move and are only refitted. Returns true on a rebuild.
+    bool RefitOrRebuild(float a_fTimeBegin = 0.0f, float a_fTimeEnd = 0.0f);
+
+    // Expected node and primitive tests of a ray through the root, in node tests, from the
+    // surface area heuristic over the current bounds.
+    float GetSahCost() const;
+
+    double GetBuildTimeMs() const;
+
+    // Time spent in the last Refit().
+    double GetRefitTimeMs() const;
+
+    int GetNodeCount() const;
+
+    const BvhNode* GetNodes() const;
+
+    // The leaf-ordered spheres, or nullptr when the leaves hold generic primitives.
+    const SphereSoA* GetSpheres() const;
+
+    // The mesh the leaves index, or nullptr.
+    const TriangleMesh* GetMesh() const;
+
+    // BVH part of the per-thread counters, summed since the last Counters::Reset().
+    static BvhTraversalStats GetTraversalStats();
+
+private:
+    Bvh(const Bvh&);
+    Bvh& operator=(const Bvh&);
+
+    void BuildSpheres(const SphereSoA& a_oSpheres, int a_iMaxLeafSize, float a_fTimeBegin = 0.0f, float a_fTimeEnd = 0.0f);
+
+    // SAH cost and primitive count of every subtree, from one backward sweep.
+    void ComputeSubtreeCosts(std::vector<float>& a_oCosts, std::vector<int>& a_oCounts) const;
+
+    // Picks the subtrees RefitOrRebuild() watches and records their current costs.
+    void WatchSubtrees();
+
+    // With a_bAnyHit the walk ends at the first leaf a_oLeafTest reports a hit in.
+    template <typename LeafTest>
+    bool Traverse(const Ray& a_oRay, float a_fTMin, float& a_fClosest, LeafTest& a_oLeafTest, bool a_bAnyHit = false) const;
+
+    std::vector<BvhNode> m_oNodes;
+
+    // Either m_oNodes or a prebuilt array owned by the caller.
+    const BvhNode* m_pNodes;
+    int m_iNodeCount;
+
+    // Primitives in leaf order, so every leaf references a contiguous range.
+    std::vector<Hittable*> m_oPrimitives;
+
+    SphereSoA m_oSpheres;
+
+    bool m_bSphereLeaves;
+
+    // Owned by the caller.
+    const TriangleMesh* m_pMesh;
+
+    // As the build used them, for GetSahCost() and rebuilds.
+    int m_iMaxLeafSize;
+    float m_fIntersectionCost;
+
+    struct WatchedSubtree
+    {
+        int m_iNode;
+
+        float m_fBuildCost;
+    };
+
+    // Empty until a build, or for a wrapped hierarchy until its first refit.
+    std::vector<WatchedSubtree> m_oWatched;
+
+    double m_dBuildTimeMs;
+
+    double m_dRefitTimeMs;
+};
+
+#endif // BVH_H
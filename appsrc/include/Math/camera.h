@@ -3,12 +3,45 @@
 
 #include "appsrc/include/Math/ray.h"
 
+// One primary ray request: pixel (x, y), a jitter inside the pixel and a lens position,
+// both in [0, 1)^2, and a point in [0, 1) of the shutter interval.
+struct CameraSample
+{
+    int m_iX;
+    int m_iY;
+
+    float m_fJitterX;
+    float m_fJitterY;
+
+    float m_fLensX;
+    float m_fLensY;
+
+    float m_fTime;
+};
+
 class Camera
 {
 public:
     Camera(Vec3 a_oLookFrom, Vec3 a_oLookAt, Vec3 a_oUp, float a_fFov, float a_fAspect, float a_fAperture, float a_fFocusDist);
 
-    Ray GetRay(float a_fU, float a_fV);
+    // Rays get times in [a_fOpen, a_fClose), in frames; the default shutter is closed at 0.
+    void SetShutter(float a_fOpen, float a_fClose);
+
+    // True when rays spread over time and need a time sample.
+    bool HasShutter() const;
+
+    // (a_fLensX, a_fLensY) in [0, 1)^2 picks the point on the lens, a_fTime in [0, 1) the
+    // moment within the shutter interval. Rounds differently from GetRays().
+    Ray GetRay(float a_fU, float a_fV, float a_fLensX, float a_fLensY, float a_fTime = 0.0f) const;
+
+    // The ray GetRays() makes for a_oSample, bit for bit, so one-path-at-a-time integrators
+    // trace the same primary rays as batched ones.
+    Ray GetRay(const CameraSample& a_oSample, int a_iWidth, int a_iHeight) const;
+
+    // Fills a_pRays for a whole batch, e.g. a tile, on an a_iWidth x a_iHeight image. The
+    // image-plane point is rebuilt from a per-row base plus per-pixel steps, and lenses
+    // with zero radius skip the disk mapping entirely.
+    void GetRays(const CameraSample* a_pSamples, int a_iCount, int a_iWidth, int a_iHeight, Ray* a_pRays) const;
 
     Vec3 m_oOrigin;
     Vec3 m_oLowerLeftCorner;
@@ -16,9 +49,10 @@ public:
     Vec3 m_oVertical;
     Vec3 m_oU, m_oV, m_oW;
 
-    Vec3 RandomUnitInDisk();
-
     float m_fLensRadius;
+
+    float m_fShutterOpen;
+    float m_fShutterClose;
 };
 
 #endif // CAMERA_H
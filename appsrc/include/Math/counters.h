@@ -0,0 +1,75 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <stdint.h>
+
+// Building with -DRT_ENABLE_COUNTERS=0 removes every counter update from the hot paths;
+// the getters then report zeros.
+#ifndef RT_ENABLE_COUNTERS
+#define RT_ENABLE_COUNTERS 1
+#endif
+
+enum RenderCounter
+{
+    COUNTER_BVH_RAYS = 0,
+    COUNTER_BVH_NODES_VISITED,
+    COUNTER_BVH_PRIMITIVE_TESTS,
+
+    COUNTER_PATHS,
+
+    // Rays traced, i.e. camera rays plus every scattered ray.
+    COUNTER_PATH_SEGMENTS,
+    COUNTER_ROULETTE_KILLS,
+
+    // Shaded hits, in MaterialType order.
+    COUNTER_HITS_LAMBERTIAN,
+    COUNTER_HITS_METAL,
+    COUNTER_HITS_DIELECTRIC,
+    COUNTER_HITS_EMISSIVE,
+
+    COUNTER_DIELECTRIC_TOTAL_INTERNAL_REFLECTIONS,
+
+    // Next event estimation: shadow rays towards sampled light points, and those blocked.
+    COUNTER_SHADOW_RAYS,
+    COUNTER_SHADOW_RAYS_OCCLUDED,
+
+    COUNTER_TILES,
+    COUNTER_TILE_NANOSECONDS,
+
+    COUNTER_COUNT
+};
+
+struct CounterBlock
+{
+    CounterBlock();
+
+    uint64_t m_uValues[COUNTER_COUNT];
+};
+
+// Per-thread counter blocks. A thread registers its block on first use and then updates
+// it without synchronisation; Sum() and Reset() are only meant for when rendering has
+// stopped.
+class Counters
+{
+public:
+    static CounterBlock& Local();
+
+    static CounterBlock Sum();
+
+    static void Reset();
+
+    static const char* GetName(RenderCounter a_eCounter);
+};
+
+#if RT_ENABLE_COUNTERS
+// Binds this thread's block to a_oName, for functions that update several counters.
+#define RT_COUNTERS(a_oName) CounterBlock& a_oName = Counters::Local()
+#define RT_COUNTER_ADD(a_oName, a_eCounter, a_uValue) ((a_oName).m_uValues[(a_eCounter)] += (a_uValue))
+#define RT_COUNT(a_eCounter, a_uValue) (Counters::Local().m_uValues[(a_eCounter)] += (a_uValue))
+#else
+#define RT_COUNTERS(a_oName)
+#define RT_COUNTER_ADD(a_oName, a_eCounter, a_uValue) ((void)0)
+#define RT_COUNT(a_eCounter, a_uValue) ((void)0)
+#endif
+
+#endif // COUNTERS_H
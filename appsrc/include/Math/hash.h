@@ -0,0 +1,139 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+
+// Marks functions that device code calls too; plain inline functions elsewhere.
+#if defined(__CUDACC__)
+#define RT_HOST_DEVICE __host__ __device__
+#else
+#define RT_HOST_DEVICE
+#endif
+
+// Integer hashes and permutations the samplers are built from. Everything here is pure,
+// so the GPU backend reproduces the CPU samplers value for value.
+
+// SplitMix64 finaliser.
+RT_HOST_DEVICE inline uint64_t SplitMix64(uint64_t a_uValue)
+{
+    a_uValue += 0x9e3779b97f4a7c15ULL;
+    a_uValue = (a_uValue ^ (a_uValue >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    a_uValue = (a_uValue ^ (a_uValue >> 27)) * 0x94d049bb133111ebULL;
+
+    return a_uValue ^ (a_uValue >> 31);
+}
+
+// The top 24 bits as a float in [0, 1).
+RT_HOST_DEVICE inline float ToUnitFloat(uint32_t a_uBits)
+{
+    return static_cast<float>(a_uBits >> 8) * (1.0f / 16777216.0f);
+}
+
+RT_HOST_DEVICE inline uint32_t HashCombine(uint32_t a_uSeed, uint32_t a_uValue)
+{
+    return a_uSeed ^ (a_uValue + 0x9e3779b9u + (a_uSeed << 6) + (a_uSeed >> 2));
+}
+
+// lowbias32 (Wellons, "Prospecting for Hash Functions").
+RT_HOST_DEVICE inline uint32_t Hash(uint32_t a_uValue)
+{
+    a_uValue ^= a_uValue >> 16;
+    a_uValue *= 0x7feb352du;
+    a_uValue ^= a_uValue >> 15;
+    a_uValue *= 0x846ca68bu;
+    a_uValue ^= a_uValue >> 16;
+
+    return a_uValue;
+}
+
+RT_HOST_DEVICE inline uint32_t PixelSeed(int a_iX, int a_iY, int a_iDimension, uint32_t a_uSeed)
+{
+    uint64_t _pixel = (static_cast<uint64_t>(static_cast<uint32_t>(a_iY)) << 32) | static_cast<uint32_t>(a_iX);
+
+    return static_cast<uint32_t>(SplitMix64(_pixel ^ (static_cast<uint64_t>(static_cast<uint32_t>(a_iDimension) ^ a_uSeed) * 0x9e3779b97f4a7c15ULL)));
+}
+
+RT_HOST_DEVICE inline uint32_t ReverseBits(uint32_t a_uValue)
+{
+    a_uValue = (a_uValue << 16) | (a_uValue >> 16);
+    a_uValue = ((a_uValue & 0x00ff00ffu) << 8) | ((a_uValue & 0xff00ff00u) >> 8);
+    a_uValue = ((a_uValue & 0x0f0f0f0fu) << 4) | ((a_uValue & 0xf0f0f0f0u) >> 4);
+    a_uValue = ((a_uValue & 0x33333333u) << 2) | ((a_uValue & 0xccccccccu) >> 2);
+    a_uValue = ((a_uValue & 0x55555555u) << 1) | ((a_uValue & 0xaaaaaaaau) >> 1);
+
+    return a_uValue;
+}
+
+// Laine-Karras style permutation: every bit only depends on itself and lower bits.
+RT_HOST_DEVICE inline uint32_t LaineKarrasPermutation(uint32_t a_uValue, uint32_t a_uSeed)
+{
+    a_uValue += a_uSeed;
+    a_uValue ^= a_uValue * 0x6c50b47cu;
+    a_uValue ^= a_uValue * 0xb82f1e52u;
+    a_uValue ^= a_uValue * 0xc7afe638u;
+    a_uValue ^= a_uValue * 0x8d22f6e6u;
+
+    return a_uValue;
+}
+
+// Owen scrambling of a base-2 fraction held with its most significant digit in bit 31.
+RT_HOST_DEVICE inline uint32_t NestedUniformScramble(uint32_t a_uValue, uint32_t a_uSeed)
+{
+    return ReverseBits(LaineKarrasPermutation(ReverseBits(a_uValue), a_uSeed));
+}
+
+// Kensler's permutation of [0, a_uLength) selected by a_uPattern.
+RT_HOST_DEVICE inline uint32_t Permute(uint32_t a_uIndex, uint32_t a_uLength, uint32_t a_uPattern)
+{
+    uint32_t _mask = a_uLength - 1;
+
+    _mask |= _mask >> 1;
+    _mask |= _mask >> 2;
+    _mask |= _mask >> 4;
+    _mask |= _mask >> 8;
+    _mask |= _mask >> 16;
+
+    // Cycle-walks until the value lands inside the range.
+    do
+    {
+        a_uIndex ^= a_uPattern;
+        a_uIndex *= 0xe170893du;
+        a_uIndex ^= a_uPattern >> 16;
+        a_uIndex ^= (a_uIndex & _mask) >> 4;
+        a_uIndex ^= a_uPattern >> 8;
+        a_uIndex *= 0x0929eb3fu;
+        a_uIndex ^= a_uPattern >> 23;
+        a_uIndex ^= (a_uIndex & _mask) >> 1;
+        a_uIndex *= 1u | a_uPattern >> 27;
+        a_uIndex *= 0x6935fa69u;
+        a_uIndex ^= (a_uIndex & _mask) >> 11;
+        a_uIndex *= 0x74dcb303u;
+        a_uIndex ^= (a_uIndex & _mask) >> 2;
+        a_uIndex *= 0x9e501cc3u;
+        a_uIndex ^= (a_uIndex & _mask) >> 2;
+        a_uIndex *= 0xc860a3dfu;
+        a_uIndex &= _mask;
+        a_uIndex ^= a_uIndex >> 5;
+    } while (a_uIndex >= a_uLength);
+
+    return (a_uIndex + a_uPattern) % a_uLength;
+}
+
+// Kensler's hashed jitter in [0, 1).
+RT_HOST_DEVICE inline float JitterFloat(uint32_t a_uIndex, uint32_t a_uPattern)
+{
+    a_uIndex ^= a_uPattern;
+    a_uIndex ^= a_uIndex >> 17;
+    a_uIndex ^= a_uIndex >> 10;
+    a_uIndex *= 0xb36534e5u;
+    a_uIndex ^= a_uIndex >> 12;
+    a_uIndex ^= a_uIndex >> 21;
+    a_uIndex *= 0x93fc4795u;
+    a_uIndex ^= 0xdf6e307fu;
+    a_uIndex ^= a_uIndex >> 17;
+    a_uIndex *= 1u | a_uPattern >> 18;
+
+    return ToUnitFloat(a_uIndex);
+}
+
+#endif // HASH_H
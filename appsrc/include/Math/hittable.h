@@ -1,22 +1,46 @@
 #ifndef HITTABLE_H
 #define HITTABLE_H
 
+#include <stdint.h>
 #include "appsrc/include/Math/ray.h"
+#include "appsrc/include/Math/aabb.h"
 
-class Material;
+// Index into a MaterialTable; primitives and hit records carry this instead of a pointer.
+typedef uint32_t MaterialId;
+
+const MaterialId INVALID_MATERIAL_ID = 0xffffffffu;
+
+struct Material;
 
 struct HitRecord
 {
     float m_fT;
     Vec3 m_oPoint;
     Vec3 m_oNormal;
-    Material* m_oMaterial;
+    MaterialId m_uMaterialId;
 };
 
 class Hittable
 {
 public:
+    virtual ~Hittable()
+    {
+    }
+
     virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const = 0;
+
+    // Any-hit query for shadow rays: whether anything lies in (a_fTMin, a_fTMax), without
+    // finding the closest hit or filling a record. Accelerated geometry returns at the first
+    // intersection it meets; the default falls back to Hit().
+    virtual bool Occluded(const Ray& a_oRay, float a_fTMin, float a_fTMax) const
+    {
+        HitRecord _record;
+
+        return this->Hit(a_oRay, a_fTMin, a_fTMax, _record);
+    }
+
+    // Returns false for unbounded geometry, which cannot be placed in a Bvh.
+    virtual bool BoundingBox(Aabb& a_oBox) const = 0;
 };
 
 #endif // HITTABLE_H
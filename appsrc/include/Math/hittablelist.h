@@ -11,6 +11,10 @@ public:
 
     virtual bool Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const;
 
+    virtual bool Occluded(const Ray& a_oRay, float a_fTMin, float a_fTMax) const;
+
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
     Hittable** m_oList;
     int m_iListSize;
 };
@@ -0,0 +1,44 @@
+#ifndef INSTANCE_H
+#define INSTANCE_H
+
+#include "appsrc/include/Math/hittable.h"
+#include "appsrc/include/Math/transform.h"
+
+// Places shared geometry, typically a bottom-level Bvh, in the world under an affine
+// transform. Rays are moved into object space instead of the geometry into world space,
+// so any number of instances share one copy of the primitives. The object-space
+// direction is not renormalised, which keeps t identical in both spaces.
+class Instance : public Hittable
+{
+public:
+    // a_pObject must outlive the instance.
+    Instance(const Hittable* a_pObject, const Transform& a_oObjectToWorld);
+
+    virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const;
+
+    virtual bool Occluded(const Ray& a_oRay, float a_fTMin, float a_fTMax) const;
+
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
+    void SetTransform(const Transform& a_oObjectToWorld);
+
+    // Recomputes the cached world bounds after the object's own bounds changed, e.g. a refit.
+    void UpdateBounds();
+
+    const Transform& GetTransform() const;
+
+    const Hittable* GetObject() const;
+
+private:
+    const Hittable* m_pObject;
+
+    Transform m_oObjectToWorld;
+    Transform m_oWorldToObject;
+
+    // World-space bounds, cached because every top-level rebuild asks for them.
+    Aabb m_oBox;
+
+    bool m_bBounded;
+};
+
+#endif // INSTANCE_H
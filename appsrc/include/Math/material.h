@@ -1,11 +1,13 @@
 #ifndef MATERIAL_H
 #define MATERIAL_H
 
+#include <vector>
 #include "appsrc/include/Math/ray.h"
 #include "appsrc/include/Math/hittable.h"
+#include "appsrc/include/Math/random.h"
+#include "appsrc/include/Math/sampler.h"
 
-
-float Schlick(float a_dCosine, float a_dRefIdx)
+inline float Schlick(float a_dCosine, float a_dRefIdx)
 {
     float _r0 = (1.0f - a_dRefIdx) / (1.0f + a_dRefIdx);
 
@@ -14,7 +16,7 @@ float Schlick(float a_dCosine, float a_dRefIdx)
     return _r0 + (1.0f - _r0) * pow((1.0f - a_dCosine), 5);
 }
 
-bool Refract(const Vec3& a_oVecIn, const Vec3& a_oNormal, float a_fNiOverNt, Vec3& a_oRefracted)
+inline bool Refract(const Vec3& a_oVecIn, const Vec3& a_oNormal, float a_fNiOverNt, Vec3& a_oRefracted)
 {
     Vec3 _uv = Unit_Vector(a_oVecIn);
 
@@ -33,158 +35,137 @@ bool Refract(const Vec3& a_oVecIn, const Vec3& a_oNormal, float a_fNiOverNt, Vec
     }
 }
 
-Vec3 Reflect(const Vec3& a_oVecIn, const Vec3& a_oNormal)
+inline Vec3 Reflect(const Vec3& a_oVecIn, const Vec3& a_oNormal)
 {
     return a_oVecIn - 2 * Dot(a_oVecIn, a_oNormal) * a_oNormal;
 }
 
-Vec3 RandomInUnitSphere()
+// Rejection sampled; scattering uses the direct warps in sampling.h instead.
+inline Vec3 RandomInUnitSphere(Rng& a_oRng)
 {
     Vec3 _p;
 
     do
     {
-        _p = 2.0f * Vec3((std::rand() / (RAND_MAX + 1.0)),
-                         (std::rand() / (RAND_MAX + 1.0)),
-                         (std::rand() / (RAND_MAX + 1.0))) - Vec3(1.0f, 1.0f, 1.0f);
+        _p = 2.0f * Vec3(a_oRng.NextFloat(),
+                         a_oRng.NextFloat(),
+                         a_oRng.NextFloat()) - Vec3(1.0f, 1.0f, 1.0f);
     } while (_p.SquaredLength() >= 1.0f);
 
     return _p;
 }
 
-class Material
+enum MaterialType
 {
-public:
-    virtual bool Scatter(const Ray& a_oRayIn, const HitRecord& a_oRecord, Vec3& a_oAttenuation, Ray& a_oScatterRay) const = 0;
-
+    MATERIAL_LAMBERTIAN = 0,
+    MATERIAL_METAL,
+    MATERIAL_DIELECTRIC,
+    MATERIAL_EMISSIVE,
+    MATERIAL_TYPE_COUNT
 };
 
-
-class Metal : public Material
+// Plain material description. Scenes still declare Lambertian, Metal, Dielectric and
+// Emissive, which only fill these fields; shading dispatches on m_eType instead of through a vtable.
+struct Material
 {
-public:
-    Metal(const Vec3& a_oVecIn, float a_fFuzz);
+    Material(MaterialType a_eType, const Vec3& a_oAlbedo, float a_fParameter) : m_eType(a_eType),
+                                                                                m_oAlbedo(a_oAlbedo),
+                                                                                m_fParameter(a_fParameter),
+                                                                                m_uId(INVALID_MATERIAL_ID)
+    {
+    }
 
-    virtual bool Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const;
+    MaterialType m_eType;
 
+    // Emitted radiance for Emissive.
     Vec3 m_oAlbedo;
 
-    float m_fFuzz;
+    // Fuzz for Metal, refraction index for Dielectric, unused by Lambertian.
+    float m_fParameter;
+
+    // Set once the material is added to a MaterialTable.
+    MaterialId m_uId;
 };
 
-Metal::Metal(const Vec3 &a_oVecIn, float a_fFuzz) : m_oAlbedo(a_oVecIn)
+struct Metal : public Material
 {
-    if (a_fFuzz < 1)
-    {
-        m_fFuzz = a_fFuzz;
-    }
-    else
-    {
-        m_fFuzz = 1.0f;
-    }
-}
+    Metal(const Vec3& a_oVecIn, float a_fFuzz);
 
-bool Metal::Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const
+    static bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream);
+};
+
+inline Metal::Metal(const Vec3 &a_oVecIn, float a_fFuzz) : Material(MATERIAL_METAL, a_oVecIn, a_fFuzz < 1 ? a_fFuzz : 1.0f)
 {
-    Vec3 _reflected = Reflect(Unit_Vector(a_oRayIn.Direction()), a_oRecord.m_oNormal);
-    a_oScatterRay = Ray(a_oRecord.m_oPoint, _reflected + m_fFuzz * RandomInUnitSphere());
-    a_oAttenuation = m_oAlbedo;
-    return (Dot(a_oScatterRay.Direction(), a_oRecord.m_oNormal) > 0);
 }
 
-class Lambertian : public Material
+struct Lambertian : public Material
 {
-public:
     Lambertian(const Vec3& a_oVecIn);
 
-    virtual bool Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const;
-
-    Vec3 m_oAlbedo;
+    static bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream);
 };
 
-Lambertian::Lambertian(const Vec3& a_oVecIn) : m_oAlbedo(a_oVecIn)
-{
-}
-
-bool Lambertian::Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const
+inline Lambertian::Lambertian(const Vec3& a_oVecIn) : Material(MATERIAL_LAMBERTIAN, a_oVecIn, 0.0f)
 {
-    Vec3 _target = a_oRecord.m_oPoint + a_oRecord.m_oNormal + RandomInUnitSphere();
-
-    a_oScatterRay = Ray(a_oRecord.m_oPoint, _target - a_oRecord.m_oPoint);
-
-    a_oAttenuation = m_oAlbedo;
-
-    return true;
 }
 
-class Dielectric : public Material
+struct Dielectric : public Material
 {
-public:
     Dielectric(float a_fRefractionIdx);
 
-    virtual bool Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const;
-
-    float m_fRefIdx;
+    static bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream);
 };
 
-Dielectric::Dielectric(float a_fRefractionIdx) : m_fRefIdx(a_fRefractionIdx)
+inline Dielectric::Dielectric(float a_fRefractionIdx) : Material(MATERIAL_DIELECTRIC, Vec3(1.0f, 1.0f, 1.0f), a_fRefractionIdx)
 {
 }
 
-bool Dielectric::Scatter(const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay) const
+// Area light: emits m_oAlbedo as radiance from both sides and absorbs whatever reaches it.
+struct Emissive : public Material
 {
-    Vec3 _outwardNormal;
-
-    Vec3 _reflected = Reflect(a_oRayIn.Direction(), a_oRecord.m_oNormal);
-
-    float _niOverNt;
-
-    a_oAttenuation = Vec3(1.0f, 1.0f, 1.0f);
+    Emissive(const Vec3& a_oRadiance);
 
-    Vec3 _refracted;
-
-    float _reflectProb;
-
-    float _cosine;
-
-    if (Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) > 0)
-    {
-        _outwardNormal = -a_oRecord.m_oNormal;
+    static bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream);
+};
 
-        _niOverNt = m_fRefIdx;
+inline Emissive::Emissive(const Vec3& a_oRadiance) : Material(MATERIAL_EMISSIVE, a_oRadiance, 0.0f)
+{
+}
 
-        _cosine = Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) / a_oRayIn.Direction().Length();
+// Dispatches on a_oMaterial.m_eType.
+bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream);
 
-        _cosine = sqrtf(1.0f - m_fRefIdx * m_fRefIdx * (1.0f - _cosine * _cosine));
-    }
-    else
+// Contiguous copies of every material of a scene, indexed by MaterialId.
+class MaterialTable
+{
+public:
+    // Stores a copy and writes the new id back into a_oMaterial.
+    MaterialId Add(Material& a_oMaterial)
     {
-        _outwardNormal = a_oRecord.m_oNormal;
+        a_oMaterial.m_uId = static_cast<MaterialId>(this->m_oMaterials.size());
 
-        _niOverNt = 1.0f / m_fRefIdx;
+        this->m_oMaterials.push_back(a_oMaterial);
 
-        _cosine = -Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) / a_oRayIn.Direction().Length();
+        return a_oMaterial.m_uId;
     }
 
-    if (Refract(a_oRayIn.Direction(), _outwardNormal, _niOverNt, _refracted))
-    {
-        _reflectProb = Schlick(_cosine, m_fRefIdx);
-    }
-    else
+    const Material& Get(MaterialId a_uId) const
     {
-        _reflectProb = 1.0f;
+        return this->m_oMaterials[a_uId];
     }
 
-    if ((std::rand() / (RAND_MAX + 1.0)) < _reflectProb)
+    int GetCount() const
     {
-        a_oScatterRay = Ray(a_oRecord.m_oPoint, _reflected);
+        return static_cast<int>(this->m_oMaterials.size());
     }
-    else
+
+    void Clear()
     {
-        a_oScatterRay = Ray(a_oRecord.m_oPoint, _refracted);
+        this->m_oMaterials.clear();
     }
 
-    return true;
-}
+private:
+    std::vector<Material> m_oMaterials;
+};
 
 #endif // MATERIAL_H
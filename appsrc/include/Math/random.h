@@ -0,0 +1,81 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+#include "appsrc/include/Math/hash.h"
+
+// PCG32 generator (O'Neill, pcg-random.org). Small enough to live on the stack of every
+// worker, and seeded from the pixel/sample coordinates so renders are reproducible no
+// matter which thread picked up which tile.
+class Rng
+{
+public:
+    Rng();
+    Rng(uint64_t a_uSeed, uint64_t a_uStream);
+
+    void Seed(uint64_t a_uSeed, uint64_t a_uStream);
+
+    uint32_t NextUInt();
+
+    // Uniform float in [0, 1).
+    float NextFloat();
+
+    // Deterministic generator for one sample of one pixel.
+    static Rng ForPixel(int a_iX, int a_iY, int a_iSample, uint64_t a_uSeed = 0);
+
+    static uint64_t Mix(uint64_t a_uValue);
+
+    uint64_t m_uState;
+    uint64_t m_uIncrement;
+};
+
+inline Rng::Rng()
+{
+    this->Seed(0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL);
+}
+
+inline Rng::Rng(uint64_t a_uSeed, uint64_t a_uStream)
+{
+    this->Seed(a_uSeed, a_uStream);
+}
+
+inline void Rng::Seed(uint64_t a_uSeed, uint64_t a_uStream)
+{
+    this->m_uState = 0u;
+    this->m_uIncrement = (a_uStream << 1u) | 1u;
+    this->NextUInt();
+    this->m_uState += a_uSeed;
+    this->NextUInt();
+}
+
+inline uint32_t Rng::NextUInt()
+{
+    uint64_t _old = this->m_uState;
+
+    this->m_uState = _old * 6364136223846793005ULL + this->m_uIncrement;
+
+    uint32_t _xorShifted = static_cast<uint32_t>(((_old >> 18u) ^ _old) >> 27u);
+    uint32_t _rot = static_cast<uint32_t>(_old >> 59u);
+
+    return (_xorShifted >> _rot) | (_xorShifted << ((~_rot + 1u) & 31u));
+}
+
+inline float Rng::NextFloat()
+{
+    // Top 24 bits map exactly onto the float mantissa, so the result never rounds up to 1.
+    return static_cast<float>(this->NextUInt() >> 8) * (1.0f / 16777216.0f);
+}
+
+inline uint64_t Rng::Mix(uint64_t a_uValue)
+{
+    return SplitMix64(a_uValue);
+}
+
+inline Rng Rng::ForPixel(int a_iX, int a_iY, int a_iSample, uint64_t a_uSeed)
+{
+    uint64_t _pixel = (static_cast<uint64_t>(static_cast<uint32_t>(a_iY)) << 32) | static_cast<uint32_t>(a_iX);
+
+    return Rng(Mix(_pixel ^ Mix(a_uSeed)), Mix(static_cast<uint64_t>(static_cast<uint32_t>(a_iSample)) ^ a_uSeed));
+}
+
+#endif // RANDOM_H
@@ -7,17 +7,45 @@ class Ray
 {
 public:
     Ray();
-    Ray(const Vec3& a_oPointA, const Vec3& a_oPointB);
+    constexpr Ray(const Vec3& a_oPointA, const Vec3& a_oPointB, float a_fTime = 0.0f);
 
-    Vec3 Origin() const;
+    constexpr const Vec3& Origin() const;
 
-    Vec3 Direction() const;
+    constexpr const Vec3& Direction() const;
 
-    Vec3 PointAtParamenter(float a_fT) const;
+    constexpr Vec3 PointAtParamenter(float a_fT) const;
 
     Vec3 m_oOrigin;
 
     Vec3 m_oDirection;
+
+    // Scene time in frames; moving geometry is intersected where it is at this time.
+    float m_fTime;
 };
 
+inline Ray::Ray() : m_fTime(0.0f)
+{
+}
+
+constexpr Ray::Ray(const Vec3 &a_oPointA, const Vec3 &a_oPointB, float a_fTime) : m_oOrigin(a_oPointA),
+                                                                                   m_oDirection(a_oPointB),
+                                                                                   m_fTime(a_fTime)
+{
+}
+
+constexpr const Vec3& Ray::Origin() const
+{
+    return this->m_oOrigin;
+}
+
+constexpr const Vec3& Ray::Direction() const
+{
+    return this->m_oDirection;
+}
+
+constexpr Vec3 Ray::PointAtParamenter(float a_fT) const
+{
+    return this->m_oOrigin + a_fT * this->m_oDirection;
+}
+
 #endif // RAY_H
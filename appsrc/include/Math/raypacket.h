@@ -0,0 +1,34 @@
+#ifndef RAYPACKET_H
+#define RAYPACKET_H
+
+#include <stdint.h>
+#include <vector>
+#include "appsrc/include/Math/ray.h"
+
+// Up to eight rays in SoA layout, traced together through the BVH with one lane per ray.
+// Works best when the rays are coherent, e.g. primary rays of a 4x2 pixel block.
+struct RayPacket
+{
+    enum { SIZE = 8 };
+
+    RayPacket();
+
+    void Clear();
+
+    // Appends a ray; returns its lane.
+    int Add(const Ray& a_oRay);
+
+    Ray GetRay(int a_iLane) const;
+
+    alignas(32) float m_fOrigin[3][SIZE];
+    alignas(32) float m_fDirection[3][SIZE];
+    alignas(32) float m_fTime[SIZE];
+
+    int m_iCount;
+};
+
+// Orders rays so that rays with similar directions (same octant first, then nearby
+// angles) are adjacent, which keeps packets built from a stream of secondary rays coherent.
+void SortRayStream(const Ray* a_oRays, int a_iCount, std::vector<int>& a_oOrder);
+
+#endif // RAYPACKET_H
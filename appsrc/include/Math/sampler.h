@@ -0,0 +1,218 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum SamplerType
+{
+    SAMPLER_INDEPENDENT = 0,
+    SAMPLER_STRATIFIED,
+    SAMPLER_SOBOL,
+    SAMPLER_BLUE_NOISE,
+    SAMPLER_TYPE_COUNT
+};
+
+// Dimensions every path reads in the same order, so the same event of every path sees the
+// same dimension no matter what the earlier bounces consumed.
+enum SampleDimension
+{
+    SAMPLE_DIMENSION_PIXEL = 0,
+    SAMPLE_DIMENSION_LENS,
+    SAMPLE_DIMENSION_TIME,
+    SAMPLE_DIMENSION_FIRST_BOUNCE
+};
+
+// Dimensions of one bounce: the scatter direction (or a dielectric's reflect/refract choice),
+// a second scatter value such as the metal fuzz radius, Russian roulette, then the point
+// on a light and the choice of light for next event estimation.
+enum BounceSampleSlot
+{
+    SAMPLE_SLOT_SCATTER = 0,
+    SAMPLE_SLOT_SCATTER_EXTRA,
+    SAMPLE_SLOT_ROULETTE,
+    SAMPLE_SLOT_LIGHT,
+    SAMPLE_SLOT_LIGHT_SELECT,
+    SAMPLE_SLOTS_PER_BOUNCE
+};
+
+// Source of the [0, 1) values a path consumes, addressed by pixel, sample index and
+// dimension rather than drawn from a running generator. Each dimension is either one value
+// or one 2D point, and 2D points are well distributed in both coordinates together.
+class Sampler
+{
+public:
+    virtual ~Sampler();
+
+    virtual float Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const = 0;
+
+    virtual void Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV) const = 0;
+
+    SamplerType GetType() const;
+
+    uint32_t GetSeed() const;
+
+    // a_iSamplesPerPixel sizes the strata of the stratified sampler; the others ignore it.
+    static std::unique_ptr<Sampler> Create(SamplerType a_eType, int a_iSamplesPerPixel, uint32_t a_uSeed = 0);
+
+    // Accepts "independent", "stratified", "sobol" and "bluenoise".
+    static bool ParseType(const std::string& a_sName, SamplerType& a_eType);
+
+    static const char* GetTypeName(SamplerType a_eType);
+
+protected:
+    Sampler(SamplerType a_eType, uint32_t a_uSeed);
+
+    uint32_t m_uSeed;
+
+private:
+    Sampler(const Sampler&);
+    Sampler& operator=(const Sampler&);
+
+    SamplerType m_eType;
+};
+
+// Uncorrelated hash of (pixel, sample, dimension); what the renderer used before samplers.
+class IndependentSampler : public Sampler
+{
+public:
+    explicit IndependentSampler(uint32_t a_uSeed);
+
+    virtual float Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const;
+
+    virtual void Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV) const;
+};
+
+// Kensler's correlated multi-jittered sampling: the first a_iSamplesPerPixel samples of a
+// pixel fall one per cell of a jittered grid and one per row and column of its sub-grid.
+// Strata are permuted per pixel and dimension.
+class StratifiedSampler : public Sampler
+{
+public:
+    StratifiedSampler(int a_iSamplesPerPixel, uint32_t a_uSeed);
+
+    virtual float Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const;
+
+    virtual void Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV) const;
+
+    // The per-pixel budget the strata were sized for, and the grid holding it.
+    int GetSampleCount() const;
+    int GetColumns() const;
+    int GetRows() const;
+
+private:
+    int m_iSamples;
+
+    // Grid of m_iColumns x m_iRows cells holding m_iSamples.
+    int m_iColumns;
+    int m_iRows;
+};
+
+// First two Sobol dimensions, with the index shuffled and every coordinate Owen scrambled
+// from a per-pixel, per-dimension seed (Burley, "Practical Hash-based Owen Scrambling").
+// Any prefix of a pixel's samples stays well stratified, so it also suits progressive and
+// adaptive rendering.
+class SobolSampler : public Sampler
+{
+public:
+    explicit SobolSampler(uint32_t a_uSeed);
+
+    virtual float Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const;
+
+    virtual void Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV) const;
+};
+
+// Every pixel uses the same scrambled Sobol points, toroidally shifted by a void-and-cluster
+// blue-noise mask (Georgiev and Fajardo, "Blue-noise Dithered Sampling"). Errors of
+// neighbouring pixels become anticorrelated and read as fine grain at low sample counts.
+class BlueNoiseSampler : public Sampler
+{
+public:
+    explicit BlueNoiseSampler(uint32_t a_uSeed);
+
+    virtual float Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const;
+
+    virtual void Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV) const;
+
+    static const int MASK_SIZE = 64;
+
+    // MASK_SIZE x MASK_SIZE ranks in (0, 1), row by row.
+    const std::vector<float>& GetMask() const;
+
+private:
+    float MaskValue(int a_iX, int a_iY, uint32_t a_uOffset) const;
+
+    std::vector<float> m_oMask;
+};
+
+// Cursor over the dimensions of one path sample.
+class SampleStream
+{
+public:
+    SampleStream();
+    SampleStream(const Sampler* a_pSampler, int a_iX, int a_iY, int a_iSample);
+
+    float Next1D();
+
+    void Next2D(float& a_fU, float& a_fV);
+
+    void SetDimension(int a_iDimension);
+
+    int GetDimension() const;
+
+    // First dimension of bounce a_iBounce; add a SAMPLE_SLOT_* for a specific event.
+    static int BounceDimension(int a_iBounce);
+
+private:
+    const Sampler* m_pSampler;
+
+    int m_iX;
+    int m_iY;
+    int m_iSample;
+    int m_iDimension;
+};
+
+inline SampleStream::SampleStream() : m_pSampler(nullptr),
+                                      m_iX(0),
+                                      m_iY(0),
+                                      m_iSample(0),
+                                      m_iDimension(0)
+{
+}
+
+inline SampleStream::SampleStream(const Sampler* a_pSampler, int a_iX, int a_iY, int a_iSample) : m_pSampler(a_pSampler),
+                                                                                                    m_iX(a_iX),
+                                                                                                    m_iY(a_iY),
+                                                                                                    m_iSample(a_iSample),
+                                                                                                    m_iDimension(0)
+{
+}
+
+inline float SampleStream::Next1D()
+{
+    return this->m_pSampler->Get1D(this->m_iX, this->m_iY, this->m_iSample, this->m_iDimension++);
+}
+
+inline void SampleStream::Next2D(float& a_fU, float& a_fV)
+{
+    this->m_pSampler->Get2D(this->m_iX, this->m_iY, this->m_iSample, this->m_iDimension++, a_fU, a_fV);
+}
+
+inline void SampleStream::SetDimension(int a_iDimension)
+{
+    this->m_iDimension = a_iDimension;
+}
+
+inline int SampleStream::GetDimension() const
+{
+    return this->m_iDimension;
+}
+
+inline int SampleStream::BounceDimension(int a_iBounce)
+{
+    return SAMPLE_DIMENSION_FIRST_BOUNCE + a_iBounce * SAMPLE_SLOTS_PER_BOUNCE;
+}
+
+#endif // SAMPLER_H
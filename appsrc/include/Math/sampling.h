@@ -0,0 +1,97 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <math.h>
+#include "appsrc/include/Math/vec3.h"
+
+// Direct warps from [0, 1)^n onto the domains the renderer samples. None of them reject,
+// so stratified and low-discrepancy input keeps its structure after the mapping.
+
+// Shirley and Chiu's concentric mapping onto the unit disk in the z = 0 plane.
+inline Vec3 ConcentricSampleDisk(float a_fU, float a_fV)
+{
+    float _a = 2.0f * a_fU - 1.0f;
+    float _b = 2.0f * a_fV - 1.0f;
+
+    if (_a == 0.0f && _b == 0.0f)
+    {
+        return Vec3(0.0f, 0.0f, 0.0f);
+    }
+
+    float _radius;
+    float _phi;
+
+    if (fabsf(_a) > fabsf(_b))
+    {
+        _radius = _a;
+        _phi = float(M_PI / 4) * (_b / _a);
+    }
+    else
+    {
+        _radius = _b;
+        _phi = float(M_PI / 2) - float(M_PI / 4) * (_a / _b);
+    }
+
+    return Vec3(_radius * cosf(_phi), _radius * sinf(_phi), 0.0f);
+}
+
+// Tangent and bitangent completing the unit vector a_oNormal into a right-handed basis,
+// without branches on the axis (Duff et al., "Building an Orthonormal Basis, Revisited").
+inline void BuildOrthonormalBasis(const Vec3& a_oNormal, Vec3& a_oTangent, Vec3& a_oBitangent)
+{
+    float _sign = copysignf(1.0f, a_oNormal.GetZ());
+
+    float _a = -1.0f / (_sign + a_oNormal.GetZ());
+    float _b = a_oNormal.GetX() * a_oNormal.GetY() * _a;
+
+    a_oTangent = Vec3(1.0f + _sign * a_oNormal.GetX() * a_oNormal.GetX() * _a, _sign * _b, -_sign * a_oNormal.GetX());
+    a_oBitangent = Vec3(_b, _sign + a_oNormal.GetY() * a_oNormal.GetY() * _a, -a_oNormal.GetY());
+}
+
+// Unit direction about a_oNormal with density cos(theta) / pi: the disk mapping lifted onto
+// the hemisphere (Malley's method).
+inline Vec3 SampleCosineHemisphere(const Vec3& a_oNormal, float a_fU, float a_fV)
+{
+    Vec3 _disk = ConcentricSampleDisk(a_fU, a_fV);
+
+    float _z = sqrtf(fmaxf(0.0f, 1.0f - _disk.GetX() * _disk.GetX() - _disk.GetY() * _disk.GetY()));
+
+    Vec3 _tangent;
+    Vec3 _bitangent;
+
+    BuildOrthonormalBasis(a_oNormal, _tangent, _bitangent);
+
+    return _disk.GetX() * _tangent + _disk.GetY() * _bitangent + _z * a_oNormal;
+}
+
+// Unit direction within angle theta of a_oAxis, uniform over the cone's solid angle
+// 2 pi (1 - cos theta). Takes 1 - cos theta itself, which a narrow cone needs exactly.
+inline Vec3 SampleUniformCone(const Vec3& a_oAxis, float a_fOneMinusCos, float a_fU, float a_fV)
+{
+    float _k = a_fU * a_fOneMinusCos;
+
+    float _cosine = 1.0f - _k;
+    float _sine = sqrtf(fmaxf(0.0f, _k * (2.0f - _k)));
+    float _phi = float(2.0 * M_PI) * a_fV;
+
+    Vec3 _tangent;
+    Vec3 _bitangent;
+
+    BuildOrthonormalBasis(a_oAxis, _tangent, _bitangent);
+
+    return (_sine * cosf(_phi)) * _tangent + (_sine * sinf(_phi)) * _bitangent + _cosine * a_oAxis;
+}
+
+// Uniform point in the unit ball: a direction from (a_fU, a_fV), a radius from a_fW.
+inline Vec3 SampleUniformBall(float a_fU, float a_fV, float a_fW)
+{
+    float _z = 1.0f - 2.0f * a_fU;
+    float _r = sqrtf(fmaxf(0.0f, 1.0f - _z * _z));
+    float _phi = float(2.0 * M_PI) * a_fV;
+
+    float _radius = cbrtf(a_fW);
+
+    return Vec3(_radius * _r * cosf(_phi), _radius * _r * sinf(_phi), _radius * _z);
+}
+
+#endif // SAMPLING_H
@@ -0,0 +1,111 @@
+#ifndef SCENEARENA_H
+#define SCENEARENA_H
+
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "appsrc/include/Math/material.h"
+
+// Owns every primitive, material and list of a scene. Objects are bump-allocated into
+// large contiguous blocks in creation order, so a material created right before its
+// sphere sits next to it, and Release() destroys everything at once, newest first.
+// Pointers handed out stay valid until Release() or the arena's destruction. Every
+// Material created here is also added to the arena's MaterialTable, which fixes its id.
+class SceneArena
+{
+public:
+    explicit SceneArena(size_t a_uBlockSize = 64 * 1024);
+
+    ~SceneArena();
+
+    template <typename T, typename... Args>
+    T* Create(Args&&... a_oArgs)
+    {
+        void* _memory = this->Allocate(sizeof(T), alignof(T));
+
+        T* _object = new (_memory) T(std::forward<Args>(a_oArgs)...);
+
+        this->Register(_object, std::is_base_of<Material, T>());
+
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            Destructor _destructor;
+            _destructor.m_pDestroy = &SceneArena::Destroy<T>;
+            _destructor.m_pObject = _object;
+
+            this->m_oDestructors.push_back(_destructor);
+        }
+
+        return _object;
+    }
+
+    // Value-initialised array; limited to types that need no destructor.
+    template <typename T>
+    T* CreateArray(size_t a_uCount)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena arrays are never destroyed element by element");
+
+        void* _memory = this->Allocate(sizeof(T) * a_uCount, alignof(T));
+
+        return new (_memory) T[a_uCount]();
+    }
+
+    // Destroys every object and frees all blocks; the arena can be reused afterwards.
+    void Release();
+
+    const MaterialTable& GetMaterials() const;
+
+    size_t GetBytesUsed() const;
+
+    size_t GetBlockCount() const;
+
+private:
+    struct Block
+    {
+        char* m_pData;
+        size_t m_uSize;
+    };
+
+    struct Destructor
+    {
+        void (*m_pDestroy)(void*);
+        void* m_pObject;
+    };
+
+    template <typename T>
+    static void Destroy(void* a_pObject)
+    {
+        static_cast<T*>(a_pObject)->~T();
+    }
+
+    SceneArena(const SceneArena&);
+    SceneArena& operator=(const SceneArena&);
+
+    void* Allocate(size_t a_uSize, size_t a_uAlignment);
+
+    void Register(Material* a_oMaterial, std::true_type)
+    {
+        this->m_oMaterials.Add(*a_oMaterial);
+    }
+
+    void Register(void*, std::false_type)
+    {
+    }
+
+    size_t m_uBlockSize;
+
+    // Bytes used in the last block.
+    size_t m_uOffset;
+
+    size_t m_uBytesUsed;
+
+    std::vector<Block> m_oBlocks;
+
+    std::vector<Destructor> m_oDestructors;
+
+    MaterialTable m_oMaterials;
+};
+
+#endif // SCENEARENA_H
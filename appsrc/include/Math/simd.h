@@ -0,0 +1,47 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RT_SIMD_X86 1
+#endif
+
+// Per-function ISA targeting so one binary can carry SSE, AVX2 and AVX-512 kernels and
+// choose between them at runtime. MSVC accepts the intrinsics without an attribute.
+// GCC would otherwise fuse the AVX-512 mul/add intrinsics into FMAs, so contraction is
+// disabled to keep every kernel bit-identical to the scalar path.
+#if defined(RT_SIMD_X86) && defined(__clang__)
+#define RT_TARGET_AVX2 __attribute__((target("avx2")))
+#define RT_TARGET_AVX512 __attribute__((target("avx512f")))
+#elif defined(RT_SIMD_X86) && defined(__GNUC__)
+#define RT_TARGET_AVX2 __attribute__((target("avx2"), optimize("fp-contract=off")))
+#define RT_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#else
+#define RT_TARGET_AVX2
+#define RT_TARGET_AVX512
+#endif
+
+enum SimdIsa
+{
+    SIMD_ISA_SCALAR = 0,
+    SIMD_ISA_SSE2,
+    SIMD_ISA_AVX2,
+    SIMD_ISA_AVX512
+};
+
+// Widest instruction set supported by both the build and the running CPU.
+SimdIsa DetectSimdIsa();
+
+// Lets RT_SIMD_ISA=scalar|sse2|avx2|avx512 cap the detected ISA, for benchmarking.
+SimdIsa GetActiveSimdIsa();
+
+const char* SimdIsaName(SimdIsa a_eIsa);
+
+int SimdIsaWidth(SimdIsa a_eIsa);
+
+void* AlignedAlloc(size_t a_uSize, size_t a_uAlignment);
+
+void AlignedFree(void* a_pMemory);
+
+#endif // SIMD_H
@@ -7,13 +7,16 @@ class Sphere : public Hittable
 {
 public:
     Sphere();
-    Sphere(Vec3 a_oCenter, float a_fRadius, Material* a_oMaterial);
+    // a_oMaterial must already be in a MaterialTable; the sphere keeps only its id.
+    Sphere(Vec3 a_oCenter, float a_fRadius, const Material* a_oMaterial);
 
     virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const;
 
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
     Vec3 m_oCenter;
     float m_fRadius;
 
-    Material* m_oMaterial;
+    MaterialId m_uMaterialId;
 };
 #endif // SPHERE_H
@@ -0,0 +1,108 @@
+#ifndef SPHERESOA_H
+#define SPHERESOA_H
+
+#include <stdint.h>
+#include <vector>
+#include "appsrc/include/Math/hittablelist.h"
+#include "appsrc/include/Math/sphere.h"
+#include "appsrc/include/Math/simd.h"
+
+// Ray terms shared by every sphere test, computed once per ray instead of once per sphere.
+struct SphereRay
+{
+    explicit SphereRay(const Ray& a_oRay);
+
+    float m_fOrigin[3];
+    float m_fDirection[3];
+
+    // Dot(direction, direction).
+    float m_fA;
+
+    float m_fTime;
+};
+
+// Spheres stored as separate aligned arrays so one ray can be tested against 4, 8 or 16
+// of them per instruction. Only t and the sphere index are tracked while searching;
+// the HitRecord is filled once for the closest hit.
+class SphereSoA : public Hittable
+{
+public:
+    SphereSoA();
+    explicit SphereSoA(const HittableList& a_oList);
+    ~SphereSoA();
+
+    SphereSoA(const SphereSoA& a_oOther);
+    SphereSoA& operator=(const SphereSoA& a_oOther);
+
+    // Every array holds PADDING entries past its capacity so the widest kernel may always
+    // load a full vector; padded centres and radii are NaN, which never compare as a hit.
+    static const int PADDING = 16;
+
+    void Reserve(int a_iCapacity);
+
+    // Points at arrays owned by someone else, e.g. a mapped scene cache, laid out like the
+    // owned ones: a_iCount entries followed by PADDING NaN lanes. Nothing is copied or
+    // freed; growing the container copies the spheres into owned storage first.
+    void Attach(float* a_pCenterX, float* a_pCenterY, float* a_pCenterZ, float* a_pRadius, MaterialId* a_pMaterialId, int a_iCount);
+
+    void Add(const Vec3& a_oCenter, float a_fRadius, MaterialId a_uMaterialId);
+
+    // Makes sphere a_iIndex move linearly, a_oVelocity per unit of ray time (one frame), so
+    // its centre at time t is centre + t * velocity. The velocity arrays are allocated on
+    // the first call, always owned, and until then every sphere is static and the kernels
+    // never touch them.
+    void SetVelocity(int a_iIndex, const Vec3& a_oVelocity);
+
+    Vec3 GetVelocity(int a_iIndex) const;
+
+    bool HasMotion() const;
+
+    Vec3 GetCenter(int a_iIndex, float a_fTime = 0.0f) const;
+
+    void Clear();
+
+    // Permutes the spheres so that new index i holds old index a_oOrder[i].
+    void Reorder(const std::vector<int>& a_oOrder);
+
+    virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const;
+
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
+    // Closest sphere in [a_iBegin, a_iEnd) with a_fTMin < t < a_fTMax. On a hit, shrinks
+    // a_fTMax to the new t and stores the sphere index.
+    bool Intersect(const SphereRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex) const;
+
+    void FillRecord(const Ray& a_oRay, float a_fT, int a_iIndex, HitRecord& a_oRecord) const;
+
+    // Bounds over the times [a_fTimeBegin, a_fTimeEnd].
+    Aabb GetSphereBounds(int a_iIndex, float a_fTimeBegin = 0.0f, float a_fTimeEnd = 0.0f) const;
+
+    int GetCount() const;
+
+    static SimdIsa GetIsa();
+
+    float* m_pCenterX;
+    float* m_pCenterY;
+    float* m_pCenterZ;
+    float* m_pRadius;
+
+    MaterialId* m_pMaterialId;
+
+    // Null while every sphere is static.
+    float* m_pVelocityX;
+    float* m_pVelocityY;
+    float* m_pVelocityZ;
+
+private:
+    void Release();
+
+    void ReleaseVelocity();
+
+    int m_iCount;
+    int m_iCapacity;
+
+    // False while attached to external arrays.
+    bool m_bOwner;
+};
+
+#endif // SPHERESOA_H
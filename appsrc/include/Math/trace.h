@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <string>
+
+// Building with -DRT_ENABLE_TRACING=0 turns every RT_TRACE_SPAN into nothing.
+#ifndef RT_ENABLE_TRACING
+#define RT_ENABLE_TRACING 1
+#endif
+
+// Records timed spans per thread and writes them in the Chrome trace event format, which
+// chrome://tracing and Perfetto open directly. Recording is off until Start(), so spans
+// cost one relaxed load when nobody is tracing.
+class Tracer
+{
+public:
+    static void Start();
+
+    static void Stop();
+
+    static bool IsRecording();
+
+    // Nanoseconds on a steady clock, relative to the first call.
+    static uint64_t Now();
+
+    // a_pName must outlive the tracer, e.g. a string literal. Negative arguments are omitted.
+    static void Record(const char* a_pName, uint64_t a_uStartNs, uint64_t a_uEndNs, int a_iArgX, int a_iArgY);
+
+    // Writes every recorded span and clears them. Call once the spans' threads are idle.
+    static bool Write(const std::string& a_sPath);
+};
+
+// Records the span from construction to destruction while the tracer is recording.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* a_pName, int a_iArgX = -1, int a_iArgY = -1);
+
+    ~TraceSpan();
+
+private:
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+
+    const char* m_pName;
+
+    int m_iArgX;
+    int m_iArgY;
+
+    bool m_bRecording;
+
+    uint64_t m_uStartNs;
+};
+
+#define RT_TRACE_JOIN_IMPL(a_oA, a_oB) a_oA##a_oB
+#define RT_TRACE_JOIN(a_oA, a_oB) RT_TRACE_JOIN_IMPL(a_oA, a_oB)
+
+#if RT_ENABLE_TRACING
+#define RT_TRACE_SPAN(...) TraceSpan RT_TRACE_JOIN(_traceSpan, __LINE__)(__VA_ARGS__)
+#else
+#define RT_TRACE_SPAN(...)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,63 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "appsrc/include/Math/aabb.h"
+
+// Affine 3x4 transform, p' = M * (p, 1). The point and vector maps are inline because
+// instances apply them to every ray.
+struct Transform
+{
+    // Identity.
+    Transform();
+
+    static Transform Translate(const Vec3& a_oOffset);
+
+    static Transform Scale(const Vec3& a_oFactors);
+
+    // Right-handed rotation of a_fDegrees around a_oAxis, which need not be unit length.
+    static Transform Rotate(const Vec3& a_oAxis, float a_fDegrees);
+
+    // Applies a_oRhs first, then this.
+    Transform operator*(const Transform& a_oRhs) const;
+
+    // Assumes the linear part is invertible.
+    Transform Inverse() const;
+
+    Vec3 Point(const Vec3& a_oPoint) const;
+
+    Vec3 Vector(const Vec3& a_oVector) const;
+
+    // Multiplies by the transposed linear part. Called on the world-to-object transform,
+    // this maps an object-space normal to world space; the result is not normalised.
+    Vec3 TransposedVector(const Vec3& a_oVector) const;
+
+    // Bounds of the eight transformed corners.
+    Aabb Box(const Aabb& a_oBox) const;
+
+    bool IsIdentity() const;
+
+    float m_fM[3][4];
+};
+
+inline Vec3 Transform::Point(const Vec3& a_oPoint) const
+{
+    return Vec3(this->m_fM[0][0] * a_oPoint[0] + this->m_fM[0][1] * a_oPoint[1] + this->m_fM[0][2] * a_oPoint[2] + this->m_fM[0][3],
+                this->m_fM[1][0] * a_oPoint[0] + this->m_fM[1][1] * a_oPoint[1] + this->m_fM[1][2] * a_oPoint[2] + this->m_fM[1][3],
+                this->m_fM[2][0] * a_oPoint[0] + this->m_fM[2][1] * a_oPoint[1] + this->m_fM[2][2] * a_oPoint[2] + this->m_fM[2][3]);
+}
+
+inline Vec3 Transform::Vector(const Vec3& a_oVector) const
+{
+    return Vec3(this->m_fM[0][0] * a_oVector[0] + this->m_fM[0][1] * a_oVector[1] + this->m_fM[0][2] * a_oVector[2],
+                this->m_fM[1][0] * a_oVector[0] + this->m_fM[1][1] * a_oVector[1] + this->m_fM[1][2] * a_oVector[2],
+                this->m_fM[2][0] * a_oVector[0] + this->m_fM[2][1] * a_oVector[1] + this->m_fM[2][2] * a_oVector[2]);
+}
+
+inline Vec3 Transform::TransposedVector(const Vec3& a_oVector) const
+{
+    return Vec3(this->m_fM[0][0] * a_oVector[0] + this->m_fM[1][0] * a_oVector[1] + this->m_fM[2][0] * a_oVector[2],
+                this->m_fM[0][1] * a_oVector[0] + this->m_fM[1][1] * a_oVector[1] + this->m_fM[2][1] * a_oVector[2],
+                this->m_fM[0][2] * a_oVector[0] + this->m_fM[1][2] * a_oVector[1] + this->m_fM[2][2] * a_oVector[2]);
+}
+
+#endif // TRANSFORM_H
@@ -0,0 +1,109 @@
+#ifndef TRIANGLEMESH_H
+#define TRIANGLEMESH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "appsrc/include/Math/hittable.h"
+#include "appsrc/include/Math/simd.h"
+
+// Ray terms shared by every triangle test.
+struct TriangleRay
+{
+    explicit TriangleRay(const Ray& a_oRay);
+
+    float m_fOrigin[3];
+    float m_fDirection[3];
+};
+
+// Indexed triangle mesh with one material. Triangles share vertices through 32-bit
+// indices and are wound counter-clockwise seen from the front, which is the side the
+// geometric normal faces; dielectric meshes must be closed for refraction to pair up.
+//
+// Vertex positions are full floats, or after Quantize() 16-bit fixed point on a grid
+// spanning the mesh bounds, which halves vertex memory at a precision of 1/65535 of the
+// extent. The SIMD kernels test 4 (SSE2) or 8 (AVX2) triangles at once, gathering their
+// vertices through the index buffer, so a Bvh over the mesh uses leaves of that width
+// and keeps each leaf a contiguous triangle range, like the sphere leaves.
+class TriangleMesh : public Hittable
+{
+public:
+    explicit TriangleMesh(MaterialId a_uMaterialId = 0);
+
+    void ReserveVertices(int a_iCapacity);
+
+    void ReserveTriangles(int a_iCapacity);
+
+    // Only while the positions are still floats.
+    void AddVertex(const Vec3& a_oPosition);
+
+    // Indices must name vertices already added.
+    void AddTriangle(uint32_t a_uA, uint32_t a_uB, uint32_t a_uC);
+
+    // Snaps every vertex to the 16-bit grid over the current bounds and frees the float
+    // positions. Call it once all vertices are in.
+    void Quantize();
+
+    bool IsQuantized() const;
+
+    void Clear();
+
+    // Permutes the triangles so that new index i holds old index a_oOrder[i]; vertices stay put.
+    void Reorder(const std::vector<int>& a_oOrder);
+
+    // Brute force over every triangle; a Bvh over the mesh is the fast path.
+    virtual bool Hit(const Ray& a_oRay, float a_fTMin, float a_fTMax, HitRecord& a_oRecord) const;
+
+    virtual bool BoundingBox(Aabb& a_oBox) const;
+
+    // Closest triangle in [a_iBegin, a_iEnd) with a_fTMin < t < a_fTMax. On a hit, shrinks
+    // a_fTMax to the new t and stores the triangle index.
+    bool Intersect(const TriangleRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex) const;
+
+    void FillRecord(const Ray& a_oRay, float a_fT, int a_iIndex, HitRecord& a_oRecord) const;
+
+    Aabb GetTriangleBounds(int a_iIndex) const;
+
+    // The position the kernels see, dequantized if need be.
+    Vec3 GetVertex(int a_iIndex) const;
+
+    const uint32_t* GetTriangle(int a_iIndex) const;
+
+    int GetVertexCount() const;
+
+    int GetTriangleCount() const;
+
+    MaterialId GetMaterialId() const;
+
+    void SetMaterialId(MaterialId a_uMaterialId);
+
+    // Bytes held by the vertex and index arrays.
+    size_t GetMemoryBytes() const;
+
+    // Triangles tested per kernel call: 8 with AVX2 or wider, 4 otherwise.
+    static int GetBatchWidth();
+
+    static SimdIsa GetIsa();
+
+private:
+    // x, y, z per vertex; empty once quantized.
+    std::vector<float> m_oPositions;
+
+    // x, y, z per vertex and one trailing entry, so a 32-bit gather of the last z stays in bounds.
+    std::vector<uint16_t> m_oQuantized;
+
+    // Three per triangle.
+    std::vector<uint32_t> m_oIndices;
+
+    int m_iVertexCount;
+
+    Aabb m_oBounds;
+
+    // Dequantized position = m_fGridOrigin + q * m_fGridStep, per axis.
+    float m_fGridOrigin[3];
+    float m_fGridStep[3];
+
+    MaterialId m_uMaterialId;
+};
+
+#endif // TRIANGLEMESH_H
@@ -5,30 +5,32 @@
 #include <stdlib.h>
 #include <iostream>
 
+// Members are defined inline below the class, and the pure ones are constexpr, so the
+// hot arithmetic inlines into every translation unit without relying on LTO.
 class Vec3
 {
 public:
     Vec3();
 
-    Vec3(const float& a_cfE0, const float& a_cfE1, const float& a_cfE2);
+    constexpr Vec3(const float& a_cfE0, const float& a_cfE1, const float& a_cfE2);
 
-    float GetX() const;
+    constexpr float GetX() const;
 
-    float GetY() const;
+    constexpr float GetY() const;
 
-    float GetZ() const;
+    constexpr float GetZ() const;
 
-    float GetR() const;
+    constexpr float GetR() const;
 
-    float GetG() const;
+    constexpr float GetG() const;
 
-    float GetB() const;
+    constexpr float GetB() const;
 
-    const Vec3& operator+() const;
+    constexpr const Vec3& operator+() const;
 
-    Vec3 operator-() const;
+    constexpr Vec3 operator-() const;
 
-    float operator[](int a_iIndex) const;
+    constexpr float operator[](int a_iIndex) const;
 
     float& operator[](int a_iIndex);
 
@@ -42,7 +44,7 @@ public:
 
     float Length() const;
 
-    float SquaredLength() const;
+    constexpr float SquaredLength() const;
 
     void MakeUnitVector();
 
@@ -50,6 +52,139 @@ public:
 
 };
 
+inline Vec3::Vec3()
+{
+}
+
+constexpr Vec3::Vec3(const float &a_cfE0, const float &a_cfE1, const float &a_cfE2) : m_fAxis{ a_cfE0, a_cfE1, a_cfE2 }
+{
+}
+
+constexpr float Vec3::GetX() const
+{
+    return this->m_fAxis[0];
+}
+
+constexpr float Vec3::GetY() const
+{
+    return this->m_fAxis[1];
+}
+
+constexpr float Vec3::GetZ() const
+{
+    return this->m_fAxis[2];
+}
+
+constexpr float Vec3::GetR() const
+{
+    return this->m_fAxis[0];
+}
+
+constexpr float Vec3::GetG() const
+{
+    return this->m_fAxis[1];
+}
+
+constexpr float Vec3::GetB() const
+{
+    return this->m_fAxis[2];
+}
+
+constexpr const Vec3& Vec3::operator+() const
+{
+    return *this;
+}
+
+constexpr Vec3 Vec3::operator-() const
+{
+    return Vec3(-this->m_fAxis[0], -this->m_fAxis[1], -this->m_fAxis[2]);
+}
+
+constexpr float Vec3::operator[](int a_iIndex) const
+{
+    return this->m_fAxis[a_iIndex];
+}
+
+inline float& Vec3::operator[](int a_iIndex)
+{
+    return this->m_fAxis[a_iIndex];
+}
+
+inline Vec3& Vec3::operator+=(const Vec3& a_oRhs)
+{
+    this->m_fAxis[0] += a_oRhs.m_fAxis[0];
+    this->m_fAxis[1] += a_oRhs.m_fAxis[1];
+    this->m_fAxis[2] += a_oRhs.m_fAxis[2];
+
+    return *this;
+}
+
+inline Vec3& Vec3::operator-=(const Vec3& a_oRhs)
+{
+    this->m_fAxis[0] -= a_oRhs.m_fAxis[0];
+    this->m_fAxis[1] -= a_oRhs.m_fAxis[1];
+    this->m_fAxis[2] -= a_oRhs.m_fAxis[2];
+
+    return *this;
+}
+
+inline Vec3& Vec3::operator/=(const Vec3& a_oRhs)
+{
+    this->m_fAxis[0] /= a_oRhs.m_fAxis[0];
+    this->m_fAxis[1] /= a_oRhs.m_fAxis[1];
+    this->m_fAxis[2] /= a_oRhs.m_fAxis[2];
+
+    return *this;
+}
+
+inline Vec3& Vec3::operator*=(const Vec3& a_oRhs)
+{
+    this->m_fAxis[0] *= a_oRhs.m_fAxis[0];
+    this->m_fAxis[1] *= a_oRhs.m_fAxis[1];
+    this->m_fAxis[2] *= a_oRhs.m_fAxis[2];
+
+    return *this;
+}
+
+inline Vec3& Vec3::operator*=(float a_cfDiscriminant)
+{
+    this->m_fAxis[0] *= a_cfDiscriminant;
+    this->m_fAxis[1] *= a_cfDiscriminant;
+    this->m_fAxis[2] *= a_cfDiscriminant;
+
+    return *this;
+}
+
+inline Vec3& Vec3::operator/=(float a_cfDiscriminant)
+{
+    float _k = 1.0f / a_cfDiscriminant;
+
+    this->m_fAxis[0] *= _k;
+    this->m_fAxis[1] *= _k;
+    this->m_fAxis[2] *= _k;
+
+    return *this;
+}
+
+inline void Vec3::MakeUnitVector()
+{
+    float _k = 1.0f / sqrtf((this->m_fAxis[0] * this->m_fAxis[0]) + (this->m_fAxis[1] * this->m_fAxis[1]) + (this->m_fAxis[2] * this->m_fAxis[2]));
+
+    this->m_fAxis[0] *= _k;
+    this->m_fAxis[1] *= _k;
+    this->m_fAxis[2] *= _k;
+}
+
+inline float Vec3::Length() const
+{
+    return sqrtf(this->m_fAxis[0] * this->m_fAxis[0] + this->m_fAxis[1] * this->m_fAxis[1] + this->m_fAxis[2] * this->m_fAxis[2]);
+}
+
+constexpr float Vec3::SquaredLength() const
+{
+    return this->m_fAxis[0] * this->m_fAxis[0] + this->m_fAxis[1] * this->m_fAxis[1] + this->m_fAxis[2] * this->m_fAxis[2];
+}
+
 inline std::istream& operator >>(std::istream& a_sStreamIn, Vec3& a_oVector)
 {
     a_sStreamIn >> a_oVector.m_fAxis[0] >> a_oVector.m_fAxis[1] >> a_oVector.m_fAxis[2];
@@ -66,70 +201,70 @@ inline std::ostream& operator <<(std::ostream& a_sStreamOut, const Vec3& a_oVect
     return a_sStreamOut;
 }
 
-inline Vec3 operator+(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr Vec3 operator+(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return Vec3(a_oLhs.m_fAxis[0] + a_oRhs.m_fAxis[0],
             a_oLhs.m_fAxis[1] + a_oRhs.m_fAxis[1],
             a_oLhs.m_fAxis[2] + a_oRhs.m_fAxis[2]);
 }
 
-inline Vec3 operator-(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr Vec3 operator-(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return Vec3(a_oLhs.m_fAxis[0] - a_oRhs.m_fAxis[0],
             a_oLhs.m_fAxis[1] - a_oRhs.m_fAxis[1],
             a_oLhs.m_fAxis[2] - a_oRhs.m_fAxis[2]);
 }
 
-inline Vec3 operator*(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr Vec3 operator*(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return Vec3(a_oLhs.m_fAxis[0] * a_oRhs.m_fAxis[0],
             a_oLhs.m_fAxis[1] * a_oRhs.m_fAxis[1],
             a_oLhs.m_fAxis[2] * a_oRhs.m_fAxis[2]);
 }
 
-inline Vec3 operator/(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr Vec3 operator/(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return Vec3(a_oLhs.m_fAxis[0] / a_oRhs.m_fAxis[0],
             a_oLhs.m_fAxis[1] / a_oRhs.m_fAxis[1],
             a_oLhs.m_fAxis[2] / a_oRhs.m_fAxis[2]);
 }
 
-inline Vec3 operator*(float a_fDisc, const Vec3& a_oVector)
+constexpr Vec3 operator*(float a_fDisc, const Vec3& a_oVector)
 {
     return Vec3(a_fDisc * a_oVector.m_fAxis[0],
             a_fDisc * a_oVector.m_fAxis[1],
             a_fDisc * a_oVector.m_fAxis[2]);
 }
 
-inline Vec3 operator*(const Vec3& a_oVector, float a_fDisc)
+constexpr Vec3 operator*(const Vec3& a_oVector, float a_fDisc)
 {
     return Vec3(a_oVector.m_fAxis[0] * a_fDisc,
             a_oVector.m_fAxis[1] * a_fDisc,
             a_oVector.m_fAxis[2] * a_fDisc);
 }
 
-inline Vec3 operator/(const Vec3& a_oVector, float a_fDisc)
+constexpr Vec3 operator/(const Vec3& a_oVector, float a_fDisc)
 {
     return Vec3(a_oVector.m_fAxis[0] / a_fDisc,
             a_oVector.m_fAxis[1] / a_fDisc,
             a_oVector.m_fAxis[2] / a_fDisc);
 }
 
-inline float Dot(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr float Dot(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return (a_oLhs.m_fAxis[0] * a_oRhs.m_fAxis[0]) +
            (a_oLhs.m_fAxis[1] * a_oRhs.m_fAxis[1]) +
            (a_oLhs.m_fAxis[2] * a_oRhs.m_fAxis[2]);
 }
 
-inline Vec3 Cross(const Vec3& a_oLhs, const Vec3& a_oRhs)
+constexpr Vec3 Cross(const Vec3& a_oLhs, const Vec3& a_oRhs)
 {
     return Vec3(a_oLhs.m_fAxis[1] * a_oRhs.m_fAxis[2] - a_oLhs.m_fAxis[2] * a_oRhs.m_fAxis[1],
             (-(a_oLhs.m_fAxis[0] * a_oRhs.m_fAxis[2] - a_oLhs.m_fAxis[2] * a_oRhs.m_fAxis[0])),
             a_oLhs.m_fAxis[0] * a_oRhs.m_fAxis[1] - a_oLhs.m_fAxis[1] * a_oRhs.m_fAxis[0]);
 }
 
-inline Vec3 Unit_Vector(Vec3 a_oVector)
+inline Vec3 Unit_Vector(const Vec3& a_oVector)
 {
     return a_oVector / a_oVector.Length();
 }
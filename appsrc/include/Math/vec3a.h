@@ -0,0 +1,379 @@
+#ifndef VEC3A_H
+#define VEC3A_H
+
+#include "appsrc/include/Math/vec3.h"
+#include "appsrc/include/Math/simd.h"
+
+#if defined(RT_SIMD_X86)
+#include <immintrin.h>
+#define RT_VEC3A_SSE 1
+#endif
+
+// Set to 1 to route Sphere::Hit, Camera::GetRay and the scatter functions through Vec3A.
+// That path normalizes with rsqrt and uses FMA where the target has it, so images are close
+// to, but not bit-identical with, the default Vec3 path.
+#ifndef RT_USE_VEC3A
+#define RT_USE_VEC3A 0
+#endif
+
+// Vec3 in one 16-byte aligned SSE register, w kept at zero. Without SSE it falls back to four
+// floats so the type stays available everywhere. Exact operations (arithmetic, Dot, Length,
+// Normalize) evaluate in the same order as Vec3 and round identically; NormalizeFast and
+// MulAdd trade that for speed.
+class alignas(16) Vec3A
+{
+public:
+    Vec3A();
+
+    Vec3A(float a_fX, float a_fY, float a_fZ);
+
+    explicit Vec3A(const Vec3& a_oVector);
+
+    // Same value in x, y and z.
+    static Vec3A Splat(float a_fValue);
+
+    Vec3 ToVec3() const;
+
+    float GetX() const;
+
+    float GetY() const;
+
+    float GetZ() const;
+
+    Vec3A& operator+=(const Vec3A& a_oRhs);
+    Vec3A& operator-=(const Vec3A& a_oRhs);
+    Vec3A& operator*=(const Vec3A& a_oRhs);
+    Vec3A& operator*=(float a_fScale);
+
+#if defined(RT_VEC3A_SSE)
+    explicit Vec3A(__m128 a_oValue);
+
+    __m128 m_oValue;
+#else
+    float m_fAxis[4];
+#endif
+};
+
+#if defined(RT_VEC3A_SSE)
+
+inline Vec3A::Vec3A() : m_oValue(_mm_setzero_ps())
+{
+}
+
+inline Vec3A::Vec3A(float a_fX, float a_fY, float a_fZ) : m_oValue(_mm_setr_ps(a_fX, a_fY, a_fZ, 0.0f))
+{
+}
+
+inline Vec3A::Vec3A(const Vec3 &a_oVector) : m_oValue(_mm_setr_ps(a_oVector.m_fAxis[0], a_oVector.m_fAxis[1], a_oVector.m_fAxis[2], 0.0f))
+{
+}
+
+inline Vec3A::Vec3A(__m128 a_oValue) : m_oValue(a_oValue)
+{
+}
+
+inline Vec3A Vec3A::Splat(float a_fValue)
+{
+    return Vec3A(_mm_setr_ps(a_fValue, a_fValue, a_fValue, 0.0f));
+}
+
+inline Vec3 Vec3A::ToVec3() const
+{
+    alignas(16) float _axis[4];
+
+    _mm_store_ps(_axis, this->m_oValue);
+
+    return Vec3(_axis[0], _axis[1], _axis[2]);
+}
+
+inline float Vec3A::GetX() const
+{
+    return _mm_cvtss_f32(this->m_oValue);
+}
+
+inline float Vec3A::GetY() const
+{
+    return _mm_cvtss_f32(_mm_shuffle_ps(this->m_oValue, this->m_oValue, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+
+inline float Vec3A::GetZ() const
+{
+    return _mm_cvtss_f32(_mm_movehl_ps(this->m_oValue, this->m_oValue));
+}
+
+inline Vec3A& Vec3A::operator+=(const Vec3A &a_oRhs)
+{
+    this->m_oValue = _mm_add_ps(this->m_oValue, a_oRhs.m_oValue);
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator-=(const Vec3A &a_oRhs)
+{
+    this->m_oValue = _mm_sub_ps(this->m_oValue, a_oRhs.m_oValue);
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator*=(const Vec3A &a_oRhs)
+{
+    this->m_oValue = _mm_mul_ps(this->m_oValue, a_oRhs.m_oValue);
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator*=(float a_fScale)
+{
+    this->m_oValue = _mm_mul_ps(this->m_oValue, _mm_set1_ps(a_fScale));
+
+    return *this;
+}
+
+inline Vec3A operator+(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    return Vec3A(_mm_add_ps(a_oLhs.m_oValue, a_oRhs.m_oValue));
+}
+
+inline Vec3A operator-(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    return Vec3A(_mm_sub_ps(a_oLhs.m_oValue, a_oRhs.m_oValue));
+}
+
+inline Vec3A operator-(const Vec3A& a_oVector)
+{
+    return Vec3A(_mm_sub_ps(_mm_setzero_ps(), a_oVector.m_oValue));
+}
+
+inline Vec3A operator*(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    return Vec3A(_mm_mul_ps(a_oLhs.m_oValue, a_oRhs.m_oValue));
+}
+
+inline Vec3A operator*(float a_fScale, const Vec3A& a_oVector)
+{
+    return Vec3A(_mm_mul_ps(_mm_set1_ps(a_fScale), a_oVector.m_oValue));
+}
+
+inline Vec3A operator*(const Vec3A& a_oVector, float a_fScale)
+{
+    return Vec3A(_mm_mul_ps(a_oVector.m_oValue, _mm_set1_ps(a_fScale)));
+}
+
+inline Vec3A operator/(const Vec3A& a_oVector, float a_fScale)
+{
+    // Dividing w by the scale too would turn a zero w into NaN for a zero scale; mask it back.
+    __m128 _quotient = _mm_div_ps(a_oVector.m_oValue, _mm_set1_ps(a_fScale));
+
+    return Vec3A(_mm_and_ps(_quotient, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0))));
+}
+
+// (x * x + y * y) + z * z, the same rounding sequence as the scalar Dot.
+inline float Dot(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    __m128 _product = _mm_mul_ps(a_oLhs.m_oValue, a_oRhs.m_oValue);
+
+    __m128 _sum = _mm_add_ss(_product, _mm_shuffle_ps(_product, _product, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    return _mm_cvtss_f32(_mm_add_ss(_sum, _mm_movehl_ps(_product, _product)));
+}
+
+inline Vec3A Cross(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    __m128 _lhsYzx = _mm_shuffle_ps(a_oLhs.m_oValue, a_oLhs.m_oValue, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 _rhsYzx = _mm_shuffle_ps(a_oRhs.m_oValue, a_oRhs.m_oValue, _MM_SHUFFLE(3, 0, 2, 1));
+
+    __m128 _crossZxy = _mm_sub_ps(_mm_mul_ps(a_oLhs.m_oValue, _rhsYzx), _mm_mul_ps(_lhsYzx, a_oRhs.m_oValue));
+
+    return Vec3A(_mm_shuffle_ps(_crossZxy, _crossZxy, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+
+// a * b + c, fused into one rounding when the target has FMA.
+inline Vec3A MulAdd(const Vec3A& a_oA, const Vec3A& a_oB, const Vec3A& a_oC)
+{
+#if defined(__FMA__)
+    return Vec3A(_mm_fmadd_ps(a_oA.m_oValue, a_oB.m_oValue, a_oC.m_oValue));
+#else
+    return Vec3A(_mm_add_ps(_mm_mul_ps(a_oA.m_oValue, a_oB.m_oValue), a_oC.m_oValue));
+#endif
+}
+
+// rsqrt estimate refined by one Newton-Raphson step, about 23 bits of precision.
+inline Vec3A NormalizeFast(const Vec3A& a_oVector)
+{
+    __m128 _product = _mm_mul_ps(a_oVector.m_oValue, a_oVector.m_oValue);
+
+    __m128 _sum = _mm_add_ss(_product, _mm_shuffle_ps(_product, _product, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    _sum = _mm_add_ss(_sum, _mm_movehl_ps(_product, _product));
+
+    __m128 _lengthSq = _mm_shuffle_ps(_sum, _sum, _MM_SHUFFLE(0, 0, 0, 0));
+
+    __m128 _estimate = _mm_rsqrt_ps(_lengthSq);
+
+    __m128 _refined = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), _estimate),
+                                 _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(_lengthSq, _estimate), _estimate)));
+
+    return Vec3A(_mm_mul_ps(a_oVector.m_oValue, _refined));
+}
+
+#else
+
+inline Vec3A::Vec3A()
+{
+    this->m_fAxis[0] = this->m_fAxis[1] = this->m_fAxis[2] = this->m_fAxis[3] = 0.0f;
+}
+
+inline Vec3A::Vec3A(float a_fX, float a_fY, float a_fZ)
+{
+    this->m_fAxis[0] = a_fX;
+    this->m_fAxis[1] = a_fY;
+    this->m_fAxis[2] = a_fZ;
+    this->m_fAxis[3] = 0.0f;
+}
+
+inline Vec3A::Vec3A(const Vec3 &a_oVector) : Vec3A(a_oVector.m_fAxis[0], a_oVector.m_fAxis[1], a_oVector.m_fAxis[2])
+{
+}
+
+inline Vec3A Vec3A::Splat(float a_fValue)
+{
+    return Vec3A(a_fValue, a_fValue, a_fValue);
+}
+
+inline Vec3 Vec3A::ToVec3() const
+{
+    return Vec3(this->m_fAxis[0], this->m_fAxis[1], this->m_fAxis[2]);
+}
+
+inline float Vec3A::GetX() const
+{
+    return this->m_fAxis[0];
+}
+
+inline float Vec3A::GetY() const
+{
+    return this->m_fAxis[1];
+}
+
+inline float Vec3A::GetZ() const
+{
+    return this->m_fAxis[2];
+}
+
+inline Vec3A& Vec3A::operator+=(const Vec3A &a_oRhs)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fAxis[a] += a_oRhs.m_fAxis[a];
+    }
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator-=(const Vec3A &a_oRhs)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fAxis[a] -= a_oRhs.m_fAxis[a];
+    }
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator*=(const Vec3A &a_oRhs)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fAxis[a] *= a_oRhs.m_fAxis[a];
+    }
+
+    return *this;
+}
+
+inline Vec3A& Vec3A::operator*=(float a_fScale)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fAxis[a] *= a_fScale;
+    }
+
+    return *this;
+}
+
+inline Vec3A operator+(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    Vec3A _result(a_oLhs);
+
+    return _result += a_oRhs;
+}
+
+inline Vec3A operator-(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    Vec3A _result(a_oLhs);
+
+    return _result -= a_oRhs;
+}
+
+inline Vec3A operator-(const Vec3A& a_oVector)
+{
+    return Vec3A(-a_oVector.m_fAxis[0], -a_oVector.m_fAxis[1], -a_oVector.m_fAxis[2]);
+}
+
+inline Vec3A operator*(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    Vec3A _result(a_oLhs);
+
+    return _result *= a_oRhs;
+}
+
+inline Vec3A operator*(float a_fScale, const Vec3A& a_oVector)
+{
+    return Vec3A(a_fScale * a_oVector.m_fAxis[0], a_fScale * a_oVector.m_fAxis[1], a_fScale * a_oVector.m_fAxis[2]);
+}
+
+inline Vec3A operator*(const Vec3A& a_oVector, float a_fScale)
+{
+    Vec3A _result(a_oVector);
+
+    return _result *= a_fScale;
+}
+
+inline Vec3A operator/(const Vec3A& a_oVector, float a_fScale)
+{
+    return Vec3A(a_oVector.m_fAxis[0] / a_fScale, a_oVector.m_fAxis[1] / a_fScale, a_oVector.m_fAxis[2] / a_fScale);
+}
+
+inline float Dot(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    return (a_oLhs.m_fAxis[0] * a_oRhs.m_fAxis[0]) + (a_oLhs.m_fAxis[1] * a_oRhs.m_fAxis[1]) + (a_oLhs.m_fAxis[2] * a_oRhs.m_fAxis[2]);
+}
+
+inline Vec3A Cross(const Vec3A& a_oLhs, const Vec3A& a_oRhs)
+{
+    return Vec3A(Cross(a_oLhs.ToVec3(), a_oRhs.ToVec3()));
+}
+
+inline Vec3A MulAdd(const Vec3A& a_oA, const Vec3A& a_oB, const Vec3A& a_oC)
+{
+    return a_oA * a_oB + a_oC;
+}
+
+inline Vec3A NormalizeFast(const Vec3A& a_oVector)
+{
+    return a_oVector * (1.0f / sqrtf(Dot(a_oVector, a_oVector)));
+}
+
+#endif
+
+inline float Length(const Vec3A& a_oVector)
+{
+    return sqrtf(Dot(a_oVector, a_oVector));
+}
+
+// Exact: divides by the length like Unit_Vector.
+inline Vec3A Normalize(const Vec3A& a_oVector)
+{
+    return a_oVector / Length(a_oVector);
+}
+
+#endif // VEC3A_H
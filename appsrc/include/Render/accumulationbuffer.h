@@ -0,0 +1,52 @@
+#ifndef ACCUMULATIONBUFFER_H
+#define ACCUMULATIONBUFFER_H
+
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/framebuffer.h"
+#include "appsrc/include/Render/tilerenderer.h"
+
+// Float running sum of one-sample progressive passes. Pass p traces sample index p of
+// every pixel, and the Sampler addresses each sample's values by that index alone, so the
+// pass count is the complete sampler state and a resumed render continues the exact
+// sample sequence of an uninterrupted one.
+class AccumulationBuffer
+{
+public:
+    AccumulationBuffer(int a_iWidth, int a_iHeight);
+
+    // Drops every pass but keeps the storage, e.g. for the next frame of a sequence.
+    void Clear();
+
+    // Adds a pass rendered with one sample per pixel, and its AOVs if it has them.
+    void Add(const FrameBuffer& a_oPass);
+
+    // Writes the current estimate and the pass count as the per-pixel sample count, and
+    // the AOV means when a_oFrameBuffer keeps AOVs and some pass had them.
+    void Resolve(FrameBuffer& a_oFrameBuffer) const;
+
+    int GetPassCount() const;
+
+    // Stores the sums, the pass count and the settings that shape a sample, in host byte
+    // order. Written to a temporary file and renamed, so an interrupted save keeps the old one.
+    // AOVs are not saved: a resumed render averages them over its own passes only.
+    bool Save(const std::string& a_sPath, const RenderSettings& a_oSettings) const;
+
+    // Fails if the file is missing, damaged or was written with different settings.
+    bool Load(const std::string& a_sPath, const RenderSettings& a_oSettings);
+
+private:
+    int m_iWidth;
+    int m_iHeight;
+
+    int m_iPasses;
+
+    std::vector<Vec3> m_oSums;
+
+    // Sums over the m_iAovPasses passes that had AOVs; empty until the first of them.
+    std::vector<SampleAovs> m_oAovSums;
+
+    int m_iAovPasses;
+};
+
+#endif // ACCUMULATIONBUFFER_H
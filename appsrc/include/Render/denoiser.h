@@ -0,0 +1,59 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+#include <string>
+#include "appsrc/include/Render/framebuffer.h"
+#include "appsrc/include/Render/threadpool.h"
+
+enum DenoiserType
+{
+    DENOISER_NONE = 0,
+    DENOISER_BILATERAL,
+    DENOISER_ATROUS,
+    DENOISER_OIDN,
+    DENOISER_TYPE_COUNT
+};
+
+struct DenoiseSettings
+{
+    DenoiseSettings();
+
+    DenoiserType m_eType;
+
+    // Half width of the bilateral window.
+    int m_iRadius;
+
+    // À-trous passes; pass i spaces its taps 2^i pixels apart.
+    int m_iIterations;
+
+    // Edge stops. Colour is compared after c / (1 + c) compression, depth relative to the
+    // centre pixel's.
+    float m_fColorSigma;
+    float m_fNormalSigma;
+    float m_fAlbedoSigma;
+    float m_fDepthSigma;
+};
+
+// Post-process filters that use a frame's AOVs as guides. The built-in ones divide the
+// colour by the albedo, blur what is left with weights that stop at normal, albedo, depth
+// and colour edges, and multiply the albedo back, so texture and silhouettes stay sharp
+// while the lighting noise goes. DENOISER_OIDN hands colour, albedo and normal to Intel
+// Open Image Denoise instead, when the build has it (RT_USE_OIDN in CMake).
+class Denoiser
+{
+public:
+    // a_oInput needs AOVs, except for DENOISER_NONE which copies. a_oOutput gets the
+    // filtered colour, a_oInput's sample counts and, if it keeps them, its AOVs; it may be
+    // a_oInput itself.
+    static bool Denoise(const FrameBuffer& a_oInput, FrameBuffer& a_oOutput, const DenoiseSettings& a_oSettings, ThreadPool& a_oPool, std::string& a_sError);
+
+    // Accepts "none", "bilateral", "atrous" and "oidn".
+    static bool ParseType(const std::string& a_sName, DenoiserType& a_eType);
+
+    static const char* GetTypeName(DenoiserType a_eType);
+
+    // False for DENOISER_OIDN in builds without it.
+    static bool IsAvailable(DenoiserType a_eType);
+};
+
+#endif // DENOISER_H
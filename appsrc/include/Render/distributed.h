@@ -0,0 +1,188 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "appsrc/include/IO/socket.h"
+#include "appsrc/include/Render/tilerenderer.h"
+
+// What a worker needs besides the scene to take exactly the coordinator's samples. Sent
+// once per connection; the worker loads the same scene itself and compares keys.
+struct DistributedSession
+{
+    DistributedSession();
+
+    RenderSettings m_oSettings;
+
+    bool m_bWavefront;
+
+    // Negative keeps the scene's own aperture.
+    float m_fAperture;
+
+    // Fingerprint of the scene file, zero for the built-in scene.
+    uint64_t m_uSceneKey;
+};
+
+// Renders samples [a_iFirstSample, a_iFirstSample + a_iSampleCount) of a_oTiles in frame
+// a_iFrame into a_oTarget, a framebuffer of the whole image.
+typedef std::function<void(int a_iFrame, int a_iFirstSample, int a_iSampleCount, const std::vector<Tile>& a_oTiles, FrameBuffer& a_oTarget)> TileBatchRenderer;
+
+struct DistributedStats
+{
+    DistributedStats();
+
+    int m_iWorkersJoined;
+    int m_iWorkersLost;
+
+    uint64_t m_uLocalUnits;
+    uint64_t m_uRemoteUnits;
+
+    // Units handed out again because the worker holding them failed.
+    uint64_t m_uReissuedUnits;
+};
+
+// Hands the tiles of each frame to workers connected over TCP and renders alongside them.
+//
+// A frame is cut into units of one tile and one range of samples. Workers take batches of
+// units sized to their thread count, with a second batch queued behind the one in flight
+// so no worker waits on the network, and send back the float means and sample counts. The
+// Sampler addresses samples by pixel and index alone, so a unit renders the same on any
+// node; results are kept per unit and merged in a fixed order once the frame is complete,
+// which makes the image independent of who rendered what. A frame rendered as one range
+// of samples is bit-identical to a local render.
+//
+// A worker that disconnects, sends garbage or stays silent past the timeout is dropped
+// and its units go back to the front of the queue. Workers may join at any time.
+class RenderCoordinator
+{
+public:
+    // Told about workers joining and leaving; called with the coordinator's lock held.
+    typedef std::function<void(const std::string& a_sMessage)> LogCallback;
+
+    RenderCoordinator(const DistributedSession& a_oSession, int a_iLocalThreads);
+    ~RenderCoordinator();
+
+    bool Listen(int a_iPort, std::string& a_sError);
+
+    // Splits every tile's samples into ranges of this many, so fewer, slower tiles still
+    // spread over many nodes; zero keeps whole tiles. Not for adaptive sampling.
+    void SetUnitSamples(int a_iSamples);
+
+    // Seconds a worker may take per batch before it counts as dead; zero waits forever.
+    void SetTimeout(double a_dSeconds);
+
+    void SetLog(const LogCallback& a_oLog);
+
+    // Blocks until every tile is done. a_oLocal renders on this node; a_oFrameBuffer gets
+    // AOVs too if it keeps them.
+    void RenderFrame(int a_iFrame, const std::vector<Tile>& a_oTiles, const TileBatchRenderer& a_oLocal, FrameBuffer& a_oFrameBuffer);
+
+    // Sends the workers away and joins every thread.
+    void Stop();
+
+    DistributedStats GetStats() const;
+
+    int GetWorkerCount() const;
+
+private:
+    struct Unit
+    {
+        Tile m_oTile;
+
+        int m_iFirstSample;
+        int m_iSampleCount;
+
+        // Where the result goes in m_oResults.
+        int m_iIndex;
+    };
+
+    struct UnitResult
+    {
+        std::vector<Vec3> m_oPixels;
+        std::vector<int32_t> m_oSampleCounts;
+        std::vector<SampleAovs> m_oAovs;
+    };
+
+    RenderCoordinator(const RenderCoordinator&);
+    RenderCoordinator& operator=(const RenderCoordinator&);
+
+    void AcceptLoop();
+
+    void ServeWorker(std::shared_ptr<Socket> a_pSocket);
+
+    // Takes a batch for a node with a_iThreads threads; the caller holds m_oMutex.
+    void TakeBatch(int a_iThreads, std::vector<Unit>& a_oBatch);
+
+    // Stores finished units and wakes RenderFrame; the caller holds m_oMutex.
+    void Complete(std::vector<Unit>& a_oUnits, std::vector<UnitResult>& a_oResults);
+
+    DistributedSession m_oSession;
+
+    int m_iLocalThreads;
+
+    int m_iUnitSamples;
+
+    double m_dTimeout;
+
+    LogCallback m_oLog;
+
+    Socket m_oListener;
+
+    std::thread m_oAcceptThread;
+
+    std::vector<std::thread> m_oWorkerThreads;
+
+    mutable std::mutex m_oMutex;
+
+    std::condition_variable m_oChanged;
+
+    std::deque<Unit> m_oQueue;
+
+    std::vector<UnitResult> m_oResults;
+
+    int m_iRemaining;
+
+    int m_iFrame;
+
+    bool m_bAovs;
+
+    int m_iWorkers;
+
+    bool m_bStop;
+
+    DistributedStats m_oStats;
+};
+
+// The other end: connects to a coordinator, takes its settings and renders what it is sent.
+class RenderWorker
+{
+public:
+    RenderWorker();
+
+    // Retries for up to a_dRetrySeconds, so workers may be started before the coordinator.
+    bool Connect(const std::string& a_sHost, int a_iPort, int a_iThreads, double a_dRetrySeconds, DistributedSession& a_oSession, std::string& a_sError);
+
+    // Renders batches until the coordinator says it is done; false if the connection broke.
+    bool Serve(const TileBatchRenderer& a_oRender, std::string& a_sError);
+
+    uint64_t GetUnitCount() const;
+
+private:
+    RenderWorker(const RenderWorker&);
+    RenderWorker& operator=(const RenderWorker&);
+
+    Socket m_oSocket;
+
+    RenderSettings m_oSettings;
+
+    uint64_t m_uUnits;
+};
+
+#endif // DISTRIBUTED_H
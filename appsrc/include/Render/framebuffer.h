@@ -0,0 +1,83 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <vector>
+#include "appsrc/include/Math/vec3.h"
+
+// Surface attributes at the first hit of a camera ray: the material's albedo, the unit
+// geometric normal and the distance along the ray. Rays that miss leave the background
+// colour as albedo, a zero normal and depth. Summed and averaged per pixel like colour,
+// they are the guide images of a denoiser.
+struct SampleAovs
+{
+    SampleAovs();
+
+    void Add(const SampleAovs& a_oOther);
+
+    void Scale(float a_fFactor);
+
+    Vec3 m_oAlbedo;
+    Vec3 m_oNormal;
+
+    float m_fDepth;
+};
+
+enum AovChannel
+{
+    AOV_ALBEDO = 0,
+    AOV_NORMAL,
+    AOV_DEPTH,
+    AOV_CHANNEL_COUNT
+};
+
+// Linear, unbounded colour storage shared by every tile of a render; ToneMapper turns it
+// into display values. Row 0 is the bottom
+// scanline, matching the (u, v) convention of Camera::GetRay. AOV storage is only
+// allocated once EnableAovs() asks for it.
+class FrameBuffer
+{
+public:
+    FrameBuffer(int a_iWidth, int a_iHeight);
+
+    void EnableAovs();
+
+    bool HasAovs() const;
+
+    void SetAovs(int a_iX, int a_iY, const SampleAovs& a_oAovs);
+
+    const SampleAovs& GetAovs(int a_iX, int a_iY) const;
+
+    // One AOV as a colour image, e.g. to write it out: depth goes to all three channels.
+    void CopyAov(AovChannel a_eChannel, FrameBuffer& a_oTarget) const;
+
+    void SetPixel(int a_iX, int a_iY, const Vec3& a_oColor);
+
+    const Vec3& GetPixel(int a_iX, int a_iY) const;
+
+    void SetSampleCount(int a_iX, int a_iY, int a_iCount);
+
+    int GetSampleCount(int a_iX, int a_iY) const;
+
+    int GetWidth() const;
+
+    int GetHeight() const;
+
+    // Samples per pixel as a blue (fewest) to red (most) heatmap, top scanline first.
+    void SampleHeatmapToRgb8(std::vector<unsigned char>& a_oRgb) const;
+
+    // Linear colour, bottom scanline first.
+    const Vec3* GetData() const;
+
+private:
+    int m_iWidth;
+    int m_iHeight;
+
+    std::vector<Vec3> m_oPixels;
+
+    std::vector<int> m_oSampleCounts;
+
+    // Empty until EnableAovs().
+    std::vector<SampleAovs> m_oAovs;
+};
+
+#endif // FRAMEBUFFER_H
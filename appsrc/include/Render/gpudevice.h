@@ -0,0 +1,81 @@
+#ifndef GPUDEVICE_H
+#define GPUDEVICE_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/gpukernel.h"
+
+// Host copy of a scene in the layouts of gpukernel.h, as GpuRenderer packs it.
+struct GpuSceneData
+{
+    GpuSceneData();
+
+    std::vector<GpuBvhNode> m_oNodes;
+
+    std::vector<float> m_oCenterX;
+    std::vector<float> m_oCenterY;
+    std::vector<float> m_oCenterZ;
+    std::vector<float> m_oRadius;
+    std::vector<uint32_t> m_oMaterialIds;
+
+    // Empty while every sphere is static.
+    std::vector<float> m_oVelocityX;
+    std::vector<float> m_oVelocityY;
+    std::vector<float> m_oVelocityZ;
+
+    std::vector<GpuMaterial> m_oMaterials;
+
+    std::vector<GpuLight> m_oLights;
+    std::vector<int32_t> m_oSpheresByMaterial;
+
+    float m_fTotalPower;
+
+    GpuVec3 m_oBackground;
+    bool m_bBackground;
+};
+
+struct GpuPixel
+{
+    int32_t m_iX;
+    int32_t m_iY;
+};
+
+// One CUDA device with a scene on it, running the wavefront of gpukernel.h: a camera kernel
+// starts a wave of paths, extend and one shade kernel per material queue alternate until
+// every path has ended, and a last kernel adds the wave to its pixels in sample order.
+// Buffers only grow, so re-uploading a moving scene or rendering the next pass of the
+// same size allocates nothing. Only built with RT_USE_CUDA; the rest of the renderer goes
+// through GpuRenderer.
+class GpuDevice
+{
+public:
+    GpuDevice();
+    ~GpuDevice();
+
+    // Binds the current CUDA device. False when there is none or no usable driver.
+    bool Open(std::string& a_sError);
+
+    const std::string& GetName() const;
+
+    bool UploadScene(const GpuSceneData& a_oData, std::string& a_sError);
+
+    // Samples [a_iFirstSample, a_iFirstSample + a_iSampleCount) of every pixel, one sum per
+    // pixel into a_oSums. a_oMask is the blue-noise mask, empty for other samplers.
+    // a_pCancel, if set, is polled between waves; a cancelled render leaves a_oSums alone.
+    bool Render(const GpuFrame& a_oFrame, const std::vector<float>& a_oMask, const std::vector<GpuPixel>& a_oPixels, int a_iFirstSample, int a_iSampleCount, const std::atomic<bool>* a_pCancel, std::vector<GpuPixelSum>& a_oSums, std::string& a_sError);
+
+private:
+    GpuDevice(const GpuDevice&);
+    GpuDevice& operator=(const GpuDevice&);
+
+    // Device allocations, kept out of this header so it needs no CUDA includes.
+    struct Buffers;
+
+    std::unique_ptr<Buffers> m_pBuffers;
+
+    std::string m_sName;
+};
+
+#endif // GPUDEVICE_H
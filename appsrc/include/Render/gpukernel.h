@@ -0,0 +1,1275 @@
+#ifndef GPUKERNEL_H
+#define GPUKERNEL_H
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include "appsrc/include/Math/hash.h"
+
+// Plain-data mirror of what the wavefront integrator reads, and the stages of one path on
+// top of it: start at the camera, extend to the next hit, shade it, accumulate. Nothing
+// here touches the host classes, so the same functions run in the CUDA kernels of
+// gpudevice.cu and, for checking them against the CPU integrators, on the host.
+// gpurenderer.cpp packs the scene into these layouts and asserts that the enums and the
+// node layout still match MaterialType, SamplerType, the sample slots and BvhNode.
+
+enum GpuMaterialType
+{
+    GPU_MATERIAL_LAMBERTIAN = 0,
+    GPU_MATERIAL_METAL,
+    GPU_MATERIAL_DIELECTRIC,
+    GPU_MATERIAL_EMISSIVE,
+    GPU_MATERIAL_TYPE_COUNT
+};
+
+enum GpuSamplerType
+{
+    GPU_SAMPLER_INDEPENDENT = 0,
+    GPU_SAMPLER_STRATIFIED,
+    GPU_SAMPLER_SOBOL,
+    GPU_SAMPLER_BLUE_NOISE
+};
+
+// Sample dimensions, laid out like SAMPLE_DIMENSION_* and SAMPLE_SLOT_*.
+enum GpuSampleLayout
+{
+    GPU_DIMENSION_FIRST_BOUNCE = 3,
+    GPU_SLOT_ROULETTE = 2,
+    GPU_SLOT_LIGHT = 3,
+    GPU_SLOT_LIGHT_SELECT = 4,
+    GPU_SLOTS_PER_BOUNCE = 5
+};
+
+struct GpuLimits
+{
+    static constexpr float RAY_EPSILON = 0.001f;
+
+    // Caps the survival probability so even bright paths eventually terminate.
+    static constexpr float MAX_SURVIVAL = 0.95f;
+
+    static constexpr int BLUE_NOISE_MASK_SIZE = 64;
+
+    // Entries of GpuIntersect()'s traversal stack; deeper trees are left to the CPU.
+    static constexpr int STACK_SIZE = 64;
+
+    // As in lightlist.cpp: how near a sphere light's surface, relative to its radius, a
+    // hit must be to count as on it.
+    static constexpr float LIGHT_SURFACE_TOLERANCE = 1e-2f;
+};
+
+struct GpuVec3
+{
+    float m_fX;
+    float m_fY;
+    float m_fZ;
+};
+
+RT_HOST_DEVICE inline GpuVec3 MakeGpuVec3(float a_fX, float a_fY, float a_fZ)
+{
+    GpuVec3 _v;
+
+    _v.m_fX = a_fX;
+    _v.m_fY = a_fY;
+    _v.m_fZ = a_fZ;
+
+    return _v;
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator+(const GpuVec3& a_oA, const GpuVec3& a_oB)
+{
+    return MakeGpuVec3(a_oA.m_fX + a_oB.m_fX, a_oA.m_fY + a_oB.m_fY, a_oA.m_fZ + a_oB.m_fZ);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator-(const GpuVec3& a_oA, const GpuVec3& a_oB)
+{
+    return MakeGpuVec3(a_oA.m_fX - a_oB.m_fX, a_oA.m_fY - a_oB.m_fY, a_oA.m_fZ - a_oB.m_fZ);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator-(const GpuVec3& a_oA)
+{
+    return MakeGpuVec3(-a_oA.m_fX, -a_oA.m_fY, -a_oA.m_fZ);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator*(const GpuVec3& a_oA, const GpuVec3& a_oB)
+{
+    return MakeGpuVec3(a_oA.m_fX * a_oB.m_fX, a_oA.m_fY * a_oB.m_fY, a_oA.m_fZ * a_oB.m_fZ);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator*(float a_fS, const GpuVec3& a_oA)
+{
+    return MakeGpuVec3(a_fS * a_oA.m_fX, a_fS * a_oA.m_fY, a_fS * a_oA.m_fZ);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator*(const GpuVec3& a_oA, float a_fS)
+{
+    return MakeGpuVec3(a_oA.m_fX * a_fS, a_oA.m_fY * a_fS, a_oA.m_fZ * a_fS);
+}
+
+RT_HOST_DEVICE inline GpuVec3 operator/(const GpuVec3& a_oA, float a_fS)
+{
+    return MakeGpuVec3(a_oA.m_fX / a_fS, a_oA.m_fY / a_fS, a_oA.m_fZ / a_fS);
+}
+
+RT_HOST_DEVICE inline float Dot(const GpuVec3& a_oA, const GpuVec3& a_oB)
+{
+    return a_oA.m_fX * a_oB.m_fX + a_oA.m_fY * a_oB.m_fY + a_oA.m_fZ * a_oB.m_fZ;
+}
+
+RT_HOST_DEVICE inline float Length(const GpuVec3& a_oA)
+{
+    return sqrtf(Dot(a_oA, a_oA));
+}
+
+RT_HOST_DEVICE inline GpuVec3 Normalize(const GpuVec3& a_oA)
+{
+    return a_oA / Length(a_oA);
+}
+
+RT_HOST_DEVICE inline float MaxComponent(const GpuVec3& a_oA)
+{
+    return fmaxf(a_oA.m_fX, fmaxf(a_oA.m_fY, a_oA.m_fZ));
+}
+
+RT_HOST_DEVICE inline GpuVec3 ClampUnit(const GpuVec3& a_oA)
+{
+    return MakeGpuVec3(fminf(fmaxf(a_oA.m_fX, 0.0f), 1.0f), fminf(fmaxf(a_oA.m_fY, 0.0f), 1.0f), fminf(fmaxf(a_oA.m_fZ, 0.0f), 1.0f));
+}
+
+struct GpuRay
+{
+    GpuVec3 m_oOrigin;
+    GpuVec3 m_oDirection;
+    float m_fTime;
+};
+
+// Camera with the fields of Camera.
+struct GpuCamera
+{
+    GpuVec3 m_oOrigin;
+    GpuVec3 m_oLowerLeftCorner;
+    GpuVec3 m_oHorizontal;
+    GpuVec3 m_oVertical;
+    GpuVec3 m_oU;
+    GpuVec3 m_oV;
+
+    float m_fLensRadius;
+    float m_fShutterOpen;
+    float m_fShutterClose;
+};
+
+// Whichever Sampler the CPU would use, reduced to its parameters.
+struct GpuSampler
+{
+    int32_t m_iType;
+
+    uint32_t m_uSeed;
+
+    // Stratified: the per-pixel budget and the grid it is split into.
+    int32_t m_iSamples;
+    int32_t m_iColumns;
+    int32_t m_iRows;
+
+    // Blue noise: BLUE_NOISE_MASK_SIZE^2 ranks in device memory.
+    const float* m_pMask;
+};
+
+// Same layout as BvhNode.
+struct GpuBvhNode
+{
+    float m_fMin[3];
+    float m_fMax[3];
+
+    uint32_t m_uOffset;
+    uint16_t m_uCount;
+    uint8_t m_uAxis;
+    uint8_t m_uPad;
+};
+
+struct GpuMaterial
+{
+    GpuVec3 m_oAlbedo;
+
+    float m_fParameter;
+
+    int32_t m_iType;
+};
+
+// A LightList emitter with its running power total.
+struct GpuLight
+{
+    GpuVec3 m_oPoint;
+    GpuVec3 m_oEdgeA;
+    GpuVec3 m_oEdgeB;
+
+    float m_fRadius;
+
+    GpuVec3 m_oRadiance;
+
+    float m_fCumulativePower;
+
+    uint32_t m_uMaterialId;
+};
+
+// Device pointers to everything a path reads: the sphere BVH with its leaf-ordered
+// spheres, the material table and the emitters.
+struct GpuScene
+{
+    const GpuBvhNode* m_pNodes;
+    int32_t m_iNodeCount;
+
+    const float* m_pCenterX;
+    const float* m_pCenterY;
+    const float* m_pCenterZ;
+    const float* m_pRadius;
+    const uint32_t* m_pMaterialId;
+
+    // Null while every sphere is static.
+    const float* m_pVelocityX;
+    const float* m_pVelocityY;
+    const float* m_pVelocityZ;
+
+    const GpuMaterial* m_pMaterials;
+
+    const GpuLight* m_pLights;
+    int32_t m_iLightCount;
+    float m_fTotalPower;
+
+    // Indices into m_pLights of the spheres, ordered by material id as
+    // LightList::GetSpheresByMaterial() gives them.
+    const int32_t* m_pSpheresByMaterial;
+    int32_t m_iSphereLightCount;
+
+    GpuVec3 m_oBackground;
+    bool m_bBackground;
+};
+
+// Per-render constants.
+struct GpuFrame
+{
+    GpuCamera m_oCamera;
+
+    GpuSampler m_oSampler;
+
+    int32_t m_iWidth;
+    int32_t m_iHeight;
+
+    int32_t m_iMaxDepth;
+    int32_t m_iRouletteDepth;
+
+    // Only set when the scene has emitters.
+    bool m_bNextEvent;
+
+    bool m_bAovs;
+};
+
+struct GpuHit
+{
+    float m_fT;
+
+    GpuVec3 m_oPoint;
+    GpuVec3 m_oNormal;
+
+    uint32_t m_uMaterialId;
+};
+
+// One path of the wavefront: the ray it traces next, or the hit it shades next.
+struct GpuPath
+{
+    GpuRay m_oRay;
+    GpuHit m_oHit;
+
+    GpuVec3 m_oThroughput;
+    GpuVec3 m_oRadiance;
+
+    // Density of the last bounce direction, zero when no light sample competed with it.
+    float m_fBouncePdf;
+
+    int32_t m_iDepth;
+
+    int32_t m_iX;
+    int32_t m_iY;
+    int32_t m_iSample;
+
+    // First-hit AOVs, filled when the frame asks for them.
+    GpuVec3 m_oAlbedo;
+    GpuVec3 m_oNormal;
+    float m_fDepth;
+};
+
+// What a pixel accumulates over the samples of a render.
+struct GpuPixelSum
+{
+    GpuVec3 m_oRadiance;
+    GpuVec3 m_oAlbedo;
+    GpuVec3 m_oNormal;
+
+    float m_fDepth;
+
+    int32_t m_iCount;
+};
+
+struct GpuStream
+{
+    int32_t m_iX;
+    int32_t m_iY;
+    int32_t m_iSample;
+    int32_t m_iDimension;
+};
+
+RT_HOST_DEVICE inline int GpuBounceDimension(int a_iBounce)
+{
+    return GPU_DIMENSION_FIRST_BOUNCE + a_iBounce * GPU_SLOTS_PER_BOUNCE;
+}
+
+// -- Samplers: the CPU samplers value for value --------------------------------------
+
+// Second Sobol dimension of a_uIndex, applying the generator matrix bit by bit where the
+// CPU uses byte tables.
+RT_HOST_DEVICE inline uint32_t SobolSecondDimension(uint32_t a_uIndex)
+{
+    uint32_t _result = 0;
+    uint32_t _direction = 0x80000000u;
+
+    for (int b = 0; b < 32; ++b)
+    {
+        if (a_uIndex & (1u << b))
+        {
+            _result ^= _direction;
+        }
+
+        _direction ^= _direction >> 1;
+    }
+
+    return _result;
+}
+
+RT_HOST_DEVICE inline void GpuScrambledSobol(uint32_t a_uIndex, uint32_t a_uSeed, float& a_fU, float& a_fV)
+{
+    uint32_t _index = NestedUniformScramble(a_uIndex, a_uSeed);
+
+    a_fU = ToUnitFloat(ReverseBits(LaineKarrasPermutation(_index, HashCombine(a_uSeed, 0u))));
+    a_fV = ToUnitFloat(ReverseBits(LaineKarrasPermutation(ReverseBits(SobolSecondDimension(_index)), HashCombine(a_uSeed, 1u))));
+}
+
+RT_HOST_DEVICE inline float GpuScrambledVanDerCorput(uint32_t a_uIndex, uint32_t a_uSeed)
+{
+    uint32_t _index = NestedUniformScramble(a_uIndex, a_uSeed);
+
+    return ToUnitFloat(ReverseBits(LaineKarrasPermutation(_index, HashCombine(a_uSeed, 0u))));
+}
+
+RT_HOST_DEVICE inline float GpuMaskValue(const GpuSampler& a_oSampler, int a_iX, int a_iY, uint32_t a_uOffset)
+{
+    const int _wrap = GpuLimits::BLUE_NOISE_MASK_SIZE - 1;
+
+    int _x = (a_iX + static_cast<int>(a_uOffset & 0xffffu)) & _wrap;
+    int _y = (a_iY + static_cast<int>(a_uOffset >> 16)) & _wrap;
+
+    return a_oSampler.m_pMask[_y * GpuLimits::BLUE_NOISE_MASK_SIZE + _x];
+}
+
+RT_HOST_DEVICE inline void GpuSample2D(const GpuSampler& a_oSampler, int a_iX, int a_iY, int a_iSample, int a_iDimension, float& a_fU, float& a_fV)
+{
+    switch (a_oSampler.m_iType)
+    {
+    case GPU_SAMPLER_STRATIFIED:
+    {
+        uint32_t _count = static_cast<uint32_t>(a_oSampler.m_iSamples);
+        uint32_t _columns = static_cast<uint32_t>(a_oSampler.m_iColumns);
+        uint32_t _rows = static_cast<uint32_t>(a_oSampler.m_iRows);
+        uint32_t _sample = static_cast<uint32_t>(a_iSample);
+
+        uint32_t _pattern = PixelSeed(a_iX, a_iY, a_iDimension, a_oSampler.m_uSeed ^ Hash(_sample / _count));
+
+        _sample = Permute(_sample % _count, _count, _pattern * 0x51633e2du);
+
+        uint32_t _column = _sample % _columns;
+        uint32_t _row = _sample / _columns;
+
+        uint32_t _subColumn = Permute(_column, _columns, _pattern * 0xa511e9b3u);
+        uint32_t _subRow = Permute(_row, _rows, _pattern * 0x63d83595u);
+
+        float _jitterX = JitterFloat(_sample, _pattern * 0xa399d265u);
+        float _jitterY = JitterFloat(_sample, _pattern * 0x711ad6a5u);
+
+        a_fU = (float(_column) + (float(_subRow) + _jitterX) / float(_rows)) / float(_columns);
+        a_fV = (float(_row) + (float(_subColumn) + _jitterY) / float(_columns)) / float(_rows);
+        return;
+    }
+    case GPU_SAMPLER_SOBOL:
+        GpuScrambledSobol(static_cast<uint32_t>(a_iSample), PixelSeed(a_iX, a_iY, a_iDimension, a_oSampler.m_uSeed), a_fU, a_fV);
+        return;
+    case GPU_SAMPLER_BLUE_NOISE:
+    {
+        uint32_t _seed = Hash(a_oSampler.m_uSeed ^ static_cast<uint32_t>(a_iDimension) * 0x68bc21ebu);
+
+        GpuScrambledSobol(static_cast<uint32_t>(a_iSample), _seed, a_fU, a_fV);
+
+        a_fU += GpuMaskValue(a_oSampler, a_iX, a_iY, Hash(_seed));
+        a_fV += GpuMaskValue(a_oSampler, a_iX, a_iY, Hash(_seed ^ 0x5bd1e995u));
+
+        a_fU = a_fU < 1.0f ? a_fU : a_fU - 1.0f;
+        a_fV = a_fV < 1.0f ? a_fV : a_fV - 1.0f;
+        return;
+    }
+    case GPU_SAMPLER_INDEPENDENT:
+    default:
+    {
+        uint64_t _pixel = (static_cast<uint64_t>(static_cast<uint32_t>(a_iY)) << 32) | static_cast<uint32_t>(a_iX);
+        uint64_t _event = (static_cast<uint64_t>(static_cast<uint32_t>(a_iSample)) << 32) | static_cast<uint32_t>(a_iDimension);
+
+        uint64_t _bits = SplitMix64(_pixel ^ SplitMix64(_event ^ SplitMix64(a_oSampler.m_uSeed)));
+
+        a_fU = ToUnitFloat(static_cast<uint32_t>(_bits));
+        a_fV = ToUnitFloat(static_cast<uint32_t>(_bits >> 32));
+        return;
+    }
+    }
+}
+
+RT_HOST_DEVICE inline float GpuSample1D(const GpuSampler& a_oSampler, int a_iX, int a_iY, int a_iSample, int a_iDimension)
+{
+    switch (a_oSampler.m_iType)
+    {
+    case GPU_SAMPLER_STRATIFIED:
+    {
+        uint32_t _count = static_cast<uint32_t>(a_oSampler.m_iSamples);
+        uint32_t _sample = static_cast<uint32_t>(a_iSample);
+
+        uint32_t _pattern = PixelSeed(a_iX, a_iY, a_iDimension, a_oSampler.m_uSeed ^ Hash(_sample / _count));
+
+        _sample %= _count;
+
+        uint32_t _stratum = Permute(_sample, _count, _pattern * 0x68bc21ebu);
+
+        return (float(_stratum) + JitterFloat(_sample, _pattern * 0x967a889bu)) / float(_count);
+    }
+    case GPU_SAMPLER_SOBOL:
+        return GpuScrambledVanDerCorput(static_cast<uint32_t>(a_iSample), PixelSeed(a_iX, a_iY, a_iDimension, a_oSampler.m_uSeed));
+    case GPU_SAMPLER_BLUE_NOISE:
+    {
+        uint32_t _seed = Hash(a_oSampler.m_uSeed ^ static_cast<uint32_t>(a_iDimension) * 0x68bc21ebu);
+
+        float _u = GpuScrambledVanDerCorput(static_cast<uint32_t>(a_iSample), _seed) + GpuMaskValue(a_oSampler, a_iX, a_iY, Hash(_seed));
+
+        return _u < 1.0f ? _u : _u - 1.0f;
+    }
+    case GPU_SAMPLER_INDEPENDENT:
+    default:
+    {
+        float _u;
+        float _v;
+
+        GpuSample2D(a_oSampler, a_iX, a_iY, a_iSample, a_iDimension, _u, _v);
+
+        return _u;
+    }
+    }
+}
+
+RT_HOST_DEVICE inline float GpuNext1D(const GpuSampler& a_oSampler, GpuStream& a_oStream)
+{
+    return GpuSample1D(a_oSampler, a_oStream.m_iX, a_oStream.m_iY, a_oStream.m_iSample, a_oStream.m_iDimension++);
+}
+
+RT_HOST_DEVICE inline void GpuNext2D(const GpuSampler& a_oSampler, GpuStream& a_oStream, float& a_fU, float& a_fV)
+{
+    GpuSample2D(a_oSampler, a_oStream.m_iX, a_oStream.m_iY, a_oStream.m_iSample, a_oStream.m_iDimension++, a_fU, a_fV);
+}
+
+// -- Warps, as in sampling.h ---------------------------------------------------------
+
+RT_HOST_DEVICE inline void GpuConcentricSampleDisk(float a_fU, float a_fV, float& a_fX, float& a_fY)
+{
+    float _a = 2.0f * a_fU - 1.0f;
+    float _b = 2.0f * a_fV - 1.0f;
+
+    if (_a == 0.0f && _b == 0.0f)
+    {
+        a_fX = 0.0f;
+        a_fY = 0.0f;
+        return;
+    }
+
+    float _radius;
+    float _phi;
+
+    if (fabsf(_a) > fabsf(_b))
+    {
+        _radius = _a;
+        _phi = float(M_PI / 4) * (_b / _a);
+    }
+    else
+    {
+        _radius = _b;
+        _phi = float(M_PI / 2) - float(M_PI / 4) * (_a / _b);
+    }
+
+    a_fX = _radius * cosf(_phi);
+    a_fY = _radius * sinf(_phi);
+}
+
+RT_HOST_DEVICE inline void GpuBuildOrthonormalBasis(const GpuVec3& a_oNormal, GpuVec3& a_oTangent, GpuVec3& a_oBitangent)
+{
+    float _sign = copysignf(1.0f, a_oNormal.m_fZ);
+
+    float _a = -1.0f / (_sign + a_oNormal.m_fZ);
+    float _b = a_oNormal.m_fX * a_oNormal.m_fY * _a;
+
+    a_oTangent = MakeGpuVec3(1.0f + _sign * a_oNormal.m_fX * a_oNormal.m_fX * _a, _sign * _b, -_sign * a_oNormal.m_fX);
+    a_oBitangent = MakeGpuVec3(_b, _sign + a_oNormal.m_fY * a_oNormal.m_fY * _a, -a_oNormal.m_fY);
+}
+
+RT_HOST_DEVICE inline GpuVec3 GpuSampleCosineHemisphere(const GpuVec3& a_oNormal, float a_fU, float a_fV)
+{
+    float _dx;
+    float _dy;
+
+    GpuConcentricSampleDisk(a_fU, a_fV, _dx, _dy);
+
+    float _z = sqrtf(fmaxf(0.0f, 1.0f - _dx * _dx - _dy * _dy));
+
+    GpuVec3 _tangent;
+    GpuVec3 _bitangent;
+
+    GpuBuildOrthonormalBasis(a_oNormal, _tangent, _bitangent);
+
+    return _dx * _tangent + _dy * _bitangent + _z * a_oNormal;
+}
+
+RT_HOST_DEVICE inline GpuVec3 GpuSampleUniformCone(const GpuVec3& a_oAxis, float a_fOneMinusCos, float a_fU, float a_fV)
+{
+    float _k = a_fU * a_fOneMinusCos;
+
+    float _cosine = 1.0f - _k;
+    float _sine = sqrtf(fmaxf(0.0f, _k * (2.0f - _k)));
+    float _phi = float(2.0 * M_PI) * a_fV;
+
+    GpuVec3 _tangent;
+    GpuVec3 _bitangent;
+
+    GpuBuildOrthonormalBasis(a_oAxis, _tangent, _bitangent);
+
+    return (_sine * cosf(_phi)) * _tangent + (_sine * sinf(_phi)) * _bitangent + _cosine * a_oAxis;
+}
+
+RT_HOST_DEVICE inline GpuVec3 GpuSampleUniformBall(float a_fU, float a_fV, float a_fW)
+{
+    float _z = 1.0f - 2.0f * a_fU;
+    float _r = sqrtf(fmaxf(0.0f, 1.0f - _z * _z));
+    float _phi = float(2.0 * M_PI) * a_fV;
+
+    float _radius = cbrtf(a_fW);
+
+    return MakeGpuVec3(_radius * _r * cosf(_phi), _radius * _r * sinf(_phi), _radius * _z);
+}
+
+// -- Scene queries -------------------------------------------------------------------
+
+RT_HOST_DEVICE inline GpuVec3 GpuBackground(const GpuScene& a_oScene, const GpuRay& a_oRay)
+{
+    if (a_oScene.m_bBackground)
+    {
+        return a_oScene.m_oBackground;
+    }
+
+    float _t = 0.5f * (Normalize(a_oRay.m_oDirection).m_fY + 1.0f);
+
+    return (1.0f - _t) * MakeGpuVec3(1.0f, 1.0f, 1.0f) + _t * MakeGpuVec3(0.5f, 0.7f, 1.0f);
+}
+
+RT_HOST_DEVICE inline GpuVec3 GpuSphereCenter(const GpuScene& a_oScene, int a_iIndex, float a_fTime)
+{
+    GpuVec3 _center = MakeGpuVec3(a_oScene.m_pCenterX[a_iIndex], a_oScene.m_pCenterY[a_iIndex], a_oScene.m_pCenterZ[a_iIndex]);
+
+    if (a_oScene.m_pVelocityX != nullptr)
+    {
+        _center = _center + a_fTime * MakeGpuVec3(a_oScene.m_pVelocityX[a_iIndex], a_oScene.m_pVelocityY[a_iIndex], a_oScene.m_pVelocityZ[a_iIndex]);
+    }
+
+    return _center;
+}
+
+// Closest sphere hit in (a_fTMin, a_fTMax), walking the BVH near child first like
+// Bvh::Hit(). With a_bAnyHit it stops at the first leaf with a hit and leaves a_pHit
+// alone, like Bvh::Occluded().
+RT_HOST_DEVICE inline bool GpuIntersect(const GpuScene& a_oScene, const GpuRay& a_oRay, float a_fTMin, float a_fTMax, bool a_bAnyHit, GpuHit* a_pHit)
+{
+    if (a_oScene.m_iNodeCount == 0)
+    {
+        return false;
+    }
+
+    const float _dir[3] = { a_oRay.m_oDirection.m_fX, a_oRay.m_oDirection.m_fY, a_oRay.m_oDirection.m_fZ };
+    const float _org[3] = { a_oRay.m_oOrigin.m_fX, a_oRay.m_oOrigin.m_fY, a_oRay.m_oOrigin.m_fZ };
+
+    float _invDir[3];
+    float _orgScaled[3];
+    int _dirIsNeg[3];
+
+    for (int a = 0; a < 3; ++a)
+    {
+        _invDir[a] = 1.0f / _dir[a];
+        _orgScaled[a] = -_org[a] * _invDir[a];
+        _dirIsNeg[a] = _invDir[a] < 0.0f;
+    }
+
+    float _a = Dot(a_oRay.m_oDirection, a_oRay.m_oDirection);
+
+    float _closest = a_fTMax;
+
+    int _best = -1;
+
+    uint32_t _stack[GpuLimits::STACK_SIZE];
+    int _stackSize = 0;
+
+    uint32_t _current = 0;
+
+    for (;;)
+    {
+        const GpuBvhNode& _node = a_oScene.m_pNodes[_current];
+
+        float _tMin = a_fTMin;
+        float _tMax = _closest;
+
+        for (int a = 0; a < 3; ++a)
+        {
+            float _near = _dirIsNeg[a] ? _node.m_fMax[a] : _node.m_fMin[a];
+            float _far = _dirIsNeg[a] ? _node.m_fMin[a] : _node.m_fMax[a];
+
+            float _t0 = _near * _invDir[a] + _orgScaled[a];
+            float _t1 = _far * _invDir[a] + _orgScaled[a];
+
+            _tMin = _t0 > _tMin ? _t0 : _tMin;
+            _tMax = _t1 < _tMax ? _t1 : _tMax;
+        }
+
+        if (_tMin <= _tMax)
+        {
+            if (_node.m_uCount > 0)
+            {
+                bool _leafHit = false;
+
+                for (uint32_t i = _node.m_uOffset; i < _node.m_uOffset + _node.m_uCount; ++i)
+                {
+                    GpuVec3 _oc = a_oRay.m_oOrigin - GpuSphereCenter(a_oScene, int(i), a_oRay.m_fTime);
+
+                    float _b = Dot(_oc, a_oRay.m_oDirection);
+                    float _c = Dot(_oc, _oc) - a_oScene.m_pRadius[i] * a_oScene.m_pRadius[i];
+
+                    float _desc = _b * _b - _a * _c;
+
+                    if (_desc > 0.0f)
+                    {
+                        float _sq = sqrtf(_desc);
+
+                        float _t = (-_b - _sq) / _a;
+
+                        if (!(_t < _closest && _t > a_fTMin))
+                        {
+                            _t = (-_b + _sq) / _a;
+                        }
+
+                        if (_t < _closest && _t > a_fTMin)
+                        {
+                            _closest = _t;
+                            _best = int(i);
+                            _leafHit = true;
+                        }
+                    }
+                }
+
+                if (_leafHit && a_bAnyHit)
+                {
+                    return true;
+                }
+            }
+            else
+            {
+                // GpuRenderer::Supports() turns down trees deep enough to overflow the stack.
+                // Descend into the child on the ray's side of the split plane first.
+                if (_dirIsNeg[_node.m_uAxis])
+                {
+                    _stack[_stackSize++] = _current + 1;
+                    _current = _node.m_uOffset;
+                }
+                else
+                {
+                    _stack[_stackSize++] = _node.m_uOffset;
+                    _current = _current + 1;
+                }
+                continue;
+            }
+        }
+
+        if (_stackSize == 0)
+        {
+            break;
+        }
+
+        _current = _stack[--_stackSize];
+    }
+
+    if (_best < 0)
+    {
+        return false;
+    }
+
+    if (a_pHit != nullptr)
+    {
+        a_pHit->m_fT = _closest;
+        a_pHit->m_oPoint = a_oRay.m_oOrigin + _closest * a_oRay.m_oDirection;
+        a_pHit->m_oNormal = (a_pHit->m_oPoint - GpuSphereCenter(a_oScene, _best, a_oRay.m_fTime)) / a_oScene.m_pRadius[_best];
+        a_pHit->m_uMaterialId = a_oScene.m_pMaterialId[_best];
+    }
+
+    return true;
+}
+
+// 1 - cos of the half-angle of the cone a sphere light subtends, from its squared sine.
+RT_HOST_DEVICE inline float GpuConeOneMinusCos(float a_fSinSquared)
+{
+    return a_fSinSquared / (1.0f + sqrtf(1.0f - a_fSinSquared));
+}
+
+struct GpuLightSample
+{
+    GpuVec3 m_oDirection;
+
+    float m_fDistance;
+
+    GpuVec3 m_oRadiance;
+
+    float m_fPdf;
+};
+
+// LightList::Sample().
+RT_HOST_DEVICE inline bool GpuSampleLight(const GpuScene& a_oScene, const GpuVec3& a_oFrom, float a_fTime, float a_fSelect, float a_fU, float a_fV, GpuLightSample& a_oSample)
+{
+    if (a_oScene.m_iLightCount == 0)
+    {
+        return false;
+    }
+
+    // First emitter whose running total exceeds the target, as std::upper_bound finds it.
+    float _target = a_fSelect * a_oScene.m_fTotalPower;
+
+    int _low = 0;
+    int _high = a_oScene.m_iLightCount;
+
+    while (_low < _high)
+    {
+        int _middle = (_low + _high) / 2;
+
+        if (a_oScene.m_pLights[_middle].m_fCumulativePower > _target)
+        {
+            _high = _middle;
+        }
+        else
+        {
+            _low = _middle + 1;
+        }
+    }
+
+    const GpuLight& _light = a_oScene.m_pLights[_low < a_oScene.m_iLightCount ? _low : a_oScene.m_iLightCount - 1];
+
+    float _weight = (_light.m_oRadiance.m_fX + _light.m_oRadiance.m_fY + _light.m_oRadiance.m_fZ) * (1.0f / 3.0f);
+
+    if (_light.m_fRadius > 0.0f)
+    {
+        GpuVec3 _toCenter = _light.m_oPoint + a_fTime * _light.m_oEdgeA - a_oFrom;
+
+        float _radius2 = _light.m_fRadius * _light.m_fRadius;
+
+        float _sin2 = _radius2 / Dot(_toCenter, _toCenter);
+
+        if (!(_sin2 < 1.0f))
+        {
+            return false;
+        }
+
+        float _oneMinusCos = GpuConeOneMinusCos(_sin2);
+
+        GpuVec3 _direction = GpuSampleUniformCone(Normalize(_toCenter), _oneMinusCos, a_fU, a_fV);
+
+        float _along = Dot(_direction, _toCenter);
+
+        GpuVec3 _across = _toCenter - _along * _direction;
+
+        float _distance = _along - sqrtf(fmaxf(0.0f, _radius2 - Dot(_across, _across)));
+
+        if (!(_distance > 0.0f))
+        {
+            return false;
+        }
+
+        a_oSample.m_oDirection = _direction;
+        a_oSample.m_fDistance = _distance;
+        a_oSample.m_oRadiance = _light.m_oRadiance;
+        a_oSample.m_fPdf = _weight * 2.0f * _radius2 / (a_oScene.m_fTotalPower * _oneMinusCos);
+
+        return true;
+    }
+
+    float _s = sqrtf(a_fU);
+
+    GpuVec3 _point = _light.m_oPoint + (_s * (1.0f - a_fV)) * _light.m_oEdgeA + (_s * a_fV) * _light.m_oEdgeB;
+
+    GpuVec3 _cross = MakeGpuVec3(_light.m_oEdgeA.m_fY * _light.m_oEdgeB.m_fZ - _light.m_oEdgeA.m_fZ * _light.m_oEdgeB.m_fY,
+                                 _light.m_oEdgeA.m_fZ * _light.m_oEdgeB.m_fX - _light.m_oEdgeA.m_fX * _light.m_oEdgeB.m_fZ,
+                                 _light.m_oEdgeA.m_fX * _light.m_oEdgeB.m_fY - _light.m_oEdgeA.m_fY * _light.m_oEdgeB.m_fX);
+
+    GpuVec3 _normal = Normalize(_cross);
+
+    GpuVec3 _toLight = _point - a_oFrom;
+
+    float _distance = Length(_toLight);
+
+    if (!(_distance > 0.0f))
+    {
+        return false;
+    }
+
+    a_oSample.m_oDirection = _toLight / _distance;
+    a_oSample.m_fDistance = _distance;
+
+    float _cosine = fabsf(Dot(_normal, a_oSample.m_oDirection));
+
+    if (!(_cosine > 0.0f))
+    {
+        return false;
+    }
+
+    a_oSample.m_oRadiance = _light.m_oRadiance;
+    a_oSample.m_fPdf = _weight * _distance * _distance / (a_oScene.m_fTotalPower * _cosine);
+
+    return true;
+}
+
+// LightList::FindSphere().
+RT_HOST_DEVICE inline int GpuFindSphereLight(const GpuScene& a_oScene, const GpuRay& a_oRay, const GpuHit& a_oHit)
+{
+    int _low = 0;
+    int _high = a_oScene.m_iSphereLightCount;
+
+    while (_low < _high)
+    {
+        int _middle = (_low + _high) / 2;
+
+        if (a_oScene.m_pLights[a_oScene.m_pSpheresByMaterial[_middle]].m_uMaterialId < a_oHit.m_uMaterialId)
+        {
+            _low = _middle + 1;
+        }
+        else
+        {
+            _high = _middle;
+        }
+    }
+
+    int _best = -1;
+
+    float _bestError = GpuLimits::LIGHT_SURFACE_TOLERANCE;
+
+    for (int i = _low; i < a_oScene.m_iSphereLightCount; ++i)
+    {
+        const GpuLight& _light = a_oScene.m_pLights[a_oScene.m_pSpheresByMaterial[i]];
+
+        if (_light.m_uMaterialId != a_oHit.m_uMaterialId)
+        {
+            break;
+        }
+
+        GpuVec3 _center = _light.m_oPoint + a_oRay.m_fTime * _light.m_oEdgeA;
+
+        float _error = fabsf(Length(a_oHit.m_oPoint - _center) - _light.m_fRadius) / _light.m_fRadius;
+
+        if (_error < _bestError)
+        {
+            _best = a_oScene.m_pSpheresByMaterial[i];
+            _bestError = _error;
+        }
+    }
+
+    return _best;
+}
+
+// LightList::Pdf().
+RT_HOST_DEVICE inline float GpuLightPdf(const GpuScene& a_oScene, const GpuRay& a_oRay, const GpuHit& a_oHit, const GpuVec3& a_oRadiance)
+{
+    if (!(a_oScene.m_fTotalPower > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    float _weight = (a_oRadiance.m_fX + a_oRadiance.m_fY + a_oRadiance.m_fZ) * (1.0f / 3.0f);
+
+    int _sphere = GpuFindSphereLight(a_oScene, a_oRay, a_oHit);
+
+    if (_sphere >= 0)
+    {
+        const GpuLight& _light = a_oScene.m_pLights[_sphere];
+
+        GpuVec3 _toCenter = _light.m_oPoint + a_oRay.m_fTime * _light.m_oEdgeA - a_oRay.m_oOrigin;
+
+        float _radius2 = _light.m_fRadius * _light.m_fRadius;
+
+        float _sin2 = _radius2 / Dot(_toCenter, _toCenter);
+
+        if (!(_sin2 < 1.0f))
+        {
+            return 0.0f;
+        }
+
+        return _weight * 2.0f * _radius2 / (a_oScene.m_fTotalPower * GpuConeOneMinusCos(_sin2));
+    }
+
+    float _length = Length(a_oRay.m_oDirection);
+    float _distance = a_oHit.m_fT * _length;
+    float _cosine = fabsf(Dot(a_oHit.m_oNormal, a_oRay.m_oDirection)) / _length;
+
+    if (!(_cosine > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    return _weight * _distance * _distance / (a_oScene.m_fTotalPower * _cosine);
+}
+
+RT_HOST_DEVICE inline float GpuPowerHeuristic(float a_fPdf, float a_fOtherPdf)
+{
+    if (!(a_fPdf > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    float _ratio = a_fOtherPdf / a_fPdf;
+
+    return 1.0f / (1.0f + _ratio * _ratio);
+}
+
+// -- Materials, as in material.cpp ---------------------------------------------------
+
+RT_HOST_DEVICE inline GpuVec3 GpuReflect(const GpuVec3& a_oIn, const GpuVec3& a_oNormal)
+{
+    return a_oIn - 2.0f * Dot(a_oIn, a_oNormal) * a_oNormal;
+}
+
+RT_HOST_DEVICE inline bool GpuScatter(const GpuSampler& a_oSampler, const GpuMaterial& a_oMaterial, const GpuRay& a_oRay, const GpuHit& a_oHit, GpuStream& a_oStream, GpuVec3& a_oAttenuation, GpuRay& a_oScatter)
+{
+    a_oScatter.m_oOrigin = a_oHit.m_oPoint;
+    a_oScatter.m_fTime = a_oRay.m_fTime;
+
+    switch (a_oMaterial.m_iType)
+    {
+    case GPU_MATERIAL_LAMBERTIAN:
+    {
+        float _u;
+        float _v;
+
+        GpuNext2D(a_oSampler, a_oStream, _u, _v);
+
+        a_oScatter.m_oDirection = GpuSampleCosineHemisphere(a_oHit.m_oNormal, _u, _v);
+        a_oAttenuation = a_oMaterial.m_oAlbedo;
+        return true;
+    }
+    case GPU_MATERIAL_METAL:
+    {
+        GpuVec3 _fuzz = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+
+        if (a_oMaterial.m_fParameter > 0.0f)
+        {
+            float _u;
+            float _v;
+
+            GpuNext2D(a_oSampler, a_oStream, _u, _v);
+
+            _fuzz = GpuSampleUniformBall(_u, _v, GpuNext1D(a_oSampler, a_oStream));
+        }
+
+        a_oScatter.m_oDirection = GpuReflect(Normalize(a_oRay.m_oDirection), a_oHit.m_oNormal) + a_oMaterial.m_fParameter * _fuzz;
+        a_oAttenuation = a_oMaterial.m_oAlbedo;
+        return Dot(a_oScatter.m_oDirection, a_oHit.m_oNormal) > 0.0f;
+    }
+    case GPU_MATERIAL_DIELECTRIC:
+    {
+        float _refIdx = a_oMaterial.m_fParameter;
+
+        const GpuVec3& _in = a_oRay.m_oDirection;
+
+        float _inDotNormal = Dot(_in, a_oHit.m_oNormal);
+
+        GpuVec3 _outwardNormal;
+
+        float _niOverNt;
+        float _cosine;
+
+        if (_inDotNormal > 0.0f)
+        {
+            _outwardNormal = -a_oHit.m_oNormal;
+            _niOverNt = _refIdx;
+            _cosine = _inDotNormal / Length(_in);
+            _cosine = sqrtf(1.0f - _refIdx * _refIdx * (1.0f - _cosine * _cosine));
+        }
+        else
+        {
+            _outwardNormal = a_oHit.m_oNormal;
+            _niOverNt = 1.0f / _refIdx;
+            _cosine = -_inDotNormal / Length(_in);
+        }
+
+        GpuVec3 _unit = Normalize(_in);
+
+        float _dt = Dot(_unit, _outwardNormal);
+        float _disc = 1.0f - _niOverNt * _niOverNt * (1.0f - _dt * _dt);
+
+        float _reflectProb = 1.0f;
+
+        GpuVec3 _refracted = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+
+        if (_disc > 0.0f)
+        {
+            _refracted = _niOverNt * (_unit - _outwardNormal * _dt) - _outwardNormal * sqrtf(_disc);
+
+            float _r0 = (1.0f - _refIdx) / (1.0f + _refIdx);
+
+            _r0 = _r0 * _r0;
+
+            _reflectProb = _r0 + (1.0f - _r0) * powf(1.0f - _cosine, 5.0f);
+        }
+
+        a_oScatter.m_oDirection = GpuNext1D(a_oSampler, a_oStream) < _reflectProb ? GpuReflect(_in, a_oHit.m_oNormal) : _refracted;
+        a_oAttenuation = MakeGpuVec3(1.0f, 1.0f, 1.0f);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+// -- Path stages ---------------------------------------------------------------------
+
+// Camera ray of one sample, built like Camera::GetRays() from the dimensions
+// RenderTileWavefront() draws: pixel jitter, lens, then time.
+RT_HOST_DEVICE inline void GpuStartPath(const GpuFrame& a_oFrame, int a_iX, int a_iY, int a_iSample, GpuPath& a_oPath)
+{
+    const GpuCamera& _camera = a_oFrame.m_oCamera;
+
+    GpuStream _stream;
+
+    _stream.m_iX = a_iX;
+    _stream.m_iY = a_iY;
+    _stream.m_iSample = a_iSample;
+    _stream.m_iDimension = 0;
+
+    float _jitterX;
+    float _jitterY;
+    float _lensX;
+    float _lensY;
+
+    GpuNext2D(a_oFrame.m_oSampler, _stream, _jitterX, _jitterY);
+    GpuNext2D(a_oFrame.m_oSampler, _stream, _lensX, _lensY);
+
+    bool _shutter = _camera.m_fShutterClose > _camera.m_fShutterOpen;
+
+    float _time = _shutter ? GpuNext1D(a_oFrame.m_oSampler, _stream) : 0.0f;
+
+    GpuVec3 _stepX = _camera.m_oHorizontal / float(a_oFrame.m_iWidth);
+    GpuVec3 _stepY = _camera.m_oVertical / float(a_oFrame.m_iHeight);
+
+    GpuVec3 _rowBase = _camera.m_oLowerLeftCorner + float(a_iY) * _stepY - _camera.m_oOrigin;
+
+    GpuVec3 _target = _rowBase + (float(a_iX) + _jitterX) * _stepX + _jitterY * _stepY;
+
+    GpuVec3 _offset = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+
+    if (_camera.m_fLensRadius != 0.0f)
+    {
+        float _diskX;
+        float _diskY;
+
+        GpuConcentricSampleDisk(_lensX, _lensY, _diskX, _diskY);
+
+        _offset = _diskX * (_camera.m_fLensRadius * _camera.m_oU) + _diskY * (_camera.m_fLensRadius * _camera.m_oV);
+    }
+
+    a_oPath.m_oRay.m_oOrigin = _camera.m_oOrigin + _offset;
+    a_oPath.m_oRay.m_oDirection = _target - _offset;
+    a_oPath.m_oRay.m_fTime = _camera.m_fShutterOpen + _time * (_camera.m_fShutterClose - _camera.m_fShutterOpen);
+
+    a_oPath.m_oThroughput = MakeGpuVec3(1.0f, 1.0f, 1.0f);
+    a_oPath.m_oRadiance = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+    a_oPath.m_fBouncePdf = 0.0f;
+    a_oPath.m_iDepth = 0;
+
+    a_oPath.m_iX = a_iX;
+    a_oPath.m_iY = a_iY;
+    a_oPath.m_iSample = a_iSample;
+
+    a_oPath.m_oAlbedo = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+    a_oPath.m_oNormal = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+    a_oPath.m_fDepth = 0.0f;
+}
+
+// Traces the path's ray. Misses and emitters add their radiance and end the path, as does
+// the depth limit; otherwise returns the material type that has to shade the hit.
+RT_HOST_DEVICE inline int GpuExtend(const GpuScene& a_oScene, const GpuFrame& a_oFrame, GpuPath& a_oPath)
+{
+    bool _firstHit = a_oPath.m_iDepth == 0 && a_oFrame.m_bAovs;
+
+    if (!GpuIntersect(a_oScene, a_oPath.m_oRay, GpuLimits::RAY_EPSILON, FLT_MAX, false, &a_oPath.m_oHit))
+    {
+        GpuVec3 _background = GpuBackground(a_oScene, a_oPath.m_oRay);
+
+        if (_firstHit)
+        {
+            a_oPath.m_oAlbedo = ClampUnit(_background);
+        }
+
+        a_oPath.m_oRadiance = a_oPath.m_oRadiance + a_oPath.m_oThroughput * _background;
+        return -1;
+    }
+
+    const GpuHit& _hit = a_oPath.m_oHit;
+
+    const GpuMaterial& _material = a_oScene.m_pMaterials[_hit.m_uMaterialId];
+
+    if (_firstHit)
+    {
+        a_oPath.m_oAlbedo = _material.m_iType == GPU_MATERIAL_DIELECTRIC ? MakeGpuVec3(1.0f, 1.0f, 1.0f) : ClampUnit(_material.m_oAlbedo);
+        a_oPath.m_oNormal = _hit.m_oNormal;
+        a_oPath.m_fDepth = _hit.m_fT * Length(a_oPath.m_oRay.m_oDirection);
+    }
+
+    if (_material.m_iType == GPU_MATERIAL_EMISSIVE)
+    {
+        float _weight = a_oPath.m_fBouncePdf > 0.0f ? GpuPowerHeuristic(a_oPath.m_fBouncePdf, GpuLightPdf(a_oScene, a_oPath.m_oRay, _hit, _material.m_oAlbedo)) : 1.0f;
+
+        a_oPath.m_oRadiance = a_oPath.m_oRadiance + _weight * (a_oPath.m_oThroughput * _material.m_oAlbedo);
+        return -1;
+    }
+
+    if (a_oPath.m_iDepth >= a_oFrame.m_iMaxDepth)
+    {
+        return -1;
+    }
+
+    return _material.m_iType;
+}
+
+// Next event estimation at a Lambertian hit, before the path throughput.
+RT_HOST_DEVICE inline GpuVec3 GpuSampleDirect(const GpuScene& a_oScene, const GpuFrame& a_oFrame, const GpuMaterial& a_oMaterial, const GpuPath& a_oPath, GpuStream& a_oStream)
+{
+    const GpuVec3 _black = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+
+    const GpuHit& _hit = a_oPath.m_oHit;
+
+    float _u;
+    float _v;
+
+    a_oStream.m_iDimension = GpuBounceDimension(a_oPath.m_iDepth) + GPU_SLOT_LIGHT;
+
+    GpuNext2D(a_oFrame.m_oSampler, a_oStream, _u, _v);
+
+    a_oStream.m_iDimension = GpuBounceDimension(a_oPath.m_iDepth) + GPU_SLOT_LIGHT_SELECT;
+
+    float _select = GpuNext1D(a_oFrame.m_oSampler, a_oStream);
+
+    GpuLightSample _sample;
+
+    if (!GpuSampleLight(a_oScene, _hit.m_oPoint, a_oPath.m_oRay.m_fTime, _select, _u, _v, _sample))
+    {
+        return _black;
+    }
+
+    float _cosine = Dot(_hit.m_oNormal, _sample.m_oDirection);
+
+    if (!(_cosine > 0.0f))
+    {
+        return _black;
+    }
+
+    GpuRay _shadow;
+
+    _shadow.m_oOrigin = _hit.m_oPoint;
+    _shadow.m_oDirection = _sample.m_oDirection;
+    _shadow.m_fTime = a_oPath.m_oRay.m_fTime;
+
+    if (GpuIntersect(a_oScene, _shadow, GpuLimits::RAY_EPSILON, _sample.m_fDistance - GpuLimits::RAY_EPSILON, true, nullptr))
+    {
+        return _black;
+    }
+
+    float _bouncePdf = _cosine * float(1.0 / M_PI);
+
+    return (_bouncePdf * GpuPowerHeuristic(_sample.m_fPdf, _bouncePdf) / _sample.m_fPdf) * (a_oMaterial.m_oAlbedo * _sample.m_oRadiance);
+}
+
+// Shades the hit GpuExtend() stopped at: a light sample at Lambertian hits, the scatter,
+// then Russian roulette. Returns false once the path has ended.
+RT_HOST_DEVICE inline bool GpuShade(const GpuScene& a_oScene, const GpuFrame& a_oFrame, GpuPath& a_oPath)
+{
+    const GpuMaterial& _material = a_oScene.m_pMaterials[a_oPath.m_oHit.m_uMaterialId];
+
+    GpuStream _stream;
+
+    _stream.m_iX = a_oPath.m_iX;
+    _stream.m_iY = a_oPath.m_iY;
+    _stream.m_iSample = a_oPath.m_iSample;
+    _stream.m_iDimension = 0;
+
+    bool _sampleLight = a_oFrame.m_bNextEvent && _material.m_iType == GPU_MATERIAL_LAMBERTIAN;
+
+    if (_sampleLight)
+    {
+        a_oPath.m_oRadiance = a_oPath.m_oRadiance + a_oPath.m_oThroughput * GpuSampleDirect(a_oScene, a_oFrame, _material, a_oPath, _stream);
+    }
+
+    _stream.m_iDimension = GpuBounceDimension(a_oPath.m_iDepth);
+
+    GpuVec3 _attenuation;
+    GpuRay _scatter;
+
+    if (!GpuScatter(a_oFrame.m_oSampler, _material, a_oPath.m_oRay, a_oPath.m_oHit, _stream, _attenuation, _scatter))
+    {
+        return false;
+    }
+
+    a_oPath.m_fBouncePdf = _sampleLight ? fmaxf(0.0f, Dot(a_oPath.m_oHit.m_oNormal, Normalize(_scatter.m_oDirection))) * float(1.0 / M_PI) : 0.0f;
+    a_oPath.m_oThroughput = a_oPath.m_oThroughput * _attenuation;
+    a_oPath.m_oRay = _scatter;
+    a_oPath.m_iDepth++;
+
+    if (a_oFrame.m_iRouletteDepth < 0 || a_oPath.m_iDepth < a_oFrame.m_iRouletteDepth)
+    {
+        return true;
+    }
+
+    float _p = fminf(MaxComponent(a_oPath.m_oThroughput), GpuLimits::MAX_SURVIVAL);
+
+    _stream.m_iDimension = GpuBounceDimension(a_oPath.m_iDepth - 1) + GPU_SLOT_ROULETTE;
+
+    if (GpuNext1D(a_oFrame.m_oSampler, _stream) >= _p)
+    {
+        return false;
+    }
+
+    a_oPath.m_oThroughput = a_oPath.m_oThroughput / _p;
+
+    return true;
+}
+
+// Adds a finished path to its pixel.
+RT_HOST_DEVICE inline void GpuAccumulate(const GpuFrame& a_oFrame, const GpuPath& a_oPath, GpuPixelSum& a_oSum)
+{
+    a_oSum.m_oRadiance = a_oSum.m_oRadiance + a_oPath.m_oRadiance;
+    a_oSum.m_iCount++;
+
+    if (a_oFrame.m_bAovs)
+    {
+        a_oSum.m_oAlbedo = a_oSum.m_oAlbedo + a_oPath.m_oAlbedo;
+        a_oSum.m_oNormal = a_oSum.m_oNormal + a_oPath.m_oNormal;
+        a_oSum.m_fDepth += a_oPath.m_fDepth;
+    }
+}
+
+#endif // GPUKERNEL_H
@@ -0,0 +1,76 @@
+#ifndef GPURENDERER_H
+#define GPURENDERER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Render/framebuffer.h"
+#include "appsrc/include/Render/gpudevice.h"
+#include "appsrc/include/Render/lightlist.h"
+#include "appsrc/include/Render/tilerenderer.h"
+
+// The wavefront integrator on a CUDA device, when the build has the backend (RT_USE_CUDA in
+// CMake). Packs the sphere BVH, its leaf-ordered SoA spheres, the material table and the
+// emitters into the layouts of gpukernel.h and renders tiles as RenderTileWavefront()
+// would, from the same sampler dimensions, so images match the CPU's statistically.
+//
+// Open() fails in builds without the backend and on machines without a device, and
+// Supports() turns down worlds the kernels cannot trace; Renderer falls back to the CPU in
+// either case.
+class GpuRenderer
+{
+public:
+    GpuRenderer();
+    ~GpuRenderer();
+
+    // Binds the device once; later calls return the first result.
+    bool Open(std::string& a_sError);
+
+    const std::string& GetDeviceName() const;
+
+    // Only BVHs over spheres, without instances or meshes, no deeper than the kernels'
+    // traversal stack, and fixed sample counts.
+    static bool Supports(const Bvh& a_oWorld, const RenderSettings& a_oSettings, std::string& a_sReason);
+
+    // Uploads a_oWorld again after it moved; buffers of the same size are reused.
+    bool Upload(const Bvh& a_oWorld, const MaterialTable& a_oMaterials, const LightList& a_oLights, std::string& a_sError);
+
+    // Renders the sample range of a_oSettings over a_oTiles into a_oTarget, AOVs included
+    // if it keeps them. A cancelled render leaves the target untouched.
+    bool Render(const std::vector<Tile>& a_oTiles, const RenderSettings& a_oSettings, const Camera& a_oCamera, const Sampler& a_oSampler, const std::atomic<bool>* a_pCancel, FrameBuffer& a_oTarget, std::string& a_sError);
+
+    // The packing the device receives, which the CPU can run through gpukernel.h too.
+    // a_oWorld must pass Supports().
+    static void PackScene(const Bvh& a_oWorld, const MaterialTable& a_oMaterials, const LightList& a_oLights, GpuSceneData& a_oData);
+
+    static GpuFrame PackFrame(const RenderSettings& a_oSettings, const Camera& a_oCamera, const Sampler& a_oSampler, bool a_bNextEvent, bool a_bAovs);
+
+private:
+    GpuRenderer(const GpuRenderer&);
+    GpuRenderer& operator=(const GpuRenderer&);
+
+    // Owned; null until Open() succeeds, and always in builds without the backend.
+    GpuDevice* m_pDevice;
+
+    GpuSceneData m_oData;
+
+    // Whether the uploaded scene has emitters, for next event estimation.
+    bool m_bLights;
+
+    std::vector<GpuPixel> m_oPixels;
+    std::vector<GpuPixelSum> m_oSums;
+
+    // Set by the first Open().
+    bool m_bOpened;
+    bool m_bOpen;
+
+    std::string m_sOpenError;
+
+    std::string m_sDeviceName;
+};
+
+#endif // GPURENDERER_H
@@ -0,0 +1,107 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <vector>
+#include "appsrc/include/Math/hittable.h"
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Render/lightlist.h"
+#include "appsrc/include/Render/tilerenderer.h"
+
+class Bvh;
+
+// Radiance for rays that leave a scene without a background of its own.
+Vec3 SkyColor(const Ray& a_oRay);
+
+struct PathStats
+{
+    PathStats();
+
+    uint64_t m_uPaths;
+
+    // Rays traced, i.e. camera rays plus every scattered ray.
+    uint64_t m_uSegments;
+
+    uint64_t m_uRouletteKills;
+
+    // Next event estimation shadow rays, and how many of them the world blocked.
+    uint64_t m_uShadowRays;
+    uint64_t m_uShadowRaysOccluded;
+};
+
+// Path part of the per-thread counters, summed since the last Counters::Reset().
+PathStats GetPathStats();
+
+// Iterative replacement for the recursive Color(): follows one path, carrying the product
+// of the attenuations as its throughput. Stops at m_iMaxDepth bounces, and from
+// m_iRouletteDepth on survives each bounce with a probability tied to that throughput.
+// Emitters add their radiance where the path meets them. With m_bNextEvent every
+// Lambertian hit also samples a_oLights through a shadow ray, and both ways of reaching a
+// light are weighted by the power heuristic; metal and glass leave lights to the bounce.
+// a_pAovs, when given, receives the first hit's AOVs.
+Vec3 TracePath(const Ray& a_oRay, const Hittable& a_oWorld, const MaterialTable& a_oMaterials, const LightList& a_oLights, SampleStream& a_oStream, const RenderSettings& a_oSettings, SampleAovs* a_pAovs = nullptr);
+
+// Traces a batch of paths one bounce at a time. Each bounce intersects every live path
+// (as packets on the first bounce, as a direction-sorted stream afterwards), then bins the
+// hits by material type so Lambertian, Metal and Dielectric each shade in their own tight loop.
+// Lights are handled as in TracePath(), with the shadow rays traced from the Lambertian loop.
+class WavefrontIntegrator
+{
+public:
+    WavefrontIntegrator(const Hittable& a_oWorld, const MaterialTable& a_oMaterials, const LightList& a_oLights, const RenderSettings& a_oSettings);
+
+    // a_oStreams holds one sample stream per path, already past the camera dimensions.
+    // a_oAovs, when given, is indexed like a_oRays and receives each first hit's AOVs.
+    void Trace(const Ray* a_oRays, SampleStream* a_oStreams, int a_iCount, Vec3* a_oRadiance, SampleAovs* a_oAovs = nullptr);
+
+private:
+    struct PathState
+    {
+        Ray m_oRay;
+        Vec3 m_oThroughput;
+        HitRecord m_oRecord;
+
+        // Density of the last bounce direction, zero when no light sample competed with it.
+        float m_fBouncePdf;
+
+        int m_iDepth;
+    };
+
+    void Extend(bool a_bCoherent);
+
+    template <typename MaterialClass>
+    void Shade(MaterialType a_eType, SampleStream* a_oStreams);
+
+    const Hittable& m_oWorld;
+    const Bvh* m_oBvh;
+
+    const MaterialTable& m_oMaterials;
+
+    const LightList& m_oLights;
+
+    int m_iMaxDepth;
+    int m_iRouletteDepth;
+
+    bool m_bNextEvent;
+
+    Vec3* m_oRadiance;
+
+    SampleAovs* m_oAovs;
+
+    std::vector<PathState> m_oPaths;
+
+    // Indices into m_oPaths, rebuilt every bounce.
+    std::vector<int> m_oActive;
+    std::vector<int> m_oShadeQueues[MATERIAL_TYPE_COUNT];
+
+    std::vector<Ray> m_oRayBuffer;
+    std::vector<HitRecord> m_oRecordBuffer;
+    std::vector<uint8_t> m_oHitBuffer;
+};
+
+// Traces every sample of a tile through a WavefrontIntegrator and stores the pixel averages,
+// AOVs included when a_oFrameBuffer keeps them.
+void RenderTileWavefront(const Tile& a_oTile, const RenderSettings& a_oSettings, const Camera& a_oCamera, const Hittable& a_oWorld, const MaterialTable& a_oMaterials, const LightList& a_oLights, const Sampler& a_oSampler, FrameBuffer& a_oFrameBuffer);
+
+#endif // INTEGRATOR_H
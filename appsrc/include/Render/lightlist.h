@@ -0,0 +1,125 @@
+#ifndef LIGHTLIST_H
+#define LIGHTLIST_H
+
+#include <vector>
+#include "appsrc/include/Math/hittable.h"
+
+// A point picked on an emitter as seen from a shading point.
+struct LightSample
+{
+    Vec3 m_oPoint;
+
+    // Unit vector from the shading point to m_oPoint.
+    Vec3 m_oDirection;
+
+    float m_fDistance;
+
+    Vec3 m_oRadiance;
+
+    // Density over solid angle at the shading point, including the choice of emitter.
+    float m_fPdf;
+};
+
+// Everything that emits: the world-space spheres and triangles with an Emissive material,
+// which next event estimation samples directly, and the background that rays leaving
+// the scene see.
+//
+// An emitter is picked with probability proportional to its power. A triangle is then
+// sampled uniformly by area, so per unit area each of its points has the density of its
+// radiance over the total power and Pdf() needs nothing but the hit. A sphere is sampled
+// uniformly over the cone it subtends at the shading point, so no sample lands on the
+// half turned away; Pdf() finds the sphere a bounce hit by its material and the hit point.
+// Either way every emissive primitive of the world must have been added.
+class LightList
+{
+public:
+    struct Emitter
+    {
+        // Sphere centre at time zero, or the first triangle corner.
+        Vec3 m_oPoint;
+
+        // The sphere's velocity, or the triangle's first edge.
+        Vec3 m_oEdgeA;
+
+        // The triangle's second edge.
+        Vec3 m_oEdgeB;
+
+        // Zero for triangles.
+        float m_fRadius;
+
+        Vec3 m_oRadiance;
+
+        // The sphere's material, which Pdf() looks it up by.
+        MaterialId m_uMaterialId;
+    };
+
+    LightList();
+
+    // Removes the emitters and keeps the background.
+    void Clear();
+
+    // Sphere whose centre at time t is a_oCenter + t * a_oVelocity.
+    void AddSphere(const Vec3& a_oCenter, const Vec3& a_oVelocity, float a_fRadius, const Vec3& a_oRadiance, MaterialId a_uMaterialId);
+
+    void AddTriangle(const Vec3& a_oA, const Vec3& a_oB, const Vec3& a_oC, const Vec3& a_oRadiance);
+
+    bool IsEmpty() const;
+
+    int GetCount() const;
+
+    // Emitted power in units of radiance times area, summed over every emitter.
+    float GetTotalPower() const;
+
+    // Picks an emitter with a_fSelect and a point on it with (a_fU, a_fV) at ray time
+    // a_fTime. Fails for points that cannot light a_oFrom, e.g. a_oFrom inside a sphere.
+    bool Sample(const Vec3& a_oFrom, float a_fTime, float a_fSelect, float a_fU, float a_fV, LightSample& a_oSample) const;
+
+    // Solid-angle density with which Sample() would have picked the point where a_oRay
+    // hit an emitter of radiance a_oRadiance.
+    float Pdf(const Ray& a_oRay, const HitRecord& a_oRecord, const Vec3& a_oRadiance) const;
+
+    // The sphere emitter a_oRay hit at a_oRecord, or -1 when it hit a triangle.
+    int FindSphere(const Ray& a_oRay, const HitRecord& a_oRecord) const;
+
+    // The constant background if one was set, the sky gradient otherwise.
+    Vec3 Background(const Ray& a_oRay) const;
+
+    void SetBackground(const Vec3& a_oRadiance);
+
+    // Goes back to the sky gradient.
+    void ClearBackground();
+
+    bool HasBackground() const;
+
+    const Vec3& GetBackground() const;
+
+    const Emitter& GetEmitter(int a_iIndex) const;
+
+    // Power of the emitters up to and including a_iIndex, which Sample() picks by.
+    float GetCumulativePower(int a_iIndex) const;
+
+    // Indices of the sphere emitters ordered by material id, then by index.
+    const std::vector<int>& GetSpheresByMaterial() const;
+
+    // What emitters are weighted by: the mean of the three channels.
+    static float Weight(const Vec3& a_oRadiance);
+
+private:
+    // False when the emitter could never be picked and was left out.
+    bool Append(const Emitter& a_oEmitter, float a_fArea);
+
+    std::vector<Emitter> m_oEmitters;
+
+    // Running total of the emitters' power, one entry per emitter.
+    std::vector<float> m_oCdf;
+
+    std::vector<int> m_oSpheresByMaterial;
+
+    float m_fTotalPower;
+
+    Vec3 m_oBackground;
+
+    bool m_bBackground;
+};
+
+#endif // LIGHTLIST_H
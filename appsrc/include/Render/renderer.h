@@ -0,0 +1,172 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Render/denoiser.h"
+#include "appsrc/include/Render/gpurenderer.h"
+#include "appsrc/include/Render/tilerenderer.h"
+#include "appsrc/include/Scene/scene.h"
+
+// One image to render from a Renderer's scene.
+struct RenderRequest
+{
+    RenderRequest();
+
+    // The thread count is ignored; the Renderer keeps the pool it was built with.
+    RenderSettings m_oSettings;
+
+    bool m_bWavefront;
+
+    // Runs the wavefront integrator on the GPU backend if there is a device and it can take
+    // the scene, and on the CPU otherwise; see Renderer::GetGpuStatus().
+    bool m_bGpu;
+
+    int m_iFrame;
+
+    // Renders through m_oCamera instead of the scene's own camera.
+    bool m_bCamera;
+
+    SceneCamera m_oCamera;
+
+    // Keeps first-hit AOVs in the target; a denoiser implies them.
+    bool m_bAovs;
+
+    DenoiseSettings m_oDenoise;
+};
+
+// A scene loaded or built once with the pool, sampler and BVHs that render it, for
+// embedding: every request renders against the same warm state, only refitting what moves
+// between frames and rebuilding the sampler when its type or sample count changes.
+//
+// Render() does a whole request and may be cancelled from any thread. Prepare(),
+// SetSampleRange() and RenderTiles() are the pieces it is made of, for callers that
+// split a frame themselves, e.g. into progressive passes or distributed batches; they
+// must not overlap with Render() or each other.
+//
+// GPU requests fall back to the CPU integrators when the device is missing, turns the scene
+// down or fails mid-render; the fallback sticks until the next Prepare().
+class Renderer
+{
+public:
+    typedef TileRenderer::TileCallback TileCallback;
+
+    // Zero or less picks one thread per hardware core.
+    explicit Renderer(int a_iThreadCount = 0);
+
+    // Leaves the scene empty on failure.
+    bool LoadScene(const std::string& a_sPath, std::string& a_sError);
+
+    // The "Ray Tracing in One Weekend" cover scene.
+    void BuildDefaultScene();
+
+    // For scenes built or adjusted in code before the next Prepare(). The GPU copy of the
+    // scene is refreshed before its next render.
+    Scene& GetScene();
+
+    // Takes the request's settings, frame and camera for the following calls.
+    void Prepare(const RenderRequest& a_oRequest);
+
+    // Moves the world and the camera to a_iFrame, keeping everything else prepared.
+    void SetFrame(int a_iFrame);
+
+    // Restricts RenderTiles() to samples [a_iFirst, a_iFirst + a_iCount) of every pixel.
+    void SetSampleRange(int a_iFirst, int a_iCount);
+
+    std::vector<Tile> BuildTiles() const;
+
+    void RenderTiles(const std::vector<Tile>& a_oTiles, FrameBuffer& a_oTarget);
+
+    // Renders and denoises a_oRequest into a_oTarget, which must be the request's size and
+    // gets AOVs if it needs them. a_oOnTile, if set, sees every tile as it finishes, on
+    // the worker that rendered it; the image is only complete once Render() returns.
+    // Returns false with "cancelled" when Cancel() reaches it, whether while it waits for an
+    // earlier request, renders or denoises.
+    bool Render(const RenderRequest& a_oRequest, FrameBuffer& a_oTarget, const TileCallback& a_oOnTile, std::string& a_sError);
+
+    // Stops every Render() already called: the one in flight skips the tiles not yet started
+    // and its denoise, leaving the target partly written, and those waiting return at once.
+    // Cancelling with no render called does nothing.
+    void Cancel();
+
+    // Whether the render in flight, or else the last one, was cancelled.
+    bool IsCancelled() const;
+
+    const RenderSettings& GetSettings() const;
+
+    const Camera& GetCamera() const;
+
+    // The BVH of the prepared frame.
+    const Bvh& GetWorld() const;
+
+    int GetThreadCount() const;
+
+    ThreadPool& GetPool();
+
+    // Whether the prepared request renders on the GPU.
+    bool IsUsingGpu() const;
+
+    // The device name while on the GPU, otherwise why a GPU request runs on the CPU.
+    const std::string& GetGpuStatus() const;
+
+private:
+    Renderer(const Renderer&);
+    Renderer& operator=(const Renderer&);
+
+    void PrepareGpu();
+
+    // Render() once it holds the render mutex.
+    bool RenderHeld(const RenderRequest& a_oRequest, FrameBuffer& a_oTarget, const TileCallback& a_oOnTile, std::string& a_sError);
+
+    // False, after switching to the CPU, when the device failed.
+    bool RenderTilesGpu(const std::vector<Tile>& a_oTiles, FrameBuffer& a_oTarget);
+
+    Scene m_oScene;
+
+    TileRenderer m_oTiles;
+
+    // The request as prepared, with the full sample count whatever range is being rendered.
+    RenderRequest m_oRequest;
+
+    Camera m_oCamera;
+
+    const Bvh* m_pWorld;
+
+    std::unique_ptr<Sampler> m_pSampler;
+
+    // What m_pSampler was sized for.
+    int m_iSamplerSamples;
+
+    // Raised for the request in flight only, so the tile loops can poll it.
+    std::atomic<bool> m_bCancel;
+
+    // Every Render() takes the next ticket on entry, before it waits for the render mutex;
+    // Cancel() reaches each ticket handed out so far.
+    std::atomic<uint64_t> m_uTickets;
+    uint64_t m_uCancelledTickets;
+
+    // The ticket of the request in flight, zero for none.
+    uint64_t m_uActiveTicket;
+
+    std::mutex m_oCancelMutex;
+
+    GpuRenderer m_oGpu;
+
+    bool m_bGpuActive;
+
+    // The scene on the device is out of date.
+    bool m_bGpuDirty;
+
+    std::string m_sGpuStatus;
+
+    // Held by Render(), so concurrent requests queue up.
+    std::mutex m_oRenderMutex;
+};
+
+#endif // RENDERER_H
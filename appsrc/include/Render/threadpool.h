@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of workers, each owning a task deque. A worker pops from the
+// front of its own deque and, once that runs dry, steals from the back of the
+// others so uneven tiles do not leave cores idle.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // A thread count of zero or less uses std::thread::hardware_concurrency().
+    explicit ThreadPool(int a_iThreadCount = 0);
+    ~ThreadPool();
+
+    void Submit(const Task& a_oTask);
+
+    // Blocks until every submitted task has finished.
+    void Wait();
+
+    int GetThreadCount() const;
+
+private:
+    struct WorkQueue
+    {
+        std::mutex m_oMutex;
+        std::deque<Task> m_oTasks;
+    };
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void WorkerLoop(int a_iIndex);
+
+    bool PopTask(int a_iIndex, Task& a_oTask);
+
+    std::vector<std::thread> m_oThreads;
+    std::vector<std::unique_ptr<WorkQueue> > m_oQueues;
+
+    std::mutex m_oStateMutex;
+    std::condition_variable m_oWorkAvailable;
+    std::condition_variable m_oWorkDone;
+
+    std::atomic<int> m_iQueued;
+    std::atomic<int> m_iPending;
+    std::atomic<unsigned int> m_uNextQueue;
+
+    bool m_bStop;
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,121 @@
+#ifndef TILERENDERER_H
+#define TILERENDERER_H
+
+#include <atomic>
+#include <functional>
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Render/framebuffer.h"
+#include "appsrc/include/Render/threadpool.h"
+
+struct RenderSettings
+{
+    RenderSettings();
+
+    int m_iWidth;
+    int m_iHeight;
+
+    // Samples per pixel, or the per-pixel cap when sampling adaptively.
+    int m_iSamples;
+
+    // Index of the first sample taken per pixel, so progressive passes continue the sequence.
+    int m_iFirstSample;
+
+    int m_iTileSize;
+
+    // Zero or less picks one thread per hardware core.
+    int m_iThreadCount;
+
+    // Paths are cut after this many scattering events.
+    int m_iMaxDepth;
+
+    // Bounce from which Russian roulette may end low-throughput paths; negative disables it.
+    int m_iRouletteDepth;
+
+    // Samples a light at every diffuse bounce, weighted against hitting it by chance with
+    // multiple importance sampling. Off, emitters are only found by the bounces themselves.
+    bool m_bNextEvent;
+
+    // Where pixel, lens and bounce samples come from.
+    SamplerType m_eSampler;
+
+    bool m_bAdaptive;
+
+    // Adaptive sampling: samples every pixel gets before its noise is measured.
+    int m_iMinSamples;
+
+    // Adaptive sampling: a pixel stops once its relative standard error falls below this.
+    float m_fNoiseThreshold;
+
+    // Adaptive sampling: wall-clock budget per tile in milliseconds, zero for none.
+    double m_dTileTimeLimitMs;
+};
+
+struct Tile
+{
+    int m_iX0;
+    int m_iY0;
+    int m_iX1;
+    int m_iY1;
+};
+
+// Splits the image into square tiles and renders them on a work-stealing pool.
+class TileRenderer
+{
+public:
+    // Returns the radiance of one sample of pixel (x, y); called concurrently from every worker.
+    // a_pAovs is null unless the target framebuffer keeps AOVs, in which case the shader
+    // fills it for the sample.
+    typedef std::function<Vec3(int a_iX, int a_iY, int a_iSample, SampleAovs* a_pAovs)> SampleShader;
+
+    // Renders every pixel of a tile into the framebuffer; for integrators that batch a whole tile.
+    typedef std::function<void(const Tile& a_oTile, FrameBuffer& a_oFrameBuffer)> TileShader;
+
+    // Told about each finished tile, from the worker that rendered it, once its pixels are final.
+    typedef std::function<void(const Tile& a_oTile, const FrameBuffer& a_oFrameBuffer)> TileCallback;
+
+    explicit TileRenderer(const RenderSettings& a_oSettings);
+
+    void Render(const SampleShader& a_oShader, FrameBuffer& a_oFrameBuffer);
+
+    void RenderTiles(const TileShader& a_oShader, FrameBuffer& a_oFrameBuffer);
+
+    // Only renders a_oTiles, e.g. the share of a frame handed to this node.
+    void Render(const SampleShader& a_oShader, const std::vector<Tile>& a_oTiles, FrameBuffer& a_oFrameBuffer);
+
+    void RenderTiles(const TileShader& a_oShader, const std::vector<Tile>& a_oTiles, FrameBuffer& a_oFrameBuffer);
+
+    std::vector<Tile> BuildTiles() const;
+
+    // Restricts later renders to samples [a_iFirst, a_iFirst + a_iCount) of every pixel.
+    void SetSampleRange(int a_iFirst, int a_iCount);
+
+    // Takes everything but the thread count, which the pool was built with.
+    void SetSettings(const RenderSettings& a_oSettings);
+
+    // Tiles that have not started when *a_pCancel turns true are skipped; null renders everything.
+    void SetCancelFlag(const std::atomic<bool>* a_pCancel);
+
+    void SetTileCallback(const TileCallback& a_oCallback);
+
+    const TileCallback& GetTileCallback() const;
+
+    const RenderSettings& GetSettings() const;
+
+    int GetThreadCount() const;
+
+    // The workers, for post-processing that wants them once rendering is done.
+    ThreadPool& GetPool();
+
+private:
+    void RenderTile(const Tile& a_oTile, const SampleShader& a_oShader, FrameBuffer& a_oFrameBuffer) const;
+
+    RenderSettings m_oSettings;
+
+    const std::atomic<bool>* m_pCancel;
+
+    TileCallback m_oTileCallback;
+
+    ThreadPool m_oPool;
+};
+
+#endif // TILERENDERER_H
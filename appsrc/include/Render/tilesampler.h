@@ -0,0 +1,90 @@
+#ifndef TILESAMPLER_H
+#define TILESAMPLER_H
+
+#include <chrono>
+#include <vector>
+#include "appsrc/include/Render/tilerenderer.h"
+
+// Running estimate of one pixel: the colour sum for the mean, plus Welford's mean and M2
+// of the luminance for the variance.
+struct PixelEstimate
+{
+    PixelEstimate();
+
+    void Add(const Vec3& a_oSample);
+
+    Vec3 GetMean() const;
+
+    // Standard error of the mean luminance relative to that mean.
+    float GetRelativeError() const;
+
+    Vec3 m_oSum;
+
+    double m_dMean;
+    double m_dM2;
+
+    int m_iCount;
+};
+
+struct SampleRequest
+{
+    int m_iX;
+    int m_iY;
+    int m_iSample;
+
+    // Index of the pixel within the tile.
+    int m_iPixel;
+};
+
+// Hands out sample rounds for one tile. Without adaptive sampling there is a single round
+// of m_iSamples per pixel. With it, every pixel first gets m_iMinSamples, then only pixels
+// whose relative error is still above m_fNoiseThreshold get further rounds, until
+// m_iSamples or the tile's time budget is reached. Those first rounds grow with the sample
+// count, so they are handed out in slices of at most MAX_ROUND_SIZE requests, in the same
+// pixel and sample order.
+class TileSampler
+{
+public:
+    static const int MAX_ROUND_SIZE = 1 << 16;
+
+    // With a_bAovs the first-hit AOVs of every sample are averaged as well.
+    TileSampler(const Tile& a_oTile, const RenderSettings& a_oSettings, bool a_bAovs = false);
+
+    // Fills the next round; returns false once the tile is finished.
+    bool NextRound(std::vector<SampleRequest>& a_oRequests);
+
+    // a_pAovs is ignored unless the sampler was created with AOVs.
+    void AddSample(const SampleRequest& a_oRequest, const Vec3& a_oRadiance, const SampleAovs* a_pAovs = nullptr);
+
+    bool HasAovs() const;
+
+    // Writes the pixel means and per-pixel sample counts, and the AOV means if both sides keep AOVs.
+    void Resolve(FrameBuffer& a_oFrameBuffer) const;
+
+private:
+    bool IsPending(const PixelEstimate& a_oEstimate) const;
+
+    // Appends the next slice of the round that takes every pixel to m_iFixedTarget.
+    void ContinueFixedRound(std::vector<SampleRequest>& a_oRequests);
+
+    Tile m_oTile;
+
+    const RenderSettings& m_oSettings;
+
+    std::vector<PixelEstimate> m_oPixels;
+
+    // Per-pixel AOV sums; empty without AOVs.
+    std::vector<SampleAovs> m_oAovSums;
+
+    int m_iRound;
+
+    // Where the current fixed round goes on; m_uCursorPixel is past the last pixel when
+    // no fixed round is in progress.
+    int m_iFixedTarget;
+    size_t m_uCursorPixel;
+    int m_iCursorSample;
+
+    std::chrono::steady_clock::time_point m_oStart;
+};
+
+#endif // TILESAMPLER_H
@@ -0,0 +1,68 @@
+#ifndef TONEMAPPER_H
+#define TONEMAPPER_H
+
+#include <string>
+#include <vector>
+#include "appsrc/include/Math/simd.h"
+#include "appsrc/include/Render/framebuffer.h"
+
+enum ToneCurve
+{
+    TONE_CURVE_CLAMP = 0,
+    TONE_CURVE_REINHARD,
+    TONE_CURVE_ACES,
+    TONE_CURVE_COUNT
+};
+
+enum DisplayEncoding
+{
+    DISPLAY_SRGB = 0,
+    DISPLAY_GAMMA2,
+    DISPLAY_ENCODING_COUNT
+};
+
+struct ToneMapSettings
+{
+    ToneMapSettings();
+
+    // In stops: colour is scaled by 2^m_fExposure before the curve.
+    float m_fExposure;
+
+    ToneCurve m_eCurve;
+
+    DisplayEncoding m_eEncoding;
+
+    // Triangular noise of one 8-bit step before rounding, against banding in gradients.
+    bool m_bDither;
+};
+
+// The display transform, kept out of the render so that one linear FrameBuffer, or a PFM
+// of it, gives any number of looks. Exposure and the curve treat the buffer as a flat
+// stream of floats with SSE2 or AVX2 kernels chosen at startup; the encoding goes through
+// a table, and the dither is hashed from the pixel so every run quantises alike.
+class ToneMapper
+{
+public:
+    // Display-referred 8-bit RGB, top scanline first.
+    static void ToRgb8(const FrameBuffer& a_oFrameBuffer, const ToneMapSettings& a_oSettings, std::vector<unsigned char>& a_oRgb);
+
+    // Exposure and curve over a_iCount floats, clamped to [0, 1]. a_pOut may be a_pIn.
+    static void ApplyCurve(const float* a_pIn, int a_iCount, const ToneMapSettings& a_oSettings, float* a_pOut);
+
+    // A display value in [0, 1] from one in [0, 1] of ApplyCurve().
+    static float Encode(float a_fValue, DisplayEncoding a_eEncoding);
+
+    // Accepts "clamp", "reinhard" and "aces".
+    static bool ParseCurve(const std::string& a_sName, ToneCurve& a_eCurve);
+
+    static const char* GetCurveName(ToneCurve a_eCurve);
+
+    // Accepts "srgb" and "gamma2".
+    static bool ParseEncoding(const std::string& a_sName, DisplayEncoding& a_eEncoding);
+
+    static const char* GetEncodingName(DisplayEncoding a_eEncoding);
+
+    static SimdIsa GetIsa();
+};
+
+#endif // TONEMAPPER_H
@@ -0,0 +1,32 @@
+#ifndef RANDOMSCENE_H
+#define RANDOMSCENE_H
+
+#include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Math/hittablelist.h"
+#include "appsrc/include/Math/random.h"
+#include "appsrc/include/Math/scenearena.h"
+
+// Shape of the "Ray Tracing in One Weekend" cover scene. The defaults rebuild the original
+// exactly: about 500 small spheres, 80% diffuse, 15% metal and the rest glass.
+struct RandomSceneOptions
+{
+    RandomSceneOptions();
+
+    // Small spheres are jittered over a 2n x 2n grid of unit cells around the origin.
+    int m_iGridHalfExtent;
+
+    // Material odds of each small sphere; whatever is left over is glass.
+    float m_fDiffuseFraction;
+    float m_fMetalFraction;
+};
+
+// Every object of the scene lives in a_oArena; each material is allocated right before its sphere.
+HittableList* RandomScene(SceneArena& a_oArena, Rng& a_oRng, const RandomSceneOptions& a_oOptions = RandomSceneOptions());
+
+// Upper bound on the primitives RandomScene() creates for a_oOptions.
+int RandomSceneCapacity(const RandomSceneOptions& a_oOptions);
+
+// The cover shot, focused on the glass sphere ten units away. Zero aperture gives a pinhole.
+Camera RandomSceneCamera(float a_fAspect, float a_fAperture);
+
+#endif // RANDOMSCENE_H
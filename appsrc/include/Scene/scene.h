@@ -0,0 +1,277 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Math/hittablelist.h"
+#include "appsrc/include/Math/instance.h"
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/spheresoa.h"
+#include "appsrc/include/Math/trianglemesh.h"
+#include "appsrc/include/IO/mappedfile.h"
+#include "appsrc/include/Render/lightlist.h"
+
+// Camera placement as scene files store it, matching the Camera constructor minus the
+// aspect ratio, which comes from the image. The defaults are the cover shot.
+struct SceneCamera
+{
+    SceneCamera();
+
+    // The camera of frame a_iFrame: orbited into place, with the shutter open from the
+    // start of the frame.
+    Camera Build(float a_fAspect, int a_iFrame = 0) const;
+
+    Vec3 m_oLookFrom;
+    Vec3 m_oLookAt;
+    Vec3 m_oUp;
+
+    // Vertical field of view in degrees.
+    float m_fFov;
+
+    // Zero gives a pinhole.
+    float m_fAperture;
+
+    float m_fFocusDist;
+
+    // How long the shutter stays open, in frames; zero renders every frame without motion blur.
+    float m_fShutter;
+
+    // Turntable rotation of the look-from point around m_oUp through m_oLookAt, in degrees
+    // per frame. The camera holds still while the shutter is open.
+    float m_fOrbit;
+};
+
+// A renderable scene: spheres in SoA form, their materials, the camera and the BVH over
+// them. Scenes come from a JSON description, from a binary cache, or from a HittableList
+// built in code.
+//
+// The JSON format is one object with "camera", "materials" and "spheres" members:
+//
+//   {
+//     "camera": { "look_from": [13, 2, 3], "look_at": [0, 0, 0], "up": [0, 1, 0],
+//                 "fov": 20, "aperture": 0.1, "focus_distance": 10 },
+//     "materials": [ { "name": "ground", "type": "lambertian", "albedo": [0.5, 0.5, 0.5] },
+//                    { "type": "metal", "albedo": [0.7, 0.6, 0.5], "fuzz": 0.1 },
+//                    { "type": "dielectric", "ior": 1.5 },
+//                    { "name": "lamp", "type": "emissive", "emission": [4, 4, 4] } ],
+//     "spheres": [ { "center": [0, -1000, 0], "radius": 1000, "material": "ground" },
+//                  { "center": [4, 1, 0], "radius": 1, "material": 1 } ]
+//   }
+//
+// Spheres reference materials by name or by index. Every camera field is optional.
+//
+// Spheres and meshes with an emissive material are area lights, which the integrators
+// sample directly. An optional top-level "background": [r, g, b] replaces the sky
+// gradient with a constant, e.g. black for a scene lit by its lights alone.
+//
+// Scenes animate over frames. A sphere with "velocity": [x, y, z] moves that far per
+// frame, so in frame f it sits at center + f * velocity, and while the camera's "shutter"
+// (in frames) is open it keeps moving, which blurs it. The camera's "orbit" turns it
+// around the look-at point by that many degrees per frame:
+//
+//     "camera": { ..., "shutter": 0.5, "orbit": 1.5 },
+//     "spheres": [ { "center": [0, 1, 0], "radius": 1, "material": 0, "velocity": [0, 0, 0.2] } ]
+//
+// Repeated geometry goes into "objects", each with its own "spheres" array, and is placed
+// by "instances" that reference an object by name or index:
+//
+//     "objects": [ { "name": "cluster", "spheres": [ ... ] } ],
+//     "instances": [ { "object": "cluster", "scale": 2, "rotate": [0, 1, 0, 45], "translate": [10, 0, 0] },
+//                    { "object": 0, "matrix": [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0] } ]
+//
+// "rotate" is an axis and an angle in degrees; scale, then rotation, then translation
+// apply. "matrix" gives the 3x4 object-to-world transform row by row instead. Each object
+// gets one bottom-level BVH shared by all of its instances, and a top-level BVH over the
+// instances and the loose spheres ties them together.
+//
+// An object may be a triangle mesh with one material instead, read from an OBJ or PLY
+// file relative to the scene file, or given inline as flat vertex and index triples.
+// "quantize" stores its vertices in 16 bits:
+//
+//     "objects": [ { "name": "bunny", "mesh": "bunny.ply", "material": "ground", "quantize": true },
+//                  { "name": "quad", "material": 0, "vertices": [0, 0, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1],
+//                    "triangles": [0, 2, 1, 0, 3, 2] } ]
+//
+// The binary cache (.rtscene) is memory-mapped and its sphere arrays are used in place,
+// padded and aligned exactly like SphereSoA's own, so loading costs a header check no
+// matter how many spheres there are. It may also carry the BVH, in which case the
+// spheres are stored in leaf order and nothing is built at all. The cache only holds
+// scenes without instances or moving spheres.
+class Scene
+{
+public:
+    Scene();
+
+    // Copies the spheres of a_oList and the whole material table; other primitives are
+    // skipped. Returns the number of spheres taken.
+    int SetSpheres(const HittableList& a_oList, const MaterialTable& a_oMaterials);
+
+    // Picks the format from the extension: .json for text, anything else for the cache.
+    bool Load(const std::string& a_sPath, std::string& a_sError);
+
+    bool LoadJson(const std::string& a_sPath, std::string& a_sError);
+
+    bool LoadCache(const std::string& a_sPath, std::string& a_sError);
+
+    bool Save(const std::string& a_sPath);
+
+    bool SaveJson(const std::string& a_sPath) const;
+
+    // With a_bWithBvh the hierarchy is built first if needed and stored too. Fails for
+    // scenes with instances or moving spheres.
+    bool SaveCache(const std::string& a_sPath, bool a_bWithBvh = true);
+
+    // Builds the BVH over the loose spheres unless one was loaded from the cache.
+    const Bvh& PrepareBvh(int a_iMaxLeafSize = 0);
+
+    // Null before PrepareBvh() unless the cache held a BVH.
+    const Bvh* GetBvh() const;
+
+    // Adds shared geometry for instances and returns its index.
+    int AddObject(const std::string& a_sName, const SphereSoA& a_oSpheres);
+
+    int AddObject(const std::string& a_sName, const TriangleMesh& a_oMesh);
+
+    void AddInstance(int a_iObject, const Transform& a_oObjectToWorld);
+
+    // Takes effect with the next RebuildTopLevel() or PrepareWorld().
+    void SetInstanceTransform(int a_iInstance, const Transform& a_oObjectToWorld);
+
+    // What to render: the loose-sphere BVH alone, or the top-level BVH once instances exist.
+    // Builds whatever is missing; later calls only return it.
+    const Bvh& PrepareWorld();
+
+    // Rebuilds the top level over the current instance transforms and keeps every
+    // bottom-level BVH as is. Requires PrepareWorld() to have run.
+    const Bvh& RebuildTopLevel();
+
+    // Moves the world to frame a_iFrame: every BVH over moving spheres, and the top level
+    // above them, is refitted in place for the frame's shutter interval, and only rebuilt
+    // once Bvh::RefitOrRebuild() finds the refit too costly to trace. Builds the world
+    // first if needed, bounded over this frame's shutter rather than time zero.
+    const Bvh& SetFrame(int a_iFrame);
+
+    int GetFrame() const;
+
+    // True when any sphere, loose or in an object, has a velocity.
+    bool HasMotion() const;
+
+    // Time spent refitting, and rebuilding, for the last SetFrame().
+    double GetRefitTimeMs() const;
+
+    // BVHs the last SetFrame() rebuilt instead of refitting.
+    int GetRebuildCount() const;
+
+    int GetObjectCount() const;
+
+    int GetInstanceCount() const;
+
+    // Spheres a ray can meet, counting every instance, and spheres actually stored.
+    int64_t GetVisibleSphereCount() const;
+    int64_t GetStoredSphereCount() const;
+
+    // The same for triangles, which only mesh objects hold.
+    int64_t GetVisibleTriangleCount() const;
+    int64_t GetStoredTriangleCount() const;
+
+    // Vertex and index memory of every mesh object.
+    size_t GetMeshMemoryBytes() const;
+
+    // Time spent in the last RebuildTopLevel(), including the one PrepareWorld() runs.
+    double GetTopLevelBuildTimeMs() const;
+
+    const SphereSoA& GetSpheres() const;
+
+    const MaterialTable& GetMaterials() const;
+
+    // Every emitter of the world and the background. Built by PrepareWorld() and
+    // RebuildTopLevel(); moving emissive spheres are placed by ray time, so frames keep it.
+    const LightList& GetLights() const;
+
+    SceneCamera& GetCamera();
+
+    const SceneCamera& GetCamera() const;
+
+    // Time spent in the last Load*().
+    double GetLoadTimeMs() const;
+
+    static bool IsJsonPath(const std::string& a_sPath);
+
+private:
+    Scene(const Scene&);
+    Scene& operator=(const Scene&);
+
+    void Reset();
+
+    void RefitWorld();
+
+    // Ray times of the current frame.
+    void GetShutterInterval(float& a_fBegin, float& a_fEnd) const;
+
+    void BuildLights();
+
+    // Backs m_oSpheres and the BVH nodes after LoadCache(), so it is declared first and
+    // unmapped last.
+    MappedFile m_oCache;
+
+    // In leaf order when the BVH came from the cache, in file order otherwise.
+    SphereSoA m_oSpheres;
+
+    MaterialTable m_oMaterials;
+
+    SceneCamera m_oCamera;
+
+    std::unique_ptr<Bvh> m_pBvh;
+
+    struct SceneObject
+    {
+        std::string m_sName;
+
+        SphereSoA m_oSpheres;
+
+        // Set for mesh objects, which hold no spheres. Their BVH reorders the triangles in place.
+        std::unique_ptr<TriangleMesh> m_pMesh;
+
+        // As the scene file names it; empty for meshes given inline or built in code.
+        std::string m_sMeshPath;
+
+        // Bottom-level BVH, built by PrepareWorld().
+        std::unique_ptr<Bvh> m_pBvh;
+    };
+
+    struct SceneInstance
+    {
+        int m_iObject;
+
+        Transform m_oObjectToWorld;
+    };
+
+    std::vector<std::unique_ptr<SceneObject> > m_oObjects;
+
+    std::vector<SceneInstance> m_oInstanceDescs;
+
+    // Built by PrepareWorld(); the top level points into this, so it is only rebuilt as a whole.
+    std::vector<Instance> m_oInstances;
+
+    std::unique_ptr<Bvh> m_pTopLevel;
+
+    // The background is set by the loaders, the emitters by BuildLights().
+    LightList m_oLights;
+
+    bool m_bLightsBuilt;
+
+    int m_iFrame;
+
+    double m_dLoadTimeMs;
+
+    double m_dTopLevelBuildTimeMs;
+
+    double m_dRefitTimeMs;
+
+    int m_iRebuildCount;
+};
+
+#endif // SCENE_H
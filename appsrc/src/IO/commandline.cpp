@@ -0,0 +1,102 @@
+#include "appsrc/include/IO/commandline.h"
+#include <errno.h>
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <iomanip>
+
+const CommandOption* CommandLine::Find(const std::string &a_sName) const
+{
+    for (int o = 0; o < this->m_iCount; ++o)
+    {
+        if (a_sName == this->m_pOptions[o].m_pName)
+        {
+            return &this->m_pOptions[o];
+        }
+    }
+
+    return nullptr;
+}
+
+void CommandLine::PrintUsage(std::ostream &a_oOut, const char *a_pProgram) const
+{
+    a_oOut << "Usage: " << a_pProgram << " [options]\n";
+
+    size_t _width = 0;
+
+    // The help column starts after the longest option and its value.
+    for (int o = 0; o < this->m_iCount; ++o)
+    {
+        const CommandOption& _option = this->m_pOptions[o];
+
+        size_t _length = std::string(_option.m_pName).size() + (_option.m_pValue ? std::string(_option.m_pValue).size() + 1 : 0);
+
+        _width = _length > _width ? _length : _width;
+    }
+
+    for (int o = 0; o < this->m_iCount; ++o)
+    {
+        const CommandOption& _option = this->m_pOptions[o];
+
+        std::string _name = _option.m_pName;
+
+        if (_option.m_pValue)
+        {
+            _name += std::string(" ") + _option.m_pValue;
+        }
+
+        a_oOut << "  " << std::left << std::setw(int(_width + 2)) << _name << _option.m_pHelp << "\n";
+    }
+}
+
+bool CommandLine::ParseInt(const char *a_pText, int a_iMin, int &a_iValue)
+{
+    char* _end = nullptr;
+
+    errno = 0;
+
+    long _value = strtol(a_pText, &_end, 10);
+
+    if (_end == a_pText || *_end != '\0' || errno == ERANGE || _value < a_iMin || _value > INT_MAX)
+    {
+        return false;
+    }
+
+    a_iValue = int(_value);
+
+    return true;
+}
+
+bool CommandLine::ParseFloat(const char *a_pText, float a_fMin, float &a_fValue)
+{
+    double _value;
+
+    if (!ParseDouble(a_pText, a_fMin, _value) || fabs(_value) > FLT_MAX)
+    {
+        return false;
+    }
+
+    a_fValue = float(_value);
+
+    return true;
+}
+
+bool CommandLine::ParseDouble(const char *a_pText, double a_dMin, double &a_dValue)
+{
+    char* _end = nullptr;
+
+    errno = 0;
+
+    double _value = strtod(a_pText, &_end);
+
+    // NaN compares false against the minimum, so it is refused with the rest.
+    if (_end == a_pText || *_end != '\0' || errno == ERANGE || !(_value >= a_dMin) || isinf(_value))
+    {
+        return false;
+    }
+
+    a_dValue = _value;
+
+    return true;
+}
@@ -0,0 +1,143 @@
+#include "appsrc/include/IO/imagereader.h"
+#include "appsrc/include/IO/mappedfile.h"
+#include "appsrc/include/Math/trace.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+    bool IsSpace(char a_cValue)
+    {
+        return a_cValue == ' ' || a_cValue == '\t' || a_cValue == '\r' || a_cValue == '\n';
+    }
+
+    // The next whitespace-separated header field.
+    bool ReadField(const char*& a_pPosition, const char* a_pEnd, std::string& a_sField)
+    {
+        while (a_pPosition < a_pEnd && IsSpace(*a_pPosition))
+        {
+            ++a_pPosition;
+        }
+
+        const char* _start = a_pPosition;
+
+        while (a_pPosition < a_pEnd && !IsSpace(*a_pPosition))
+        {
+            ++a_pPosition;
+        }
+
+        a_sField.assign(_start, a_pPosition);
+
+        return !a_sField.empty();
+    }
+
+    float ReadFloat(const unsigned char* a_pBytes, bool a_bLittleEndian)
+    {
+        uint32_t _bits = a_bLittleEndian ? uint32_t(a_pBytes[0]) | uint32_t(a_pBytes[1]) << 8 | uint32_t(a_pBytes[2]) << 16 | uint32_t(a_pBytes[3]) << 24
+                                         : uint32_t(a_pBytes[3]) | uint32_t(a_pBytes[2]) << 8 | uint32_t(a_pBytes[1]) << 16 | uint32_t(a_pBytes[0]) << 24;
+
+        float _value;
+
+        memcpy(&_value, &_bits, sizeof(_value));
+
+        return _value;
+    }
+}
+
+bool ImageReader::ReadPfm(const std::string &a_sPath, FrameBuffer &a_oImage, std::string &a_sError)
+{
+    RT_TRACE_SPAN("image read");
+
+    MappedFile _file;
+
+    if (!_file.Open(a_sPath))
+    {
+        a_sError = "cannot read " + a_sPath;
+        return false;
+    }
+
+    if (!DecodePfm(_file.GetData(), _file.GetSize(), a_oImage, a_sError))
+    {
+        a_sError = a_sPath + ": " + a_sError;
+        return false;
+    }
+
+    return true;
+}
+
+bool ImageReader::DecodePfm(const char *a_pData, size_t a_uSize, FrameBuffer &a_oImage, std::string &a_sError)
+{
+    const char* _position = a_pData;
+    const char* _end = a_pData + a_uSize;
+
+    std::string _magic;
+    std::string _width;
+    std::string _height;
+    std::string _scale;
+
+    if (!ReadField(_position, _end, _magic) || (_magic != "PF" && _magic != "Pf"))
+    {
+        a_sError = "not a PFM image";
+        return false;
+    }
+
+    if (!ReadField(_position, _end, _width) || !ReadField(_position, _end, _height) || !ReadField(_position, _end, _scale))
+    {
+        a_sError = "truncated PFM header";
+        return false;
+    }
+
+    long _columns = strtol(_width.c_str(), nullptr, 10);
+    long _rows = strtol(_height.c_str(), nullptr, 10);
+
+    // Rejects sizes whose float count would overflow an int index of the framebuffer.
+    if (_columns <= 0 || _rows <= 0 || _columns > 65536 || _rows > 65536 || _columns * _rows > (1L << 28))
+    {
+        a_sError = "bad PFM size " + _width + "x" + _height;
+        return false;
+    }
+
+    // A single whitespace character ends the header.
+    ++_position;
+
+    int _channels = _magic == "PF" ? 3 : 1;
+
+    size_t _bytes = static_cast<size_t>(_columns) * _rows * _channels * sizeof(float);
+
+    if (_position > _end || static_cast<size_t>(_end - _position) < _bytes)
+    {
+        a_sError = "truncated PFM data";
+        return false;
+    }
+
+    // The sign of the scale gives the byte order; its magnitude is not an exposure here.
+    bool _littleEndian = strtod(_scale.c_str(), nullptr) < 0.0;
+
+    int _w = int(_columns);
+    int _h = int(_rows);
+
+    a_oImage = FrameBuffer(_w, _h);
+
+    const unsigned char* _in = reinterpret_cast<const unsigned char*>(_position);
+
+    for (int j = 0; j < _h; ++j)
+    {
+        for (int i = 0; i < _w; ++i)
+        {
+            Vec3 _color;
+
+            for (int c = 0; c < 3; ++c)
+            {
+                _color[c] = ReadFloat(_in + (_channels == 3 ? 4 * c : 0), _littleEndian);
+            }
+
+            _in += 4 * _channels;
+
+            a_oImage.SetPixel(i, j, _color);
+            a_oImage.SetSampleCount(i, j, 1);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,508 @@
+#include "appsrc/include/IO/imagewriter.h"
+#include "appsrc/include/Math/trace.h"
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+    const int s_ciHashBits = 15;
+    const int s_ciWindowSize = 32768;
+    const int s_ciMinMatch = 3;
+    const int s_ciMaxMatch = 258;
+
+    const uint16_t s_cuLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t s_cuLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t s_cuDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t s_cuDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<unsigned char>& a_oOut) : m_oOut(a_oOut),
+                                                                 m_uBuffer(0),
+                                                                 m_iBits(0)
+        {
+        }
+
+        // Deflate packs values least significant bit first.
+        void Write(uint32_t a_uValue, int a_iCount)
+        {
+            this->m_uBuffer |= static_cast<uint64_t>(a_uValue) << this->m_iBits;
+            this->m_iBits += a_iCount;
+
+            while (this->m_iBits >= 8)
+            {
+                this->m_oOut.push_back(static_cast<unsigned char>(this->m_uBuffer & 0xff));
+                this->m_uBuffer >>= 8;
+                this->m_iBits -= 8;
+            }
+        }
+
+        // Huffman codes are defined most significant bit first.
+        void WriteCode(uint32_t a_uCode, int a_iLength)
+        {
+            uint32_t _reversed = 0;
+
+            for (int i = 0; i < a_iLength; ++i)
+            {
+                _reversed = (_reversed << 1) | ((a_uCode >> i) & 1u);
+            }
+
+            this->Write(_reversed, a_iLength);
+        }
+
+        void Flush()
+        {
+            if (this->m_iBits > 0)
+            {
+                this->Write(0, 8 - this->m_iBits);
+            }
+        }
+
+    private:
+        std::vector<unsigned char>& m_oOut;
+
+        uint64_t m_uBuffer;
+        int m_iBits;
+    };
+
+    void WriteLiteral(BitWriter& a_oBits, int a_iSymbol)
+    {
+        // Fixed Huffman table from RFC 1951, 3.2.6.
+        if (a_iSymbol < 144)
+        {
+            a_oBits.WriteCode(0x30 + a_iSymbol, 8);
+        }
+        else if (a_iSymbol < 256)
+        {
+            a_oBits.WriteCode(0x190 + a_iSymbol - 144, 9);
+        }
+        else if (a_iSymbol < 280)
+        {
+            a_oBits.WriteCode(a_iSymbol - 256, 7);
+        }
+        else
+        {
+            a_oBits.WriteCode(0xc0 + a_iSymbol - 280, 8);
+        }
+    }
+
+    void WriteMatch(BitWriter& a_oBits, int a_iLength, int a_iDistance)
+    {
+        int _code = 28;
+
+        while (s_cuLengthBase[_code] > a_iLength)
+        {
+            --_code;
+        }
+
+        WriteLiteral(a_oBits, 257 + _code);
+        a_oBits.Write(a_iLength - s_cuLengthBase[_code], s_cuLengthExtra[_code]);
+
+        _code = 29;
+
+        while (s_cuDistBase[_code] > a_iDistance)
+        {
+            --_code;
+        }
+
+        a_oBits.WriteCode(_code, 5);
+        a_oBits.Write(a_iDistance - s_cuDistBase[_code], s_cuDistExtra[_code]);
+    }
+
+    // Single fixed-Huffman deflate block with greedy LZ77 over a one-entry hash table.
+    void Deflate(const unsigned char* a_pData, size_t a_uSize, std::vector<unsigned char>& a_oOut)
+    {
+        BitWriter _bits(a_oOut);
+
+        _bits.Write(1, 1);
+        _bits.Write(1, 2);
+
+        std::vector<int64_t> _head(static_cast<size_t>(1) << s_ciHashBits, -1);
+
+        size_t i = 0;
+
+        while (i < a_uSize)
+        {
+            int _bestLength = 0;
+            int _bestDistance = 0;
+
+            if (i + s_ciMinMatch <= a_uSize)
+            {
+                uint32_t _hash = ((a_pData[i] << 16) | (a_pData[i + 1] << 8) | a_pData[i + 2]) * 2654435761u >> (32 - s_ciHashBits);
+
+                int64_t _candidate = _head[_hash];
+
+                _head[_hash] = static_cast<int64_t>(i);
+
+                if (_candidate >= 0 && static_cast<int64_t>(i) - _candidate <= s_ciWindowSize)
+                {
+                    size_t _limit = std::min<size_t>(s_ciMaxMatch, a_uSize - i);
+                    size_t _length = 0;
+
+                    while (_length < _limit && a_pData[_candidate + _length] == a_pData[i + _length])
+                    {
+                        ++_length;
+                    }
+
+                    if (_length >= static_cast<size_t>(s_ciMinMatch))
+                    {
+                        _bestLength = static_cast<int>(_length);
+                        _bestDistance = static_cast<int>(i - _candidate);
+                    }
+                }
+            }
+
+            if (_bestLength > 0)
+            {
+                WriteMatch(_bits, _bestLength, _bestDistance);
+                i += _bestLength;
+            }
+            else
+            {
+                WriteLiteral(_bits, a_pData[i]);
+                ++i;
+            }
+        }
+
+        WriteLiteral(_bits, 256);
+
+        _bits.Flush();
+    }
+
+    uint32_t Crc32(const unsigned char* a_pData, size_t a_uSize, uint32_t a_uCrc = 0)
+    {
+        static uint32_t s_uTable[256];
+        static bool s_bInitialised = false;
+
+        if (!s_bInitialised)
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1u) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+
+                s_uTable[n] = c;
+            }
+
+            s_bInitialised = true;
+        }
+
+        a_uCrc = ~a_uCrc;
+
+        for (size_t i = 0; i < a_uSize; ++i)
+        {
+            a_uCrc = s_uTable[(a_uCrc ^ a_pData[i]) & 0xff] ^ (a_uCrc >> 8);
+        }
+
+        return ~a_uCrc;
+    }
+
+    uint32_t Adler32(const unsigned char* a_pData, size_t a_uSize)
+    {
+        uint32_t a = 1;
+        uint32_t b = 0;
+
+        for (size_t i = 0; i < a_uSize; ++i)
+        {
+            a = (a + a_pData[i]) % 65521u;
+            b = (b + a) % 65521u;
+        }
+
+        return (b << 16) | a;
+    }
+
+    void PushBigEndian(std::vector<unsigned char>& a_oOut, uint32_t a_uValue)
+    {
+        a_oOut.push_back(static_cast<unsigned char>(a_uValue >> 24));
+        a_oOut.push_back(static_cast<unsigned char>(a_uValue >> 16));
+        a_oOut.push_back(static_cast<unsigned char>(a_uValue >> 8));
+        a_oOut.push_back(static_cast<unsigned char>(a_uValue));
+    }
+
+    void WriteChunk(std::vector<unsigned char>& a_oOut, const char* a_sType, const std::vector<unsigned char>& a_oData)
+    {
+        PushBigEndian(a_oOut, static_cast<uint32_t>(a_oData.size()));
+
+        size_t _typeStart = a_oOut.size();
+
+        a_oOut.insert(a_oOut.end(), a_sType, a_sType + 4);
+        a_oOut.insert(a_oOut.end(), a_oData.begin(), a_oData.end());
+
+        PushBigEndian(a_oOut, Crc32(&a_oOut[_typeStart], a_oOut.size() - _typeStart));
+    }
+
+    int Paeth(int a_iA, int a_iB, int a_iC)
+    {
+        int _p = a_iA + a_iB - a_iC;
+        int _pa = abs(_p - a_iA);
+        int _pb = abs(_p - a_iB);
+        int _pc = abs(_p - a_iC);
+
+        if (_pa <= _pb && _pa <= _pc)
+        {
+            return a_iA;
+        }
+
+        return _pb <= _pc ? a_iB : a_iC;
+    }
+
+    void AppendText(std::vector<unsigned char>& a_oOut, const char* a_sText)
+    {
+        a_oOut.insert(a_oOut.end(), a_sText, a_sText + strlen(a_sText));
+    }
+}
+
+ImageFormat ImageWriter::FormatFromPath(const std::string &a_sPath)
+{
+    size_t _dot = a_sPath.find_last_of('.');
+
+    if (_dot != std::string::npos)
+    {
+        std::string _ext = a_sPath.substr(_dot + 1);
+
+        std::transform(_ext.begin(), _ext.end(), _ext.begin(), ::tolower);
+
+        ImageFormat _format;
+
+        if (ParseFormat(_ext, _format))
+        {
+            return _format;
+        }
+    }
+
+    return IMAGE_FORMAT_PPM;
+}
+
+bool ImageWriter::ParseFormat(const std::string &a_sName, ImageFormat &a_eFormat)
+{
+    if (a_sName == "ppm")
+    {
+        a_eFormat = IMAGE_FORMAT_PPM;
+    }
+    else if (a_sName == "ppm-ascii")
+    {
+        a_eFormat = IMAGE_FORMAT_PPM_ASCII;
+    }
+    else if (a_sName == "png")
+    {
+        a_eFormat = IMAGE_FORMAT_PNG;
+    }
+    else if (a_sName == "pfm")
+    {
+        a_eFormat = IMAGE_FORMAT_PFM;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool ImageWriter::Write(const FrameBuffer &a_oFrameBuffer, const std::string &a_sPath, ImageFormat a_eFormat, const ToneMapSettings &a_oToneMap)
+{
+    RT_TRACE_SPAN("image write");
+
+    std::vector<unsigned char> _encoded;
+
+    if (a_eFormat == IMAGE_FORMAT_PFM)
+    {
+        EncodePfm(a_oFrameBuffer, _encoded);
+
+        return WriteFile(a_sPath, _encoded);
+    }
+
+    std::vector<unsigned char> _rgb;
+
+    ToneMapper::ToRgb8(a_oFrameBuffer, a_oToneMap, _rgb);
+
+    return WriteRgb8(_rgb.empty() ? nullptr : &_rgb[0], a_oFrameBuffer.GetWidth(), a_oFrameBuffer.GetHeight(), a_sPath, a_eFormat);
+}
+
+bool ImageWriter::WriteRgb8(const unsigned char *a_pRgb, int a_iWidth, int a_iHeight, const std::string &a_sPath, ImageFormat a_eFormat)
+{
+    std::vector<unsigned char> _encoded;
+
+    switch (a_eFormat)
+    {
+    case IMAGE_FORMAT_PPM:
+        EncodePpm(a_pRgb, a_iWidth, a_iHeight, false, _encoded);
+        break;
+    case IMAGE_FORMAT_PPM_ASCII:
+        EncodePpm(a_pRgb, a_iWidth, a_iHeight, true, _encoded);
+        break;
+    case IMAGE_FORMAT_PNG:
+        EncodePng(a_pRgb, a_iWidth, a_iHeight, _encoded);
+        break;
+    default:
+        return false;
+    }
+
+    return WriteFile(a_sPath, _encoded);
+}
+
+void ImageWriter::EncodePpm(const unsigned char *a_pRgb, int a_iWidth, int a_iHeight, bool a_bAscii, std::vector<unsigned char> &a_oOut)
+{
+    char _header[64];
+
+    snprintf(_header, sizeof(_header), "%s\n%d %d\n255\n", a_bAscii ? "P3" : "P6", a_iWidth, a_iHeight);
+
+    size_t _bytes = static_cast<size_t>(a_iWidth) * a_iHeight * 3;
+
+    a_oOut.clear();
+    a_oOut.reserve(strlen(_header) + (a_bAscii ? _bytes * 4 : _bytes));
+
+    AppendText(a_oOut, _header);
+
+    if (!a_bAscii)
+    {
+        a_oOut.insert(a_oOut.end(), a_pRgb, a_pRgb + _bytes);
+        return;
+    }
+
+    char _pixel[16];
+
+    for (size_t i = 0; i < _bytes; i += 3)
+    {
+        snprintf(_pixel, sizeof(_pixel), "%d %d %d\n", a_pRgb[i], a_pRgb[i + 1], a_pRgb[i + 2]);
+
+        AppendText(a_oOut, _pixel);
+    }
+}
+
+void ImageWriter::EncodePng(const unsigned char *a_pRgb, int a_iWidth, int a_iHeight, std::vector<unsigned char> &a_oOut)
+{
+    size_t _stride = static_cast<size_t>(a_iWidth) * 3;
+
+    // Each row is prefixed by the filter that gives the smallest sum of absolute residuals.
+    std::vector<unsigned char> _filtered((_stride + 1) * a_iHeight);
+    std::vector<unsigned char> _candidate(_stride);
+    std::vector<unsigned char> _zeroRow(_stride, 0);
+
+    for (int y = 0; y < a_iHeight; ++y)
+    {
+        const unsigned char* _row = a_pRgb + y * _stride;
+        const unsigned char* _prev = y > 0 ? a_pRgb + (y - 1) * _stride : &_zeroRow[0];
+
+        unsigned char* _out = &_filtered[y * (_stride + 1)];
+
+        long _bestScore = -1;
+
+        for (int f = 0; f < 5; ++f)
+        {
+            long _score = 0;
+
+            for (size_t x = 0; x < _stride; ++x)
+            {
+                int _a = x >= 3 ? _row[x - 3] : 0;
+                int _b = _prev[x];
+                int _c = x >= 3 ? _prev[x - 3] : 0;
+
+                int _predictor = 0;
+
+                switch (f)
+                {
+                case 1: _predictor = _a; break;
+                case 2: _predictor = _b; break;
+                case 3: _predictor = (_a + _b) / 2; break;
+                case 4: _predictor = Paeth(_a, _b, _c); break;
+                default: break;
+                }
+
+                _candidate[x] = static_cast<unsigned char>(_row[x] - _predictor);
+
+                _score += _candidate[x] < 128 ? _candidate[x] : 256 - _candidate[x];
+            }
+
+            if (_bestScore < 0 || _score < _bestScore)
+            {
+                _bestScore = _score;
+                _out[0] = static_cast<unsigned char>(f);
+                std::copy(_candidate.begin(), _candidate.end(), _out + 1);
+            }
+        }
+    }
+
+    std::vector<unsigned char> _zlib;
+
+    _zlib.push_back(0x78);
+    _zlib.push_back(0x01);
+
+    Deflate(_filtered.empty() ? nullptr : &_filtered[0], _filtered.size(), _zlib);
+
+    PushBigEndian(_zlib, Adler32(_filtered.empty() ? nullptr : &_filtered[0], _filtered.size()));
+
+    std::vector<unsigned char> _ihdr;
+
+    PushBigEndian(_ihdr, static_cast<uint32_t>(a_iWidth));
+    PushBigEndian(_ihdr, static_cast<uint32_t>(a_iHeight));
+
+    _ihdr.push_back(8);  // bit depth
+    _ihdr.push_back(2);  // colour type: RGB
+    _ihdr.push_back(0);  // compression
+    _ihdr.push_back(0);  // filter method
+    _ihdr.push_back(0);  // no interlace
+
+    static const unsigned char s_cuSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    a_oOut.assign(s_cuSignature, s_cuSignature + 8);
+
+    WriteChunk(a_oOut, "IHDR", _ihdr);
+    WriteChunk(a_oOut, "IDAT", _zlib);
+    WriteChunk(a_oOut, "IEND", std::vector<unsigned char>());
+}
+
+void ImageWriter::EncodePfm(const FrameBuffer &a_oFrameBuffer, std::vector<unsigned char> &a_oOut)
+{
+    // A negative scale marks little-endian data; PFM rows run bottom to top like the framebuffer.
+    char _header[64];
+
+    snprintf(_header, sizeof(_header), "PF\n%d %d\n-1.0\n", a_oFrameBuffer.GetWidth(), a_oFrameBuffer.GetHeight());
+
+    size_t _pixels = static_cast<size_t>(a_oFrameBuffer.GetWidth()) * a_oFrameBuffer.GetHeight();
+
+    a_oOut.clear();
+    a_oOut.reserve(strlen(_header) + _pixels * 3 * sizeof(float));
+
+    AppendText(a_oOut, _header);
+
+    const Vec3* _data = a_oFrameBuffer.GetData();
+
+    for (size_t p = 0; p < _pixels; ++p)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            float _value = _data[p][c];
+
+            uint32_t _bits;
+
+            memcpy(&_bits, &_value, sizeof(_bits));
+
+            a_oOut.push_back(static_cast<unsigned char>(_bits));
+            a_oOut.push_back(static_cast<unsigned char>(_bits >> 8));
+            a_oOut.push_back(static_cast<unsigned char>(_bits >> 16));
+            a_oOut.push_back(static_cast<unsigned char>(_bits >> 24));
+        }
+    }
+}
+
+bool ImageWriter::WriteFile(const std::string &a_sPath, const std::vector<unsigned char> &a_oData)
+{
+    FILE* _file = fopen(a_sPath.c_str(), "wb");
+
+    if (_file == nullptr)
+    {
+        return false;
+    }
+
+    bool _ok = a_oData.empty() || fwrite(&a_oData[0], 1, a_oData.size(), _file) == a_oData.size();
+
+    return (fclose(_file) == 0) && _ok;
+}
@@ -0,0 +1,409 @@
+#include "appsrc/include/IO/json.h"
+#include <sstream>
+#include <stdlib.h>
+
+namespace
+{
+    // Deeper documents are rejected rather than risking the stack.
+    const int s_ciMaxDepth = 128;
+
+    const JsonValue s_oNull;
+}
+
+// Recursive-descent parser over the whole document text.
+class JsonParser
+{
+public:
+    JsonParser(const std::string& a_sText) : m_sText(a_sText),
+                                             m_uPosition(0),
+                                             m_iLine(1)
+    {
+    }
+
+    bool ParseDocument(JsonValue& a_oValue)
+    {
+        if (!this->ParseValue(a_oValue, 0))
+        {
+            return false;
+        }
+
+        this->SkipWhitespace();
+
+        return this->m_uPosition == this->m_sText.size() || this->Fail("end of document");
+    }
+
+    std::string m_sError;
+
+private:
+    bool Fail(const char* a_pExpected)
+    {
+        std::ostringstream _message;
+
+        _message << "line " << this->m_iLine << ": expected " << a_pExpected;
+
+        this->m_sError = _message.str();
+
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (this->m_uPosition < this->m_sText.size())
+        {
+            char _c = this->m_sText[this->m_uPosition];
+
+            if (_c == '\n')
+            {
+                ++this->m_iLine;
+            }
+            else if (_c != ' ' && _c != '\t' && _c != '\r')
+            {
+                break;
+            }
+
+            ++this->m_uPosition;
+        }
+    }
+
+    bool Consume(char a_cChar)
+    {
+        this->SkipWhitespace();
+
+        if (this->m_uPosition < this->m_sText.size() && this->m_sText[this->m_uPosition] == a_cChar)
+        {
+            ++this->m_uPosition;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool ConsumeWord(const char* a_pWord)
+    {
+        size_t _length = 0;
+
+        while (a_pWord[_length] != '\0')
+        {
+            ++_length;
+        }
+
+        if (this->m_sText.compare(this->m_uPosition, _length, a_pWord) != 0)
+        {
+            return false;
+        }
+
+        this->m_uPosition += _length;
+
+        return true;
+    }
+
+    bool ParseValue(JsonValue& a_oValue, int a_iDepth)
+    {
+        if (a_iDepth > s_ciMaxDepth)
+        {
+            return this->Fail("less nesting");
+        }
+
+        this->SkipWhitespace();
+
+        if (this->m_uPosition >= this->m_sText.size())
+        {
+            return this->Fail("a value");
+        }
+
+        char _c = this->m_sText[this->m_uPosition];
+
+        if (_c == '{')
+        {
+            return this->ParseObject(a_oValue, a_iDepth);
+        }
+
+        if (_c == '[')
+        {
+            return this->ParseArray(a_oValue, a_iDepth);
+        }
+
+        if (_c == '"')
+        {
+            a_oValue.m_eType = JSON_STRING;
+            return this->ParseString(a_oValue.m_sString);
+        }
+
+        if (this->ConsumeWord("true") || this->ConsumeWord("false"))
+        {
+            a_oValue.m_eType = JSON_BOOL;
+            a_oValue.m_bBool = _c == 't';
+            return true;
+        }
+
+        if (this->ConsumeWord("null"))
+        {
+            a_oValue.m_eType = JSON_NULL;
+            return true;
+        }
+
+        const char* _begin = this->m_sText.c_str() + this->m_uPosition;
+        char* _end = nullptr;
+
+        double _number = strtod(_begin, &_end);
+
+        if (_end == _begin)
+        {
+            return this->Fail("a value");
+        }
+
+        a_oValue.m_eType = JSON_NUMBER;
+        a_oValue.m_dNumber = _number;
+
+        this->m_uPosition += _end - _begin;
+
+        return true;
+    }
+
+    bool ParseObject(JsonValue& a_oValue, int a_iDepth)
+    {
+        a_oValue.m_eType = JSON_OBJECT;
+
+        ++this->m_uPosition;
+
+        if (this->Consume('}'))
+        {
+            return true;
+        }
+
+        do
+        {
+            this->SkipWhitespace();
+
+            std::string _key;
+
+            if (this->m_uPosition >= this->m_sText.size() || this->m_sText[this->m_uPosition] != '"')
+            {
+                return this->Fail("a member name");
+            }
+
+            if (!this->ParseString(_key))
+            {
+                return false;
+            }
+
+            if (!this->Consume(':'))
+            {
+                return this->Fail("':'");
+            }
+
+            a_oValue.m_oKeys.push_back(_key);
+            a_oValue.m_oItems.push_back(JsonValue());
+
+            if (!this->ParseValue(a_oValue.m_oItems.back(), a_iDepth + 1))
+            {
+                return false;
+            }
+        } while (this->Consume(','));
+
+        return this->Consume('}') || this->Fail("',' or '}'");
+    }
+
+    bool ParseArray(JsonValue& a_oValue, int a_iDepth)
+    {
+        a_oValue.m_eType = JSON_ARRAY;
+
+        ++this->m_uPosition;
+
+        if (this->Consume(']'))
+        {
+            return true;
+        }
+
+        do
+        {
+            a_oValue.m_oItems.push_back(JsonValue());
+
+            if (!this->ParseValue(a_oValue.m_oItems.back(), a_iDepth + 1))
+            {
+                return false;
+            }
+        } while (this->Consume(','));
+
+        return this->Consume(']') || this->Fail("',' or ']'");
+    }
+
+    // Escapes are decoded; \u sequences are written out as UTF-8.
+    bool ParseString(std::string& a_sOut)
+    {
+        ++this->m_uPosition;
+
+        while (this->m_uPosition < this->m_sText.size())
+        {
+            char _c = this->m_sText[this->m_uPosition++];
+
+            if (_c == '"')
+            {
+                return true;
+            }
+
+            if (_c == '\n')
+            {
+                return this->Fail("'\"' before the end of the line");
+            }
+
+            if (_c != '\\')
+            {
+                a_sOut += _c;
+                continue;
+            }
+
+            if (this->m_uPosition >= this->m_sText.size())
+            {
+                break;
+            }
+
+            char _escape = this->m_sText[this->m_uPosition++];
+
+            switch (_escape)
+            {
+            case 'n':
+                a_sOut += '\n';
+                break;
+            case 't':
+                a_sOut += '\t';
+                break;
+            case 'r':
+                a_sOut += '\r';
+                break;
+            case 'b':
+                a_sOut += '\b';
+                break;
+            case 'f':
+                a_sOut += '\f';
+                break;
+            case 'u':
+            {
+                if (this->m_uPosition + 4 > this->m_sText.size())
+                {
+                    return this->Fail("four hex digits");
+                }
+
+                char* _end = nullptr;
+                std::string _digits = this->m_sText.substr(this->m_uPosition, 4);
+
+                unsigned long _code = strtoul(_digits.c_str(), &_end, 16);
+
+                if (_end != _digits.c_str() + 4)
+                {
+                    return this->Fail("four hex digits");
+                }
+
+                this->m_uPosition += 4;
+
+                if (_code < 0x80)
+                {
+                    a_sOut += static_cast<char>(_code);
+                }
+                else if (_code < 0x800)
+                {
+                    a_sOut += static_cast<char>(0xc0 | (_code >> 6));
+                    a_sOut += static_cast<char>(0x80 | (_code & 0x3f));
+                }
+                else
+                {
+                    a_sOut += static_cast<char>(0xe0 | (_code >> 12));
+                    a_sOut += static_cast<char>(0x80 | ((_code >> 6) & 0x3f));
+                    a_sOut += static_cast<char>(0x80 | (_code & 0x3f));
+                }
+                break;
+            }
+            default:
+                a_sOut += _escape;
+                break;
+            }
+        }
+
+        return this->Fail("'\"'");
+    }
+
+    const std::string& m_sText;
+
+    size_t m_uPosition;
+
+    int m_iLine;
+};
+
+JsonValue::JsonValue() : m_eType(JSON_NULL),
+                         m_bBool(false),
+                         m_dNumber(0.0)
+{
+}
+
+bool JsonValue::Parse(const std::string &a_sText, JsonValue &a_oValue, std::string &a_sError)
+{
+    JsonParser _parser(a_sText);
+
+    a_oValue = JsonValue();
+
+    if (!_parser.ParseDocument(a_oValue))
+    {
+        a_sError = _parser.m_sError;
+        return false;
+    }
+
+    return true;
+}
+
+JsonType JsonValue::GetType() const
+{
+    return this->m_eType;
+}
+
+bool JsonValue::GetBool() const
+{
+    return this->m_bBool;
+}
+
+double JsonValue::GetNumber() const
+{
+    return this->m_dNumber;
+}
+
+const std::string& JsonValue::GetString() const
+{
+    return this->m_sString;
+}
+
+int JsonValue::GetSize() const
+{
+    return static_cast<int>(this->m_oItems.size());
+}
+
+const JsonValue& JsonValue::GetItem(int a_iIndex) const
+{
+    if (a_iIndex < 0 || a_iIndex >= this->GetSize())
+    {
+        return s_oNull;
+    }
+
+    return this->m_oItems[a_iIndex];
+}
+
+const std::string& JsonValue::GetKey(int a_iIndex) const
+{
+    return this->m_oKeys[a_iIndex];
+}
+
+const JsonValue* JsonValue::Find(const std::string &a_sKey) const
+{
+    if (this->m_eType != JSON_OBJECT)
+    {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i < this->m_oKeys.size(); ++i)
+    {
+        if (this->m_oKeys[i] == a_sKey)
+        {
+            return &this->m_oItems[i];
+        }
+    }
+
+    return nullptr;
+}
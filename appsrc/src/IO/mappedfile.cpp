@@ -0,0 +1,148 @@
+#include "appsrc/include/IO/mappedfile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : m_pData(nullptr),
+                           m_uSize(0)
+#if defined(_WIN32)
+                           , m_pFile(nullptr),
+                           m_pMapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    this->Close();
+}
+
+#if defined(_WIN32)
+bool MappedFile::Open(const std::string &a_sPath)
+{
+    this->Close();
+
+    HANDLE _file = CreateFileA(a_sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER _size;
+
+    if (!GetFileSizeEx(_file, &_size) || _size.QuadPart == 0)
+    {
+        CloseHandle(_file);
+        return false;
+    }
+
+    HANDLE _mapping = CreateFileMappingA(_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+    void* _data = _mapping != nullptr ? MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+
+    if (_data == nullptr)
+    {
+        if (_mapping != nullptr)
+        {
+            CloseHandle(_mapping);
+        }
+
+        CloseHandle(_file);
+        return false;
+    }
+
+    this->m_pFile = _file;
+    this->m_pMapping = _mapping;
+    this->m_pData = static_cast<char*>(_data);
+    this->m_uSize = static_cast<size_t>(_size.QuadPart);
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (this->m_pData != nullptr)
+    {
+        UnmapViewOfFile(this->m_pData);
+        CloseHandle(this->m_pMapping);
+        CloseHandle(this->m_pFile);
+    }
+
+    this->m_pData = nullptr;
+    this->m_uSize = 0;
+    this->m_pFile = nullptr;
+    this->m_pMapping = nullptr;
+}
+#else
+bool MappedFile::Open(const std::string &a_sPath)
+{
+    this->Close();
+
+    int _file = open(a_sPath.c_str(), O_RDONLY);
+
+    if (_file < 0)
+    {
+        return false;
+    }
+
+    struct stat _stat;
+
+    if (fstat(_file, &_stat) != 0 || _stat.st_size <= 0)
+    {
+        close(_file);
+        return false;
+    }
+
+    size_t _size = static_cast<size_t>(_stat.st_size);
+
+    void* _data = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _file, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(_file);
+
+    if (_data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    this->m_pData = static_cast<char*>(_data);
+    this->m_uSize = _size;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (this->m_pData != nullptr)
+    {
+        munmap(this->m_pData, this->m_uSize);
+    }
+
+    this->m_pData = nullptr;
+    this->m_uSize = 0;
+}
+#endif
+
+bool MappedFile::IsOpen() const
+{
+    return this->m_pData != nullptr;
+}
+
+char* MappedFile::GetData() const
+{
+    return this->m_pData;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return this->m_uSize;
+}
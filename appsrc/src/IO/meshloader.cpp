@@ -0,0 +1,824 @@
+#include "appsrc/include/IO/meshloader.h"
+#include "appsrc/include/IO/mappedfile.h"
+#include "appsrc/include/Math/trace.h"
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <sstream>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    // Only the leading digits of a mantissa this long affect a float.
+    const int s_ciMaxMantissaDigits = 19;
+
+    const double s_cdPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    enum PlyFormat
+    {
+        PLY_FORMAT_ASCII = 0,
+        PLY_FORMAT_BINARY_LITTLE_ENDIAN,
+        PLY_FORMAT_BINARY_BIG_ENDIAN,
+        PLY_FORMAT_COUNT
+    };
+
+    const char* const s_cpPlyFormatNames[PLY_FORMAT_COUNT] = { "ascii", "binary_little_endian", "binary_big_endian" };
+
+    enum PlyType
+    {
+        PLY_TYPE_INT8 = 0,
+        PLY_TYPE_UINT8,
+        PLY_TYPE_INT16,
+        PLY_TYPE_UINT16,
+        PLY_TYPE_INT32,
+        PLY_TYPE_UINT32,
+        PLY_TYPE_FLOAT32,
+        PLY_TYPE_FLOAT64,
+        PLY_TYPE_COUNT
+    };
+
+    // The original names and the sized aliases later writers use.
+    const char* const s_cpPlyTypeNames[PLY_TYPE_COUNT] = { "char", "uchar", "short", "ushort", "int", "uint", "float", "double" };
+    const char* const s_cpPlySizedTypeNames[PLY_TYPE_COUNT] = { "int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64" };
+
+    const int s_ciPlyTypeSizes[PLY_TYPE_COUNT] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+    struct PlyProperty
+    {
+        std::string m_sName;
+
+        PlyType m_eType;
+
+        // Lists hold a count of m_eCountType followed by that many m_eType values.
+        bool m_bList;
+        PlyType m_eCountType;
+    };
+
+    struct PlyElement
+    {
+        std::string m_sName;
+
+        int m_iCount;
+
+        std::vector<PlyProperty> m_oProperties;
+    };
+
+    // Read position over the mapped file; nothing at or past m_pEnd is ever touched.
+    struct TextCursor
+    {
+        const char* m_pPosition;
+        const char* m_pEnd;
+
+        int m_iLine;
+    };
+
+    std::string LowerExtension(const std::string& a_sPath)
+    {
+        size_t _dot = a_sPath.find_last_of('.');
+
+        if (_dot == std::string::npos)
+        {
+            return std::string();
+        }
+
+        std::string _extension = a_sPath.substr(_dot + 1);
+
+        for (size_t i = 0; i < _extension.size(); ++i)
+        {
+            _extension[i] = static_cast<char>(tolower(static_cast<unsigned char>(_extension[i])));
+        }
+
+        return _extension;
+    }
+
+    std::string AtLine(const std::string& a_sPath, int a_iLine, const std::string& a_sMessage)
+    {
+        std::ostringstream _out;
+
+        _out << a_sPath << ": line " << a_iLine << ": " << a_sMessage;
+
+        return _out.str();
+    }
+
+    inline bool IsBlank(char a_cChar)
+    {
+        return a_cChar == ' ' || a_cChar == '\t' || a_cChar == '\r';
+    }
+
+    inline bool IsDigit(char a_cChar)
+    {
+        return a_cChar >= '0' && a_cChar <= '9';
+    }
+
+    inline void SkipBlanks(TextCursor& a_oCursor)
+    {
+        while (a_oCursor.m_pPosition < a_oCursor.m_pEnd && IsBlank(*a_oCursor.m_pPosition))
+        {
+            ++a_oCursor.m_pPosition;
+        }
+    }
+
+    // Blanks and line breaks alike, for the free-form body of an ASCII PLY.
+    inline void SkipWhitespace(TextCursor& a_oCursor)
+    {
+        while (a_oCursor.m_pPosition < a_oCursor.m_pEnd && (IsBlank(*a_oCursor.m_pPosition) || *a_oCursor.m_pPosition == '\n'))
+        {
+            a_oCursor.m_iLine += *a_oCursor.m_pPosition == '\n';
+
+            ++a_oCursor.m_pPosition;
+        }
+    }
+
+    // Moves past the next line break.
+    inline void SkipLine(TextCursor& a_oCursor)
+    {
+        const void* _newline = memchr(a_oCursor.m_pPosition, '\n', a_oCursor.m_pEnd - a_oCursor.m_pPosition);
+
+        a_oCursor.m_pPosition = _newline != nullptr ? static_cast<const char*>(_newline) + 1 : a_oCursor.m_pEnd;
+
+        ++a_oCursor.m_iLine;
+    }
+
+    inline bool AtLineEnd(const TextCursor& a_oCursor)
+    {
+        return a_oCursor.m_pPosition >= a_oCursor.m_pEnd || *a_oCursor.m_pPosition == '\n' || *a_oCursor.m_pPosition == '#';
+    }
+
+    // A directive is a word of its own at the start of a line, e.g. the "v" of "v 1 2 3".
+    inline bool IsDirective(const TextCursor& a_oCursor, char a_cChar)
+    {
+        return a_oCursor.m_pEnd - a_oCursor.m_pPosition >= 2 && a_oCursor.m_pPosition[0] == a_cChar && IsBlank(a_oCursor.m_pPosition[1]);
+    }
+
+    // Decimal number with an optional sign, fraction and exponent. strtod would need the
+    // mapped text to be NUL-terminated; this stops at a_pEnd instead.
+    bool ParseNumber(TextCursor& a_oCursor, double& a_dOut)
+    {
+        const char* _p = a_oCursor.m_pPosition;
+        const char* _end = a_oCursor.m_pEnd;
+
+        bool _negative = false;
+
+        if (_p < _end && (*_p == '-' || *_p == '+'))
+        {
+            _negative = *_p == '-';
+            ++_p;
+        }
+
+        uint64_t _mantissa = 0;
+        int _digits = 0;
+        int _exponent = 0;
+        bool _any = false;
+
+        for (; _p < _end && IsDigit(*_p); ++_p)
+        {
+            if (_digits < s_ciMaxMantissaDigits)
+            {
+                _mantissa = _mantissa * 10 + (*_p - '0');
+                _digits += _mantissa != 0;
+            }
+            else
+            {
+                ++_exponent;
+            }
+
+            _any = true;
+        }
+
+        if (_p < _end && *_p == '.')
+        {
+            for (++_p; _p < _end && IsDigit(*_p); ++_p)
+            {
+                if (_digits < s_ciMaxMantissaDigits)
+                {
+                    _mantissa = _mantissa * 10 + (*_p - '0');
+                    _digits += _mantissa != 0;
+                    --_exponent;
+                }
+
+                _any = true;
+            }
+        }
+
+        if (!_any)
+        {
+            return false;
+        }
+
+        if (_p < _end && (*_p == 'e' || *_p == 'E'))
+        {
+            const char* _e = _p + 1;
+
+            bool _negativeExponent = false;
+
+            if (_e < _end && (*_e == '-' || *_e == '+'))
+            {
+                _negativeExponent = *_e == '-';
+                ++_e;
+            }
+
+            int _value = 0;
+            bool _anyExponent = false;
+
+            for (; _e < _end && IsDigit(*_e); ++_e)
+            {
+                _value = _value < 100000 ? _value * 10 + (*_e - '0') : _value;
+                _anyExponent = true;
+            }
+
+            if (_anyExponent)
+            {
+                _exponent += _negativeExponent ? -_value : _value;
+                _p = _e;
+            }
+        }
+
+        double _number = double(_mantissa);
+
+        int _magnitude = _exponent < 0 ? -_exponent : _exponent;
+
+        double _scale = _magnitude <= 22 ? s_cdPowersOfTen[_magnitude] : pow(10.0, _magnitude);
+
+        _number = _exponent < 0 ? _number / _scale : _number * _scale;
+
+        a_dOut = _negative ? -_number : _number;
+
+        a_oCursor.m_pPosition = _p;
+
+        return true;
+    }
+
+    // Reads one blank-separated word of a PLY header line.
+    std::string ReadWord(TextCursor& a_oCursor)
+    {
+        SkipBlanks(a_oCursor);
+
+        const char* _begin = a_oCursor.m_pPosition;
+
+        while (a_oCursor.m_pPosition < a_oCursor.m_pEnd && !IsBlank(*a_oCursor.m_pPosition) && *a_oCursor.m_pPosition != '\n')
+        {
+            ++a_oCursor.m_pPosition;
+        }
+
+        return std::string(_begin, a_oCursor.m_pPosition);
+    }
+
+    bool ParsePlyType(const std::string& a_sName, PlyType& a_eType)
+    {
+        for (int t = 0; t < PLY_TYPE_COUNT; ++t)
+        {
+            if (a_sName == s_cpPlyTypeNames[t] || a_sName == s_cpPlySizedTypeNames[t])
+            {
+                a_eType = PlyType(t);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool IsLittleEndianHost()
+    {
+        const uint16_t _one = 1;
+
+        return *reinterpret_cast<const unsigned char*>(&_one) == 1;
+    }
+
+    template <typename T>
+    inline double LoadAs(const unsigned char* a_pBytes)
+    {
+        T _value;
+
+        memcpy(&_value, a_pBytes, sizeof(T));
+
+        return double(_value);
+    }
+
+    bool ReadPlyValue(TextCursor& a_oCursor, PlyFormat a_eFormat, bool a_bSwap, PlyType a_eType, double& a_dOut)
+    {
+        if (a_eFormat == PLY_FORMAT_ASCII)
+        {
+            SkipWhitespace(a_oCursor);
+
+            return ParseNumber(a_oCursor, a_dOut);
+        }
+
+        int _size = s_ciPlyTypeSizes[a_eType];
+
+        if (a_oCursor.m_pEnd - a_oCursor.m_pPosition < _size)
+        {
+            return false;
+        }
+
+        unsigned char _bytes[8];
+
+        for (int b = 0; b < _size; ++b)
+        {
+            _bytes[b] = static_cast<unsigned char>(a_oCursor.m_pPosition[a_bSwap ? _size - 1 - b : b]);
+        }
+
+        a_oCursor.m_pPosition += _size;
+
+        switch (a_eType)
+        {
+        case PLY_TYPE_INT8:
+            a_dOut = LoadAs<int8_t>(_bytes);
+            break;
+        case PLY_TYPE_UINT8:
+            a_dOut = LoadAs<uint8_t>(_bytes);
+            break;
+        case PLY_TYPE_INT16:
+            a_dOut = LoadAs<int16_t>(_bytes);
+            break;
+        case PLY_TYPE_UINT16:
+            a_dOut = LoadAs<uint16_t>(_bytes);
+            break;
+        case PLY_TYPE_INT32:
+            a_dOut = LoadAs<int32_t>(_bytes);
+            break;
+        case PLY_TYPE_UINT32:
+            a_dOut = LoadAs<uint32_t>(_bytes);
+            break;
+        case PLY_TYPE_FLOAT32:
+            a_dOut = LoadAs<float>(_bytes);
+            break;
+        default:
+            a_dOut = LoadAs<double>(_bytes);
+            break;
+        }
+
+        return true;
+    }
+
+    // Adds the fan (a_uFirst, a_uPrevious, a_uCurrent) once a polygon has three corners.
+    inline void AddFanCorner(TriangleMesh& a_oMesh, int a_iCorner, uint32_t a_uVertex, uint32_t& a_uFirst, uint32_t& a_uPrevious)
+    {
+        if (a_iCorner == 0)
+        {
+            a_uFirst = a_uVertex;
+        }
+        else if (a_iCorner >= 2)
+        {
+            a_oMesh.AddTriangle(a_uFirst, a_uPrevious, a_uVertex);
+        }
+
+        a_uPrevious = a_uVertex;
+    }
+}
+
+bool MeshLoader::Load(const std::string &a_sPath, TriangleMesh &a_oMesh, std::string &a_sError)
+{
+    std::string _extension = LowerExtension(a_sPath);
+
+    if (_extension == "obj")
+    {
+        return LoadObj(a_sPath, a_oMesh, a_sError);
+    }
+
+    if (_extension == "ply")
+    {
+        return LoadPly(a_sPath, a_oMesh, a_sError);
+    }
+
+    a_sError = a_sPath + ": unknown mesh format, expected .obj or .ply";
+
+    return false;
+}
+
+bool MeshLoader::IsMeshPath(const std::string &a_sPath)
+{
+    std::string _extension = LowerExtension(a_sPath);
+
+    return _extension == "obj" || _extension == "ply";
+}
+
+bool MeshLoader::LoadObj(const std::string &a_sPath, TriangleMesh &a_oMesh, std::string &a_sError)
+{
+    RT_TRACE_SPAN("mesh load");
+
+    a_oMesh.Clear();
+
+    MappedFile _file;
+
+    if (!_file.Open(a_sPath))
+    {
+        a_sError = "cannot read " + a_sPath;
+        return false;
+    }
+
+    TextCursor _cursor = { _file.GetData(), _file.GetData() + _file.GetSize(), 1 };
+
+    // Counting pass: vertices, and triangles as corners minus two per face.
+    int64_t _vertexCount = 0;
+    int64_t _triangleCount = 0;
+
+    while (_cursor.m_pPosition < _cursor.m_pEnd)
+    {
+        SkipBlanks(_cursor);
+
+        if (IsDirective(_cursor, 'v'))
+        {
+            ++_vertexCount;
+        }
+        else if (IsDirective(_cursor, 'f'))
+        {
+            ++_cursor.m_pPosition;
+
+            int _corners = 0;
+
+            for (;;)
+            {
+                SkipBlanks(_cursor);
+
+                if (AtLineEnd(_cursor))
+                {
+                    break;
+                }
+
+                while (_cursor.m_pPosition < _cursor.m_pEnd && !IsBlank(*_cursor.m_pPosition) && *_cursor.m_pPosition != '\n')
+                {
+                    ++_cursor.m_pPosition;
+                }
+
+                ++_corners;
+            }
+
+            _triangleCount += _corners > 2 ? _corners - 2 : 0;
+        }
+
+        SkipLine(_cursor);
+    }
+
+    if (_vertexCount > INT_MAX || _triangleCount > INT_MAX)
+    {
+        a_sError = a_sPath + ": too many vertices or faces";
+        return false;
+    }
+
+    a_oMesh.ReserveVertices(static_cast<int>(_vertexCount));
+    a_oMesh.ReserveTriangles(static_cast<int>(_triangleCount));
+
+    _cursor.m_pPosition = _file.GetData();
+    _cursor.m_iLine = 1;
+
+    int64_t _maxIndex = -1;
+
+    while (_cursor.m_pPosition < _cursor.m_pEnd)
+    {
+        SkipBlanks(_cursor);
+
+        if (IsDirective(_cursor, 'v'))
+        {
+            ++_cursor.m_pPosition;
+
+            double _xyz[3];
+
+            for (int a = 0; a < 3; ++a)
+            {
+                SkipBlanks(_cursor);
+
+                if (!ParseNumber(_cursor, _xyz[a]))
+                {
+                    a_sError = AtLine(a_sPath, _cursor.m_iLine, "a vertex needs three coordinates");
+                    return false;
+                }
+            }
+
+            a_oMesh.AddVertex(Vec3(float(_xyz[0]), float(_xyz[1]), float(_xyz[2])));
+        }
+        else if (IsDirective(_cursor, 'f'))
+        {
+            ++_cursor.m_pPosition;
+
+            int _corners = 0;
+
+            uint32_t _first = 0;
+            uint32_t _previous = 0;
+
+            for (;;)
+            {
+                SkipBlanks(_cursor);
+
+                if (AtLineEnd(_cursor))
+                {
+                    break;
+                }
+
+                double _reference;
+
+                if (!ParseNumber(_cursor, _reference) || _reference != floor(_reference) || _reference == 0.0)
+                {
+                    a_sError = AtLine(a_sPath, _cursor.m_iLine, "face corners must be non-zero vertex numbers");
+                    return false;
+                }
+
+                // The texture and normal references after a '/' are not used.
+                while (_cursor.m_pPosition < _cursor.m_pEnd && !IsBlank(*_cursor.m_pPosition) && *_cursor.m_pPosition != '\n')
+                {
+                    ++_cursor.m_pPosition;
+                }
+
+                // Positive numbers count from 1, negative ones back from the latest vertex.
+                int64_t _index = _reference > 0.0 ? int64_t(_reference) - 1 : a_oMesh.GetVertexCount() + int64_t(_reference);
+
+                if (_index < 0 || _index > UINT32_MAX)
+                {
+                    a_sError = AtLine(a_sPath, _cursor.m_iLine, "face references a vertex out of range");
+                    return false;
+                }
+
+                _maxIndex = _index > _maxIndex ? _index : _maxIndex;
+
+                AddFanCorner(a_oMesh, _corners++, static_cast<uint32_t>(_index), _first, _previous);
+            }
+
+            if (_corners < 3)
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "a face needs at least three corners");
+                return false;
+            }
+        }
+
+        SkipLine(_cursor);
+    }
+
+    if (_maxIndex >= a_oMesh.GetVertexCount())
+    {
+        a_sError = a_sPath + ": a face references a vertex that is never defined";
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshLoader::LoadPly(const std::string &a_sPath, TriangleMesh &a_oMesh, std::string &a_sError)
+{
+    RT_TRACE_SPAN("mesh load");
+
+    a_oMesh.Clear();
+
+    MappedFile _file;
+
+    if (!_file.Open(a_sPath))
+    {
+        a_sError = "cannot read " + a_sPath;
+        return false;
+    }
+
+    TextCursor _cursor = { _file.GetData(), _file.GetData() + _file.GetSize(), 1 };
+
+    if (ReadWord(_cursor) != "ply")
+    {
+        a_sError = a_sPath + ": not a PLY file";
+        return false;
+    }
+
+    SkipLine(_cursor);
+
+    PlyFormat _format = PLY_FORMAT_COUNT;
+
+    std::vector<PlyElement> _elements;
+
+    // The header is a handful of short lines, so plain strings are fine here.
+    for (;;)
+    {
+        if (_cursor.m_pPosition >= _cursor.m_pEnd)
+        {
+            a_sError = a_sPath + ": missing end_header";
+            return false;
+        }
+
+        std::string _keyword = ReadWord(_cursor);
+
+        if (_keyword == "end_header")
+        {
+            SkipLine(_cursor);
+            break;
+        }
+
+        if (_keyword == "format")
+        {
+            std::string _name = ReadWord(_cursor);
+
+            for (int f = 0; f < PLY_FORMAT_COUNT; ++f)
+            {
+                _format = _name == s_cpPlyFormatNames[f] ? PlyFormat(f) : _format;
+            }
+
+            if (_format == PLY_FORMAT_COUNT)
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "unknown format '" + _name + "'");
+                return false;
+            }
+        }
+        else if (_keyword == "element")
+        {
+            PlyElement _element;
+
+            _element.m_sName = ReadWord(_cursor);
+
+            double _count;
+
+            SkipBlanks(_cursor);
+
+            if (!ParseNumber(_cursor, _count) || _count < 0.0 || _count > INT_MAX)
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "bad element count");
+                return false;
+            }
+
+            _element.m_iCount = int(_count);
+
+            _elements.push_back(_element);
+        }
+        else if (_keyword == "property")
+        {
+            if (_elements.empty())
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "property outside an element");
+                return false;
+            }
+
+            PlyProperty _property;
+
+            std::string _type = ReadWord(_cursor);
+
+            _property.m_bList = _type == "list";
+            _property.m_eCountType = PLY_TYPE_UINT8;
+
+            if (_property.m_bList && !ParsePlyType(ReadWord(_cursor), _property.m_eCountType))
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "unknown list count type");
+                return false;
+            }
+
+            if (!ParsePlyType(_property.m_bList ? ReadWord(_cursor) : _type, _property.m_eType))
+            {
+                a_sError = AtLine(a_sPath, _cursor.m_iLine, "unknown property type");
+                return false;
+            }
+
+            _property.m_sName = ReadWord(_cursor);
+
+            _elements.back().m_oProperties.push_back(_property);
+        }
+        else if (_keyword != "comment" && _keyword != "obj_info" && !_keyword.empty())
+        {
+            a_sError = AtLine(a_sPath, _cursor.m_iLine, "unknown header keyword '" + _keyword + "'");
+            return false;
+        }
+
+        SkipLine(_cursor);
+    }
+
+    if (_format == PLY_FORMAT_COUNT)
+    {
+        a_sError = a_sPath + ": missing format";
+        return false;
+    }
+
+    bool _swap = _format == (IsLittleEndianHost() ? PLY_FORMAT_BINARY_BIG_ENDIAN : PLY_FORMAT_BINARY_LITTLE_ENDIAN);
+
+    for (size_t e = 0; e < _elements.size(); ++e)
+    {
+        if (_elements[e].m_sName == "vertex")
+        {
+            a_oMesh.ReserveVertices(_elements[e].m_iCount);
+        }
+        else if (_elements[e].m_sName == "face")
+        {
+            a_oMesh.ReserveTriangles(_elements[e].m_iCount);
+        }
+    }
+
+    int64_t _maxIndex = -1;
+
+    for (size_t e = 0; e < _elements.size(); ++e)
+    {
+        const PlyElement& _element = _elements[e];
+
+        bool _isVertex = _element.m_sName == "vertex";
+        bool _isFace = _element.m_sName == "face";
+
+        // Property slots that feed the mesh: x, y, z of a vertex, or a face's index list.
+        int _axisOf[64];
+        int _axesFound = 0;
+        bool _hasIndices = false;
+
+        if (_element.m_oProperties.size() > 64)
+        {
+            a_sError = a_sPath + ": too many properties in element '" + _element.m_sName + "'";
+            return false;
+        }
+
+        for (size_t p = 0; p < _element.m_oProperties.size(); ++p)
+        {
+            const PlyProperty& _property = _element.m_oProperties[p];
+
+            _axisOf[p] = -1;
+
+            if (_isVertex && !_property.m_bList && _property.m_sName.size() == 1 && _property.m_sName[0] >= 'x' && _property.m_sName[0] <= 'z')
+            {
+                _axisOf[p] = _property.m_sName[0] - 'x';
+                ++_axesFound;
+            }
+            else if (_isFace && _property.m_bList && (_property.m_sName == "vertex_indices" || _property.m_sName == "vertex_index"))
+            {
+                _axisOf[p] = 0;
+                _hasIndices = true;
+            }
+        }
+
+        if ((_isVertex && _axesFound != 3) || (_isFace && !_hasIndices))
+        {
+            a_sError = a_sPath + ": element '" + _element.m_sName + (_isVertex ? "' needs x, y and z" : "' needs a vertex_indices list");
+            return false;
+        }
+
+        for (int i = 0; i < _element.m_iCount; ++i)
+        {
+            double _xyz[3] = { 0.0, 0.0, 0.0 };
+
+            for (size_t p = 0; p < _element.m_oProperties.size(); ++p)
+            {
+                const PlyProperty& _property = _element.m_oProperties[p];
+
+                double _value;
+
+                if (!_property.m_bList)
+                {
+                    if (!ReadPlyValue(_cursor, _format, _swap, _property.m_eType, _value))
+                    {
+                        a_sError = a_sPath + ": truncated or malformed element '" + _element.m_sName + "'";
+                        return false;
+                    }
+
+                    if (_axisOf[p] >= 0)
+                    {
+                        _xyz[_axisOf[p]] = _value;
+                    }
+                    continue;
+                }
+
+                double _length;
+
+                if (!ReadPlyValue(_cursor, _format, _swap, _property.m_eCountType, _length) || _length < 0.0)
+                {
+                    a_sError = a_sPath + ": truncated or malformed element '" + _element.m_sName + "'";
+                    return false;
+                }
+
+                bool _indices = _isFace && _axisOf[p] == 0;
+
+                if (_indices && _length < 3.0)
+                {
+                    a_sError = a_sPath + ": a face needs at least three corners";
+                    return false;
+                }
+
+                uint32_t _first = 0;
+                uint32_t _previous = 0;
+
+                for (int k = 0; k < int(_length); ++k)
+                {
+                    if (!ReadPlyValue(_cursor, _format, _swap, _property.m_eType, _value))
+                    {
+                        a_sError = a_sPath + ": truncated or malformed element '" + _element.m_sName + "'";
+                        return false;
+                    }
+
+                    if (!_indices)
+                    {
+                        continue;
+                    }
+
+                    if (_value < 0.0 || _value > UINT32_MAX || _value != floor(_value))
+                    {
+                        a_sError = a_sPath + ": face references a vertex out of range";
+                        return false;
+                    }
+
+                    int64_t _index = int64_t(_value);
+
+                    _maxIndex = _index > _maxIndex ? _index : _maxIndex;
+
+                    AddFanCorner(a_oMesh, k, static_cast<uint32_t>(_index), _first, _previous);
+                }
+            }
+
+            if (_isVertex)
+            {
+                a_oMesh.AddVertex(Vec3(float(_xyz[0]), float(_xyz[1]), float(_xyz[2])));
+            }
+        }
+    }
+
+    if (_maxIndex >= a_oMesh.GetVertexCount())
+    {
+        a_sError = a_sPath + ": a face references a vertex that is never defined";
+        return false;
+    }
+
+    return true;
+}
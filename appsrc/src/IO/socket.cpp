@@ -0,0 +1,359 @@
+#include "appsrc/include/IO/socket.h"
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+    typedef SOCKET NativeSocket;
+
+    typedef int IoSize;
+
+    const NativeSocket s_ciInvalid = INVALID_SOCKET;
+
+    // Winsock has to be started once per process before any other call.
+    struct WinsockStartup
+    {
+        WinsockStartup()
+        {
+            WSADATA _data;
+
+            WSAStartup(MAKEWORD(2, 2), &_data);
+        }
+
+        ~WinsockStartup()
+        {
+            WSACleanup();
+        }
+    };
+
+    void StartNetworking()
+    {
+        static WinsockStartup s_oStartup;
+    }
+
+    void CloseNative(NativeSocket a_iSocket)
+    {
+        closesocket(a_iSocket);
+    }
+
+    bool Interrupted()
+    {
+        return false;
+    }
+#else
+    typedef int NativeSocket;
+
+    typedef size_t IoSize;
+
+    const NativeSocket s_ciInvalid = -1;
+
+    void StartNetworking()
+    {
+    }
+
+    void CloseNative(NativeSocket a_iSocket)
+    {
+        close(a_iSocket);
+    }
+
+    bool Interrupted()
+    {
+        return errno == EINTR;
+    }
+#endif
+
+    // A peer that disappears must fail the send, not raise SIGPIPE.
+#if defined(MSG_NOSIGNAL)
+    const int s_ciSendFlags = MSG_NOSIGNAL;
+#else
+    const int s_ciSendFlags = 0;
+#endif
+
+    // Sends and receives at most this much per call; Winsock takes an int.
+    const size_t s_cuMaxChunk = 1 << 30;
+
+    inline NativeSocket Native(intptr_t a_iHandle)
+    {
+        return static_cast<NativeSocket>(a_iHandle);
+    }
+
+    std::string AddressName(const sockaddr_in& a_oAddress)
+    {
+        char _host[INET_ADDRSTRLEN] = { 0 };
+
+        inet_ntop(AF_INET, const_cast<in_addr*>(&a_oAddress.sin_addr), _host, sizeof(_host));
+
+        return std::string(_host) + ":" + std::to_string(ntohs(a_oAddress.sin_port));
+    }
+}
+
+Socket::Socket() : m_iHandle(-1)
+{
+    StartNetworking();
+}
+
+Socket::~Socket()
+{
+    this->Close();
+}
+
+bool Socket::Listen(int a_iPort, std::string &a_sError)
+{
+    this->Close();
+
+    NativeSocket _socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    if (_socket == s_ciInvalid)
+    {
+        a_sError = "could not create a socket";
+        return false;
+    }
+
+    // Lets a restarted coordinator take its port back from connections still in TIME_WAIT.
+    int _reuse = 1;
+
+    setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&_reuse), sizeof(_reuse));
+
+    sockaddr_in _address;
+
+    memset(&_address, 0, sizeof(_address));
+
+    _address.sin_family = AF_INET;
+    _address.sin_addr.s_addr = htonl(INADDR_ANY);
+    _address.sin_port = htons(static_cast<unsigned short>(a_iPort));
+
+    if (bind(_socket, reinterpret_cast<sockaddr*>(&_address), sizeof(_address)) != 0 || listen(_socket, SOMAXCONN) != 0)
+    {
+        CloseNative(_socket);
+
+        a_sError = "could not listen on port " + std::to_string(a_iPort);
+        return false;
+    }
+
+    this->m_iHandle = static_cast<intptr_t>(_socket);
+    this->m_sPeerName = AddressName(_address);
+
+    return true;
+}
+
+bool Socket::Accept(Socket &a_oClient, int a_iTimeoutMs)
+{
+    if (!this->IsOpen())
+    {
+        return false;
+    }
+
+    fd_set _read;
+
+    FD_ZERO(&_read);
+    FD_SET(Native(this->m_iHandle), &_read);
+
+    timeval _timeout;
+
+    _timeout.tv_sec = a_iTimeoutMs / 1000;
+    _timeout.tv_usec = (a_iTimeoutMs % 1000) * 1000;
+
+    // The first argument is ignored by Winsock.
+    if (select(static_cast<int>(this->m_iHandle) + 1, &_read, nullptr, nullptr, &_timeout) <= 0)
+    {
+        return false;
+    }
+
+    sockaddr_in _address;
+
+    socklen_t _length = sizeof(_address);
+
+    NativeSocket _client = accept(Native(this->m_iHandle), reinterpret_cast<sockaddr*>(&_address), &_length);
+
+    if (_client == s_ciInvalid)
+    {
+        return false;
+    }
+
+    a_oClient.Close();
+
+    a_oClient.m_iHandle = static_cast<intptr_t>(_client);
+    a_oClient.m_sPeerName = AddressName(_address);
+
+    a_oClient.Configure();
+
+    return true;
+}
+
+bool Socket::Connect(const std::string &a_sHost, int a_iPort, std::string &a_sError)
+{
+    this->Close();
+
+    addrinfo _hints;
+
+    memset(&_hints, 0, sizeof(_hints));
+
+    _hints.ai_family = AF_INET;
+    _hints.ai_socktype = SOCK_STREAM;
+    _hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* _addresses = nullptr;
+
+    if (getaddrinfo(a_sHost.c_str(), std::to_string(a_iPort).c_str(), &_hints, &_addresses) != 0)
+    {
+        a_sError = "could not resolve " + a_sHost;
+        return false;
+    }
+
+    for (addrinfo* _address = _addresses; _address != nullptr; _address = _address->ai_next)
+    {
+        NativeSocket _socket = socket(_address->ai_family, _address->ai_socktype, _address->ai_protocol);
+
+        if (_socket == s_ciInvalid)
+        {
+            continue;
+        }
+
+        if (connect(_socket, _address->ai_addr, static_cast<socklen_t>(_address->ai_addrlen)) == 0)
+        {
+            this->m_iHandle = static_cast<intptr_t>(_socket);
+            this->m_sPeerName = AddressName(*reinterpret_cast<sockaddr_in*>(_address->ai_addr));
+
+            break;
+        }
+
+        CloseNative(_socket);
+    }
+
+    freeaddrinfo(_addresses);
+
+    if (!this->IsOpen())
+    {
+        a_sError = "could not connect to " + a_sHost + ":" + std::to_string(a_iPort);
+        return false;
+    }
+
+    this->Configure();
+
+    return true;
+}
+
+bool Socket::Send(const void *a_pData, size_t a_uSize)
+{
+    const char* _data = static_cast<const char*>(a_pData);
+
+    while (a_uSize > 0 && this->IsOpen())
+    {
+        IoSize _chunk = static_cast<IoSize>(a_uSize < s_cuMaxChunk ? a_uSize : s_cuMaxChunk);
+
+        long _sent = static_cast<long>(send(Native(this->m_iHandle), _data, _chunk, s_ciSendFlags));
+
+        if (_sent <= 0)
+        {
+            if (_sent < 0 && Interrupted())
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        _data += _sent;
+        a_uSize -= size_t(_sent);
+    }
+
+    return a_uSize == 0;
+}
+
+bool Socket::Receive(void *a_pData, size_t a_uSize)
+{
+    char* _data = static_cast<char*>(a_pData);
+
+    while (a_uSize > 0 && this->IsOpen())
+    {
+        IoSize _chunk = static_cast<IoSize>(a_uSize < s_cuMaxChunk ? a_uSize : s_cuMaxChunk);
+
+        long _received = static_cast<long>(recv(Native(this->m_iHandle), _data, _chunk, 0));
+
+        // Zero is an orderly shutdown by the peer, which mid-message is as fatal as an error.
+        if (_received <= 0)
+        {
+            if (_received < 0 && Interrupted())
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        _data += _received;
+        a_uSize -= size_t(_received);
+    }
+
+    return a_uSize == 0;
+}
+
+void Socket::SetReceiveTimeout(double a_dSeconds)
+{
+    if (!this->IsOpen())
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    DWORD _timeout = static_cast<DWORD>(a_dSeconds > 0.0 ? a_dSeconds * 1000.0 : 0.0);
+#else
+    timeval _timeout;
+
+    _timeout.tv_sec = static_cast<time_t>(a_dSeconds > 0.0 ? a_dSeconds : 0.0);
+    _timeout.tv_usec = static_cast<suseconds_t>(a_dSeconds > 0.0 ? (a_dSeconds - double(_timeout.tv_sec)) * 1e6 : 0.0);
+#endif
+
+    setsockopt(Native(this->m_iHandle), SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&_timeout), sizeof(_timeout));
+}
+
+void Socket::Close()
+{
+    if (this->IsOpen())
+    {
+        CloseNative(Native(this->m_iHandle));
+    }
+
+    this->m_iHandle = -1;
+}
+
+bool Socket::IsOpen() const
+{
+    return this->m_iHandle != -1;
+}
+
+const std::string& Socket::GetPeerName() const
+{
+    return this->m_sPeerName;
+}
+
+void Socket::Configure()
+{
+    int _enable = 1;
+
+    setsockopt(Native(this->m_iHandle), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&_enable), sizeof(_enable));
+
+    // Lets the system notice a peer that vanished without closing the connection.
+    setsockopt(Native(this->m_iHandle), SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char*>(&_enable), sizeof(_enable));
+
+#if defined(SO_NOSIGPIPE)
+    setsockopt(Native(this->m_iHandle), SOL_SOCKET, SO_NOSIGPIPE, reinterpret_cast<const char*>(&_enable), sizeof(_enable));
+#endif
+}
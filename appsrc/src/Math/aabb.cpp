@@ -0,0 +1,104 @@
+#include "appsrc/include/Math/aabb.h"
+#include <float.h>
+
+Aabb::Aabb() : m_oMin(Vec3(FLT_MAX, FLT_MAX, FLT_MAX)),
+               m_oMax(Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX))
+{
+}
+
+Aabb::Aabb(const Vec3 &a_oMin, const Vec3 &a_oMax) : m_oMin(a_oMin),
+                                                     m_oMax(a_oMax)
+{
+}
+
+void Aabb::Grow(const Vec3 &a_oPoint)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_oMin[a] = fminf(this->m_oMin[a], a_oPoint[a]);
+        this->m_oMax[a] = fmaxf(this->m_oMax[a], a_oPoint[a]);
+    }
+}
+
+void Aabb::Grow(const Aabb &a_oBox)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_oMin[a] = fminf(this->m_oMin[a], a_oBox.m_oMin[a]);
+        this->m_oMax[a] = fmaxf(this->m_oMax[a], a_oBox.m_oMax[a]);
+    }
+}
+
+Vec3 Aabb::Centroid() const
+{
+    return 0.5f * (this->m_oMin + this->m_oMax);
+}
+
+Vec3 Aabb::Extent() const
+{
+    return this->m_oMax - this->m_oMin;
+}
+
+float Aabb::SurfaceArea() const
+{
+    if (this->IsEmpty())
+    {
+        return 0.0f;
+    }
+
+    Vec3 _d = this->Extent();
+
+    return 2.0f * (_d[0] * _d[1] + _d[1] * _d[2] + _d[2] * _d[0]);
+}
+
+int Aabb::LongestAxis() const
+{
+    Vec3 _d = this->Extent();
+
+    if (_d[0] > _d[1] && _d[0] > _d[2])
+    {
+        return 0;
+    }
+
+    return (_d[1] > _d[2]) ? 1 : 2;
+}
+
+bool Aabb::IsEmpty() const
+{
+    return this->m_oMin[0] > this->m_oMax[0] || this->m_oMin[1] > this->m_oMax[1] || this->m_oMin[2] > this->m_oMax[2];
+}
+
+bool Aabb::Hit(const Vec3 &a_oOrigin, const Vec3 &a_oInvDir, float a_fTMin, float a_fTMax) const
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        float _t0 = (this->m_oMin[a] - a_oOrigin[a]) * a_oInvDir[a];
+        float _t1 = (this->m_oMax[a] - a_oOrigin[a]) * a_oInvDir[a];
+
+        if (a_oInvDir[a] < 0.0f)
+        {
+            float _swap = _t0;
+            _t0 = _t1;
+            _t1 = _swap;
+        }
+
+        a_fTMin = _t0 > a_fTMin ? _t0 : a_fTMin;
+        a_fTMax = _t1 < a_fTMax ? _t1 : a_fTMax;
+
+        if (a_fTMax < a_fTMin)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Aabb Union(const Aabb &a_oLhs, const Aabb &a_oRhs)
+{
+    Aabb _box = a_oLhs;
+
+    _box.Grow(a_oRhs);
+
+    return _box;
+}
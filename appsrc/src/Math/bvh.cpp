@@ -0,0 +1,1129 @@
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/counters.h"
+#include "appsrc/include/Math/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+
+#if defined(RT_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const int s_ciBinCount = 16;
+
+    const float s_cfTraversalCost = 1.0f;
+
+    // How much worse than freshly built a refitted tree may get before RefitOrRebuild() builds anew.
+    const float s_cfRebuildCostFactor = 1.5f;
+
+    struct Bin
+    {
+        Aabb m_oBox;
+        int m_iCount;
+    };
+
+    // Traversals count into a local BvhTraversalStats and publish it once at the end.
+    inline void PublishTraversal(const BvhTraversalStats& a_oStats)
+    {
+        RT_COUNTERS(_counters);
+
+        RT_COUNTER_ADD(_counters, COUNTER_BVH_RAYS, a_oStats.m_uRays);
+        RT_COUNTER_ADD(_counters, COUNTER_BVH_NODES_VISITED, a_oStats.m_uNodesVisited);
+        RT_COUNTER_ADD(_counters, COUNTER_BVH_PRIMITIVE_TESTS, a_oStats.m_uPrimitiveTests);
+    }
+
+    inline Aabb NodeBox(const BvhNode& a_oNode)
+    {
+        return Aabb(Vec3(a_oNode.m_fMin[0], a_oNode.m_fMin[1], a_oNode.m_fMin[2]), Vec3(a_oNode.m_fMax[0], a_oNode.m_fMax[1], a_oNode.m_fMax[2]));
+    }
+
+    inline bool NodeHit(const BvhNode& a_oNode, const float* a_fOrgScaled, const float* a_fInvDir, const int* a_iDirIsNeg, float a_fTMin, float a_fTMax)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            float _near = a_iDirIsNeg[a] ? a_oNode.m_fMax[a] : a_oNode.m_fMin[a];
+            float _far = a_iDirIsNeg[a] ? a_oNode.m_fMin[a] : a_oNode.m_fMax[a];
+
+            float _t0 = _near * a_fInvDir[a] + a_fOrgScaled[a];
+            float _t1 = _far * a_fInvDir[a] + a_fOrgScaled[a];
+
+            a_fTMin = _t0 > a_fTMin ? _t0 : a_fTMin;
+            a_fTMax = _t1 < a_fTMax ? _t1 : a_fTMax;
+        }
+
+        return a_fTMin <= a_fTMax;
+    }
+
+#if defined(RT_SIMD_X86)
+    inline int CountLanes(uint32_t a_uMask)
+    {
+        int _count = 0;
+
+        for (; a_uMask != 0; a_uMask &= a_uMask - 1)
+        {
+            ++_count;
+        }
+
+        return _count;
+    }
+
+    // Traces all lanes of a packet through a sphere-leaf BVH. Lanes share one traversal
+    // order; a node is entered while any lane still overlaps it.
+    RT_TARGET_AVX2 uint32_t HitPacketAvx2(const BvhNode* a_oNodes, const SphereSoA& a_oSpheres, const RayPacket& a_oPacket, float a_fTMin, float a_fTMax, float* a_fBestT, int* a_iBestIndex, BvhTraversalStats& a_oStats)
+    {
+        const __m256i _laneIds = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256 _active = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(a_oPacket.m_iCount), _laneIds));
+        const __m256 _tMin = _mm256_set1_ps(a_fTMin);
+        const __m256 _one = _mm256_set1_ps(1.0f);
+        const __m256 _sign = _mm256_set1_ps(-0.0f);
+        const __m256 _zero = _mm256_setzero_ps();
+
+        __m256 _org[3];
+        __m256 _dir[3];
+        __m256 _invDir[3];
+        __m256 _orgScaled[3];
+
+        for (int a = 0; a < 3; ++a)
+        {
+            _org[a] = _mm256_load_ps(a_oPacket.m_fOrigin[a]);
+            _dir[a] = _mm256_load_ps(a_oPacket.m_fDirection[a]);
+            _invDir[a] = _mm256_div_ps(_one, _dir[a]);
+            _orgScaled[a] = _mm256_xor_ps(_mm256_mul_ps(_org[a], _invDir[a]), _sign);
+        }
+
+        const __m256 _a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_dir[0], _dir[0]), _mm256_mul_ps(_dir[1], _dir[1])), _mm256_mul_ps(_dir[2], _dir[2]));
+
+        __m256 _best = _mm256_set1_ps(a_fTMax);
+        __m256i _bestIndex = _mm256_set1_epi32(-1);
+
+        // The first lane decides the near child; packets are expected to be coherent.
+        int _dirIsNeg[3] = { a_oPacket.m_fDirection[0][0] < 0.0f, a_oPacket.m_fDirection[1][0] < 0.0f, a_oPacket.m_fDirection[2][0] < 0.0f };
+
+        // Each stacked node keeps the lanes that overlapped its parent. The stats count a
+        // node, and each primitive test, once for every such lane, as one ray at a time
+        // would, so the figures per ray compare with the scalar traversal's.
+        uint32_t _stack[BvhBuilder::MAX_DEPTH];
+        uint32_t _stackLanes[BvhBuilder::MAX_DEPTH];
+        int _stackSize = 0;
+
+        uint32_t _current = 0;
+        uint32_t _lanes = static_cast<uint32_t>(_mm256_movemask_ps(_active));
+
+        a_oStats.m_uRays += a_oPacket.m_iCount;
+
+        for (;;)
+        {
+            const BvhNode& _node = a_oNodes[_current];
+
+            a_oStats.m_uNodesVisited += CountLanes(_lanes);
+
+            __m256 _near = _tMin;
+            __m256 _far = _best;
+
+            for (int a = 0; a < 3; ++a)
+            {
+                __m256 _t0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(_node.m_fMin[a]), _invDir[a]), _orgScaled[a]);
+                __m256 _t1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(_node.m_fMax[a]), _invDir[a]), _orgScaled[a]);
+
+                _near = _mm256_max_ps(_near, _mm256_min_ps(_t0, _t1));
+                _far = _mm256_min_ps(_far, _mm256_max_ps(_t0, _t1));
+            }
+
+            __m256 _overlap = _mm256_and_ps(_mm256_cmp_ps(_near, _far, _CMP_LE_OQ), _active);
+
+            uint32_t _overlapLanes = static_cast<uint32_t>(_mm256_movemask_ps(_overlap));
+
+            if (_overlapLanes != 0)
+            {
+                if (_node.m_uCount > 0)
+                {
+                    a_oStats.m_uPrimitiveTests += uint64_t(_node.m_uCount) * CountLanes(_overlapLanes);
+
+                    for (uint32_t k = _node.m_uOffset; k < _node.m_uOffset + _node.m_uCount; ++k)
+                    {
+                        __m256 _ocx = _mm256_sub_ps(_org[0], _mm256_set1_ps(a_oSpheres.m_pCenterX[k]));
+                        __m256 _ocy = _mm256_sub_ps(_org[1], _mm256_set1_ps(a_oSpheres.m_pCenterY[k]));
+                        __m256 _ocz = _mm256_sub_ps(_org[2], _mm256_set1_ps(a_oSpheres.m_pCenterZ[k]));
+                        __m256 _r = _mm256_set1_ps(a_oSpheres.m_pRadius[k]);
+
+                        __m256 _b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_ocx, _dir[0]), _mm256_mul_ps(_ocy, _dir[1])), _mm256_mul_ps(_ocz, _dir[2]));
+                        __m256 _c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_ocx, _ocx), _mm256_mul_ps(_ocy, _ocy)), _mm256_mul_ps(_ocz, _ocz)), _mm256_mul_ps(_r, _r));
+                        __m256 _desc = _mm256_sub_ps(_mm256_mul_ps(_b, _b), _mm256_mul_ps(_a, _c));
+
+                        __m256 _candidate = _mm256_and_ps(_mm256_cmp_ps(_desc, _zero, _CMP_GT_OQ), _overlap);
+
+                        if (_mm256_movemask_ps(_candidate) == 0)
+                        {
+                            continue;
+                        }
+
+                        __m256 _sq = _mm256_sqrt_ps(_desc);
+                        __m256 _negB = _mm256_xor_ps(_b, _sign);
+
+                        __m256 _t0 = _mm256_div_ps(_mm256_sub_ps(_negB, _sq), _a);
+                        __m256 _t1 = _mm256_div_ps(_mm256_add_ps(_negB, _sq), _a);
+
+                        __m256 _in0 = _mm256_and_ps(_mm256_cmp_ps(_t0, _best, _CMP_LT_OQ), _mm256_cmp_ps(_t0, _tMin, _CMP_GT_OQ));
+                        __m256 _in1 = _mm256_and_ps(_mm256_cmp_ps(_t1, _best, _CMP_LT_OQ), _mm256_cmp_ps(_t1, _tMin, _CMP_GT_OQ));
+
+                        __m256 _t = _mm256_blendv_ps(_t1, _t0, _in0);
+                        __m256 _take = _mm256_and_ps(_mm256_or_ps(_in0, _in1), _candidate);
+
+                        _best = _mm256_blendv_ps(_best, _t, _take);
+                        _bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_bestIndex), _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(k))), _take));
+                    }
+                }
+                else
+                {
+                    _stackLanes[_stackSize] = _overlapLanes;
+                    _lanes = _overlapLanes;
+
+                    if (_dirIsNeg[_node.m_uAxis])
+                    {
+                        _stack[_stackSize++] = _current + 1;
+                        _current = _node.m_uOffset;
+                    }
+                    else
+                    {
+                        _stack[_stackSize++] = _node.m_uOffset;
+                        _current = _current + 1;
+                    }
+                    continue;
+                }
+            }
+
+            if (_stackSize == 0)
+            {
+                break;
+            }
+
+            _current = _stack[--_stackSize];
+            _lanes = _stackLanes[_stackSize];
+        }
+
+        _mm256_storeu_ps(a_fBestT, _best);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a_iBestIndex), _bestIndex);
+
+        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_bestIndex, _mm256_set1_epi32(-1)))));
+    }
+#endif
+}
+
+BvhTraversalStats::BvhTraversalStats() : m_uRays(0),
+                                         m_uNodesVisited(0),
+                                         m_uPrimitiveTests(0)
+{
+}
+
+void BvhBuilder::Build(const std::vector<Aabb> &a_oBoxes, int a_iMaxLeafSize, std::vector<BvhNode> &a_oNodes, std::vector<int> &a_oOrder, float a_fIntersectionCost)
+{
+    a_oNodes.clear();
+    a_oOrder.resize(a_oBoxes.size());
+
+    for (size_t i = 0; i < a_oBoxes.size(); ++i)
+    {
+        a_oOrder[i] = static_cast<int>(i);
+    }
+
+    if (a_oBoxes.empty())
+    {
+        return;
+    }
+
+    // A binary tree over n leaves never needs more than 2n - 1 nodes.
+    a_oNodes.reserve(2 * a_oBoxes.size());
+
+    BuildRange(0, static_cast<int>(a_oBoxes.size()), 0, a_iMaxLeafSize < 1 ? 1 : a_iMaxLeafSize, a_fIntersectionCost, a_oBoxes, a_oOrder, a_oNodes);
+}
+
+void BvhBuilder::BuildRange(int a_iBegin, int a_iEnd, int a_iDepth, int a_iMaxLeafSize, float a_fIntersectionCost, const std::vector<Aabb> &a_oBoxes, std::vector<int> &a_oOrder, std::vector<BvhNode> &a_oNodes)
+{
+    size_t _nodeIndex = a_oNodes.size();
+
+    a_oNodes.push_back(BvhNode());
+
+    Aabb _bounds;
+    Aabb _centroids;
+
+    for (int i = a_iBegin; i < a_iEnd; ++i)
+    {
+        _bounds.Grow(a_oBoxes[a_oOrder[i]]);
+        _centroids.Grow(a_oBoxes[a_oOrder[i]].Centroid());
+    }
+
+    for (int a = 0; a < 3; ++a)
+    {
+        a_oNodes[_nodeIndex].m_fMin[a] = _bounds.m_oMin[a];
+        a_oNodes[_nodeIndex].m_fMax[a] = _bounds.m_oMax[a];
+    }
+
+    int _count = a_iEnd - a_iBegin;
+
+    int _axis = _centroids.LongestAxis();
+
+    float _lo = _centroids.m_oMin[_axis];
+    float _extent = _centroids.m_oMax[_axis] - _lo;
+
+    int _mid = -1;
+
+    // Levels left below this node. Once a lopsided split could leave a child more primitives
+    // than even splits fit into those levels, only even splits are made; they halve the
+    // count per level, so the last level always holds a leaf.
+    int _levelsLeft = MAX_DEPTH - 1 - a_iDepth;
+
+    bool _balance = _levelsLeft <= 0 || (_levelsLeft <= 31 && int64_t(_count) - 1 > int64_t(a_iMaxLeafSize) << (_levelsLeft - 1));
+
+    if (_count > 1 && _extent > 0.0f && !_balance)
+    {
+        Bin _bins[s_ciBinCount];
+
+        for (int b = 0; b < s_ciBinCount; ++b)
+        {
+            _bins[b].m_iCount = 0;
+        }
+
+        float _scale = s_ciBinCount / _extent;
+
+        for (int i = a_iBegin; i < a_iEnd; ++i)
+        {
+            const Aabb& _box = a_oBoxes[a_oOrder[i]];
+
+            int _b = static_cast<int>((_box.Centroid()[_axis] - _lo) * _scale);
+
+            _b = _b < s_ciBinCount ? _b : s_ciBinCount - 1;
+
+            _bins[_b].m_iCount++;
+            _bins[_b].m_oBox.Grow(_box);
+        }
+
+        // Sweep from the right so each split plane is evaluated in O(1).
+        float _rightArea[s_ciBinCount];
+        int _rightCount[s_ciBinCount];
+
+        Aabb _accum;
+        int _accumCount = 0;
+
+        for (int b = s_ciBinCount - 1; b > 0; --b)
+        {
+            _accum.Grow(_bins[b].m_oBox);
+            _accumCount += _bins[b].m_iCount;
+            _rightArea[b] = _accum.SurfaceArea();
+            _rightCount[b] = _accumCount;
+        }
+
+        float _bestCost = FLT_MAX;
+        int _bestSplit = -1;
+
+        _accum = Aabb();
+        _accumCount = 0;
+
+        for (int b = 1; b < s_ciBinCount; ++b)
+        {
+            _accum.Grow(_bins[b - 1].m_oBox);
+            _accumCount += _bins[b - 1].m_iCount;
+
+            if (_accumCount == 0 || _rightCount[b] == 0)
+            {
+                continue;
+            }
+
+            float _cost = _accum.SurfaceArea() * _accumCount + _rightArea[b] * _rightCount[b];
+
+            if (_cost < _bestCost)
+            {
+                _bestCost = _cost;
+                _bestSplit = b;
+            }
+        }
+
+        float _parentArea = _bounds.SurfaceArea();
+
+        float _splitCost = s_cfTraversalCost + a_fIntersectionCost * _bestCost / (_parentArea > 0.0f ? _parentArea : 1.0f);
+        float _leafCost = a_fIntersectionCost * _count;
+
+        if (_bestSplit > 0 && (_count > a_iMaxLeafSize || _splitCost < _leafCost))
+        {
+            int* _first = &a_oOrder[0] + a_iBegin;
+            int* _last = &a_oOrder[0] + a_iEnd;
+
+            int* _pivot = std::partition(_first, _last, [&](int a_iIndex)
+            {
+                int _b = static_cast<int>((a_oBoxes[a_iIndex].Centroid()[_axis] - _lo) * _scale);
+
+                return (_b < s_ciBinCount ? _b : s_ciBinCount - 1) < _bestSplit;
+            });
+
+            _mid = a_iBegin + static_cast<int>(_pivot - _first);
+        }
+    }
+
+    // Coincident centroids cannot be separated by SAH; fall back to an even split.
+    if (_mid < 0 && _count > a_iMaxLeafSize && _levelsLeft > 0)
+    {
+        _mid = a_iBegin + _count / 2;
+    }
+
+    if (_mid < 0)
+    {
+        a_oNodes[_nodeIndex].m_uOffset = static_cast<uint32_t>(a_iBegin);
+        a_oNodes[_nodeIndex].m_uCount = static_cast<uint16_t>(_count);
+        a_oNodes[_nodeIndex].m_uAxis = 0;
+        a_oNodes[_nodeIndex].m_uPad = 0;
+        return;
+    }
+
+    a_oNodes[_nodeIndex].m_uCount = 0;
+    a_oNodes[_nodeIndex].m_uAxis = static_cast<uint8_t>(_axis);
+    a_oNodes[_nodeIndex].m_uPad = 0;
+
+    BuildRange(a_iBegin, _mid, a_iDepth + 1, a_iMaxLeafSize, a_fIntersectionCost, a_oBoxes, a_oOrder, a_oNodes);
+
+    a_oNodes[_nodeIndex].m_uOffset = static_cast<uint32_t>(a_oNodes.size());
+
+    BuildRange(_mid, a_iEnd, a_iDepth + 1, a_iMaxLeafSize, a_fIntersectionCost, a_oBoxes, a_oOrder, a_oNodes);
+}
+
+Bvh::Bvh(const HittableList &a_oList, int a_iMaxLeafSize) : m_pNodes(nullptr),
+                                                            m_iNodeCount(0),
+                                                            m_bSphereLeaves(true),
+                                                            m_pMesh(nullptr),
+                                                            m_iMaxLeafSize(0),
+                                                            m_fIntersectionCost(1.0f),
+                                                            m_dBuildTimeMs(0.0),
+                                                            m_dRefitTimeMs(0.0)
+{
+    RT_TRACE_SPAN("bvh build");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Aabb> _boxes;
+    std::vector<Hittable*> _unordered;
+
+    for (int i = 0; i < a_oList.m_iListSize; ++i)
+    {
+        Aabb _box;
+
+        if (a_oList.m_oList[i]->BoundingBox(_box))
+        {
+            _boxes.push_back(_box);
+            _unordered.push_back(a_oList.m_oList[i]);
+
+            this->m_bSphereLeaves = this->m_bSphereLeaves && dynamic_cast<Sphere*>(a_oList.m_oList[i]) != nullptr;
+        }
+    }
+
+    this->m_bSphereLeaves = this->m_bSphereLeaves && !_unordered.empty();
+
+    int _width = SimdIsaWidth(SphereSoA::GetIsa());
+
+    if (a_iMaxLeafSize <= 0)
+    {
+        a_iMaxLeafSize = (this->m_bSphereLeaves && _width > 4) ? _width : 4;
+    }
+
+    // A SIMD leaf tests a whole vector of spheres for roughly the price of one.
+    float _intersectionCost = this->m_bSphereLeaves ? 1.0f / _width : 1.0f;
+
+    // Leaf sizes are stored in 16 bits.
+    std::vector<int> _order;
+
+    this->m_iMaxLeafSize = a_iMaxLeafSize < 65535 ? a_iMaxLeafSize : 65535;
+    this->m_fIntersectionCost = _intersectionCost;
+
+    BvhBuilder::Build(_boxes, this->m_iMaxLeafSize, this->m_oNodes, _order, _intersectionCost);
+
+    if (this->m_bSphereLeaves)
+    {
+        this->m_oSpheres.Reserve(static_cast<int>(_order.size()));
+
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            const Sphere* _sphere = static_cast<const Sphere*>(_unordered[_order[i]]);
+
+            this->m_oSpheres.Add(_sphere->m_oCenter, _sphere->m_fRadius, _sphere->m_uMaterialId);
+        }
+    }
+    else
+    {
+        this->m_oPrimitives.resize(_order.size());
+
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            this->m_oPrimitives[i] = _unordered[_order[i]];
+        }
+    }
+
+    this->m_pNodes = this->m_oNodes.empty() ? nullptr : &this->m_oNodes[0];
+    this->m_iNodeCount = static_cast<int>(this->m_oNodes.size());
+
+    this->WatchSubtrees();
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dBuildTimeMs = _elapsed.count();
+}
+
+Bvh::Bvh(const SphereSoA &a_oSpheres, int a_iMaxLeafSize, float a_fTimeBegin, float a_fTimeEnd) : m_pNodes(nullptr),
+                                                            m_iNodeCount(0),
+                                                            m_bSphereLeaves(a_oSpheres.GetCount() > 0),
+                                                            m_pMesh(nullptr),
+                                                            m_iMaxLeafSize(0),
+                                                            m_fIntersectionCost(1.0f),
+                                                            m_dBuildTimeMs(0.0),
+                                                            m_dRefitTimeMs(0.0)
+{
+    RT_TRACE_SPAN("bvh build");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    this->BuildSpheres(a_oSpheres, a_iMaxLeafSize, a_fTimeBegin, a_fTimeEnd);
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dBuildTimeMs = _elapsed.count();
+}
+
+Bvh::Bvh(TriangleMesh &a_oMesh, int a_iMaxLeafSize) : m_pNodes(nullptr),
+                                                       m_iNodeCount(0),
+                                                       m_bSphereLeaves(false),
+                                                       m_pMesh(a_oMesh.GetTriangleCount() > 0 ? &a_oMesh : nullptr),
+                                                       m_iMaxLeafSize(0),
+                                                       m_fIntersectionCost(1.0f),
+                                                       m_dBuildTimeMs(0.0),
+                                                       m_dRefitTimeMs(0.0)
+{
+    RT_TRACE_SPAN("bvh build");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    int _count = a_oMesh.GetTriangleCount();
+
+    std::vector<Aabb> _boxes(_count);
+
+    for (int i = 0; i < _count; ++i)
+    {
+        _boxes[i] = a_oMesh.GetTriangleBounds(i);
+    }
+
+    int _width = TriangleMesh::GetBatchWidth();
+
+    if (a_iMaxLeafSize <= 0)
+    {
+        a_iMaxLeafSize = _width;
+    }
+
+    std::vector<int> _order;
+
+    this->m_iMaxLeafSize = a_iMaxLeafSize < 65535 ? a_iMaxLeafSize : 65535;
+    this->m_fIntersectionCost = 1.0f / _width;
+
+    BvhBuilder::Build(_boxes, this->m_iMaxLeafSize, this->m_oNodes, _order, this->m_fIntersectionCost);
+
+    a_oMesh.Reorder(_order);
+
+    this->m_pNodes = this->m_oNodes.empty() ? nullptr : &this->m_oNodes[0];
+    this->m_iNodeCount = static_cast<int>(this->m_oNodes.size());
+
+    this->WatchSubtrees();
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dBuildTimeMs = _elapsed.count();
+}
+
+Bvh::Bvh(const BvhNode *a_pNodes, int a_iNodeCount, const SphereSoA &a_oSpheres) : m_pNodes(a_iNodeCount > 0 ? a_pNodes : nullptr),
+                                                                                   m_iNodeCount(a_iNodeCount),
+                                                                                   m_bSphereLeaves(a_oSpheres.GetCount() > 0),
+                                                                                   m_pMesh(nullptr),
+                                                                                   m_iMaxLeafSize(0),
+                                                                                   m_fIntersectionCost(1.0f / SimdIsaWidth(SphereSoA::GetIsa())),
+                                                                                                          m_dBuildTimeMs(0.0),
+                                                                                   m_dRefitTimeMs(0.0)
+{
+    this->m_oSpheres.Attach(a_oSpheres.m_pCenterX, a_oSpheres.m_pCenterY, a_oSpheres.m_pCenterZ, a_oSpheres.m_pRadius, a_oSpheres.m_pMaterialId, a_oSpheres.GetCount());
+}
+
+void Bvh::BuildSpheres(const SphereSoA &a_oSpheres, int a_iMaxLeafSize, float a_fTimeBegin, float a_fTimeEnd)
+{
+    int _count = a_oSpheres.GetCount();
+
+    std::vector<Aabb> _boxes(_count);
+
+    for (int i = 0; i < _count; ++i)
+    {
+        _boxes[i] = a_oSpheres.GetSphereBounds(i, a_fTimeBegin, a_fTimeEnd);
+    }
+
+    int _width = SimdIsaWidth(SphereSoA::GetIsa());
+
+    if (a_iMaxLeafSize <= 0)
+    {
+        a_iMaxLeafSize = _width > 4 ? _width : 4;
+    }
+
+    std::vector<int> _order;
+
+    this->m_iMaxLeafSize = a_iMaxLeafSize < 65535 ? a_iMaxLeafSize : 65535;
+    this->m_fIntersectionCost = 1.0f / _width;
+
+    BvhBuilder::Build(_boxes, this->m_iMaxLeafSize, this->m_oNodes, _order, this->m_fIntersectionCost);
+
+    this->m_oSpheres = a_oSpheres;
+    this->m_oSpheres.Reorder(_order);
+
+    this->m_pNodes = this->m_oNodes.empty() ? nullptr : &this->m_oNodes[0];
+    this->m_iNodeCount = static_cast<int>(this->m_oNodes.size());
+
+    this->WatchSubtrees();
+}
+
+template <typename LeafTest>
+bool Bvh::Traverse(const Ray &a_oRay, float a_fTMin, float &a_fClosest, LeafTest &a_oLeafTest, bool a_bAnyHit) const
+{
+    BvhTraversalStats _stats;
+
+    _stats.m_uRays = 1;
+
+    if (this->m_iNodeCount == 0)
+    {
+        return false;
+    }
+
+    const BvhNode* _nodes = this->m_pNodes;
+
+    const Vec3& _dir = a_oRay.m_oDirection;
+
+    float _invDir[3] = { 1.0f / _dir[0], 1.0f / _dir[1], 1.0f / _dir[2] };
+    float _orgScaled[3];
+
+    for (int a = 0; a < 3; ++a)
+    {
+        _orgScaled[a] = -a_oRay.m_oOrigin[a] * _invDir[a];
+    }
+
+    int _dirIsNeg[3] = { _invDir[0] < 0.0f, _invDir[1] < 0.0f, _invDir[2] < 0.0f };
+
+    uint32_t _stack[BvhBuilder::MAX_DEPTH];
+    int _stackSize = 0;
+
+    uint32_t _current = 0;
+
+    bool _hittedAnything = false;
+
+    for (;;)
+    {
+        const BvhNode& _node = _nodes[_current];
+
+        ++_stats.m_uNodesVisited;
+
+        if (NodeHit(_node, _orgScaled, _invDir, _dirIsNeg, a_fTMin, a_fClosest))
+        {
+            if (_node.m_uCount > 0)
+            {
+                _stats.m_uPrimitiveTests += _node.m_uCount;
+
+                if (a_oLeafTest(_node.m_uOffset, _node.m_uOffset + _node.m_uCount, a_fClosest))
+                {
+                    _hittedAnything = true;
+
+                    if (a_bAnyHit)
+                    {
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                // Descend into the child on the ray's side of the split plane first.
+                if (_dirIsNeg[_node.m_uAxis])
+                {
+                    _stack[_stackSize++] = _current + 1;
+                    _current = _node.m_uOffset;
+                }
+                else
+                {
+                    _stack[_stackSize++] = _node.m_uOffset;
+                    _current = _current + 1;
+                }
+                continue;
+            }
+        }
+
+        if (_stackSize == 0)
+        {
+            break;
+        }
+
+        _current = _stack[--_stackSize];
+    }
+
+    PublishTraversal(_stats);
+
+    return _hittedAnything;
+}
+
+bool Bvh::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const
+{
+    float _closestSoFar = a_fTMax;
+
+    if (this->m_bSphereLeaves)
+    {
+        SphereRay _ray(a_oRay);
+
+        int _index = -1;
+
+        const SphereSoA& _spheres = this->m_oSpheres;
+
+        auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+        {
+            return _spheres.Intersect(_ray, a_uBegin, a_uEnd, a_fTMin, a_fClosest, _index);
+        };
+
+        if (!this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest))
+        {
+            return false;
+        }
+
+        _spheres.FillRecord(a_oRay, _closestSoFar, _index, a_oRecord);
+
+        return true;
+    }
+
+    if (this->m_pMesh != nullptr)
+    {
+        TriangleRay _ray(a_oRay);
+
+        int _index = -1;
+
+        const TriangleMesh& _mesh = *this->m_pMesh;
+
+        auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+        {
+            return _mesh.Intersect(_ray, a_uBegin, a_uEnd, a_fTMin, a_fClosest, _index);
+        };
+
+        if (!this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest))
+        {
+            return false;
+        }
+
+        _mesh.FillRecord(a_oRay, _closestSoFar, _index, a_oRecord);
+
+        return true;
+    }
+
+    Hittable* const* _primitives = this->m_oPrimitives.empty() ? nullptr : &this->m_oPrimitives[0];
+
+    auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+    {
+        bool _hit = false;
+
+        for (uint32_t i = a_uBegin; i < a_uEnd; ++i)
+        {
+            if (_primitives[i]->Hit(a_oRay, a_fTMin, a_fClosest, a_oRecord))
+            {
+                _hit = true;
+                a_fClosest = a_oRecord.m_fT;
+            }
+        }
+
+        return _hit;
+    };
+
+    return this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest);
+}
+
+bool Bvh::Occluded(const Ray &a_oRay, float a_fTMin, float a_fTMax) const
+{
+    float _closestSoFar = a_fTMax;
+
+    if (this->m_bSphereLeaves)
+    {
+        SphereRay _ray(a_oRay);
+
+        int _index = -1;
+
+        const SphereSoA& _spheres = this->m_oSpheres;
+
+        auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+        {
+            return _spheres.Intersect(_ray, a_uBegin, a_uEnd, a_fTMin, a_fClosest, _index);
+        };
+
+        return this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest, true);
+    }
+
+    if (this->m_pMesh != nullptr)
+    {
+        TriangleRay _ray(a_oRay);
+
+        int _index = -1;
+
+        const TriangleMesh& _mesh = *this->m_pMesh;
+
+        auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+        {
+            return _mesh.Intersect(_ray, a_uBegin, a_uEnd, a_fTMin, a_fClosest, _index);
+        };
+
+        return this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest, true);
+    }
+
+    Hittable* const* _primitives = this->m_oPrimitives.empty() ? nullptr : &this->m_oPrimitives[0];
+
+    auto _leafTest = [&](uint32_t a_uBegin, uint32_t a_uEnd, float& a_fClosest) -> bool
+    {
+        for (uint32_t i = a_uBegin; i < a_uEnd; ++i)
+        {
+            if (_primitives[i]->Occluded(a_oRay, a_fTMin, a_fClosest))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    return this->Traverse(a_oRay, a_fTMin, _closestSoFar, _leafTest, true);
+}
+
+uint32_t Bvh::HitPacket(const RayPacket &a_oPacket, float a_fTMin, float a_fTMax, HitRecord *a_oRecords) const
+{
+    uint32_t _mask = 0;
+
+#if defined(RT_SIMD_X86)
+    // Moving spheres sit somewhere else for every lane's time, so those packets go ray by ray.
+    if (this->m_bSphereLeaves && this->m_iNodeCount > 0 && SphereSoA::GetIsa() >= SIMD_ISA_AVX2 && !this->m_oSpheres.HasMotion())
+    {
+        float _bestT[RayPacket::SIZE];
+        int _bestIndex[RayPacket::SIZE];
+
+        BvhTraversalStats _stats;
+
+        _mask = HitPacketAvx2(this->m_pNodes, this->m_oSpheres, a_oPacket, a_fTMin, a_fTMax, _bestT, _bestIndex, _stats);
+
+        PublishTraversal(_stats);
+
+        for (int l = 0; l < a_oPacket.m_iCount; ++l)
+        {
+            if (_mask & (1u << l))
+            {
+                this->m_oSpheres.FillRecord(a_oPacket.GetRay(l), _bestT[l], _bestIndex[l], a_oRecords[l]);
+            }
+        }
+
+        return _mask;
+    }
+#endif
+
+    for (int l = 0; l < a_oPacket.m_iCount; ++l)
+    {
+        if (this->Hit(a_oPacket.GetRay(l), a_fTMin, a_fTMax, a_oRecords[l]))
+        {
+            _mask |= 1u << l;
+        }
+    }
+
+    return _mask;
+}
+
+void Bvh::HitStream(const Ray *a_oRays, int a_iCount, float a_fTMin, float a_fTMax, HitRecord *a_oRecords, uint8_t *a_uHits) const
+{
+    std::vector<int> _order;
+
+    SortRayStream(a_oRays, a_iCount, _order);
+
+    RayPacket _packet;
+    HitRecord _records[RayPacket::SIZE];
+
+    for (int i = 0; i < a_iCount; i += RayPacket::SIZE)
+    {
+        _packet.Clear();
+
+        int _count = std::min<int>(RayPacket::SIZE, a_iCount - i);
+
+        for (int l = 0; l < _count; ++l)
+        {
+            _packet.Add(a_oRays[_order[i + l]]);
+        }
+
+        uint32_t _mask = this->HitPacket(_packet, a_fTMin, a_fTMax, _records);
+
+        for (int l = 0; l < _count; ++l)
+        {
+            int _index = _order[i + l];
+
+            a_uHits[_index] = (_mask >> l) & 1u;
+
+            if (a_uHits[_index])
+            {
+                a_oRecords[_index] = _records[l];
+            }
+        }
+    }
+}
+
+bool Bvh::BoundingBox(Aabb &a_oBox) const
+{
+    if (this->m_iNodeCount == 0)
+    {
+        return false;
+    }
+
+    a_oBox = NodeBox(this->m_pNodes[0]);
+
+    return true;
+}
+
+void Bvh::Refit(float a_fTimeBegin, float a_fTimeEnd)
+{
+    RT_TRACE_SPAN("bvh refit");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    if (this->m_iNodeCount > 0 && this->m_oNodes.empty())
+    {
+        // A wrapped hierarchy is copied once, so the caller's nodes are never written.
+        this->m_oNodes.assign(this->m_pNodes, this->m_pNodes + this->m_iNodeCount);
+        this->m_pNodes = &this->m_oNodes[0];
+    }
+
+    // Children always come after their parent, so one backward sweep sees them first.
+    for (int n = this->m_iNodeCount - 1; n >= 0; --n)
+    {
+        BvhNode& _node = this->m_oNodes[n];
+
+        Aabb _box;
+
+        if (_node.m_uCount > 0)
+        {
+            for (uint32_t k = _node.m_uOffset; k < _node.m_uOffset + _node.m_uCount; ++k)
+            {
+                Aabb _primitive;
+
+                if (this->m_bSphereLeaves)
+                {
+                    _box.Grow(this->m_oSpheres.GetSphereBounds(k, a_fTimeBegin, a_fTimeEnd));
+                }
+                else if (this->m_pMesh != nullptr)
+                {
+                    _box.Grow(this->m_pMesh->GetTriangleBounds(k));
+                }
+                else if (this->m_oPrimitives[k]->BoundingBox(_primitive))
+                {
+                    _box.Grow(_primitive);
+                }
+            }
+        }
+        else
+        {
+            _box = NodeBox(this->m_oNodes[n + 1]);
+            _box.Grow(NodeBox(this->m_oNodes[_node.m_uOffset]));
+        }
+
+        for (int a = 0; a < 3; ++a)
+        {
+            _node.m_fMin[a] = _box.m_oMin[a];
+            _node.m_fMax[a] = _box.m_oMax[a];
+        }
+    }
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dRefitTimeMs = _elapsed.count();
+}
+
+bool Bvh::RefitOrRebuild(float a_fTimeBegin, float a_fTimeEnd)
+{
+    bool _wrapped = this->m_iNodeCount > 0 && this->m_oNodes.empty();
+
+    this->Refit(a_fTimeBegin, a_fTimeEnd);
+
+    // A prebuilt hierarchy's first refit gives the costs it is held to.
+    if (_wrapped)
+    {
+        this->WatchSubtrees();
+    }
+
+    if (this->m_pMesh != nullptr || this->m_oWatched.empty())
+    {
+        return false;
+    }
+
+    std::vector<float> _costs;
+    std::vector<int> _counts;
+
+    this->ComputeSubtreeCosts(_costs, _counts);
+
+    bool _spoiled = false;
+
+    for (size_t w = 0; w < this->m_oWatched.size() && !_spoiled; ++w)
+    {
+        _spoiled = _costs[this->m_oWatched[w].m_iNode] > s_cfRebuildCostFactor * this->m_oWatched[w].m_fBuildCost;
+    }
+
+    if (!_spoiled)
+    {
+        return false;
+    }
+
+    RT_TRACE_SPAN("bvh rebuild");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    if (this->m_bSphereLeaves)
+    {
+        // BuildSpheres() reorders a copy, so the leaf order it starts from does not matter.
+        SphereSoA _spheres = this->m_oSpheres;
+
+        this->m_oNodes.clear();
+
+        this->BuildSpheres(_spheres, this->m_iMaxLeafSize, a_fTimeBegin, a_fTimeEnd);
+    }
+    else
+    {
+        std::vector<Aabb> _boxes(this->m_oPrimitives.size());
+
+        for (size_t i = 0; i < this->m_oPrimitives.size(); ++i)
+        {
+            // A primitive that lost its bounds would have no place in the tree.
+            if (!this->m_oPrimitives[i]->BoundingBox(_boxes[i]))
+            {
+                return false;
+            }
+        }
+
+        std::vector<int> _order;
+
+        this->m_oNodes.clear();
+
+        BvhBuilder::Build(_boxes, this->m_iMaxLeafSize, this->m_oNodes, _order, this->m_fIntersectionCost);
+
+        std::vector<Hittable*> _primitives(_order.size());
+
+        for (size_t i = 0; i < _order.size(); ++i)
+        {
+            _primitives[i] = this->m_oPrimitives[_order[i]];
+        }
+
+        this->m_oPrimitives.swap(_primitives);
+
+        this->m_pNodes = this->m_oNodes.empty() ? nullptr : &this->m_oNodes[0];
+        this->m_iNodeCount = static_cast<int>(this->m_oNodes.size());
+
+        this->WatchSubtrees();
+    }
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dBuildTimeMs = _elapsed.count();
+
+    return true;
+}
+
+float Bvh::GetSahCost() const
+{
+    std::vector<float> _costs;
+    std::vector<int> _counts;
+
+    this->ComputeSubtreeCosts(_costs, _counts);
+
+    return _costs.empty() ? 0.0f : _costs[0];
+}
+
+void Bvh::ComputeSubtreeCosts(std::vector<float> &a_oCosts, std::vector<int> &a_oCounts) const
+{
+    a_oCosts.resize(this->m_iNodeCount);
+    a_oCounts.resize(this->m_iNodeCount);
+
+    // Children come after their parent, as in Refit().
+    for (int n = this->m_iNodeCount - 1; n >= 0; --n)
+    {
+        const BvhNode& _node = this->m_pNodes[n];
+
+        if (_node.m_uCount > 0)
+        {
+            a_oCosts[n] = this->m_fIntersectionCost * _node.m_uCount;
+            a_oCounts[n] = _node.m_uCount;
+            continue;
+        }
+
+        int _left = n + 1;
+        int _right = static_cast<int>(_node.m_uOffset);
+
+        float _area = NodeBox(_node).SurfaceArea();
+
+        float _children = NodeBox(this->m_pNodes[_left]).SurfaceArea() * a_oCosts[_left] + NodeBox(this->m_pNodes[_right]).SurfaceArea() * a_oCosts[_right];
+
+        a_oCosts[n] = s_cfTraversalCost + (_area > 0.0f ? _children / _area : 0.0f);
+        a_oCounts[n] = a_oCounts[_left] + a_oCounts[_right];
+    }
+}
+
+void Bvh::WatchSubtrees()
+{
+    this->m_oWatched.clear();
+
+    std::vector<float> _costs;
+    std::vector<int> _counts;
+
+    this->ComputeSubtreeCosts(_costs, _counts);
+
+    // No level holds more than eight subtrees this large, so the list stays short.
+    for (int n = 0; n < this->m_iNodeCount; ++n)
+    {
+        if (this->m_pNodes[n].m_uCount == 0 && 8 * _counts[n] >= _counts[0])
+        {
+            WatchedSubtree _subtree;
+            _subtree.m_iNode = n;
+            _subtree.m_fBuildCost = _costs[n];
+
+            this->m_oWatched.push_back(_subtree);
+        }
+    }
+}
+
+double Bvh::GetBuildTimeMs() const
+{
+    return this->m_dBuildTimeMs;
+}
+
+double Bvh::GetRefitTimeMs() const
+{
+    return this->m_dRefitTimeMs;
+}
+
+int Bvh::GetNodeCount() const
+{
+    return this->m_iNodeCount;
+}
+
+const BvhNode* Bvh::GetNodes() const
+{
+    return this->m_pNodes;
+}
+
+const SphereSoA* Bvh::GetSpheres() const
+{
+    return this->m_bSphereLeaves ? &this->m_oSpheres : nullptr;
+}
+
+const TriangleMesh* Bvh::GetMesh() const
+{
+    return this->m_pMesh;
+}
+
+BvhTraversalStats Bvh::GetTraversalStats()
+{
+    CounterBlock _counters = Counters::Sum();
+
+    BvhTraversalStats _total;
+
+    _total.m_uRays = _counters.m_uValues[COUNTER_BVH_RAYS];
+    _total.m_uNodesVisited = _counters.m_uValues[COUNTER_BVH_NODES_VISITED];
+    _total.m_uPrimitiveTests = _counters.m_uValues[COUNTER_BVH_PRIMITIVE_TESTS];
+
+    return _total;
+}
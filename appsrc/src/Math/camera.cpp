@@ -1,6 +1,10 @@
 #include "appsrc/include/Math/camera.h"
+#include "appsrc/include/Math/sampling.h"
+#include "appsrc/include/Math/vec3a.h"
 
 Camera::Camera(Vec3 a_oLookFrom, Vec3 a_oLookAt, Vec3 a_oUp, float a_fFov, float a_fAspect, float a_fAperture, float a_fFocusDist)
+    : m_fShutterOpen(0.0f),
+      m_fShutterClose(0.0f)
 {
     m_fLensRadius = a_fAperture / 2;
 
@@ -25,23 +29,98 @@ Camera::Camera(Vec3 a_oLookFrom, Vec3 a_oLookAt, Vec3 a_oUp, float a_fFov, float
     m_oVertical = 2 * _halfHeight * a_fFocusDist * m_oV;
 }
 
-Vec3 Camera::RandomUnitInDisk()
+void Camera::SetShutter(float a_fOpen, float a_fClose)
 {
-    Vec3 _p;
-
-    do
-    {
-        _p = 2.0f * Vec3((std::rand() / (RAND_MAX + 1.0)), (std::rand() / (RAND_MAX + 1.0)), 0.0f) - Vec3(1.0f, 1.0f, 0.0f);
-    } while (Dot(_p, _p) >= 1.0f);
+    this->m_fShutterOpen = a_fOpen;
+    this->m_fShutterClose = a_fClose;
+}
 
-    return _p;
+bool Camera::HasShutter() const
+{
+    return this->m_fShutterClose > this->m_fShutterOpen;
 }
 
-Ray Camera::GetRay(float a_fU, float a_fV)
+Ray Camera::GetRay(float a_fU, float a_fV, float a_fLensX, float a_fLensY, float a_fTime) const
 {
-    Vec3 _rd = m_fLensRadius * RandomUnitInDisk();
+    float _time = m_fShutterOpen + a_fTime * (m_fShutterClose - m_fShutterOpen);
+
+#if RT_USE_VEC3A
+    Vec3 _disk = ConcentricSampleDisk(a_fLensX, a_fLensY);
+
+    Vec3A _offset = MulAdd(Vec3A::Splat(m_fLensRadius * _disk.GetX()), Vec3A(m_oU), Vec3A(m_oV) * (m_fLensRadius * _disk.GetY()));
+
+    Vec3A _target = MulAdd(Vec3A::Splat(a_fV), Vec3A(m_oVertical), MulAdd(Vec3A::Splat(a_fU), Vec3A(m_oHorizontal), Vec3A(m_oLowerLeftCorner)));
+
+    Vec3A _start = Vec3A(m_oOrigin) + _offset;
+
+    return Ray(_start.ToVec3(), (_target - _start).ToVec3(), _time);
+#else
+    Vec3 _rd = m_fLensRadius * ConcentricSampleDisk(a_fLensX, a_fLensY);
 
     Vec3 _offset = m_oU * _rd.GetX() + m_oV * _rd.GetY();
 
-    return Ray(m_oOrigin + _offset, m_oLowerLeftCorner + a_fU * m_oHorizontal + a_fV * m_oVertical - m_oOrigin - _offset);
+    return Ray(m_oOrigin + _offset, m_oLowerLeftCorner + a_fU * m_oHorizontal + a_fV * m_oVertical - m_oOrigin - _offset, _time);
+#endif
+}
+
+Ray Camera::GetRay(const CameraSample &a_oSample, int a_iWidth, int a_iHeight) const
+{
+    Ray _ray;
+
+    this->GetRays(&a_oSample, 1, a_iWidth, a_iHeight, &_ray);
+
+    return _ray;
+}
+
+void Camera::GetRays(const CameraSample *a_pSamples, int a_iCount, int a_iWidth, int a_iHeight, Ray *a_pRays) const
+{
+    // Image-plane point of (x + jx, y + jy) relative to the origin:
+    // rowBase(y) + (x + jx) * stepX + jy * stepY.
+    Vec3 _stepX = this->m_oHorizontal / float(a_iWidth);
+    Vec3 _stepY = this->m_oVertical / float(a_iHeight);
+
+    Vec3 _rowBase;
+
+    int _row = -1;
+
+    float _open = this->m_fShutterOpen;
+    float _span = this->m_fShutterClose - this->m_fShutterOpen;
+
+    if (this->m_fLensRadius == 0.0f)
+    {
+        for (int k = 0; k < a_iCount; ++k)
+        {
+            const CameraSample& _sample = a_pSamples[k];
+
+            if (_sample.m_iY != _row)
+            {
+                _row = _sample.m_iY;
+                _rowBase = this->m_oLowerLeftCorner + float(_row) * _stepY - this->m_oOrigin;
+            }
+
+            a_pRays[k] = Ray(this->m_oOrigin, _rowBase + (float(_sample.m_iX) + _sample.m_fJitterX) * _stepX + _sample.m_fJitterY * _stepY, _open + _sample.m_fTime * _span);
+        }
+
+        return;
+    }
+
+    Vec3 _lensU = this->m_fLensRadius * this->m_oU;
+    Vec3 _lensV = this->m_fLensRadius * this->m_oV;
+
+    for (int k = 0; k < a_iCount; ++k)
+    {
+        const CameraSample& _sample = a_pSamples[k];
+
+        if (_sample.m_iY != _row)
+        {
+            _row = _sample.m_iY;
+            _rowBase = this->m_oLowerLeftCorner + float(_row) * _stepY - this->m_oOrigin;
+        }
+
+        Vec3 _disk = ConcentricSampleDisk(_sample.m_fLensX, _sample.m_fLensY);
+
+        Vec3 _offset = _disk.GetX() * _lensU + _disk.GetY() * _lensV;
+
+        a_pRays[k] = Ray(this->m_oOrigin + _offset, _rowBase + (float(_sample.m_iX) + _sample.m_fJitterX) * _stepX + _sample.m_fJitterY * _stepY - _offset, _open + _sample.m_fTime * _span);
+    }
 }
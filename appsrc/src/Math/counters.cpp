@@ -0,0 +1,98 @@
+#include "appsrc/include/Math/counters.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    std::mutex s_oBlocksMutex;
+    std::vector<std::unique_ptr<CounterBlock> > s_oBlocks;
+}
+
+CounterBlock::CounterBlock()
+{
+    for (int c = 0; c < COUNTER_COUNT; ++c)
+    {
+        this->m_uValues[c] = 0;
+    }
+}
+
+CounterBlock& Counters::Local()
+{
+    thread_local CounterBlock* s_pBlock = nullptr;
+
+    if (s_pBlock == nullptr)
+    {
+        std::lock_guard<std::mutex> _lock(s_oBlocksMutex);
+        s_oBlocks.push_back(std::unique_ptr<CounterBlock>(new CounterBlock()));
+        s_pBlock = s_oBlocks.back().get();
+    }
+
+    return *s_pBlock;
+}
+
+CounterBlock Counters::Sum()
+{
+    std::lock_guard<std::mutex> _lock(s_oBlocksMutex);
+
+    CounterBlock _total;
+
+    for (size_t i = 0; i < s_oBlocks.size(); ++i)
+    {
+        for (int c = 0; c < COUNTER_COUNT; ++c)
+        {
+            _total.m_uValues[c] += s_oBlocks[i]->m_uValues[c];
+        }
+    }
+
+    return _total;
+}
+
+void Counters::Reset()
+{
+    std::lock_guard<std::mutex> _lock(s_oBlocksMutex);
+
+    for (size_t i = 0; i < s_oBlocks.size(); ++i)
+    {
+        *s_oBlocks[i] = CounterBlock();
+    }
+}
+
+const char* Counters::GetName(RenderCounter a_eCounter)
+{
+    switch (a_eCounter)
+    {
+    case COUNTER_BVH_RAYS:
+        return "bvh_rays";
+    case COUNTER_BVH_NODES_VISITED:
+        return "bvh_nodes_visited";
+    case COUNTER_BVH_PRIMITIVE_TESTS:
+        return "bvh_primitive_tests";
+    case COUNTER_PATHS:
+        return "paths";
+    case COUNTER_PATH_SEGMENTS:
+        return "path_segments";
+    case COUNTER_ROULETTE_KILLS:
+        return "roulette_kills";
+    case COUNTER_HITS_LAMBERTIAN:
+        return "hits_lambertian";
+    case COUNTER_HITS_METAL:
+        return "hits_metal";
+    case COUNTER_HITS_DIELECTRIC:
+        return "hits_dielectric";
+    case COUNTER_HITS_EMISSIVE:
+        return "hits_emissive";
+    case COUNTER_DIELECTRIC_TOTAL_INTERNAL_REFLECTIONS:
+        return "dielectric_total_internal_reflections";
+    case COUNTER_SHADOW_RAYS:
+        return "shadow_rays";
+    case COUNTER_SHADOW_RAYS_OCCLUDED:
+        return "shadow_rays_occluded";
+    case COUNTER_TILES:
+        return "tiles";
+    case COUNTER_TILE_NANOSECONDS:
+        return "tile_nanoseconds";
+    default:
+        return "unknown";
+    }
+}
@@ -29,3 +29,33 @@ bool HittableList::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecor
     }
     return _hittedAnything;
 }
+
+bool HittableList::Occluded(const Ray &a_oRay, float a_fTMin, float a_fTMax) const
+{
+    for (int i = 0; i < m_iListSize; ++i)
+    {
+        if (m_oList[i]->Occluded(a_oRay, a_fTMin, a_fTMax))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HittableList::BoundingBox(Aabb &a_oBox) const
+{
+    a_oBox = Aabb();
+
+    for (int i = 0; i < m_iListSize; ++i)
+    {
+        Aabb _box;
+
+        if (!m_oList[i]->BoundingBox(_box))
+        {
+            return false;
+        }
+
+        a_oBox.Grow(_box);
+    }
+    return m_iListSize > 0;
+}
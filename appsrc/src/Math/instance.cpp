@@ -0,0 +1,63 @@
+#include "appsrc/include/Math/instance.h"
+
+Instance::Instance(const Hittable *a_pObject, const Transform &a_oObjectToWorld) : m_pObject(a_pObject),
+                                                                                   m_bBounded(false)
+{
+    this->SetTransform(a_oObjectToWorld);
+}
+
+bool Instance::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const
+{
+    Ray _local(this->m_oWorldToObject.Point(a_oRay.m_oOrigin), this->m_oWorldToObject.Vector(a_oRay.m_oDirection), a_oRay.m_fTime);
+
+    if (!this->m_pObject->Hit(_local, a_fTMin, a_fTMax, a_oRecord))
+    {
+        return false;
+    }
+
+    a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_oRecord.m_fT);
+    a_oRecord.m_oNormal = Unit_Vector(this->m_oWorldToObject.TransposedVector(a_oRecord.m_oNormal));
+
+    return true;
+}
+
+bool Instance::Occluded(const Ray &a_oRay, float a_fTMin, float a_fTMax) const
+{
+    Ray _local(this->m_oWorldToObject.Point(a_oRay.m_oOrigin), this->m_oWorldToObject.Vector(a_oRay.m_oDirection), a_oRay.m_fTime);
+
+    return this->m_pObject->Occluded(_local, a_fTMin, a_fTMax);
+}
+
+bool Instance::BoundingBox(Aabb &a_oBox) const
+{
+    a_oBox = this->m_oBox;
+
+    return this->m_bBounded;
+}
+
+void Instance::SetTransform(const Transform &a_oObjectToWorld)
+{
+    this->m_oObjectToWorld = a_oObjectToWorld;
+    this->m_oWorldToObject = a_oObjectToWorld.Inverse();
+
+    Aabb _objectBox;
+
+    this->m_bBounded = this->m_pObject->BoundingBox(_objectBox);
+
+    this->m_oBox = this->m_bBounded ? a_oObjectToWorld.Box(_objectBox) : Aabb();
+}
+
+void Instance::UpdateBounds()
+{
+    this->SetTransform(this->m_oObjectToWorld);
+}
+
+const Transform& Instance::GetTransform() const
+{
+    return this->m_oObjectToWorld;
+}
+
+const Hittable* Instance::GetObject() const
+{
+    return this->m_pObject;
+}
@@ -0,0 +1,133 @@
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/counters.h"
+#include "appsrc/include/Math/sampling.h"
+#include "appsrc/include/Math/vec3a.h"
+
+bool Metal::Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream)
+{
+    Vec3 _fuzz(0.0f, 0.0f, 0.0f);
+
+    if (a_oMaterial.m_fParameter > 0.0f)
+    {
+        float _u;
+        float _v;
+
+        a_oStream.Next2D(_u, _v);
+
+        _fuzz = SampleUniformBall(_u, _v, a_oStream.Next1D());
+    }
+
+#if RT_USE_VEC3A
+    Vec3A _normal(a_oRecord.m_oNormal);
+    Vec3A _unit = NormalizeFast(Vec3A(a_oRayIn.m_oDirection));
+
+    Vec3A _reflected = MulAdd(Vec3A::Splat(-2.0f * Dot(_unit, _normal)), _normal, _unit);
+    Vec3A _direction = MulAdd(Vec3A::Splat(a_oMaterial.m_fParameter), Vec3A(_fuzz), _reflected);
+
+    a_oScatterRay = Ray(a_oRecord.m_oPoint, _direction.ToVec3(), a_oRayIn.m_fTime);
+    a_oAttenuation = a_oMaterial.m_oAlbedo;
+    return (Dot(_direction, _normal) > 0);
+#else
+    Vec3 _reflected = Reflect(Unit_Vector(a_oRayIn.Direction()), a_oRecord.m_oNormal);
+    a_oScatterRay = Ray(a_oRecord.m_oPoint, _reflected + a_oMaterial.m_fParameter * _fuzz, a_oRayIn.m_fTime);
+    a_oAttenuation = a_oMaterial.m_oAlbedo;
+    return (Dot(a_oScatterRay.Direction(), a_oRecord.m_oNormal) > 0);
+#endif
+}
+
+bool Lambertian::Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream)
+{
+    float _u;
+    float _v;
+
+    a_oStream.Next2D(_u, _v);
+
+    // Cosine-weighted directions make the albedo the whole estimator weight.
+    a_oScatterRay = Ray(a_oRecord.m_oPoint, SampleCosineHemisphere(a_oRecord.m_oNormal, _u, _v), a_oRayIn.m_fTime);
+
+    a_oAttenuation = a_oMaterial.m_oAlbedo;
+
+    return true;
+}
+
+bool Dielectric::Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream)
+{
+    float _refIdx = a_oMaterial.m_fParameter;
+
+    Vec3 _outwardNormal;
+
+    Vec3 _reflected = Reflect(a_oRayIn.Direction(), a_oRecord.m_oNormal);
+
+    float _niOverNt;
+
+    a_oAttenuation = Vec3(1.0f, 1.0f, 1.0f);
+
+    Vec3 _refracted(0.0f, 0.0f, 0.0f);
+
+    float _reflectProb;
+
+    float _cosine;
+
+    if (Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) > 0)
+    {
+        _outwardNormal = -a_oRecord.m_oNormal;
+
+        _niOverNt = _refIdx;
+
+        _cosine = Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) / a_oRayIn.Direction().Length();
+
+        _cosine = sqrtf(1.0f - _refIdx * _refIdx * (1.0f - _cosine * _cosine));
+    }
+    else
+    {
+        _outwardNormal = a_oRecord.m_oNormal;
+
+        _niOverNt = 1.0f / _refIdx;
+
+        _cosine = -Dot(a_oRayIn.Direction(), a_oRecord.m_oNormal) / a_oRayIn.Direction().Length();
+    }
+
+    if (Refract(a_oRayIn.Direction(), _outwardNormal, _niOverNt, _refracted))
+    {
+        _reflectProb = Schlick(_cosine, _refIdx);
+    }
+    else
+    {
+        RT_COUNT(COUNTER_DIELECTRIC_TOTAL_INTERNAL_REFLECTIONS, 1);
+
+        _reflectProb = 1.0f;
+    }
+
+    if (a_oStream.Next1D() < _reflectProb)
+    {
+        a_oScatterRay = Ray(a_oRecord.m_oPoint, _reflected, a_oRayIn.m_fTime);
+    }
+    else
+    {
+        a_oScatterRay = Ray(a_oRecord.m_oPoint, _refracted, a_oRayIn.m_fTime);
+    }
+
+    return true;
+}
+
+bool Emissive::Scatter(const Material&, const Ray&, const HitRecord&, Vec3&, Ray&, SampleStream&)
+{
+    return false;
+}
+
+bool Scatter(const Material& a_oMaterial, const Ray &a_oRayIn, const HitRecord &a_oRecord, Vec3 &a_oAttenuation, Ray &a_oScatterRay, SampleStream &a_oStream)
+{
+    switch (a_oMaterial.m_eType)
+    {
+    case MATERIAL_LAMBERTIAN:
+        return Lambertian::Scatter(a_oMaterial, a_oRayIn, a_oRecord, a_oAttenuation, a_oScatterRay, a_oStream);
+    case MATERIAL_METAL:
+        return Metal::Scatter(a_oMaterial, a_oRayIn, a_oRecord, a_oAttenuation, a_oScatterRay, a_oStream);
+    case MATERIAL_DIELECTRIC:
+        return Dielectric::Scatter(a_oMaterial, a_oRayIn, a_oRecord, a_oAttenuation, a_oScatterRay, a_oStream);
+    case MATERIAL_EMISSIVE:
+        return Emissive::Scatter(a_oMaterial, a_oRayIn, a_oRecord, a_oAttenuation, a_oScatterRay, a_oStream);
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,84 @@
+#include "appsrc/include/Math/raypacket.h"
+#include <algorithm>
+
+namespace
+{
+    // Spreads the low 10 bits of a_uValue so that two zero bits separate each of them.
+    uint32_t Part1By2(uint32_t a_uValue)
+    {
+        a_uValue &= 0x000003ff;
+        a_uValue = (a_uValue ^ (a_uValue << 16)) & 0xff0000ff;
+        a_uValue = (a_uValue ^ (a_uValue << 8)) & 0x0300f00f;
+        a_uValue = (a_uValue ^ (a_uValue << 4)) & 0x030c30c3;
+        a_uValue = (a_uValue ^ (a_uValue << 2)) & 0x09249249;
+
+        return a_uValue;
+    }
+
+    uint32_t Quantize(float a_fValue)
+    {
+        // a_fValue is a unit direction component in [-1, 1].
+        float _q = (a_fValue * 0.5f + 0.5f) * 1023.0f;
+
+        _q = _q < 0.0f ? 0.0f : (_q > 1023.0f ? 1023.0f : _q);
+
+        return static_cast<uint32_t>(_q);
+    }
+}
+
+RayPacket::RayPacket() : m_iCount(0)
+{
+}
+
+void RayPacket::Clear()
+{
+    this->m_iCount = 0;
+}
+
+int RayPacket::Add(const Ray &a_oRay)
+{
+    int _lane = this->m_iCount++;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fOrigin[a][_lane] = a_oRay.m_oOrigin[a];
+        this->m_fDirection[a][_lane] = a_oRay.m_oDirection[a];
+    }
+
+    this->m_fTime[_lane] = a_oRay.m_fTime;
+
+    return _lane;
+}
+
+Ray RayPacket::GetRay(int a_iLane) const
+{
+    return Ray(Vec3(this->m_fOrigin[0][a_iLane], this->m_fOrigin[1][a_iLane], this->m_fOrigin[2][a_iLane]),
+               Vec3(this->m_fDirection[0][a_iLane], this->m_fDirection[1][a_iLane], this->m_fDirection[2][a_iLane]),
+               this->m_fTime[a_iLane]);
+}
+
+void SortRayStream(const Ray *a_oRays, int a_iCount, std::vector<int> &a_oOrder)
+{
+    std::vector<uint64_t> _keys(a_iCount);
+
+    for (int i = 0; i < a_iCount; ++i)
+    {
+        Vec3 _dir = Unit_Vector(a_oRays[i].m_oDirection);
+
+        uint64_t _octant = (_dir[0] < 0.0f ? 1u : 0u) | (_dir[1] < 0.0f ? 2u : 0u) | (_dir[2] < 0.0f ? 4u : 0u);
+
+        uint64_t _morton = Part1By2(Quantize(_dir[0])) | (Part1By2(Quantize(_dir[1])) << 1) | (Part1By2(Quantize(_dir[2])) << 2);
+
+        // Index in the low bits keeps the sort stable and the keys unique.
+        _keys[i] = (((_octant << 30) | _morton) << 32) | static_cast<uint32_t>(i);
+    }
+
+    std::sort(_keys.begin(), _keys.end());
+
+    a_oOrder.resize(a_iCount);
+
+    for (int i = 0; i < a_iCount; ++i)
+    {
+        a_oOrder[i] = static_cast<int>(_keys[i] & 0xffffffffu);
+    }
+}
@@ -0,0 +1,430 @@
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Math/hash.h"
+#include "appsrc/include/Math/random.h"
+#include <math.h>
+
+namespace
+{
+    // Energy falloff of the void-and-cluster filter, in pixels.
+    const float s_cfBlueNoiseSigma = 1.5f;
+
+    // Fraction of the mask set in the initial binary pattern.
+    const int s_ciBlueNoiseInitialDivisor = 10;
+
+    // Second Sobol dimension with its digits already reversed, so it can go straight into
+    // LaineKarrasPermutation(). The generator matrix is applied one index byte at a time,
+    // which works because the product is linear over GF(2). The first dimension is
+    // ReverseBits(), i.e. the index itself once reversed.
+    struct SobolTables
+    {
+        SobolTables()
+        {
+            uint32_t _directions[32];
+
+            _directions[0] = 0x80000000u;
+
+            for (int b = 1; b < 32; ++b)
+            {
+                _directions[b] = _directions[b - 1] ^ (_directions[b - 1] >> 1);
+            }
+
+            for (int t = 0; t < 4; ++t)
+            {
+                for (uint32_t v = 0; v < 256; ++v)
+                {
+                    uint32_t _result = 0;
+
+                    for (int b = 0; b < 8; ++b)
+                    {
+                        if (v & (1u << b))
+                        {
+                            _result ^= _directions[t * 8 + b];
+                        }
+                    }
+
+                    m_uTable[t][v] = ReverseBits(_result);
+                }
+            }
+        }
+
+        uint32_t m_uTable[4][256];
+    };
+
+    const SobolTables s_oSobolTables;
+
+    inline uint32_t SobolSecondDimensionReversed(uint32_t a_uIndex)
+    {
+        return s_oSobolTables.m_uTable[0][a_uIndex & 0xffu]
+             ^ s_oSobolTables.m_uTable[1][(a_uIndex >> 8) & 0xffu]
+             ^ s_oSobolTables.m_uTable[2][(a_uIndex >> 16) & 0xffu]
+             ^ s_oSobolTables.m_uTable[3][a_uIndex >> 24];
+    }
+
+    // Owen-scrambled, index-shuffled 2D Sobol point. Scrambling works on reversed digits, so
+    // pairs of ReverseBits() that cancel out are left out.
+    void ScrambledSobol(uint32_t a_uIndex, uint32_t a_uSeed, float& a_fU, float& a_fV)
+    {
+        uint32_t _index = NestedUniformScramble(a_uIndex, a_uSeed);
+
+        a_fU = ToUnitFloat(ReverseBits(LaineKarrasPermutation(_index, HashCombine(a_uSeed, 0u))));
+        a_fV = ToUnitFloat(ReverseBits(LaineKarrasPermutation(SobolSecondDimensionReversed(_index), HashCombine(a_uSeed, 1u))));
+    }
+
+    float ScrambledVanDerCorput(uint32_t a_uIndex, uint32_t a_uSeed)
+    {
+        uint32_t _index = NestedUniformScramble(a_uIndex, a_uSeed);
+
+        return ToUnitFloat(ReverseBits(LaineKarrasPermutation(_index, HashCombine(a_uSeed, 0u))));
+    }
+
+    // Ulichney's void-and-cluster method on a toroidal a_iSize x a_iSize grid (a power of
+    // two). Returns every cell's rank scaled into (0, 1).
+    std::vector<float> BuildBlueNoiseMask(int a_iSize, uint32_t a_uSeed)
+    {
+        const int _count = a_iSize * a_iSize;
+        const int _wrap = a_iSize - 1;
+
+        std::vector<float> _kernel(_count);
+
+        for (int y = 0; y < a_iSize; ++y)
+        {
+            for (int x = 0; x < a_iSize; ++x)
+            {
+                float _dx = float(x < a_iSize - x ? x : a_iSize - x);
+                float _dy = float(y < a_iSize - y ? y : a_iSize - y);
+
+                _kernel[y * a_iSize + x] = expf(-(_dx * _dx + _dy * _dy) / (2.0f * s_cfBlueNoiseSigma * s_cfBlueNoiseSigma));
+            }
+        }
+
+        std::vector<uint8_t> _pattern(_count, 0);
+        std::vector<float> _energy(_count, 0.0f);
+
+        auto _splat = [&](int a_iCell, float a_fSign)
+        {
+            int _cx = a_iCell % a_iSize;
+            int _cy = a_iCell / a_iSize;
+
+            for (int y = 0; y < a_iSize; ++y)
+            {
+                const float* _row = &_kernel[((y - _cy) & _wrap) * a_iSize];
+
+                float* _target = &_energy[y * a_iSize];
+
+                for (int x = 0; x < a_iSize; ++x)
+                {
+                    _target[x] += a_fSign * _row[(x - _cx) & _wrap];
+                }
+            }
+        };
+
+        // Densest set cell when a_uValue is 1, emptiest free cell when it is 0.
+        auto _extreme = [&](uint8_t a_uValue) -> int
+        {
+            int _best = -1;
+
+            for (int c = 0; c < _count; ++c)
+            {
+                if (_pattern[c] != a_uValue)
+                {
+                    continue;
+                }
+
+                if (_best < 0 || (a_uValue ? _energy[c] > _energy[_best] : _energy[c] < _energy[_best]))
+                {
+                    _best = c;
+                }
+            }
+
+            return _best;
+        };
+
+        Rng _rng(a_uSeed, 0x5851f42d4c957f2dULL);
+
+        int _ones = 0;
+
+        while (_ones < _count / s_ciBlueNoiseInitialDivisor)
+        {
+            int _cell = static_cast<int>(_rng.NextUInt() % static_cast<uint32_t>(_count));
+
+            if (!_pattern[_cell])
+            {
+                _pattern[_cell] = 1;
+                _splat(_cell, 1.0f);
+                ++_ones;
+            }
+        }
+
+        // Moves the tightest cluster into the largest void until that no longer changes anything.
+        for (;;)
+        {
+            int _cluster = _extreme(1);
+
+            _pattern[_cluster] = 0;
+            _splat(_cluster, -1.0f);
+
+            int _void = _extreme(0);
+
+            _pattern[_void] = 1;
+            _splat(_void, 1.0f);
+
+            if (_void == _cluster)
+            {
+                break;
+            }
+        }
+
+        std::vector<uint8_t> _prototype = _pattern;
+        std::vector<float> _prototypeEnergy = _energy;
+
+        std::vector<int> _rank(_count, 0);
+
+        // Ranks the initial points by removing clusters first...
+        for (int r = _ones - 1; r >= 0; --r)
+        {
+            int _cluster = _extreme(1);
+
+            _pattern[_cluster] = 0;
+            _splat(_cluster, -1.0f);
+
+            _rank[_cluster] = r;
+        }
+
+        _pattern = _prototype;
+        _energy = _prototypeEnergy;
+
+        // ...then fills the rest void by void. Ulichney switches to the inverted pattern past
+        // half coverage; filling voids throughout is a little noisier at the top ranks only.
+        for (int r = _ones; r < _count; ++r)
+        {
+            int _void = _extreme(0);
+
+            _pattern[_void] = 1;
+            _splat(_void, 1.0f);
+
+            _rank[_void] = r;
+        }
+
+        std::vector<float> _mask(_count);
+
+        for (int c = 0; c < _count; ++c)
+        {
+            _mask[c] = (float(_rank[c]) + 0.5f) / float(_count);
+        }
+
+        return _mask;
+    }
+}
+
+Sampler::Sampler(SamplerType a_eType, uint32_t a_uSeed) : m_uSeed(a_uSeed),
+                                                          m_eType(a_eType)
+{
+}
+
+Sampler::~Sampler()
+{
+}
+
+SamplerType Sampler::GetType() const
+{
+    return this->m_eType;
+}
+
+uint32_t Sampler::GetSeed() const
+{
+    return this->m_uSeed;
+}
+
+std::unique_ptr<Sampler> Sampler::Create(SamplerType a_eType, int a_iSamplesPerPixel, uint32_t a_uSeed)
+{
+    switch (a_eType)
+    {
+    case SAMPLER_STRATIFIED:
+        return std::unique_ptr<Sampler>(new StratifiedSampler(a_iSamplesPerPixel, a_uSeed));
+    case SAMPLER_SOBOL:
+        return std::unique_ptr<Sampler>(new SobolSampler(a_uSeed));
+    case SAMPLER_BLUE_NOISE:
+        return std::unique_ptr<Sampler>(new BlueNoiseSampler(a_uSeed));
+    case SAMPLER_INDEPENDENT:
+    default:
+        return std::unique_ptr<Sampler>(new IndependentSampler(a_uSeed));
+    }
+}
+
+bool Sampler::ParseType(const std::string &a_sName, SamplerType &a_eType)
+{
+    for (int t = 0; t < SAMPLER_TYPE_COUNT; ++t)
+    {
+        if (a_sName == GetTypeName(SamplerType(t)))
+        {
+            a_eType = SamplerType(t);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* Sampler::GetTypeName(SamplerType a_eType)
+{
+    switch (a_eType)
+    {
+    case SAMPLER_INDEPENDENT:
+        return "independent";
+    case SAMPLER_STRATIFIED:
+        return "stratified";
+    case SAMPLER_SOBOL:
+        return "sobol";
+    case SAMPLER_BLUE_NOISE:
+        return "bluenoise";
+    default:
+        return "unknown";
+    }
+}
+
+IndependentSampler::IndependentSampler(uint32_t a_uSeed) : Sampler(SAMPLER_INDEPENDENT, a_uSeed)
+{
+}
+
+float IndependentSampler::Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const
+{
+    float _u;
+    float _v;
+
+    this->Get2D(a_iX, a_iY, a_iSample, a_iDimension, _u, _v);
+
+    return _u;
+}
+
+void IndependentSampler::Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float &a_fU, float &a_fV) const
+{
+    uint64_t _pixel = (static_cast<uint64_t>(static_cast<uint32_t>(a_iY)) << 32) | static_cast<uint32_t>(a_iX);
+    uint64_t _event = (static_cast<uint64_t>(static_cast<uint32_t>(a_iSample)) << 32) | static_cast<uint32_t>(a_iDimension);
+
+    uint64_t _bits = Rng::Mix(_pixel ^ Rng::Mix(_event ^ Rng::Mix(this->m_uSeed)));
+
+    a_fU = ToUnitFloat(static_cast<uint32_t>(_bits));
+    a_fV = ToUnitFloat(static_cast<uint32_t>(_bits >> 32));
+}
+
+StratifiedSampler::StratifiedSampler(int a_iSamplesPerPixel, uint32_t a_uSeed) : Sampler(SAMPLER_STRATIFIED, a_uSeed),
+                                                                                 m_iSamples(a_iSamplesPerPixel > 0 ? a_iSamplesPerPixel : 1)
+{
+    this->m_iColumns = static_cast<int>(sqrtf(float(this->m_iSamples)));
+
+    if (this->m_iColumns < 1)
+    {
+        this->m_iColumns = 1;
+    }
+
+    this->m_iRows = (this->m_iSamples + this->m_iColumns - 1) / this->m_iColumns;
+}
+
+float StratifiedSampler::Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const
+{
+    uint32_t _count = static_cast<uint32_t>(this->m_iSamples);
+    uint32_t _sample = static_cast<uint32_t>(a_iSample);
+
+    // Samples past the stratified budget start a fresh permutation.
+    uint32_t _pattern = PixelSeed(a_iX, a_iY, a_iDimension, this->m_uSeed ^ Hash(_sample / _count));
+
+    _sample %= _count;
+
+    uint32_t _stratum = Permute(_sample, _count, _pattern * 0x68bc21ebu);
+
+    return (float(_stratum) + JitterFloat(_sample, _pattern * 0x967a889bu)) / float(_count);
+}
+
+void StratifiedSampler::Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float &a_fU, float &a_fV) const
+{
+    uint32_t _count = static_cast<uint32_t>(this->m_iSamples);
+    uint32_t _columns = static_cast<uint32_t>(this->m_iColumns);
+    uint32_t _rows = static_cast<uint32_t>(this->m_iRows);
+    uint32_t _sample = static_cast<uint32_t>(a_iSample);
+
+    uint32_t _pattern = PixelSeed(a_iX, a_iY, a_iDimension, this->m_uSeed ^ Hash(_sample / _count));
+
+    _sample = Permute(_sample % _count, _count, _pattern * 0x51633e2du);
+
+    uint32_t _column = _sample % _columns;
+    uint32_t _row = _sample / _columns;
+
+    uint32_t _subColumn = Permute(_column, _columns, _pattern * 0xa511e9b3u);
+    uint32_t _subRow = Permute(_row, _rows, _pattern * 0x63d83595u);
+
+    float _jitterX = JitterFloat(_sample, _pattern * 0xa399d265u);
+    float _jitterY = JitterFloat(_sample, _pattern * 0x711ad6a5u);
+
+    a_fU = (float(_column) + (float(_subRow) + _jitterX) / float(_rows)) / float(_columns);
+    a_fV = (float(_row) + (float(_subColumn) + _jitterY) / float(_columns)) / float(_rows);
+}
+
+int StratifiedSampler::GetSampleCount() const
+{
+    return this->m_iSamples;
+}
+
+int StratifiedSampler::GetColumns() const
+{
+    return this->m_iColumns;
+}
+
+int StratifiedSampler::GetRows() const
+{
+    return this->m_iRows;
+}
+
+SobolSampler::SobolSampler(uint32_t a_uSeed) : Sampler(SAMPLER_SOBOL, a_uSeed)
+{
+}
+
+float SobolSampler::Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const
+{
+    return ScrambledVanDerCorput(static_cast<uint32_t>(a_iSample), PixelSeed(a_iX, a_iY, a_iDimension, this->m_uSeed));
+}
+
+void SobolSampler::Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float &a_fU, float &a_fV) const
+{
+    ScrambledSobol(static_cast<uint32_t>(a_iSample), PixelSeed(a_iX, a_iY, a_iDimension, this->m_uSeed), a_fU, a_fV);
+}
+
+BlueNoiseSampler::BlueNoiseSampler(uint32_t a_uSeed) : Sampler(SAMPLER_BLUE_NOISE, a_uSeed),
+                                                       m_oMask(BuildBlueNoiseMask(MASK_SIZE, a_uSeed))
+{
+}
+
+const std::vector<float>& BlueNoiseSampler::GetMask() const
+{
+    return this->m_oMask;
+}
+
+float BlueNoiseSampler::MaskValue(int a_iX, int a_iY, uint32_t a_uOffset) const
+{
+    // Each dimension reads the mask at its own toroidal offset so dimensions stay uncorrelated.
+    int _x = (a_iX + static_cast<int>(a_uOffset & 0xffffu)) & (MASK_SIZE - 1);
+    int _y = (a_iY + static_cast<int>(a_uOffset >> 16)) & (MASK_SIZE - 1);
+
+    return this->m_oMask[_y * MASK_SIZE + _x];
+}
+
+float BlueNoiseSampler::Get1D(int a_iX, int a_iY, int a_iSample, int a_iDimension) const
+{
+    uint32_t _seed = Hash(this->m_uSeed ^ static_cast<uint32_t>(a_iDimension) * 0x68bc21ebu);
+
+    float _u = ScrambledVanDerCorput(static_cast<uint32_t>(a_iSample), _seed) + this->MaskValue(a_iX, a_iY, Hash(_seed));
+
+    return _u < 1.0f ? _u : _u - 1.0f;
+}
+
+void BlueNoiseSampler::Get2D(int a_iX, int a_iY, int a_iSample, int a_iDimension, float &a_fU, float &a_fV) const
+{
+    uint32_t _seed = Hash(this->m_uSeed ^ static_cast<uint32_t>(a_iDimension) * 0x68bc21ebu);
+
+    ScrambledSobol(static_cast<uint32_t>(a_iSample), _seed, a_fU, a_fV);
+
+    a_fU += this->MaskValue(a_iX, a_iY, Hash(_seed));
+    a_fV += this->MaskValue(a_iX, a_iY, Hash(_seed ^ 0x5bd1e995u));
+
+    a_fU = a_fU < 1.0f ? a_fU : a_fU - 1.0f;
+    a_fV = a_fV < 1.0f ? a_fV : a_fV - 1.0f;
+}
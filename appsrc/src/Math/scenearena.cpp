@@ -0,0 +1,92 @@
+#include "appsrc/include/Math/scenearena.h"
+#include "appsrc/include/Math/simd.h"
+#include <algorithm>
+
+namespace
+{
+    // Blocks start on a cache line.
+    const size_t s_cuBlockAlignment = 64;
+}
+
+SceneArena::SceneArena(size_t a_uBlockSize) : m_uBlockSize(std::max<size_t>(a_uBlockSize, s_cuBlockAlignment)),
+                                              m_uOffset(0),
+                                              m_uBytesUsed(0)
+{
+}
+
+SceneArena::~SceneArena()
+{
+    this->Release();
+}
+
+void* SceneArena::Allocate(size_t a_uSize, size_t a_uAlignment)
+{
+    if (!this->m_oBlocks.empty())
+    {
+        const Block& _block = this->m_oBlocks.back();
+
+        size_t _start = (this->m_uOffset + a_uAlignment - 1) & ~(a_uAlignment - 1);
+
+        if (_start + a_uSize <= _block.m_uSize)
+        {
+            this->m_uOffset = _start + a_uSize;
+            this->m_uBytesUsed += a_uSize;
+
+            return _block.m_pData + _start;
+        }
+    }
+
+    // Oversized requests get a block of their own.
+    Block _block;
+    _block.m_uSize = std::max(this->m_uBlockSize, a_uSize);
+    _block.m_pData = static_cast<char*>(AlignedAlloc(_block.m_uSize, s_cuBlockAlignment));
+
+    if (_block.m_pData == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    this->m_oBlocks.push_back(_block);
+
+    this->m_uOffset = a_uSize;
+    this->m_uBytesUsed += a_uSize;
+
+    return _block.m_pData;
+}
+
+void SceneArena::Release()
+{
+    for (size_t i = this->m_oDestructors.size(); i-- > 0;)
+    {
+        this->m_oDestructors[i].m_pDestroy(this->m_oDestructors[i].m_pObject);
+    }
+
+    this->m_oDestructors.clear();
+
+    for (size_t b = 0; b < this->m_oBlocks.size(); ++b)
+    {
+        AlignedFree(this->m_oBlocks[b].m_pData);
+    }
+
+    this->m_oBlocks.clear();
+
+    this->m_oMaterials.Clear();
+
+    this->m_uOffset = 0;
+    this->m_uBytesUsed = 0;
+}
+
+const MaterialTable& SceneArena::GetMaterials() const
+{
+    return this->m_oMaterials;
+}
+
+size_t SceneArena::GetBytesUsed() const
+{
+    return this->m_uBytesUsed;
+}
+
+size_t SceneArena::GetBlockCount() const
+{
+    return this->m_oBlocks.size();
+}
@@ -0,0 +1,142 @@
+#include "appsrc/include/Math/simd.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(RT_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+#if defined(RT_SIMD_X86) && defined(_MSC_VER)
+    bool OsSavesAvxState(unsigned long long a_uMask)
+    {
+        return (_xgetbv(0) & a_uMask) == a_uMask;
+    }
+#endif
+}
+
+SimdIsa DetectSimdIsa()
+{
+#if defined(RT_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return SIMD_ISA_AVX512;
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SIMD_ISA_AVX2;
+    }
+
+    return SIMD_ISA_SSE2;
+#elif defined(RT_SIMD_X86) && defined(_MSC_VER)
+    int _info[4];
+
+    __cpuid(_info, 1);
+
+    bool _osxsave = (_info[2] & (1 << 27)) != 0;
+
+    __cpuidex(_info, 7, 0);
+
+    bool _avx2 = (_info[1] & (1 << 5)) != 0;
+    bool _avx512 = (_info[1] & (1 << 16)) != 0;
+
+    if (_osxsave && _avx512 && OsSavesAvxState(0xe6))
+    {
+        return SIMD_ISA_AVX512;
+    }
+
+    if (_osxsave && _avx2 && OsSavesAvxState(0x6))
+    {
+        return SIMD_ISA_AVX2;
+    }
+
+    return SIMD_ISA_SSE2;
+#else
+    return SIMD_ISA_SCALAR;
+#endif
+}
+
+SimdIsa GetActiveSimdIsa()
+{
+    static const SimdIsa s_eIsa = []()
+    {
+        SimdIsa _isa = DetectSimdIsa();
+
+        const char* _override = getenv("RT_SIMD_ISA");
+
+        if (_override != nullptr)
+        {
+            for (int i = SIMD_ISA_SCALAR; i <= _isa; ++i)
+            {
+                if (strcmp(_override, SimdIsaName(static_cast<SimdIsa>(i))) == 0)
+                {
+                    return static_cast<SimdIsa>(i);
+                }
+            }
+        }
+
+        return _isa;
+    }();
+
+    return s_eIsa;
+}
+
+const char* SimdIsaName(SimdIsa a_eIsa)
+{
+    switch (a_eIsa)
+    {
+    case SIMD_ISA_SSE2:
+        return "sse2";
+    case SIMD_ISA_AVX2:
+        return "avx2";
+    case SIMD_ISA_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+int SimdIsaWidth(SimdIsa a_eIsa)
+{
+    switch (a_eIsa)
+    {
+    case SIMD_ISA_SSE2:
+        return 4;
+    case SIMD_ISA_AVX2:
+        return 8;
+    case SIMD_ISA_AVX512:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+void* AlignedAlloc(size_t a_uSize, size_t a_uAlignment)
+{
+    // Over-allocate and keep the original pointer just below the aligned block.
+    void* _raw = malloc(a_uSize + a_uAlignment + sizeof(void*));
+
+    if (_raw == nullptr)
+    {
+        return nullptr;
+    }
+
+    uintptr_t _aligned = (reinterpret_cast<uintptr_t>(_raw) + sizeof(void*) + a_uAlignment - 1) & ~(static_cast<uintptr_t>(a_uAlignment) - 1);
+
+    reinterpret_cast<void**>(_aligned)[-1] = _raw;
+
+    return reinterpret_cast<void*>(_aligned);
+}
+
+void AlignedFree(void* a_pMemory)
+{
+    if (a_pMemory != nullptr)
+    {
+        free(reinterpret_cast<void**>(a_pMemory)[-1]);
+    }
+}
@@ -1,24 +1,54 @@
 #include "appsrc/include/Math/sphere.h"
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/vec3a.h"
+
+namespace
+{
+    inline void FillHit(const Ray& a_oRay, float a_fT, const Vec3& a_oCenter, float a_fRadius, HitRecord& a_oRecord)
+    {
+        a_oRecord.m_fT = a_fT;
+#if RT_USE_VEC3A
+        Vec3A _center(a_oCenter);
+        Vec3A _point = MulAdd(Vec3A::Splat(a_fT), Vec3A(a_oRay.m_oDirection), Vec3A(a_oRay.m_oOrigin));
+
+        a_oRecord.m_oPoint = _point.ToVec3();
+        a_oRecord.m_oNormal = ((_point - _center) * (1.0f / a_fRadius)).ToVec3();
+#else
+        a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_fT);
+        a_oRecord.m_oNormal = (a_oRecord.m_oPoint - a_oCenter) / a_fRadius;
+#endif
+    }
+}
 
 Sphere::Sphere() : m_oCenter(Vec3()),
-                   m_fRadius(NULL)
+                   m_fRadius(NULL),
+                   m_uMaterialId(INVALID_MATERIAL_ID)
 {
 }
 
-Sphere::Sphere(Vec3 a_oCenter, float a_fRadius, Material* a_oMaterial)
+Sphere::Sphere(Vec3 a_oCenter, float a_fRadius, const Material* a_oMaterial)
     : m_oCenter(a_oCenter),
       m_fRadius(a_fRadius),
-      m_oMaterial(a_oMaterial)
+      m_uMaterialId(a_oMaterial != nullptr ? a_oMaterial->m_uId : INVALID_MATERIAL_ID)
 {
 }
 
 bool Sphere::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const
 {
+#if RT_USE_VEC3A
+    Vec3A _direction(a_oRay.m_oDirection);
+    Vec3A _oc = Vec3A(a_oRay.m_oOrigin) - Vec3A(this->m_oCenter);
+
+    float _a = Dot(_direction, _direction);
+
+    float _b = Dot(_oc, _direction);
+#else
     Vec3 _oc = a_oRay.Origin() - this->m_oCenter;
 
     float _a = Dot(a_oRay.Direction(), a_oRay.Direction());
 
     float _b = Dot(_oc, a_oRay.Direction());
+#endif
 
     float _c = Dot(_oc, _oc) - m_fRadius * m_fRadius;
 
@@ -30,10 +60,8 @@ bool Sphere::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_o
 
         if (_temp < a_fTMax && _temp > a_fTMin)
         {
-            a_oRecord.m_fT = _temp;
-            a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_oRecord.m_fT);
-            a_oRecord.m_oNormal = (a_oRecord.m_oPoint - m_oCenter) / m_fRadius;
-            a_oRecord.m_oMaterial = m_oMaterial;
+            FillHit(a_oRay, _temp, this->m_oCenter, this->m_fRadius, a_oRecord);
+            a_oRecord.m_uMaterialId = m_uMaterialId;
             return true;
         }
 
@@ -41,12 +69,19 @@ bool Sphere::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_o
 
         if (_temp < a_fTMax && _temp > a_fTMin)
         {
-            a_oRecord.m_fT = _temp;
-            a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_oRecord.m_fT);
-            a_oRecord.m_oNormal = (a_oRecord.m_oPoint - m_oCenter) / m_fRadius;
-            a_oRecord.m_oMaterial = m_oMaterial;
+            FillHit(a_oRay, _temp, this->m_oCenter, this->m_fRadius, a_oRecord);
+            a_oRecord.m_uMaterialId = m_uMaterialId;
             return true;
         }
     }
     return false;
 }
+
+bool Sphere::BoundingBox(Aabb &a_oBox) const
+{
+    float _r = fabsf(this->m_fRadius);
+
+    a_oBox = Aabb(this->m_oCenter - Vec3(_r, _r, _r), this->m_oCenter + Vec3(_r, _r, _r));
+
+    return true;
+}
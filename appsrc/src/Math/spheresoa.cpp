@@ -0,0 +1,763 @@
+#include "appsrc/include/Math/spheresoa.h"
+#include "appsrc/include/Math/vec3a.h"
+#include <algorithm>
+#include <float.h>
+#include <limits>
+#include <string.h>
+
+#if defined(RT_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const int s_ciPadding = SphereSoA::PADDING;
+
+    const size_t s_cuAlignment = 64;
+
+    typedef bool (*IntersectKernel)(const SphereSoA&, const SphereRay&, int, int, float, float&, int&);
+
+    // MOVING kernels place every centre at the ray's time; the static ones skip the velocity loads.
+    template <bool MOVING>
+    bool IntersectScalar(const SphereSoA& a_oSpheres, const SphereRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        bool _hit = false;
+
+        for (int i = a_iBegin; i < a_iEnd; ++i)
+        {
+            float _cx = a_oSpheres.m_pCenterX[i];
+            float _cy = a_oSpheres.m_pCenterY[i];
+            float _cz = a_oSpheres.m_pCenterZ[i];
+
+            if (MOVING)
+            {
+                _cx += a_oRay.m_fTime * a_oSpheres.m_pVelocityX[i];
+                _cy += a_oRay.m_fTime * a_oSpheres.m_pVelocityY[i];
+                _cz += a_oRay.m_fTime * a_oSpheres.m_pVelocityZ[i];
+            }
+
+            float _ocx = a_oRay.m_fOrigin[0] - _cx;
+            float _ocy = a_oRay.m_fOrigin[1] - _cy;
+            float _ocz = a_oRay.m_fOrigin[2] - _cz;
+
+            float _b = (_ocx * a_oRay.m_fDirection[0]) + (_ocy * a_oRay.m_fDirection[1]) + (_ocz * a_oRay.m_fDirection[2]);
+            float _c = ((_ocx * _ocx) + (_ocy * _ocy) + (_ocz * _ocz)) - a_oSpheres.m_pRadius[i] * a_oSpheres.m_pRadius[i];
+
+            float _desc = _b * _b - a_oRay.m_fA * _c;
+
+            if (_desc > 0.0f)
+            {
+                float _sq = sqrtf(_desc);
+
+                float _temp = (-_b - _sq) / a_oRay.m_fA;
+
+                if (!(_temp < a_fTMax && _temp > a_fTMin))
+                {
+                    _temp = (-_b + _sq) / a_oRay.m_fA;
+                }
+
+                if (_temp < a_fTMax && _temp > a_fTMin)
+                {
+                    a_fTMax = _temp;
+                    a_iIndex = i;
+                    _hit = true;
+                }
+            }
+        }
+
+        return _hit;
+    }
+
+    // Picks the lowest-t lane, preferring the lowest sphere index on ties like the scalar loop.
+    bool ReduceLanes(const float* a_fBest, const int* a_iBestIndex, int a_iWidth, float& a_fTMax, int& a_iIndex)
+    {
+        bool _hit = false;
+
+        for (int l = 0; l < a_iWidth; ++l)
+        {
+            if (a_iBestIndex[l] < 0)
+            {
+                continue;
+            }
+
+            if (a_fBest[l] < a_fTMax || (_hit && a_fBest[l] == a_fTMax && a_iBestIndex[l] < a_iIndex))
+            {
+                a_fTMax = a_fBest[l];
+                a_iIndex = a_iBestIndex[l];
+                _hit = true;
+            }
+        }
+
+        return _hit;
+    }
+
+#if defined(RT_SIMD_X86)
+    template <bool MOVING>
+    bool IntersectSse2(const SphereSoA& a_oSpheres, const SphereRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const __m128 _ox = _mm_set1_ps(a_oRay.m_fOrigin[0]);
+        const __m128 _oy = _mm_set1_ps(a_oRay.m_fOrigin[1]);
+        const __m128 _oz = _mm_set1_ps(a_oRay.m_fOrigin[2]);
+        const __m128 _dx = _mm_set1_ps(a_oRay.m_fDirection[0]);
+        const __m128 _dy = _mm_set1_ps(a_oRay.m_fDirection[1]);
+        const __m128 _dz = _mm_set1_ps(a_oRay.m_fDirection[2]);
+        const __m128 _a = _mm_set1_ps(a_oRay.m_fA);
+        const __m128 _time = _mm_set1_ps(a_oRay.m_fTime);
+        const __m128 _tMin = _mm_set1_ps(a_fTMin);
+        const __m128 _sign = _mm_set1_ps(-0.0f);
+        const __m128 _zero = _mm_setzero_ps();
+        const __m128i _lane = _mm_setr_epi32(0, 1, 2, 3);
+        const __m128i _end = _mm_set1_epi32(a_iEnd);
+
+        __m128 _best = _mm_set1_ps(a_fTMax);
+        __m128i _bestIndex = _mm_set1_epi32(-1);
+
+        for (int i = a_iBegin; i < a_iEnd; i += 4)
+        {
+            __m128i _index = _mm_add_epi32(_mm_set1_epi32(i), _lane);
+            __m128 _valid = _mm_castsi128_ps(_mm_cmpgt_epi32(_end, _index));
+
+            __m128 _cx = _mm_loadu_ps(a_oSpheres.m_pCenterX + i);
+            __m128 _cy = _mm_loadu_ps(a_oSpheres.m_pCenterY + i);
+            __m128 _cz = _mm_loadu_ps(a_oSpheres.m_pCenterZ + i);
+
+            if (MOVING)
+            {
+                _cx = _mm_add_ps(_cx, _mm_mul_ps(_time, _mm_loadu_ps(a_oSpheres.m_pVelocityX + i)));
+                _cy = _mm_add_ps(_cy, _mm_mul_ps(_time, _mm_loadu_ps(a_oSpheres.m_pVelocityY + i)));
+                _cz = _mm_add_ps(_cz, _mm_mul_ps(_time, _mm_loadu_ps(a_oSpheres.m_pVelocityZ + i)));
+            }
+
+            __m128 _ocx = _mm_sub_ps(_ox, _cx);
+            __m128 _ocy = _mm_sub_ps(_oy, _cy);
+            __m128 _ocz = _mm_sub_ps(_oz, _cz);
+            __m128 _r = _mm_loadu_ps(a_oSpheres.m_pRadius + i);
+
+            __m128 _b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_ocx, _dx), _mm_mul_ps(_ocy, _dy)), _mm_mul_ps(_ocz, _dz));
+            __m128 _c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_ocx, _ocx), _mm_mul_ps(_ocy, _ocy)), _mm_mul_ps(_ocz, _ocz)), _mm_mul_ps(_r, _r));
+            __m128 _desc = _mm_sub_ps(_mm_mul_ps(_b, _b), _mm_mul_ps(_a, _c));
+
+            __m128 _candidate = _mm_and_ps(_mm_cmpgt_ps(_desc, _zero), _valid);
+
+            if (_mm_movemask_ps(_candidate) == 0)
+            {
+                continue;
+            }
+
+            __m128 _sq = _mm_sqrt_ps(_desc);
+            __m128 _negB = _mm_xor_ps(_b, _sign);
+
+            __m128 _t0 = _mm_div_ps(_mm_sub_ps(_negB, _sq), _a);
+            __m128 _t1 = _mm_div_ps(_mm_add_ps(_negB, _sq), _a);
+
+            __m128 _in0 = _mm_and_ps(_mm_cmplt_ps(_t0, _best), _mm_cmpgt_ps(_t0, _tMin));
+            __m128 _in1 = _mm_and_ps(_mm_cmplt_ps(_t1, _best), _mm_cmpgt_ps(_t1, _tMin));
+
+            __m128 _t = _mm_or_ps(_mm_and_ps(_in0, _t0), _mm_andnot_ps(_in0, _t1));
+            __m128 _take = _mm_and_ps(_mm_or_ps(_in0, _in1), _candidate);
+
+            _best = _mm_or_ps(_mm_and_ps(_take, _t), _mm_andnot_ps(_take, _best));
+            _bestIndex = _mm_or_si128(_mm_and_si128(_mm_castps_si128(_take), _index), _mm_andnot_si128(_mm_castps_si128(_take), _bestIndex));
+        }
+
+        float _bestLanes[4];
+        int _indexLanes[4];
+
+        _mm_storeu_ps(_bestLanes, _best);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_indexLanes), _bestIndex);
+
+        return ReduceLanes(_bestLanes, _indexLanes, 4, a_fTMax, a_iIndex);
+    }
+
+    template <bool MOVING>
+    RT_TARGET_AVX2 bool IntersectAvx2(const SphereSoA& a_oSpheres, const SphereRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const __m256 _ox = _mm256_set1_ps(a_oRay.m_fOrigin[0]);
+        const __m256 _oy = _mm256_set1_ps(a_oRay.m_fOrigin[1]);
+        const __m256 _oz = _mm256_set1_ps(a_oRay.m_fOrigin[2]);
+        const __m256 _dx = _mm256_set1_ps(a_oRay.m_fDirection[0]);
+        const __m256 _dy = _mm256_set1_ps(a_oRay.m_fDirection[1]);
+        const __m256 _dz = _mm256_set1_ps(a_oRay.m_fDirection[2]);
+        const __m256 _a = _mm256_set1_ps(a_oRay.m_fA);
+        const __m256 _time = _mm256_set1_ps(a_oRay.m_fTime);
+        const __m256 _tMin = _mm256_set1_ps(a_fTMin);
+        const __m256 _sign = _mm256_set1_ps(-0.0f);
+        const __m256 _zero = _mm256_setzero_ps();
+        const __m256i _lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i _end = _mm256_set1_epi32(a_iEnd);
+
+        __m256 _best = _mm256_set1_ps(a_fTMax);
+        __m256i _bestIndex = _mm256_set1_epi32(-1);
+
+        for (int i = a_iBegin; i < a_iEnd; i += 8)
+        {
+            __m256i _index = _mm256_add_epi32(_mm256_set1_epi32(i), _lane);
+            __m256 _valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_end, _index));
+
+            __m256 _cx = _mm256_loadu_ps(a_oSpheres.m_pCenterX + i);
+            __m256 _cy = _mm256_loadu_ps(a_oSpheres.m_pCenterY + i);
+            __m256 _cz = _mm256_loadu_ps(a_oSpheres.m_pCenterZ + i);
+
+            if (MOVING)
+            {
+                _cx = _mm256_add_ps(_cx, _mm256_mul_ps(_time, _mm256_loadu_ps(a_oSpheres.m_pVelocityX + i)));
+                _cy = _mm256_add_ps(_cy, _mm256_mul_ps(_time, _mm256_loadu_ps(a_oSpheres.m_pVelocityY + i)));
+                _cz = _mm256_add_ps(_cz, _mm256_mul_ps(_time, _mm256_loadu_ps(a_oSpheres.m_pVelocityZ + i)));
+            }
+
+            __m256 _ocx = _mm256_sub_ps(_ox, _cx);
+            __m256 _ocy = _mm256_sub_ps(_oy, _cy);
+            __m256 _ocz = _mm256_sub_ps(_oz, _cz);
+            __m256 _r = _mm256_loadu_ps(a_oSpheres.m_pRadius + i);
+
+            __m256 _b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_ocx, _dx), _mm256_mul_ps(_ocy, _dy)), _mm256_mul_ps(_ocz, _dz));
+            __m256 _c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_ocx, _ocx), _mm256_mul_ps(_ocy, _ocy)), _mm256_mul_ps(_ocz, _ocz)), _mm256_mul_ps(_r, _r));
+            __m256 _desc = _mm256_sub_ps(_mm256_mul_ps(_b, _b), _mm256_mul_ps(_a, _c));
+
+            __m256 _candidate = _mm256_and_ps(_mm256_cmp_ps(_desc, _zero, _CMP_GT_OQ), _valid);
+
+            if (_mm256_movemask_ps(_candidate) == 0)
+            {
+                continue;
+            }
+
+            __m256 _sq = _mm256_sqrt_ps(_desc);
+            __m256 _negB = _mm256_xor_ps(_b, _sign);
+
+            __m256 _t0 = _mm256_div_ps(_mm256_sub_ps(_negB, _sq), _a);
+            __m256 _t1 = _mm256_div_ps(_mm256_add_ps(_negB, _sq), _a);
+
+            __m256 _in0 = _mm256_and_ps(_mm256_cmp_ps(_t0, _best, _CMP_LT_OQ), _mm256_cmp_ps(_t0, _tMin, _CMP_GT_OQ));
+            __m256 _in1 = _mm256_and_ps(_mm256_cmp_ps(_t1, _best, _CMP_LT_OQ), _mm256_cmp_ps(_t1, _tMin, _CMP_GT_OQ));
+
+            __m256 _t = _mm256_blendv_ps(_t1, _t0, _in0);
+            __m256 _take = _mm256_and_ps(_mm256_or_ps(_in0, _in1), _candidate);
+
+            _best = _mm256_blendv_ps(_best, _t, _take);
+            _bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_bestIndex), _mm256_castsi256_ps(_index), _take));
+        }
+
+        float _bestLanes[8];
+        int _indexLanes[8];
+
+        _mm256_storeu_ps(_bestLanes, _best);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_indexLanes), _bestIndex);
+
+        return ReduceLanes(_bestLanes, _indexLanes, 8, a_fTMax, a_iIndex);
+    }
+
+    template <bool MOVING>
+    RT_TARGET_AVX512 bool IntersectAvx512(const SphereSoA& a_oSpheres, const SphereRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const __m512 _ox = _mm512_set1_ps(a_oRay.m_fOrigin[0]);
+        const __m512 _oy = _mm512_set1_ps(a_oRay.m_fOrigin[1]);
+        const __m512 _oz = _mm512_set1_ps(a_oRay.m_fOrigin[2]);
+        const __m512 _dx = _mm512_set1_ps(a_oRay.m_fDirection[0]);
+        const __m512 _dy = _mm512_set1_ps(a_oRay.m_fDirection[1]);
+        const __m512 _dz = _mm512_set1_ps(a_oRay.m_fDirection[2]);
+        const __m512 _a = _mm512_set1_ps(a_oRay.m_fA);
+        const __m512 _time = _mm512_set1_ps(a_oRay.m_fTime);
+        const __m512 _tMin = _mm512_set1_ps(a_fTMin);
+        const __m512i _sign = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+        const __m512 _zero = _mm512_setzero_ps();
+        const __m512i _lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m512i _end = _mm512_set1_epi32(a_iEnd);
+
+        __m512 _best = _mm512_set1_ps(a_fTMax);
+        __m512i _bestIndex = _mm512_set1_epi32(-1);
+
+        for (int i = a_iBegin; i < a_iEnd; i += 16)
+        {
+            __m512i _index = _mm512_add_epi32(_mm512_set1_epi32(i), _lane);
+            __mmask16 _valid = _mm512_cmplt_epi32_mask(_index, _end);
+
+            __m512 _cx = _mm512_loadu_ps(a_oSpheres.m_pCenterX + i);
+            __m512 _cy = _mm512_loadu_ps(a_oSpheres.m_pCenterY + i);
+            __m512 _cz = _mm512_loadu_ps(a_oSpheres.m_pCenterZ + i);
+
+            if (MOVING)
+            {
+                _cx = _mm512_add_ps(_cx, _mm512_mul_ps(_time, _mm512_loadu_ps(a_oSpheres.m_pVelocityX + i)));
+                _cy = _mm512_add_ps(_cy, _mm512_mul_ps(_time, _mm512_loadu_ps(a_oSpheres.m_pVelocityY + i)));
+                _cz = _mm512_add_ps(_cz, _mm512_mul_ps(_time, _mm512_loadu_ps(a_oSpheres.m_pVelocityZ + i)));
+            }
+
+            __m512 _ocx = _mm512_sub_ps(_ox, _cx);
+            __m512 _ocy = _mm512_sub_ps(_oy, _cy);
+            __m512 _ocz = _mm512_sub_ps(_oz, _cz);
+            __m512 _r = _mm512_loadu_ps(a_oSpheres.m_pRadius + i);
+
+            __m512 _b = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_ocx, _dx), _mm512_mul_ps(_ocy, _dy)), _mm512_mul_ps(_ocz, _dz));
+            __m512 _c = _mm512_sub_ps(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_ocx, _ocx), _mm512_mul_ps(_ocy, _ocy)), _mm512_mul_ps(_ocz, _ocz)), _mm512_mul_ps(_r, _r));
+            __m512 _desc = _mm512_sub_ps(_mm512_mul_ps(_b, _b), _mm512_mul_ps(_a, _c));
+
+            __mmask16 _candidate = _mm512_mask_cmp_ps_mask(_valid, _desc, _zero, _CMP_GT_OQ);
+
+            if (_candidate == 0)
+            {
+                continue;
+            }
+
+            __m512 _sq = _mm512_maskz_sqrt_ps(_candidate, _desc);
+            __m512 _negB = _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(_b), _sign));
+
+            __m512 _t0 = _mm512_div_ps(_mm512_sub_ps(_negB, _sq), _a);
+            __m512 _t1 = _mm512_div_ps(_mm512_add_ps(_negB, _sq), _a);
+
+            __mmask16 _in0 = _mm512_cmp_ps_mask(_t0, _best, _CMP_LT_OQ) & _mm512_cmp_ps_mask(_t0, _tMin, _CMP_GT_OQ);
+            __mmask16 _in1 = _mm512_cmp_ps_mask(_t1, _best, _CMP_LT_OQ) & _mm512_cmp_ps_mask(_t1, _tMin, _CMP_GT_OQ);
+
+            __m512 _t = _mm512_mask_blend_ps(_in0, _t1, _t0);
+            __mmask16 _take = (_in0 | _in1) & _candidate;
+
+            _best = _mm512_mask_blend_ps(_take, _best, _t);
+            _bestIndex = _mm512_mask_blend_epi32(_take, _bestIndex, _index);
+        }
+
+        float _bestLanes[16];
+        int _indexLanes[16];
+
+        _mm512_storeu_ps(_bestLanes, _best);
+        _mm512_storeu_si512(_indexLanes, _bestIndex);
+
+        return ReduceLanes(_bestLanes, _indexLanes, 16, a_fTMax, a_iIndex);
+    }
+#endif
+
+    template <bool MOVING>
+    IntersectKernel SelectKernel()
+    {
+        switch (SphereSoA::GetIsa())
+        {
+#if defined(RT_SIMD_X86)
+        case SIMD_ISA_AVX512:
+            return &IntersectAvx512<MOVING>;
+        case SIMD_ISA_AVX2:
+            return &IntersectAvx2<MOVING>;
+        case SIMD_ISA_SSE2:
+            return &IntersectSse2<MOVING>;
+#endif
+        default:
+            return &IntersectScalar<MOVING>;
+        }
+    }
+
+    const IntersectKernel s_pIntersect = SelectKernel<false>();
+
+    const IntersectKernel s_pIntersectMoving = SelectKernel<true>();
+
+    float* AllocateVelocity(size_t a_uFloats)
+    {
+        float* _array = static_cast<float*>(AlignedAlloc(a_uFloats * sizeof(float), s_cuAlignment));
+
+        std::fill(_array, _array + a_uFloats, 0.0f);
+
+        return _array;
+    }
+}
+
+SphereRay::SphereRay(const Ray &a_oRay)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fOrigin[a] = a_oRay.m_oOrigin[a];
+        this->m_fDirection[a] = a_oRay.m_oDirection[a];
+    }
+
+    this->m_fA = Dot(a_oRay.m_oDirection, a_oRay.m_oDirection);
+
+    this->m_fTime = a_oRay.m_fTime;
+}
+
+SphereSoA::SphereSoA() : m_pCenterX(nullptr),
+                         m_pCenterY(nullptr),
+                         m_pCenterZ(nullptr),
+                         m_pRadius(nullptr),
+                         m_pMaterialId(nullptr),
+                         m_pVelocityX(nullptr),
+                         m_pVelocityY(nullptr),
+                         m_pVelocityZ(nullptr),
+                         m_iCount(0),
+                         m_iCapacity(0),
+                         m_bOwner(true)
+{
+}
+
+SphereSoA::SphereSoA(const HittableList &a_oList) : SphereSoA()
+{
+    this->Reserve(a_oList.m_iListSize);
+
+    for (int i = 0; i < a_oList.m_iListSize; ++i)
+    {
+        const Sphere* _sphere = dynamic_cast<const Sphere*>(a_oList.m_oList[i]);
+
+        if (_sphere != nullptr)
+        {
+            this->Add(_sphere->m_oCenter, _sphere->m_fRadius, _sphere->m_uMaterialId);
+        }
+    }
+}
+
+SphereSoA::SphereSoA(const SphereSoA &a_oOther) : SphereSoA()
+{
+    *this = a_oOther;
+}
+
+SphereSoA& SphereSoA::operator=(const SphereSoA &a_oOther)
+{
+    if (this != &a_oOther)
+    {
+        this->Clear();
+        this->Reserve(a_oOther.m_iCount);
+
+        size_t _bytes = a_oOther.m_iCount * sizeof(float);
+
+        if (_bytes > 0)
+        {
+            memcpy(this->m_pCenterX, a_oOther.m_pCenterX, _bytes);
+            memcpy(this->m_pCenterY, a_oOther.m_pCenterY, _bytes);
+            memcpy(this->m_pCenterZ, a_oOther.m_pCenterZ, _bytes);
+            memcpy(this->m_pRadius, a_oOther.m_pRadius, _bytes);
+            memcpy(this->m_pMaterialId, a_oOther.m_pMaterialId, a_oOther.m_iCount * sizeof(MaterialId));
+        }
+
+        this->m_iCount = a_oOther.m_iCount;
+
+        if (a_oOther.HasMotion())
+        {
+            for (int i = 0; i < a_oOther.m_iCount; ++i)
+            {
+                this->SetVelocity(i, a_oOther.GetVelocity(i));
+            }
+        }
+    }
+
+    return *this;
+}
+
+SphereSoA::~SphereSoA()
+{
+    this->Release();
+}
+
+void SphereSoA::Release()
+{
+    if (this->m_bOwner)
+    {
+        AlignedFree(this->m_pCenterX);
+        AlignedFree(this->m_pCenterY);
+        AlignedFree(this->m_pCenterZ);
+        AlignedFree(this->m_pRadius);
+        AlignedFree(this->m_pMaterialId);
+    }
+
+    this->ReleaseVelocity();
+
+    this->m_pCenterX = nullptr;
+    this->m_pCenterY = nullptr;
+    this->m_pCenterZ = nullptr;
+    this->m_pRadius = nullptr;
+    this->m_pMaterialId = nullptr;
+
+    this->m_iCount = 0;
+    this->m_iCapacity = 0;
+    this->m_bOwner = true;
+}
+
+void SphereSoA::ReleaseVelocity()
+{
+    AlignedFree(this->m_pVelocityX);
+    AlignedFree(this->m_pVelocityY);
+    AlignedFree(this->m_pVelocityZ);
+
+    this->m_pVelocityX = nullptr;
+    this->m_pVelocityY = nullptr;
+    this->m_pVelocityZ = nullptr;
+}
+
+void SphereSoA::Reserve(int a_iCapacity)
+{
+    if (a_iCapacity <= this->m_iCapacity)
+    {
+        return;
+    }
+
+    int _capacity = (a_iCapacity + s_ciPadding - 1) / s_ciPadding * s_ciPadding;
+    size_t _floats = _capacity + s_ciPadding;
+
+    float* _arrays[4];
+
+    for (int k = 0; k < 4; ++k)
+    {
+        _arrays[k] = static_cast<float*>(AlignedAlloc(_floats * sizeof(float), s_cuAlignment));
+
+        std::fill(_arrays[k], _arrays[k] + _floats, std::numeric_limits<float>::quiet_NaN());
+    }
+
+    MaterialId* _ids = static_cast<MaterialId*>(AlignedAlloc(_floats * sizeof(MaterialId), s_cuAlignment));
+
+    std::fill(_ids, _ids + _floats, 0u);
+
+    if (this->m_iCount > 0)
+    {
+        memcpy(_arrays[0], this->m_pCenterX, this->m_iCount * sizeof(float));
+        memcpy(_arrays[1], this->m_pCenterY, this->m_iCount * sizeof(float));
+        memcpy(_arrays[2], this->m_pCenterZ, this->m_iCount * sizeof(float));
+        memcpy(_arrays[3], this->m_pRadius, this->m_iCount * sizeof(float));
+        memcpy(_ids, this->m_pMaterialId, this->m_iCount * sizeof(MaterialId));
+    }
+
+    float* _velocity[3] = { nullptr, nullptr, nullptr };
+
+    if (this->HasMotion())
+    {
+        const float* _old[3] = { this->m_pVelocityX, this->m_pVelocityY, this->m_pVelocityZ };
+
+        for (int k = 0; k < 3; ++k)
+        {
+            _velocity[k] = AllocateVelocity(_floats);
+
+            memcpy(_velocity[k], _old[k], this->m_iCount * sizeof(float));
+        }
+    }
+
+    int _count = this->m_iCount;
+
+    this->Release();
+
+    this->m_pVelocityX = _velocity[0];
+    this->m_pVelocityY = _velocity[1];
+    this->m_pVelocityZ = _velocity[2];
+
+    this->m_pCenterX = _arrays[0];
+    this->m_pCenterY = _arrays[1];
+    this->m_pCenterZ = _arrays[2];
+    this->m_pRadius = _arrays[3];
+    this->m_pMaterialId = _ids;
+
+    this->m_iCount = _count;
+    this->m_iCapacity = _capacity;
+}
+
+void SphereSoA::Attach(float *a_pCenterX, float *a_pCenterY, float *a_pCenterZ, float *a_pRadius, MaterialId *a_pMaterialId, int a_iCount)
+{
+    this->Release();
+
+    this->m_pCenterX = a_pCenterX;
+    this->m_pCenterY = a_pCenterY;
+    this->m_pCenterZ = a_pCenterZ;
+    this->m_pRadius = a_pRadius;
+    this->m_pMaterialId = a_pMaterialId;
+
+    this->m_iCount = a_iCount;
+    this->m_iCapacity = a_iCount;
+    this->m_bOwner = false;
+}
+
+void SphereSoA::Add(const Vec3 &a_oCenter, float a_fRadius, MaterialId a_uMaterialId)
+{
+    if (this->m_iCount == this->m_iCapacity)
+    {
+        this->Reserve(this->m_iCapacity > 0 ? this->m_iCapacity * 2 : s_ciPadding);
+    }
+
+    int i = this->m_iCount++;
+
+    this->m_pCenterX[i] = a_oCenter[0];
+    this->m_pCenterY[i] = a_oCenter[1];
+    this->m_pCenterZ[i] = a_oCenter[2];
+    this->m_pRadius[i] = a_fRadius;
+    this->m_pMaterialId[i] = a_uMaterialId;
+
+    if (this->HasMotion())
+    {
+        this->m_pVelocityX[i] = 0.0f;
+        this->m_pVelocityY[i] = 0.0f;
+        this->m_pVelocityZ[i] = 0.0f;
+    }
+}
+
+void SphereSoA::SetVelocity(int a_iIndex, const Vec3 &a_oVelocity)
+{
+    if (!this->HasMotion())
+    {
+        // Owned even when the spheres are attached, and as long as the padded centre arrays.
+        size_t _floats = (this->m_bOwner ? this->m_iCapacity : this->m_iCount) + s_ciPadding;
+
+        this->m_pVelocityX = AllocateVelocity(_floats);
+        this->m_pVelocityY = AllocateVelocity(_floats);
+        this->m_pVelocityZ = AllocateVelocity(_floats);
+    }
+
+    this->m_pVelocityX[a_iIndex] = a_oVelocity[0];
+    this->m_pVelocityY[a_iIndex] = a_oVelocity[1];
+    this->m_pVelocityZ[a_iIndex] = a_oVelocity[2];
+}
+
+Vec3 SphereSoA::GetVelocity(int a_iIndex) const
+{
+    if (!this->HasMotion())
+    {
+        return Vec3(0.0f, 0.0f, 0.0f);
+    }
+
+    return Vec3(this->m_pVelocityX[a_iIndex], this->m_pVelocityY[a_iIndex], this->m_pVelocityZ[a_iIndex]);
+}
+
+bool SphereSoA::HasMotion() const
+{
+    return this->m_pVelocityX != nullptr;
+}
+
+Vec3 SphereSoA::GetCenter(int a_iIndex, float a_fTime) const
+{
+    Vec3 _center(this->m_pCenterX[a_iIndex], this->m_pCenterY[a_iIndex], this->m_pCenterZ[a_iIndex]);
+
+    if (this->HasMotion())
+    {
+        _center += a_fTime * Vec3(this->m_pVelocityX[a_iIndex], this->m_pVelocityY[a_iIndex], this->m_pVelocityZ[a_iIndex]);
+    }
+
+    return _center;
+}
+
+void SphereSoA::Clear()
+{
+    // Attached arrays are left untouched.
+    if (!this->m_bOwner)
+    {
+        this->Release();
+        return;
+    }
+
+    for (int i = 0; i < this->m_iCount; ++i)
+    {
+        this->m_pCenterX[i] = std::numeric_limits<float>::quiet_NaN();
+        this->m_pCenterY[i] = std::numeric_limits<float>::quiet_NaN();
+        this->m_pCenterZ[i] = std::numeric_limits<float>::quiet_NaN();
+        this->m_pRadius[i] = std::numeric_limits<float>::quiet_NaN();
+    }
+
+    this->ReleaseVelocity();
+
+    this->m_iCount = 0;
+}
+
+void SphereSoA::Reorder(const std::vector<int> &a_oOrder)
+{
+    SphereSoA _source(*this);
+
+    for (int i = 0; i < static_cast<int>(a_oOrder.size()) && i < this->m_iCount; ++i)
+    {
+        int _from = a_oOrder[i];
+
+        this->m_pCenterX[i] = _source.m_pCenterX[_from];
+        this->m_pCenterY[i] = _source.m_pCenterY[_from];
+        this->m_pCenterZ[i] = _source.m_pCenterZ[_from];
+        this->m_pRadius[i] = _source.m_pRadius[_from];
+        this->m_pMaterialId[i] = _source.m_pMaterialId[_from];
+
+        if (this->HasMotion())
+        {
+            this->m_pVelocityX[i] = _source.m_pVelocityX[_from];
+            this->m_pVelocityY[i] = _source.m_pVelocityY[_from];
+            this->m_pVelocityZ[i] = _source.m_pVelocityZ[_from];
+        }
+    }
+}
+
+bool SphereSoA::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const
+{
+    SphereRay _ray(a_oRay);
+
+    int _index = -1;
+
+    if (!this->Intersect(_ray, 0, this->m_iCount, a_fTMin, a_fTMax, _index))
+    {
+        return false;
+    }
+
+    this->FillRecord(a_oRay, a_fTMax, _index, a_oRecord);
+
+    return true;
+}
+
+bool SphereSoA::BoundingBox(Aabb &a_oBox) const
+{
+    a_oBox = Aabb();
+
+    for (int i = 0; i < this->m_iCount; ++i)
+    {
+        a_oBox.Grow(this->GetSphereBounds(i));
+    }
+
+    return this->m_iCount > 0;
+}
+
+bool SphereSoA::Intersect(const SphereRay &a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float &a_fTMax, int &a_iIndex) const
+{
+    // Very small ranges are cheaper without the vector setup.
+    if (this->HasMotion())
+    {
+        if (a_iEnd - a_iBegin == 1)
+        {
+            return IntersectScalar<true>(*this, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+        }
+
+        return s_pIntersectMoving(*this, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+    }
+
+    if (a_iEnd - a_iBegin == 1)
+    {
+        return IntersectScalar<false>(*this, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+    }
+
+    return s_pIntersect(*this, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+}
+
+void SphereSoA::FillRecord(const Ray &a_oRay, float a_fT, int a_iIndex, HitRecord &a_oRecord) const
+{
+    a_oRecord.m_fT = a_fT;
+#if RT_USE_VEC3A
+    Vec3A _center(this->GetCenter(a_iIndex, a_oRay.m_fTime));
+    Vec3A _point = MulAdd(Vec3A::Splat(a_fT), Vec3A(a_oRay.m_oDirection), Vec3A(a_oRay.m_oOrigin));
+
+    a_oRecord.m_oPoint = _point.ToVec3();
+    a_oRecord.m_oNormal = ((_point - _center) * (1.0f / this->m_pRadius[a_iIndex])).ToVec3();
+#else
+    Vec3 _center = this->GetCenter(a_iIndex, a_oRay.m_fTime);
+
+    a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_fT);
+    a_oRecord.m_oNormal = (a_oRecord.m_oPoint - _center) / this->m_pRadius[a_iIndex];
+#endif
+    a_oRecord.m_uMaterialId = this->m_pMaterialId[a_iIndex];
+}
+
+Aabb SphereSoA::GetSphereBounds(int a_iIndex, float a_fTimeBegin, float a_fTimeEnd) const
+{
+    Vec3 _center = this->GetCenter(a_iIndex, a_fTimeBegin);
+
+    float _r = fabsf(this->m_pRadius[a_iIndex]);
+
+    Aabb _box(_center - Vec3(_r, _r, _r), _center + Vec3(_r, _r, _r));
+
+    // Motion is linear, so the boxes at both ends bound every time in between.
+    if (this->HasMotion() && a_fTimeEnd != a_fTimeBegin)
+    {
+        _center = this->GetCenter(a_iIndex, a_fTimeEnd);
+
+        _box.Grow(Aabb(_center - Vec3(_r, _r, _r), _center + Vec3(_r, _r, _r)));
+    }
+
+    return _box;
+}
+
+int SphereSoA::GetCount() const
+{
+    return this->m_iCount;
+}
+
+SimdIsa SphereSoA::GetIsa()
+{
+    return GetActiveSimdIsa();
+}
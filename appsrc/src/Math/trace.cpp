@@ -0,0 +1,149 @@
+#include "appsrc/include/Math/trace.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char* m_pName;
+
+        uint64_t m_uStartNs;
+        uint64_t m_uEndNs;
+
+        int m_iArgX;
+        int m_iArgY;
+    };
+
+    struct ThreadEvents
+    {
+        int m_iThreadId;
+
+        std::vector<TraceEvent> m_oEvents;
+    };
+
+    std::atomic<bool> s_bRecording(false);
+
+    std::mutex s_oThreadsMutex;
+    std::vector<std::unique_ptr<ThreadEvents> > s_oThreads;
+
+    ThreadEvents& LocalEvents()
+    {
+        thread_local ThreadEvents* s_pEvents = nullptr;
+
+        if (s_pEvents == nullptr)
+        {
+            std::lock_guard<std::mutex> _lock(s_oThreadsMutex);
+            s_oThreads.push_back(std::unique_ptr<ThreadEvents>(new ThreadEvents()));
+            s_pEvents = s_oThreads.back().get();
+            s_pEvents->m_iThreadId = static_cast<int>(s_oThreads.size());
+        }
+
+        return *s_pEvents;
+    }
+}
+
+void Tracer::Start()
+{
+    // Pins the time origin before the first span.
+    Now();
+
+    s_bRecording.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop()
+{
+    s_bRecording.store(false, std::memory_order_relaxed);
+}
+
+bool Tracer::IsRecording()
+{
+    return s_bRecording.load(std::memory_order_relaxed);
+}
+
+uint64_t Tracer::Now()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    static const Clock::time_point s_oOrigin = Clock::now();
+
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - s_oOrigin).count());
+}
+
+void Tracer::Record(const char *a_pName, uint64_t a_uStartNs, uint64_t a_uEndNs, int a_iArgX, int a_iArgY)
+{
+    TraceEvent _event;
+    _event.m_pName = a_pName;
+    _event.m_uStartNs = a_uStartNs;
+    _event.m_uEndNs = a_uEndNs;
+    _event.m_iArgX = a_iArgX;
+    _event.m_iArgY = a_iArgY;
+
+    LocalEvents().m_oEvents.push_back(_event);
+}
+
+bool Tracer::Write(const std::string &a_sPath)
+{
+    FILE* _file = fopen(a_sPath.c_str(), "w");
+
+    if (_file == nullptr)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> _lock(s_oThreadsMutex);
+
+    fprintf(_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    bool _first = true;
+
+    for (size_t t = 0; t < s_oThreads.size(); ++t)
+    {
+        ThreadEvents& _thread = *s_oThreads[t];
+
+        for (size_t e = 0; e < _thread.m_oEvents.size(); ++e)
+        {
+            const TraceEvent& _event = _thread.m_oEvents[e];
+
+            // Complete events, timestamps in microseconds.
+            fprintf(_file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                    _first ? "" : ",", _event.m_pName, _thread.m_iThreadId,
+                    double(_event.m_uStartNs) * 1e-3, double(_event.m_uEndNs - _event.m_uStartNs) * 1e-3);
+
+            if (_event.m_iArgX >= 0)
+            {
+                fprintf(_file, ",\"args\":{\"x\":%d,\"y\":%d}", _event.m_iArgX, _event.m_iArgY);
+            }
+
+            fprintf(_file, "}");
+
+            _first = false;
+        }
+
+        _thread.m_oEvents.clear();
+    }
+
+    fprintf(_file, "\n]}\n");
+
+    return fclose(_file) == 0;
+}
+
+TraceSpan::TraceSpan(const char *a_pName, int a_iArgX, int a_iArgY) : m_pName(a_pName),
+                                                                       m_iArgX(a_iArgX),
+                                                                       m_iArgY(a_iArgY),
+                                                                       m_bRecording(Tracer::IsRecording()),
+                                                                       m_uStartNs(m_bRecording ? Tracer::Now() : 0)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (this->m_bRecording)
+    {
+        Tracer::Record(this->m_pName, this->m_uStartNs, Tracer::Now(), this->m_iArgX, this->m_iArgY);
+    }
+}
@@ -0,0 +1,165 @@
+#include "appsrc/include/Math/transform.h"
+#include <math.h>
+
+Transform::Transform()
+{
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            this->m_fM[r][c] = r == c ? 1.0f : 0.0f;
+        }
+    }
+}
+
+Transform Transform::Translate(const Vec3 &a_oOffset)
+{
+    Transform _result;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        _result.m_fM[r][3] = a_oOffset[r];
+    }
+
+    return _result;
+}
+
+Transform Transform::Scale(const Vec3 &a_oFactors)
+{
+    Transform _result;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        _result.m_fM[r][r] = a_oFactors[r];
+    }
+
+    return _result;
+}
+
+Transform Transform::Rotate(const Vec3 &a_oAxis, float a_fDegrees)
+{
+    Vec3 _axis = Unit_Vector(a_oAxis);
+
+    float _radians = a_fDegrees * float(M_PI) / 180.0f;
+    float _sin = sinf(_radians);
+    float _cos = cosf(_radians);
+    float _t = 1.0f - _cos;
+
+    float x = _axis[0];
+    float y = _axis[1];
+    float z = _axis[2];
+
+    Transform _result;
+
+    _result.m_fM[0][0] = _t * x * x + _cos;
+    _result.m_fM[0][1] = _t * x * y - _sin * z;
+    _result.m_fM[0][2] = _t * x * z + _sin * y;
+
+    _result.m_fM[1][0] = _t * x * y + _sin * z;
+    _result.m_fM[1][1] = _t * y * y + _cos;
+    _result.m_fM[1][2] = _t * y * z - _sin * x;
+
+    _result.m_fM[2][0] = _t * x * z - _sin * y;
+    _result.m_fM[2][1] = _t * y * z + _sin * x;
+    _result.m_fM[2][2] = _t * z * z + _cos;
+
+    return _result;
+}
+
+Transform Transform::operator*(const Transform &a_oRhs) const
+{
+    Transform _result;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            float _sum = c == 3 ? this->m_fM[r][3] : 0.0f;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                _sum += this->m_fM[r][k] * a_oRhs.m_fM[k][c];
+            }
+
+            _result.m_fM[r][c] = _sum;
+        }
+    }
+
+    return _result;
+}
+
+Transform Transform::Inverse() const
+{
+    const float (&m)[3][4] = this->m_fM;
+
+    // Adjugate of the linear part over its determinant; doubles keep near-singular scales usable.
+    double _cofactors[3][3] =
+    {
+        { double(m[1][1]) * m[2][2] - double(m[1][2]) * m[2][1], double(m[0][2]) * m[2][1] - double(m[0][1]) * m[2][2], double(m[0][1]) * m[1][2] - double(m[0][2]) * m[1][1] },
+        { double(m[1][2]) * m[2][0] - double(m[1][0]) * m[2][2], double(m[0][0]) * m[2][2] - double(m[0][2]) * m[2][0], double(m[0][2]) * m[1][0] - double(m[0][0]) * m[1][2] },
+        { double(m[1][0]) * m[2][1] - double(m[1][1]) * m[2][0], double(m[0][1]) * m[2][0] - double(m[0][0]) * m[2][1], double(m[0][0]) * m[1][1] - double(m[0][1]) * m[1][0] }
+    };
+
+    double _determinant = m[0][0] * _cofactors[0][0] + m[0][1] * _cofactors[1][0] + m[0][2] * _cofactors[2][0];
+
+    double _inverse = 1.0 / _determinant;
+
+    Transform _result;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            _result.m_fM[r][c] = float(_cofactors[r][c] * _inverse);
+        }
+    }
+
+    // The inverse translation is -A^-1 * t.
+    for (int r = 0; r < 3; ++r)
+    {
+        double _sum = 0.0;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            _sum -= _cofactors[r][k] * _inverse * m[k][3];
+        }
+
+        _result.m_fM[r][3] = float(_sum);
+    }
+
+    return _result;
+}
+
+Aabb Transform::Box(const Aabb &a_oBox) const
+{
+    Aabb _result;
+
+    for (int k = 0; k < 8; ++k)
+    {
+        Vec3 _corner((k & 1) ? a_oBox.m_oMax[0] : a_oBox.m_oMin[0],
+                     (k & 2) ? a_oBox.m_oMax[1] : a_oBox.m_oMin[1],
+                     (k & 4) ? a_oBox.m_oMax[2] : a_oBox.m_oMin[2]);
+
+        _result.Grow(this->Point(_corner));
+    }
+
+    return _result;
+}
+
+bool Transform::IsIdentity() const
+{
+    Transform _identity;
+
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            if (this->m_fM[r][c] != _identity.m_fM[r][c])
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,616 @@
+#include "appsrc/include/Math/trianglemesh.h"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#if defined(RT_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    const float s_cfGridMax = 65535.0f;
+
+    // Raw arrays of a mesh, so the kernels need no access to its internals.
+    struct MeshView
+    {
+        const float* m_pPositions;
+        const uint16_t* m_pQuantized;
+        const uint32_t* m_pIndices;
+
+        float m_fGridOrigin[3];
+        float m_fGridStep[3];
+    };
+
+    typedef bool (*IntersectKernel)(const MeshView&, const TriangleRay&, int, int, float, float&, int&);
+
+    // Every kernel dequantizes and evaluates Moller-Trumbore with the same operations in the
+    // same order, so they all agree with the scalar path bit for bit.
+    template <bool QUANTIZED>
+    inline void FetchVertex(const MeshView& a_oMesh, uint32_t a_uVertex, float* a_fOut)
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            if (QUANTIZED)
+            {
+                a_fOut[a] = a_oMesh.m_fGridOrigin[a] + float(a_oMesh.m_pQuantized[3 * a_uVertex + a]) * a_oMesh.m_fGridStep[a];
+            }
+            else
+            {
+                a_fOut[a] = a_oMesh.m_pPositions[3 * a_uVertex + a];
+            }
+        }
+    }
+
+    template <bool QUANTIZED>
+    bool IntersectScalar(const MeshView& a_oMesh, const TriangleRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const float* _o = a_oRay.m_fOrigin;
+        const float* _d = a_oRay.m_fDirection;
+
+        bool _hit = false;
+
+        for (int i = a_iBegin; i < a_iEnd; ++i)
+        {
+            const uint32_t* _triangle = a_oMesh.m_pIndices + 3 * i;
+
+            float _v0[3];
+            float _v1[3];
+            float _v2[3];
+
+            FetchVertex<QUANTIZED>(a_oMesh, _triangle[0], _v0);
+            FetchVertex<QUANTIZED>(a_oMesh, _triangle[1], _v1);
+            FetchVertex<QUANTIZED>(a_oMesh, _triangle[2], _v2);
+
+            float _e1[3] = { _v1[0] - _v0[0], _v1[1] - _v0[1], _v1[2] - _v0[2] };
+            float _e2[3] = { _v2[0] - _v0[0], _v2[1] - _v0[1], _v2[2] - _v0[2] };
+
+            float _px = _d[1] * _e2[2] - _d[2] * _e2[1];
+            float _py = _d[2] * _e2[0] - _d[0] * _e2[2];
+            float _pz = _d[0] * _e2[1] - _d[1] * _e2[0];
+
+            // A ray parallel to the plane gives an infinite or NaN inverse, which fails every test below.
+            float _inv = 1.0f / ((_e1[0] * _px + _e1[1] * _py) + _e1[2] * _pz);
+
+            float _sx = _o[0] - _v0[0];
+            float _sy = _o[1] - _v0[1];
+            float _sz = _o[2] - _v0[2];
+
+            float _u = ((_sx * _px + _sy * _py) + _sz * _pz) * _inv;
+
+            float _qx = _sy * _e1[2] - _sz * _e1[1];
+            float _qy = _sz * _e1[0] - _sx * _e1[2];
+            float _qz = _sx * _e1[1] - _sy * _e1[0];
+
+            float _v = ((_d[0] * _qx + _d[1] * _qy) + _d[2] * _qz) * _inv;
+            float _t = ((_e2[0] * _qx + _e2[1] * _qy) + _e2[2] * _qz) * _inv;
+
+            if (_u >= 0.0f && _v >= 0.0f && _u + _v <= 1.0f && _t > a_fTMin && _t < a_fTMax)
+            {
+                a_fTMax = _t;
+                a_iIndex = i;
+                _hit = true;
+            }
+        }
+
+        return _hit;
+    }
+
+    // Picks the lowest-t lane, preferring the lowest triangle index on ties like the scalar loop.
+    bool ReduceLanes(const float* a_fBest, const int* a_iBestIndex, int a_iWidth, float& a_fTMax, int& a_iIndex)
+    {
+        bool _hit = false;
+
+        for (int l = 0; l < a_iWidth; ++l)
+        {
+            if (a_iBestIndex[l] < 0)
+            {
+                continue;
+            }
+
+            if (a_fBest[l] < a_fTMax || (_hit && a_fBest[l] == a_fTMax && a_iBestIndex[l] < a_iIndex))
+            {
+                a_fTMax = a_fBest[l];
+                a_iIndex = a_iBestIndex[l];
+                _hit = true;
+            }
+        }
+
+        return _hit;
+    }
+
+#if defined(RT_SIMD_X86)
+    // SSE2 has no gathers, so the four triangles are fetched into SoA lanes first; past the
+    // range end the lanes are NaN and never hit.
+    template <bool QUANTIZED>
+    bool IntersectSse2(const MeshView& a_oMesh, const TriangleRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const __m128 _ox = _mm_set1_ps(a_oRay.m_fOrigin[0]);
+        const __m128 _oy = _mm_set1_ps(a_oRay.m_fOrigin[1]);
+        const __m128 _oz = _mm_set1_ps(a_oRay.m_fOrigin[2]);
+        const __m128 _dx = _mm_set1_ps(a_oRay.m_fDirection[0]);
+        const __m128 _dy = _mm_set1_ps(a_oRay.m_fDirection[1]);
+        const __m128 _dz = _mm_set1_ps(a_oRay.m_fDirection[2]);
+        const __m128 _tMin = _mm_set1_ps(a_fTMin);
+        const __m128 _zero = _mm_setzero_ps();
+        const __m128 _one = _mm_set1_ps(1.0f);
+        const __m128i _lane = _mm_setr_epi32(0, 1, 2, 3);
+
+        __m128 _best = _mm_set1_ps(a_fTMax);
+        __m128i _bestIndex = _mm_set1_epi32(-1);
+
+        alignas(16) float _corners[9][4];
+
+        for (int i = a_iBegin; i < a_iEnd; i += 4)
+        {
+            for (int l = 0; l < 4; ++l)
+            {
+                float _vertex[9];
+
+                if (i + l < a_iEnd)
+                {
+                    const uint32_t* _triangle = a_oMesh.m_pIndices + 3 * (i + l);
+
+                    FetchVertex<QUANTIZED>(a_oMesh, _triangle[0], _vertex);
+                    FetchVertex<QUANTIZED>(a_oMesh, _triangle[1], _vertex + 3);
+                    FetchVertex<QUANTIZED>(a_oMesh, _triangle[2], _vertex + 6);
+                }
+                else
+                {
+                    std::fill(_vertex, _vertex + 9, std::numeric_limits<float>::quiet_NaN());
+                }
+
+                for (int k = 0; k < 9; ++k)
+                {
+                    _corners[k][l] = _vertex[k];
+                }
+            }
+
+            __m128 _v0x = _mm_load_ps(_corners[0]);
+            __m128 _v0y = _mm_load_ps(_corners[1]);
+            __m128 _v0z = _mm_load_ps(_corners[2]);
+
+            __m128 _e1x = _mm_sub_ps(_mm_load_ps(_corners[3]), _v0x);
+            __m128 _e1y = _mm_sub_ps(_mm_load_ps(_corners[4]), _v0y);
+            __m128 _e1z = _mm_sub_ps(_mm_load_ps(_corners[5]), _v0z);
+            __m128 _e2x = _mm_sub_ps(_mm_load_ps(_corners[6]), _v0x);
+            __m128 _e2y = _mm_sub_ps(_mm_load_ps(_corners[7]), _v0y);
+            __m128 _e2z = _mm_sub_ps(_mm_load_ps(_corners[8]), _v0z);
+
+            __m128 _px = _mm_sub_ps(_mm_mul_ps(_dy, _e2z), _mm_mul_ps(_dz, _e2y));
+            __m128 _py = _mm_sub_ps(_mm_mul_ps(_dz, _e2x), _mm_mul_ps(_dx, _e2z));
+            __m128 _pz = _mm_sub_ps(_mm_mul_ps(_dx, _e2y), _mm_mul_ps(_dy, _e2x));
+
+            __m128 _inv = _mm_div_ps(_one, _mm_add_ps(_mm_add_ps(_mm_mul_ps(_e1x, _px), _mm_mul_ps(_e1y, _py)), _mm_mul_ps(_e1z, _pz)));
+
+            __m128 _sx = _mm_sub_ps(_ox, _v0x);
+            __m128 _sy = _mm_sub_ps(_oy, _v0y);
+            __m128 _sz = _mm_sub_ps(_oz, _v0z);
+
+            __m128 _u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_sx, _px), _mm_mul_ps(_sy, _py)), _mm_mul_ps(_sz, _pz)), _inv);
+
+            __m128 _qx = _mm_sub_ps(_mm_mul_ps(_sy, _e1z), _mm_mul_ps(_sz, _e1y));
+            __m128 _qy = _mm_sub_ps(_mm_mul_ps(_sz, _e1x), _mm_mul_ps(_sx, _e1z));
+            __m128 _qz = _mm_sub_ps(_mm_mul_ps(_sx, _e1y), _mm_mul_ps(_sy, _e1x));
+
+            __m128 _v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_dx, _qx), _mm_mul_ps(_dy, _qy)), _mm_mul_ps(_dz, _qz)), _inv);
+            __m128 _t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_e2x, _qx), _mm_mul_ps(_e2y, _qy)), _mm_mul_ps(_e2z, _qz)), _inv);
+
+            __m128 _take = _mm_and_ps(_mm_cmpge_ps(_u, _zero), _mm_cmpge_ps(_v, _zero));
+
+            _take = _mm_and_ps(_take, _mm_cmple_ps(_mm_add_ps(_u, _v), _one));
+            _take = _mm_and_ps(_take, _mm_and_ps(_mm_cmpgt_ps(_t, _tMin), _mm_cmplt_ps(_t, _best)));
+
+            if (_mm_movemask_ps(_take) == 0)
+            {
+                continue;
+            }
+
+            __m128i _index = _mm_add_epi32(_mm_set1_epi32(i), _lane);
+
+            _best = _mm_or_ps(_mm_and_ps(_take, _t), _mm_andnot_ps(_take, _best));
+            _bestIndex = _mm_or_si128(_mm_and_si128(_mm_castps_si128(_take), _index), _mm_andnot_si128(_mm_castps_si128(_take), _bestIndex));
+        }
+
+        float _bestLanes[4];
+        int _indexLanes[4];
+
+        _mm_storeu_ps(_bestLanes, _best);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_indexLanes), _bestIndex);
+
+        return ReduceLanes(_bestLanes, _indexLanes, 4, a_fTMax, a_iIndex);
+    }
+
+    // Gathers the corners of eight triangles straight from the index and vertex buffers.
+    // Offsets are 32-bit element counts, which caps a mesh at 2^31 / 3 vertices.
+    template <bool QUANTIZED>
+    RT_TARGET_AVX2 bool IntersectAvx2(const MeshView& a_oMesh, const TriangleRay& a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float& a_fTMax, int& a_iIndex)
+    {
+        const __m256 _ox = _mm256_set1_ps(a_oRay.m_fOrigin[0]);
+        const __m256 _oy = _mm256_set1_ps(a_oRay.m_fOrigin[1]);
+        const __m256 _oz = _mm256_set1_ps(a_oRay.m_fOrigin[2]);
+        const __m256 _dx = _mm256_set1_ps(a_oRay.m_fDirection[0]);
+        const __m256 _dy = _mm256_set1_ps(a_oRay.m_fDirection[1]);
+        const __m256 _dz = _mm256_set1_ps(a_oRay.m_fDirection[2]);
+        const __m256 _tMin = _mm256_set1_ps(a_fTMin);
+        const __m256 _zero = _mm256_setzero_ps();
+        const __m256 _one = _mm256_set1_ps(1.0f);
+        const __m256i _lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i _stride = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256i _end = _mm256_set1_epi32(a_iEnd);
+        const __m256i _low16 = _mm256_set1_epi32(0xffff);
+
+        __m256 _best = _mm256_set1_ps(a_fTMax);
+        __m256i _bestIndex = _mm256_set1_epi32(-1);
+
+        for (int i = a_iBegin; i < a_iEnd; i += 8)
+        {
+            __m256i _index = _mm256_add_epi32(_mm256_set1_epi32(i), _lane);
+            __m256i _valid = _mm256_cmpgt_epi32(_end, _index);
+
+            const int* _triangles = reinterpret_cast<const int*>(a_oMesh.m_pIndices + 3 * i);
+
+            // Masked-off lanes read nothing and keep a zero vertex, a degenerate triangle.
+            __m256 _corner[3][3];
+
+            for (int k = 0; k < 3; ++k)
+            {
+                __m256i _vertex = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), _triangles + k, _stride, _valid, 4);
+                __m256i _offset = _mm256_add_epi32(_mm256_add_epi32(_vertex, _vertex), _vertex);
+
+                for (int a = 0; a < 3; ++a)
+                {
+                    if (QUANTIZED)
+                    {
+                        // Each 32-bit load picks up the wanted 16-bit coordinate in its low half.
+                        __m256i _raw = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(a_oMesh.m_pQuantized + a), _offset, _valid, 2);
+                        __m256 _q = _mm256_cvtepi32_ps(_mm256_and_si256(_raw, _low16));
+
+                        _corner[k][a] = _mm256_add_ps(_mm256_set1_ps(a_oMesh.m_fGridOrigin[a]), _mm256_mul_ps(_q, _mm256_set1_ps(a_oMesh.m_fGridStep[a])));
+                    }
+                    else
+                    {
+                        _corner[k][a] = _mm256_mask_i32gather_ps(_zero, a_oMesh.m_pPositions + a, _offset, _mm256_castsi256_ps(_valid), 4);
+                    }
+                }
+            }
+
+            __m256 _e1x = _mm256_sub_ps(_corner[1][0], _corner[0][0]);
+            __m256 _e1y = _mm256_sub_ps(_corner[1][1], _corner[0][1]);
+            __m256 _e1z = _mm256_sub_ps(_corner[1][2], _corner[0][2]);
+            __m256 _e2x = _mm256_sub_ps(_corner[2][0], _corner[0][0]);
+            __m256 _e2y = _mm256_sub_ps(_corner[2][1], _corner[0][1]);
+            __m256 _e2z = _mm256_sub_ps(_corner[2][2], _corner[0][2]);
+
+            __m256 _px = _mm256_sub_ps(_mm256_mul_ps(_dy, _e2z), _mm256_mul_ps(_dz, _e2y));
+            __m256 _py = _mm256_sub_ps(_mm256_mul_ps(_dz, _e2x), _mm256_mul_ps(_dx, _e2z));
+            __m256 _pz = _mm256_sub_ps(_mm256_mul_ps(_dx, _e2y), _mm256_mul_ps(_dy, _e2x));
+
+            __m256 _inv = _mm256_div_ps(_one, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_e1x, _px), _mm256_mul_ps(_e1y, _py)), _mm256_mul_ps(_e1z, _pz)));
+
+            __m256 _sx = _mm256_sub_ps(_ox, _corner[0][0]);
+            __m256 _sy = _mm256_sub_ps(_oy, _corner[0][1]);
+            __m256 _sz = _mm256_sub_ps(_oz, _corner[0][2]);
+
+            __m256 _u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_sx, _px), _mm256_mul_ps(_sy, _py)), _mm256_mul_ps(_sz, _pz)), _inv);
+
+            __m256 _qx = _mm256_sub_ps(_mm256_mul_ps(_sy, _e1z), _mm256_mul_ps(_sz, _e1y));
+            __m256 _qy = _mm256_sub_ps(_mm256_mul_ps(_sz, _e1x), _mm256_mul_ps(_sx, _e1z));
+            __m256 _qz = _mm256_sub_ps(_mm256_mul_ps(_sx, _e1y), _mm256_mul_ps(_sy, _e1x));
+
+            __m256 _v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_dx, _qx), _mm256_mul_ps(_dy, _qy)), _mm256_mul_ps(_dz, _qz)), _inv);
+            __m256 _t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_e2x, _qx), _mm256_mul_ps(_e2y, _qy)), _mm256_mul_ps(_e2z, _qz)), _inv);
+
+            __m256 _take = _mm256_and_ps(_mm256_cmp_ps(_u, _zero, _CMP_GE_OQ), _mm256_cmp_ps(_v, _zero, _CMP_GE_OQ));
+
+            _take = _mm256_and_ps(_take, _mm256_cmp_ps(_mm256_add_ps(_u, _v), _one, _CMP_LE_OQ));
+            _take = _mm256_and_ps(_take, _mm256_and_ps(_mm256_cmp_ps(_t, _tMin, _CMP_GT_OQ), _mm256_cmp_ps(_t, _best, _CMP_LT_OQ)));
+            _take = _mm256_and_ps(_take, _mm256_castsi256_ps(_valid));
+
+            if (_mm256_movemask_ps(_take) == 0)
+            {
+                continue;
+            }
+
+            _best = _mm256_blendv_ps(_best, _t, _take);
+            _bestIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(_bestIndex), _mm256_castsi256_ps(_index), _take));
+        }
+
+        float _bestLanes[8];
+        int _indexLanes[8];
+
+        _mm256_storeu_ps(_bestLanes, _best);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_indexLanes), _bestIndex);
+
+        return ReduceLanes(_bestLanes, _indexLanes, 8, a_fTMax, a_iIndex);
+    }
+#endif
+
+    template <bool QUANTIZED>
+    IntersectKernel SelectKernel()
+    {
+        switch (TriangleMesh::GetIsa())
+        {
+#if defined(RT_SIMD_X86)
+        case SIMD_ISA_AVX2:
+            return &IntersectAvx2<QUANTIZED>;
+        case SIMD_ISA_SSE2:
+            return &IntersectSse2<QUANTIZED>;
+#endif
+        default:
+            return &IntersectScalar<QUANTIZED>;
+        }
+    }
+
+    const IntersectKernel s_pIntersect = SelectKernel<false>();
+
+    const IntersectKernel s_pIntersectQuantized = SelectKernel<true>();
+}
+
+TriangleRay::TriangleRay(const Ray &a_oRay)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fOrigin[a] = a_oRay.m_oOrigin[a];
+        this->m_fDirection[a] = a_oRay.m_oDirection[a];
+    }
+}
+
+TriangleMesh::TriangleMesh(MaterialId a_uMaterialId) : m_iVertexCount(0),
+                                                       m_uMaterialId(a_uMaterialId)
+{
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fGridOrigin[a] = 0.0f;
+        this->m_fGridStep[a] = 0.0f;
+    }
+}
+
+void TriangleMesh::ReserveVertices(int a_iCapacity)
+{
+    if (!this->IsQuantized())
+    {
+        this->m_oPositions.reserve(3 * static_cast<size_t>(a_iCapacity));
+    }
+}
+
+void TriangleMesh::ReserveTriangles(int a_iCapacity)
+{
+    this->m_oIndices.reserve(3 * static_cast<size_t>(a_iCapacity));
+}
+
+void TriangleMesh::AddVertex(const Vec3 &a_oPosition)
+{
+    if (this->IsQuantized())
+    {
+        return;
+    }
+
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_oPositions.push_back(a_oPosition[a]);
+    }
+
+    this->m_oBounds.Grow(a_oPosition);
+
+    ++this->m_iVertexCount;
+}
+
+void TriangleMesh::AddTriangle(uint32_t a_uA, uint32_t a_uB, uint32_t a_uC)
+{
+    this->m_oIndices.push_back(a_uA);
+    this->m_oIndices.push_back(a_uB);
+    this->m_oIndices.push_back(a_uC);
+}
+
+void TriangleMesh::Quantize()
+{
+    if (this->IsQuantized() || this->m_iVertexCount == 0)
+    {
+        return;
+    }
+
+    Vec3 _extent = this->m_oBounds.Extent();
+
+    for (int a = 0; a < 3; ++a)
+    {
+        this->m_fGridOrigin[a] = this->m_oBounds.m_oMin[a];
+        this->m_fGridStep[a] = _extent[a] / s_cfGridMax;
+    }
+
+    this->m_oQuantized.resize(3 * static_cast<size_t>(this->m_iVertexCount) + 1, 0);
+
+    for (size_t k = 0; k < this->m_oPositions.size(); ++k)
+    {
+        int a = static_cast<int>(k % 3);
+
+        float _q = this->m_fGridStep[a] > 0.0f ? (this->m_oPositions[k] - this->m_fGridOrigin[a]) / this->m_fGridStep[a] : 0.0f;
+
+        this->m_oQuantized[k] = static_cast<uint16_t>(std::min(std::max(floorf(_q + 0.5f), 0.0f), s_cfGridMax));
+    }
+
+    std::vector<float>().swap(this->m_oPositions);
+
+    // Snapping moves vertices by up to half a step, so the bounds are taken again from what the kernels see.
+    this->m_oBounds = Aabb();
+
+    for (int v = 0; v < this->m_iVertexCount; ++v)
+    {
+        this->m_oBounds.Grow(this->GetVertex(v));
+    }
+}
+
+bool TriangleMesh::IsQuantized() const
+{
+    return !this->m_oQuantized.empty();
+}
+
+void TriangleMesh::Clear()
+{
+    std::vector<float>().swap(this->m_oPositions);
+    std::vector<uint16_t>().swap(this->m_oQuantized);
+    std::vector<uint32_t>().swap(this->m_oIndices);
+
+    this->m_iVertexCount = 0;
+    this->m_oBounds = Aabb();
+}
+
+void TriangleMesh::Reorder(const std::vector<int> &a_oOrder)
+{
+    std::vector<uint32_t> _indices(this->m_oIndices.size());
+
+    for (size_t i = 0; i < a_oOrder.size(); ++i)
+    {
+        const uint32_t* _triangle = this->GetTriangle(a_oOrder[i]);
+
+        _indices[3 * i + 0] = _triangle[0];
+        _indices[3 * i + 1] = _triangle[1];
+        _indices[3 * i + 2] = _triangle[2];
+    }
+
+    this->m_oIndices.swap(_indices);
+}
+
+bool TriangleMesh::Hit(const Ray &a_oRay, float a_fTMin, float a_fTMax, HitRecord &a_oRecord) const
+{
+    TriangleRay _ray(a_oRay);
+
+    int _index = -1;
+
+    if (!this->Intersect(_ray, 0, this->GetTriangleCount(), a_fTMin, a_fTMax, _index))
+    {
+        return false;
+    }
+
+    this->FillRecord(a_oRay, a_fTMax, _index, a_oRecord);
+
+    return true;
+}
+
+bool TriangleMesh::BoundingBox(Aabb &a_oBox) const
+{
+    a_oBox = this->m_oBounds;
+
+    return this->GetTriangleCount() > 0;
+}
+
+bool TriangleMesh::Intersect(const TriangleRay &a_oRay, int a_iBegin, int a_iEnd, float a_fTMin, float &a_fTMax, int &a_iIndex) const
+{
+    if (a_iEnd <= a_iBegin)
+    {
+        return false;
+    }
+
+    MeshView _mesh;
+
+    _mesh.m_pPositions = this->m_oPositions.empty() ? nullptr : &this->m_oPositions[0];
+    _mesh.m_pQuantized = this->m_oQuantized.empty() ? nullptr : &this->m_oQuantized[0];
+    _mesh.m_pIndices = &this->m_oIndices[0];
+
+    for (int a = 0; a < 3; ++a)
+    {
+        _mesh.m_fGridOrigin[a] = this->m_fGridOrigin[a];
+        _mesh.m_fGridStep[a] = this->m_fGridStep[a];
+    }
+
+    // A single triangle is cheaper without the vector setup.
+    if (this->IsQuantized())
+    {
+        if (a_iEnd - a_iBegin == 1)
+        {
+            return IntersectScalar<true>(_mesh, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+        }
+
+        return s_pIntersectQuantized(_mesh, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+    }
+
+    if (a_iEnd - a_iBegin == 1)
+    {
+        return IntersectScalar<false>(_mesh, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+    }
+
+    return s_pIntersect(_mesh, a_oRay, a_iBegin, a_iEnd, a_fTMin, a_fTMax, a_iIndex);
+}
+
+void TriangleMesh::FillRecord(const Ray &a_oRay, float a_fT, int a_iIndex, HitRecord &a_oRecord) const
+{
+    const uint32_t* _triangle = this->GetTriangle(a_iIndex);
+
+    Vec3 _v0 = this->GetVertex(_triangle[0]);
+
+    a_oRecord.m_fT = a_fT;
+    a_oRecord.m_oPoint = a_oRay.PointAtParamenter(a_fT);
+    a_oRecord.m_oNormal = Unit_Vector(Cross(this->GetVertex(_triangle[1]) - _v0, this->GetVertex(_triangle[2]) - _v0));
+    a_oRecord.m_uMaterialId = this->m_uMaterialId;
+}
+
+Aabb TriangleMesh::GetTriangleBounds(int a_iIndex) const
+{
+    const uint32_t* _triangle = this->GetTriangle(a_iIndex);
+
+    Aabb _box;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        _box.Grow(this->GetVertex(_triangle[k]));
+    }
+
+    return _box;
+}
+
+Vec3 TriangleMesh::GetVertex(int a_iIndex) const
+{
+    size_t _base = 3 * static_cast<size_t>(a_iIndex);
+
+    if (this->IsQuantized())
+    {
+        return Vec3(this->m_fGridOrigin[0] + float(this->m_oQuantized[_base + 0]) * this->m_fGridStep[0],
+                    this->m_fGridOrigin[1] + float(this->m_oQuantized[_base + 1]) * this->m_fGridStep[1],
+                    this->m_fGridOrigin[2] + float(this->m_oQuantized[_base + 2]) * this->m_fGridStep[2]);
+    }
+
+    return Vec3(this->m_oPositions[_base + 0], this->m_oPositions[_base + 1], this->m_oPositions[_base + 2]);
+}
+
+const uint32_t* TriangleMesh::GetTriangle(int a_iIndex) const
+{
+    return &this->m_oIndices[3 * static_cast<size_t>(a_iIndex)];
+}
+
+int TriangleMesh::GetVertexCount() const
+{
+    return this->m_iVertexCount;
+}
+
+int TriangleMesh::GetTriangleCount() const
+{
+    return static_cast<int>(this->m_oIndices.size() / 3);
+}
+
+MaterialId TriangleMesh::GetMaterialId() const
+{
+    return this->m_uMaterialId;
+}
+
+void TriangleMesh::SetMaterialId(MaterialId a_uMaterialId)
+{
+    this->m_uMaterialId = a_uMaterialId;
+}
+
+size_t TriangleMesh::GetMemoryBytes() const
+{
+    return this->m_oPositions.capacity() * sizeof(float) + this->m_oQuantized.capacity() * sizeof(uint16_t) + this->m_oIndices.capacity() * sizeof(uint32_t);
+}
+
+int TriangleMesh::GetBatchWidth()
+{
+    return GetIsa() >= SIMD_ISA_AVX2 ? 8 : 4;
+}
+
+SimdIsa TriangleMesh::GetIsa()
+{
+    // The AVX2 kernel already covers a whole BVH leaf, so AVX-512 machines use it too.
+    SimdIsa _isa = GetActiveSimdIsa();
+
+    return _isa > SIMD_ISA_AVX2 ? SIMD_ISA_AVX2 : _isa;
+}
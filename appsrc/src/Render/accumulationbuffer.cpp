@@ -0,0 +1,213 @@
+#include "appsrc/include/Render/accumulationbuffer.h"
+#include "appsrc/include/Math/trace.h"
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+    const char s_ccMagic[4] = { 'R', 'T', 'A', 'C' };
+
+    const int32_t s_ciVersion = 4;
+
+    static_assert(sizeof(Vec3) == 3 * sizeof(float), "checkpoints store Vec3 as three packed floats");
+
+    // Magic, then version, width, height, passes, max depth, roulette depth, sampler and
+    // whether lights were sampled.
+    struct CheckpointHeader
+    {
+        char m_cMagic[4];
+
+        int32_t m_iVersion;
+        int32_t m_iWidth;
+        int32_t m_iHeight;
+        int32_t m_iPasses;
+        int32_t m_iMaxDepth;
+        int32_t m_iRouletteDepth;
+        int32_t m_iSampler;
+        int32_t m_iNextEvent;
+    };
+}
+
+AccumulationBuffer::AccumulationBuffer(int a_iWidth, int a_iHeight) : m_iWidth(a_iWidth),
+                                                                      m_iHeight(a_iHeight),
+                                                                      m_iPasses(0),
+                                                                      m_oSums(a_iWidth * a_iHeight, Vec3(0.0f, 0.0f, 0.0f)),
+                                                                      m_iAovPasses(0)
+{
+}
+
+void AccumulationBuffer::Clear()
+{
+    std::fill(this->m_oSums.begin(), this->m_oSums.end(), Vec3(0.0f, 0.0f, 0.0f));
+    std::fill(this->m_oAovSums.begin(), this->m_oAovSums.end(), SampleAovs());
+
+    this->m_iPasses = 0;
+    this->m_iAovPasses = 0;
+}
+
+void AccumulationBuffer::Add(const FrameBuffer &a_oPass)
+{
+    const Vec3* _pass = a_oPass.GetData();
+
+    for (size_t p = 0; p < this->m_oSums.size(); ++p)
+    {
+        this->m_oSums[p] += _pass[p];
+    }
+
+    ++this->m_iPasses;
+
+    if (!a_oPass.HasAovs())
+    {
+        return;
+    }
+
+    this->m_oAovSums.resize(this->m_oSums.size());
+
+    for (int j = 0; j < this->m_iHeight; ++j)
+    {
+        for (int i = 0; i < this->m_iWidth; ++i)
+        {
+            this->m_oAovSums[j * this->m_iWidth + i].Add(a_oPass.GetAovs(i, j));
+        }
+    }
+
+    ++this->m_iAovPasses;
+}
+
+void AccumulationBuffer::Resolve(FrameBuffer &a_oFrameBuffer) const
+{
+    for (int j = 0; j < this->m_iHeight; ++j)
+    {
+        for (int i = 0; i < this->m_iWidth; ++i)
+        {
+            Vec3 _mean = this->m_oSums[j * this->m_iWidth + i];
+
+            if (this->m_iPasses > 0)
+            {
+                _mean /= float(this->m_iPasses);
+            }
+
+            a_oFrameBuffer.SetPixel(i, j, _mean);
+            a_oFrameBuffer.SetSampleCount(i, j, this->m_iPasses);
+        }
+    }
+
+    if (this->m_iAovPasses == 0 || !a_oFrameBuffer.HasAovs())
+    {
+        return;
+    }
+
+    float _scale = 1.0f / float(this->m_iAovPasses);
+
+    for (int j = 0; j < this->m_iHeight; ++j)
+    {
+        for (int i = 0; i < this->m_iWidth; ++i)
+        {
+            SampleAovs _mean = this->m_oAovSums[j * this->m_iWidth + i];
+
+            _mean.Scale(_scale);
+
+            a_oFrameBuffer.SetAovs(i, j, _mean);
+        }
+    }
+}
+
+int AccumulationBuffer::GetPassCount() const
+{
+    return this->m_iPasses;
+}
+
+bool AccumulationBuffer::Save(const std::string &a_sPath, const RenderSettings &a_oSettings) const
+{
+    RT_TRACE_SPAN("checkpoint write");
+
+    CheckpointHeader _header;
+
+    memcpy(_header.m_cMagic, s_ccMagic, sizeof(s_ccMagic));
+
+    _header.m_iVersion = s_ciVersion;
+    _header.m_iWidth = this->m_iWidth;
+    _header.m_iHeight = this->m_iHeight;
+    _header.m_iPasses = this->m_iPasses;
+    _header.m_iMaxDepth = a_oSettings.m_iMaxDepth;
+    _header.m_iRouletteDepth = a_oSettings.m_iRouletteDepth;
+    _header.m_iSampler = a_oSettings.m_eSampler;
+    _header.m_iNextEvent = a_oSettings.m_bNextEvent;
+
+    std::string _temporary = a_sPath + ".tmp";
+
+    FILE* _file = fopen(_temporary.c_str(), "wb");
+
+    if (_file == nullptr)
+    {
+        return false;
+    }
+
+    bool _ok = fwrite(&_header, sizeof(_header), 1, _file) == 1;
+
+    _ok = _ok && fwrite(&this->m_oSums[0], sizeof(Vec3), this->m_oSums.size(), _file) == this->m_oSums.size();
+
+    _ok = (fclose(_file) == 0) && _ok;
+
+    if (!_ok)
+    {
+        remove(_temporary.c_str());
+        return false;
+    }
+
+    // rename() does not replace an existing file on Windows.
+    if (rename(_temporary.c_str(), a_sPath.c_str()) != 0)
+    {
+        remove(a_sPath.c_str());
+
+        return rename(_temporary.c_str(), a_sPath.c_str()) == 0;
+    }
+
+    return true;
+}
+
+bool AccumulationBuffer::Load(const std::string &a_sPath, const RenderSettings &a_oSettings)
+{
+    FILE* _file = fopen(a_sPath.c_str(), "rb");
+
+    if (_file == nullptr)
+    {
+        return false;
+    }
+
+    CheckpointHeader _header;
+
+    bool _ok = fread(&_header, sizeof(_header), 1, _file) == 1;
+
+    _ok = _ok && memcmp(_header.m_cMagic, s_ccMagic, sizeof(s_ccMagic)) == 0
+              && _header.m_iVersion == s_ciVersion
+              && _header.m_iWidth == this->m_iWidth
+              && _header.m_iHeight == this->m_iHeight
+              && _header.m_iPasses >= 0
+              && _header.m_iMaxDepth == a_oSettings.m_iMaxDepth
+              && _header.m_iRouletteDepth == a_oSettings.m_iRouletteDepth
+              && _header.m_iSampler == a_oSettings.m_eSampler
+              && _header.m_iNextEvent == int32_t(a_oSettings.m_bNextEvent);
+
+    std::vector<Vec3> _sums(this->m_oSums.size());
+
+    _ok = _ok && fread(&_sums[0], sizeof(Vec3), _sums.size(), _file) == _sums.size();
+
+    fclose(_file);
+
+    if (!_ok)
+    {
+        return false;
+    }
+
+    this->m_oSums.swap(_sums);
+    this->m_iPasses = _header.m_iPasses;
+
+    std::fill(this->m_oAovSums.begin(), this->m_oAovSums.end(), SampleAovs());
+
+    this->m_iAovPasses = 0;
+
+    return true;
+}
@@ -0,0 +1,464 @@
+#include "appsrc/include/Render/denoiser.h"
+#include "appsrc/include/Math/trace.h"
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <stdint.h>
+
+// Off unless the CMake build found Open Image Denoise (RT_USE_OIDN).
+#ifndef RT_HAVE_OIDN
+#define RT_HAVE_OIDN 0
+#endif
+
+#if RT_HAVE_OIDN
+#include <OpenImageDenoise/oidn.h>
+#endif
+
+namespace
+{
+    // Albedo channels below this are not divided out: there is nothing to remodulate.
+    const float s_cfAlbedoFloor = 0.01f;
+
+    // Depths are compared relative to the centre pixel's, floored for misses at depth zero.
+    const float s_cfDepthFloor = 1e-4f;
+
+    // B3-spline taps of the à-trous wavelet.
+    const float s_cfAtrousKernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+    // 1 / (2 sigma^2), with a sigma of zero or less switching the edge stop off.
+    inline float InverseVariance(float a_fSigma)
+    {
+        return a_fSigma > 0.0f ? 0.5f / (a_fSigma * a_fSigma) : 0.0f;
+    }
+
+    inline Vec3 Compress(const Vec3& a_oColor)
+    {
+        Vec3 _color(fmaxf(a_oColor[0], 0.0f), fmaxf(a_oColor[1], 0.0f), fmaxf(a_oColor[2], 0.0f));
+
+        return _color / (Vec3(1.0f, 1.0f, 1.0f) + _color);
+    }
+
+    // Inverse variances of the four edge stops of one pass.
+    struct EdgeStops
+    {
+        float m_fColor;
+        float m_fNormal;
+        float m_fAlbedo;
+        float m_fDepth;
+    };
+
+    // The colour a filter blurs, with the albedo taken out, and its guides.
+    struct FilterImage
+    {
+        int m_iWidth;
+        int m_iHeight;
+
+        std::vector<Vec3> m_oColor;
+
+        // m_oColor after Compress() and a 3x3 box blur, what colour edges are measured on;
+        // the blur keeps single noisy samples from reading as edges.
+        std::vector<Vec3> m_oCompressed;
+
+        std::vector<Vec3> m_oModulation;
+
+        std::vector<SampleAovs> m_oGuides;
+    };
+
+    void UpdateEdgeColor(FilterImage& a_oImage)
+    {
+        std::vector<Vec3> _compressed(a_oImage.m_oColor.size());
+
+        for (size_t p = 0; p < _compressed.size(); ++p)
+        {
+            _compressed[p] = Compress(a_oImage.m_oColor[p]);
+        }
+
+        for (int j = 0; j < a_oImage.m_iHeight; ++j)
+        {
+            for (int i = 0; i < a_oImage.m_iWidth; ++i)
+            {
+                Vec3 _sum(0.0f, 0.0f, 0.0f);
+
+                int _taps = 0;
+
+                for (int y = std::max(j - 1, 0); y <= std::min(j + 1, a_oImage.m_iHeight - 1); ++y)
+                {
+                    for (int x = std::max(i - 1, 0); x <= std::min(i + 1, a_oImage.m_iWidth - 1); ++x)
+                    {
+                        _sum += _compressed[size_t(y) * a_oImage.m_iWidth + x];
+                        ++_taps;
+                    }
+                }
+
+                a_oImage.m_oCompressed[size_t(j) * a_oImage.m_iWidth + i] = _sum / float(_taps);
+            }
+        }
+    }
+
+    void Demodulate(const FrameBuffer& a_oInput, FilterImage& a_oImage)
+    {
+        a_oImage.m_iWidth = a_oInput.GetWidth();
+        a_oImage.m_iHeight = a_oInput.GetHeight();
+
+        size_t _count = size_t(a_oImage.m_iWidth) * a_oImage.m_iHeight;
+
+        a_oImage.m_oColor.resize(_count);
+        a_oImage.m_oCompressed.resize(_count);
+        a_oImage.m_oModulation.resize(_count);
+        a_oImage.m_oGuides.resize(_count);
+
+        for (int j = 0; j < a_oImage.m_iHeight; ++j)
+        {
+            for (int i = 0; i < a_oImage.m_iWidth; ++i)
+            {
+                size_t _pixel = size_t(j) * a_oImage.m_iWidth + i;
+
+                const SampleAovs& _aovs = a_oInput.GetAovs(i, j);
+
+                Vec3 _modulation;
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    _modulation[c] = _aovs.m_oAlbedo[c] > s_cfAlbedoFloor ? _aovs.m_oAlbedo[c] : 1.0f;
+                }
+
+                a_oImage.m_oColor[_pixel] = a_oInput.GetPixel(i, j) / _modulation;
+                a_oImage.m_oModulation[_pixel] = _modulation;
+                a_oImage.m_oGuides[_pixel] = _aovs;
+            }
+        }
+
+        UpdateEdgeColor(a_oImage);
+    }
+
+    // Weight of tap q for centre p apart from the spatial kernel.
+    inline float EdgeWeight(const FilterImage& a_oImage, size_t a_uP, size_t a_uQ, const EdgeStops& a_oStops)
+    {
+        const SampleAovs& _p = a_oImage.m_oGuides[a_uP];
+        const SampleAovs& _q = a_oImage.m_oGuides[a_uQ];
+
+        float _depth = (_p.m_fDepth - _q.m_fDepth) / fmaxf(_p.m_fDepth, s_cfDepthFloor);
+
+        float _exponent = (a_oImage.m_oCompressed[a_uP] - a_oImage.m_oCompressed[a_uQ]).SquaredLength() * a_oStops.m_fColor
+                        + (_p.m_oNormal - _q.m_oNormal).SquaredLength() * a_oStops.m_fNormal
+                        + (_p.m_oAlbedo - _q.m_oAlbedo).SquaredLength() * a_oStops.m_fAlbedo
+                        + _depth * _depth * a_oStops.m_fDepth;
+
+        return expf(-_exponent);
+    }
+
+    // Runs a_oRows over disjoint bands of rows on the pool and waits for all of them.
+    void ForEachBand(ThreadPool& a_oPool, int a_iHeight, const std::function<void(int, int)>& a_oRows)
+    {
+        int _bands = std::min(a_iHeight, std::max(1, a_oPool.GetThreadCount() * 4));
+
+        for (int b = 0; b < _bands; ++b)
+        {
+            int _begin = int(int64_t(a_iHeight) * b / _bands);
+            int _end = int(int64_t(a_iHeight) * (b + 1) / _bands);
+
+            a_oPool.Submit([&a_oRows, _begin, _end]()
+            {
+                a_oRows(_begin, _end);
+            });
+        }
+
+        a_oPool.Wait();
+    }
+
+    void Bilateral(FilterImage& a_oImage, const DenoiseSettings& a_oSettings, ThreadPool& a_oPool)
+    {
+        int _radius = std::max(a_oSettings.m_iRadius, 1);
+
+        float _spatial = InverseVariance(std::max(0.5f * _radius, 0.5f));
+
+        EdgeStops _stops = { InverseVariance(a_oSettings.m_fColorSigma), InverseVariance(a_oSettings.m_fNormalSigma),
+                             InverseVariance(a_oSettings.m_fAlbedoSigma), InverseVariance(a_oSettings.m_fDepthSigma) };
+
+        std::vector<Vec3> _filtered(a_oImage.m_oColor.size());
+
+        ForEachBand(a_oPool, a_oImage.m_iHeight, [&](int a_iBegin, int a_iEnd)
+        {
+            for (int j = a_iBegin; j < a_iEnd; ++j)
+            {
+                for (int i = 0; i < a_oImage.m_iWidth; ++i)
+                {
+                    size_t _p = size_t(j) * a_oImage.m_iWidth + i;
+
+                    Vec3 _sum(0.0f, 0.0f, 0.0f);
+
+                    float _weights = 0.0f;
+
+                    for (int y = std::max(j - _radius, 0); y <= std::min(j + _radius, a_oImage.m_iHeight - 1); ++y)
+                    {
+                        for (int x = std::max(i - _radius, 0); x <= std::min(i + _radius, a_oImage.m_iWidth - 1); ++x)
+                        {
+                            size_t _q = size_t(y) * a_oImage.m_iWidth + x;
+
+                            float _distance = float((x - i) * (x - i) + (y - j) * (y - j));
+
+                            float _weight = expf(-_distance * _spatial) * EdgeWeight(a_oImage, _p, _q, _stops);
+
+                            _sum += _weight * a_oImage.m_oColor[_q];
+                            _weights += _weight;
+                        }
+                    }
+
+                    // The centre tap weighs one, so _weights is never zero.
+                    _filtered[_p] = _sum / _weights;
+                }
+            }
+        });
+
+        a_oImage.m_oColor.swap(_filtered);
+    }
+
+    void Atrous(FilterImage& a_oImage, const DenoiseSettings& a_oSettings, ThreadPool& a_oPool)
+    {
+        std::vector<Vec3> _filtered(a_oImage.m_oColor.size());
+
+        float _colorSigma = a_oSettings.m_fColorSigma;
+
+        for (int _iteration = 0; _iteration < a_oSettings.m_iIterations; ++_iteration)
+        {
+            int _step = 1 << _iteration;
+
+            EdgeStops _stops = { InverseVariance(_colorSigma), InverseVariance(a_oSettings.m_fNormalSigma),
+                                 InverseVariance(a_oSettings.m_fAlbedoSigma), InverseVariance(a_oSettings.m_fDepthSigma) };
+
+            ForEachBand(a_oPool, a_oImage.m_iHeight, [&](int a_iBegin, int a_iEnd)
+            {
+                for (int j = a_iBegin; j < a_iEnd; ++j)
+                {
+                    for (int i = 0; i < a_oImage.m_iWidth; ++i)
+                    {
+                        size_t _p = size_t(j) * a_oImage.m_iWidth + i;
+
+                        Vec3 _sum(0.0f, 0.0f, 0.0f);
+
+                        float _weights = 0.0f;
+
+                        for (int b = 0; b < 5; ++b)
+                        {
+                            int y = j + (b - 2) * _step;
+
+                            if (y < 0 || y >= a_oImage.m_iHeight)
+                            {
+                                continue;
+                            }
+
+                            for (int a = 0; a < 5; ++a)
+                            {
+                                int x = i + (a - 2) * _step;
+
+                                if (x < 0 || x >= a_oImage.m_iWidth)
+                                {
+                                    continue;
+                                }
+
+                                size_t _q = size_t(y) * a_oImage.m_iWidth + x;
+
+                                float _weight = s_cfAtrousKernel[a] * s_cfAtrousKernel[b] * EdgeWeight(a_oImage, _p, _q, _stops);
+
+                                _sum += _weight * a_oImage.m_oColor[_q];
+                                _weights += _weight;
+                            }
+                        }
+
+                        _filtered[_p] = _sum / _weights;
+                    }
+                }
+            });
+
+            a_oImage.m_oColor.swap(_filtered);
+
+            UpdateEdgeColor(a_oImage);
+
+            // Each pass sees a smoother image, so colour edges can be held tighter.
+            _colorSigma *= 0.5f;
+        }
+    }
+
+#if RT_HAVE_OIDN
+    bool DenoiseOidn(const FrameBuffer& a_oInput, std::vector<Vec3>& a_oOutput, std::string& a_sError)
+    {
+        int _width = a_oInput.GetWidth();
+        int _height = a_oInput.GetHeight();
+
+        size_t _count = size_t(_width) * _height;
+
+        std::vector<Vec3> _albedo(_count);
+        std::vector<Vec3> _normal(_count);
+
+        for (int j = 0; j < _height; ++j)
+        {
+            for (int i = 0; i < _width; ++i)
+            {
+                _albedo[size_t(j) * _width + i] = a_oInput.GetAovs(i, j).m_oAlbedo;
+                _normal[size_t(j) * _width + i] = a_oInput.GetAovs(i, j).m_oNormal;
+            }
+        }
+
+        a_oOutput.resize(_count);
+
+        // Shared host images need the CPU device; a GPU one may not see host memory.
+        OIDNDevice _device = oidnNewDevice(OIDN_DEVICE_TYPE_CPU);
+
+        oidnCommitDevice(_device);
+
+        OIDNFilter _filter = oidnNewFilter(_device, "RT");
+
+        oidnSetSharedFilterImage(_filter, "color", const_cast<Vec3*>(a_oInput.GetData()), OIDN_FORMAT_FLOAT3, _width, _height, 0, 0, 0);
+        oidnSetSharedFilterImage(_filter, "albedo", &_albedo[0], OIDN_FORMAT_FLOAT3, _width, _height, 0, 0, 0);
+        oidnSetSharedFilterImage(_filter, "normal", &_normal[0], OIDN_FORMAT_FLOAT3, _width, _height, 0, 0, 0);
+        oidnSetSharedFilterImage(_filter, "output", &a_oOutput[0], OIDN_FORMAT_FLOAT3, _width, _height, 0, 0, 0);
+
+#if OIDN_VERSION_MAJOR >= 2
+        oidnSetFilterBool(_filter, "hdr", true);
+#else
+        oidnSetFilter1b(_filter, "hdr", true);
+#endif
+
+        oidnCommitFilter(_filter);
+        oidnExecuteFilter(_filter);
+
+        const char* _message = nullptr;
+
+        bool _ok = oidnGetDeviceError(_device, &_message) == OIDN_ERROR_NONE;
+
+        if (!_ok)
+        {
+            a_sError = std::string("Open Image Denoise failed: ") + (_message != nullptr ? _message : "unknown error");
+        }
+
+        oidnReleaseFilter(_filter);
+        oidnReleaseDevice(_device);
+
+        return _ok;
+    }
+#endif
+}
+
+DenoiseSettings::DenoiseSettings() : m_eType(DENOISER_NONE),
+                                     m_iRadius(4),
+                                     m_iIterations(5),
+                                     m_fColorSigma(0.1f),
+                                     m_fNormalSigma(0.3f),
+                                     m_fAlbedoSigma(0.1f),
+                                     m_fDepthSigma(0.1f)
+{
+}
+
+bool Denoiser::Denoise(const FrameBuffer &a_oInput, FrameBuffer &a_oOutput, const DenoiseSettings &a_oSettings, ThreadPool &a_oPool, std::string &a_sError)
+{
+    RT_TRACE_SPAN("denoise");
+
+    if (a_oOutput.GetWidth() != a_oInput.GetWidth() || a_oOutput.GetHeight() != a_oInput.GetHeight())
+    {
+        a_sError = "denoiser output does not match the input size";
+        return false;
+    }
+
+    if (a_oSettings.m_eType != DENOISER_NONE && !a_oInput.HasAovs())
+    {
+        a_sError = "denoising needs a frame rendered with AOVs";
+        return false;
+    }
+
+    if (!IsAvailable(a_oSettings.m_eType))
+    {
+        a_sError = std::string("this build has no ") + GetTypeName(a_oSettings.m_eType) + " denoiser";
+        return false;
+    }
+
+    int _width = a_oInput.GetWidth();
+    int _height = a_oInput.GetHeight();
+
+    std::vector<Vec3> _result(a_oInput.GetData(), a_oInput.GetData() + size_t(_width) * _height);
+
+    if (a_oSettings.m_eType == DENOISER_BILATERAL || a_oSettings.m_eType == DENOISER_ATROUS)
+    {
+        FilterImage _image;
+
+        Demodulate(a_oInput, _image);
+
+        if (a_oSettings.m_eType == DENOISER_BILATERAL)
+        {
+            Bilateral(_image, a_oSettings, a_oPool);
+        }
+        else
+        {
+            Atrous(_image, a_oSettings, a_oPool);
+        }
+
+        for (size_t p = 0; p < _result.size(); ++p)
+        {
+            _result[p] = _image.m_oColor[p] * _image.m_oModulation[p];
+        }
+    }
+#if RT_HAVE_OIDN
+    else if (a_oSettings.m_eType == DENOISER_OIDN && !DenoiseOidn(a_oInput, _result, a_sError))
+    {
+        return false;
+    }
+#endif
+
+    bool _aovs = a_oInput.HasAovs() && a_oOutput.HasAovs() && &a_oInput != &a_oOutput;
+
+    for (int j = 0; j < _height; ++j)
+    {
+        for (int i = 0; i < _width; ++i)
+        {
+            a_oOutput.SetPixel(i, j, _result[size_t(j) * _width + i]);
+            a_oOutput.SetSampleCount(i, j, a_oInput.GetSampleCount(i, j));
+
+            if (_aovs)
+            {
+                a_oOutput.SetAovs(i, j, a_oInput.GetAovs(i, j));
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Denoiser::ParseType(const std::string &a_sName, DenoiserType &a_eType)
+{
+    for (int t = 0; t < DENOISER_TYPE_COUNT; ++t)
+    {
+        if (a_sName == GetTypeName(DenoiserType(t)))
+        {
+            a_eType = DenoiserType(t);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* Denoiser::GetTypeName(DenoiserType a_eType)
+{
+    switch (a_eType)
+    {
+    case DENOISER_NONE:
+        return "none";
+    case DENOISER_BILATERAL:
+        return "bilateral";
+    case DENOISER_ATROUS:
+        return "atrous";
+    case DENOISER_OIDN:
+        return "oidn";
+    default:
+        return "unknown";
+    }
+}
+
+bool Denoiser::IsAvailable(DenoiserType a_eType)
+{
+    if (a_eType == DENOISER_OIDN)
+    {
+        return RT_HAVE_OIDN != 0;
+    }
+
+    return a_eType >= DENOISER_NONE && a_eType < DENOISER_TYPE_COUNT;
+}
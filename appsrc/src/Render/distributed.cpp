@@ -0,0 +1,887 @@
+#include "appsrc/include/Render/distributed.h"
+#include "appsrc/include/Math/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+namespace
+{
+    const char s_ccHelloMagic[4] = { 'R', 'T', 'W', 'H' };
+    const char s_ccSessionMagic[4] = { 'R', 'T', 'S', 'S' };
+    const char s_ccJobMagic[4] = { 'R', 'T', 'J', 'B' };
+    const char s_ccResultMagic[4] = { 'R', 'T', 'R', 'S' };
+
+    const int32_t s_ciProtocolVersion = 1;
+
+    // Messages are sent in host byte order; both ends check that they agree on it.
+    const uint32_t s_cuByteOrder = 0x01020304u;
+
+    // Upper bound on the units of one batch, against corrupt headers.
+    const int32_t s_ciMaxBatch = 1 << 16;
+
+    // How often the accept loop looks at the stop flag.
+    const int s_ciAcceptPollMs = 200;
+
+    const int s_ciConnectRetryMs = 500;
+
+    static_assert(sizeof(Vec3) == 3 * sizeof(float), "results send Vec3 as three packed floats");
+    static_assert(sizeof(SampleAovs) == 7 * sizeof(float), "results send SampleAovs as seven packed floats");
+
+    enum JobType
+    {
+        JOB_RENDER = 0,
+        JOB_STOP
+    };
+
+    struct WorkerHello
+    {
+        char m_cMagic[4];
+
+        int32_t m_iVersion;
+        uint32_t m_uByteOrder;
+        int32_t m_iThreads;
+    };
+
+    struct SessionMessage
+    {
+        char m_cMagic[4];
+
+        int32_t m_iVersion;
+
+        uint64_t m_uSceneKey;
+
+        double m_dTileTimeLimitMs;
+
+        int32_t m_iWidth;
+        int32_t m_iHeight;
+        int32_t m_iSamples;
+        int32_t m_iFirstSample;
+        int32_t m_iTileSize;
+        int32_t m_iMaxDepth;
+        int32_t m_iRouletteDepth;
+        int32_t m_iNextEvent;
+        int32_t m_iSampler;
+        int32_t m_iAdaptive;
+        int32_t m_iMinSamples;
+
+        float m_fNoiseThreshold;
+
+        int32_t m_iWavefront;
+
+        float m_fAperture;
+    };
+
+    // Followed by m_iUnitCount WireUnits.
+    struct JobHeader
+    {
+        char m_cMagic[4];
+
+        int32_t m_iType;
+        int32_t m_iFrame;
+        int32_t m_iAovs;
+        int32_t m_iUnitCount;
+    };
+
+    struct WireUnit
+    {
+        int32_t m_iX0;
+        int32_t m_iY0;
+        int32_t m_iX1;
+        int32_t m_iY1;
+
+        int32_t m_iFirstSample;
+        int32_t m_iSampleCount;
+    };
+
+    // Followed, per unit and in the job's order, by the pixel means, the sample counts and
+    // the AOVs if the job asked for them, each row by row over the tile.
+    struct ResultHeader
+    {
+        char m_cMagic[4];
+
+        int32_t m_iUnitCount;
+    };
+
+    inline size_t PixelCount(const Tile& a_oTile)
+    {
+        return size_t(a_oTile.m_iX1 - a_oTile.m_iX0) * size_t(a_oTile.m_iY1 - a_oTile.m_iY0);
+    }
+
+    inline Tile UnitTile(const WireUnit& a_oUnit)
+    {
+        Tile _tile;
+
+        _tile.m_iX0 = a_oUnit.m_iX0;
+        _tile.m_iY0 = a_oUnit.m_iY0;
+        _tile.m_iX1 = a_oUnit.m_iX1;
+        _tile.m_iY1 = a_oUnit.m_iY1;
+
+        return _tile;
+    }
+
+    // Renders a batch with one call per run of units that share a range of samples.
+    void RenderBatch(const TileBatchRenderer& a_oRender, int a_iFrame, const std::vector<WireUnit>& a_oUnits, FrameBuffer& a_oTarget)
+    {
+        std::vector<Tile> _tiles;
+
+        size_t _begin = 0;
+
+        while (_begin < a_oUnits.size())
+        {
+            const WireUnit& _first = a_oUnits[_begin];
+
+            _tiles.clear();
+
+            size_t _end = _begin;
+
+            while (_end < a_oUnits.size() && a_oUnits[_end].m_iFirstSample == _first.m_iFirstSample && a_oUnits[_end].m_iSampleCount == _first.m_iSampleCount)
+            {
+                _tiles.push_back(UnitTile(a_oUnits[_end]));
+                ++_end;
+            }
+
+            a_oRender(a_iFrame, _first.m_iFirstSample, _first.m_iSampleCount, _tiles, a_oTarget);
+
+            _begin = _end;
+        }
+    }
+
+    void PackTile(const FrameBuffer& a_oSource, const Tile& a_oTile, bool a_bAovs, std::vector<Vec3>& a_oPixels, std::vector<int32_t>& a_oSampleCounts, std::vector<SampleAovs>& a_oAovs)
+    {
+        a_oPixels.clear();
+        a_oSampleCounts.clear();
+        a_oAovs.clear();
+
+        for (int j = a_oTile.m_iY0; j < a_oTile.m_iY1; ++j)
+        {
+            for (int i = a_oTile.m_iX0; i < a_oTile.m_iX1; ++i)
+            {
+                a_oPixels.push_back(a_oSource.GetPixel(i, j));
+                a_oSampleCounts.push_back(a_oSource.GetSampleCount(i, j));
+
+                if (a_bAovs)
+                {
+                    a_oAovs.push_back(a_oSource.GetAovs(i, j));
+                }
+            }
+        }
+    }
+
+    bool SendTile(Socket& a_oSocket, const std::vector<Vec3>& a_oPixels, const std::vector<int32_t>& a_oSampleCounts, const std::vector<SampleAovs>& a_oAovs)
+    {
+        bool _ok = a_oSocket.Send(&a_oPixels[0], a_oPixels.size() * sizeof(Vec3))
+                && a_oSocket.Send(&a_oSampleCounts[0], a_oSampleCounts.size() * sizeof(int32_t));
+
+        return _ok && (a_oAovs.empty() || a_oSocket.Send(&a_oAovs[0], a_oAovs.size() * sizeof(SampleAovs)));
+    }
+
+    bool ReceiveTile(Socket& a_oSocket, size_t a_uPixels, bool a_bAovs, std::vector<Vec3>& a_oPixels, std::vector<int32_t>& a_oSampleCounts, std::vector<SampleAovs>& a_oAovs)
+    {
+        a_oPixels.resize(a_uPixels);
+        a_oSampleCounts.resize(a_uPixels);
+        a_oAovs.resize(a_bAovs ? a_uPixels : 0);
+
+        bool _ok = a_oSocket.Receive(&a_oPixels[0], a_uPixels * sizeof(Vec3))
+                && a_oSocket.Receive(&a_oSampleCounts[0], a_uPixels * sizeof(int32_t));
+
+        return _ok && (!a_bAovs || a_oSocket.Receive(&a_oAovs[0], a_uPixels * sizeof(SampleAovs)));
+    }
+
+    bool SendJob(Socket& a_oSocket, int a_iType, int a_iFrame, bool a_bAovs, const std::vector<WireUnit>& a_oUnits)
+    {
+        JobHeader _header;
+
+        memcpy(_header.m_cMagic, s_ccJobMagic, sizeof(s_ccJobMagic));
+
+        _header.m_iType = a_iType;
+        _header.m_iFrame = a_iFrame;
+        _header.m_iAovs = a_bAovs;
+        _header.m_iUnitCount = static_cast<int32_t>(a_oUnits.size());
+
+        return a_oSocket.Send(&_header, sizeof(_header)) && (a_oUnits.empty() || a_oSocket.Send(&a_oUnits[0], a_oUnits.size() * sizeof(WireUnit)));
+    }
+}
+
+DistributedSession::DistributedSession() : m_bWavefront(true),
+                                           m_fAperture(-1.0f),
+                                           m_uSceneKey(0)
+{
+}
+
+DistributedStats::DistributedStats() : m_iWorkersJoined(0),
+                                       m_iWorkersLost(0),
+                                       m_uLocalUnits(0),
+                                       m_uRemoteUnits(0),
+                                       m_uReissuedUnits(0)
+{
+}
+
+RenderCoordinator::RenderCoordinator(const DistributedSession &a_oSession, int a_iLocalThreads) : m_oSession(a_oSession),
+                                                                                                   m_iLocalThreads(std::max(a_iLocalThreads, 1)),
+                                                                                                   m_iUnitSamples(0),
+                                                                                                   m_dTimeout(0.0),
+                                                                                                   m_iRemaining(0),
+                                                                                                   m_iFrame(0),
+                                                                                                   m_bAovs(false),
+                                                                                                   m_iWorkers(0),
+                                                                                                   m_bStop(false)
+{
+}
+
+RenderCoordinator::~RenderCoordinator()
+{
+    this->Stop();
+}
+
+bool RenderCoordinator::Listen(int a_iPort, std::string &a_sError)
+{
+    if (!this->m_oListener.Listen(a_iPort, a_sError))
+    {
+        return false;
+    }
+
+    this->m_oAcceptThread = std::thread(&RenderCoordinator::AcceptLoop, this);
+
+    return true;
+}
+
+void RenderCoordinator::SetUnitSamples(int a_iSamples)
+{
+    this->m_iUnitSamples = a_iSamples;
+}
+
+void RenderCoordinator::SetTimeout(double a_dSeconds)
+{
+    this->m_dTimeout = a_dSeconds;
+}
+
+void RenderCoordinator::SetLog(const LogCallback &a_oLog)
+{
+    this->m_oLog = a_oLog;
+}
+
+void RenderCoordinator::RenderFrame(int a_iFrame, const std::vector<Tile> &a_oTiles, const TileBatchRenderer &a_oLocal, FrameBuffer &a_oFrameBuffer)
+{
+    RT_TRACE_SPAN("distributed frame");
+
+    const RenderSettings& _settings = this->m_oSession.m_oSettings;
+
+    int _rangeSamples = this->m_iUnitSamples > 0 ? std::min(this->m_iUnitSamples, _settings.m_iSamples) : _settings.m_iSamples;
+
+    int _ranges = std::max((_settings.m_iSamples + _rangeSamples - 1) / std::max(_rangeSamples, 1), 1);
+
+    int _tiles = static_cast<int>(a_oTiles.size());
+
+    bool _aovs = a_oFrameBuffer.HasAovs();
+
+    {
+        std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+        this->m_oResults.assign(size_t(_ranges) * _tiles, UnitResult());
+
+        this->m_oQueue.clear();
+
+        // Range-major, so batches mostly share one sample range.
+        for (int r = 0; r < _ranges; ++r)
+        {
+            for (int t = 0; t < _tiles; ++t)
+            {
+                Unit _unit;
+
+                _unit.m_oTile = a_oTiles[t];
+                _unit.m_iFirstSample = _settings.m_iFirstSample + r * _rangeSamples;
+                _unit.m_iSampleCount = std::min(_rangeSamples, _settings.m_iSamples - r * _rangeSamples);
+                _unit.m_iIndex = r * _tiles + t;
+
+                this->m_oQueue.push_back(_unit);
+            }
+        }
+
+        this->m_iRemaining = _ranges * _tiles;
+        this->m_iFrame = a_iFrame;
+        this->m_bAovs = _aovs;
+    }
+
+    this->m_oChanged.notify_all();
+
+    // This node works through the queue like any worker until nothing is left to take.
+    FrameBuffer _scratch(a_oFrameBuffer.GetWidth(), a_oFrameBuffer.GetHeight());
+
+    if (_aovs)
+    {
+        _scratch.EnableAovs();
+    }
+
+    std::vector<Unit> _batch;
+    std::vector<WireUnit> _units;
+    std::vector<UnitResult> _results;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> _lock(this->m_oMutex);
+
+            this->m_oChanged.wait(_lock, [this]()
+            {
+                return this->m_iRemaining == 0 || !this->m_oQueue.empty();
+            });
+
+            if (this->m_iRemaining == 0)
+            {
+                break;
+            }
+
+            this->TakeBatch(this->m_iLocalThreads, _batch);
+        }
+
+        _units.resize(_batch.size());
+
+        for (size_t u = 0; u < _batch.size(); ++u)
+        {
+            const Unit& _unit = _batch[u];
+
+            WireUnit _wire = { _unit.m_oTile.m_iX0, _unit.m_oTile.m_iY0, _unit.m_oTile.m_iX1, _unit.m_oTile.m_iY1, _unit.m_iFirstSample, _unit.m_iSampleCount };
+
+            _units[u] = _wire;
+        }
+
+        RenderBatch(a_oLocal, a_iFrame, _units, _scratch);
+
+        _results.resize(_batch.size());
+
+        for (size_t u = 0; u < _batch.size(); ++u)
+        {
+            PackTile(_scratch, _batch[u].m_oTile, _aovs, _results[u].m_oPixels, _results[u].m_oSampleCounts, _results[u].m_oAovs);
+        }
+
+        std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+        this->m_oStats.m_uLocalUnits += _batch.size();
+
+        this->Complete(_batch, _results);
+    }
+
+    // Every unit is in; merge each tile's ranges in range order.
+    for (int t = 0; t < _tiles; ++t)
+    {
+        const Tile& _tile = a_oTiles[t];
+
+        size_t p = 0;
+
+        for (int j = _tile.m_iY0; j < _tile.m_iY1; ++j)
+        {
+            for (int i = _tile.m_iX0; i < _tile.m_iX1; ++i, ++p)
+            {
+                const UnitResult& _first = this->m_oResults[t];
+
+                if (_ranges == 1)
+                {
+                    a_oFrameBuffer.SetPixel(i, j, _first.m_oPixels[p]);
+                    a_oFrameBuffer.SetSampleCount(i, j, _first.m_oSampleCounts[p]);
+
+                    if (_aovs)
+                    {
+                        a_oFrameBuffer.SetAovs(i, j, _first.m_oAovs[p]);
+                    }
+
+                    continue;
+                }
+
+                Vec3 _sum(0.0f, 0.0f, 0.0f);
+
+                SampleAovs _aovSum;
+
+                int _count = 0;
+
+                for (int r = 0; r < _ranges; ++r)
+                {
+                    const UnitResult& _result = this->m_oResults[size_t(r) * _tiles + t];
+
+                    float _weight = float(_result.m_oSampleCounts[p]);
+
+                    _sum += _weight * _result.m_oPixels[p];
+                    _count += _result.m_oSampleCounts[p];
+
+                    if (_aovs)
+                    {
+                        SampleAovs _weighted = _result.m_oAovs[p];
+
+                        _weighted.Scale(_weight);
+
+                        _aovSum.Add(_weighted);
+                    }
+                }
+
+                float _scale = _count > 0 ? 1.0f / float(_count) : 0.0f;
+
+                a_oFrameBuffer.SetPixel(i, j, _sum * _scale);
+                a_oFrameBuffer.SetSampleCount(i, j, _count);
+
+                if (_aovs)
+                {
+                    _aovSum.Scale(_scale);
+
+                    a_oFrameBuffer.SetAovs(i, j, _aovSum);
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+    std::vector<UnitResult>().swap(this->m_oResults);
+}
+
+void RenderCoordinator::Stop()
+{
+    {
+        std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+        this->m_bStop = true;
+    }
+
+    this->m_oChanged.notify_all();
+
+    // No worker threads are started once the accept loop is gone.
+    if (this->m_oAcceptThread.joinable())
+    {
+        this->m_oAcceptThread.join();
+    }
+
+    for (size_t w = 0; w < this->m_oWorkerThreads.size(); ++w)
+    {
+        this->m_oWorkerThreads[w].join();
+    }
+
+    this->m_oWorkerThreads.clear();
+
+    this->m_oListener.Close();
+}
+
+DistributedStats RenderCoordinator::GetStats() const
+{
+    std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+    return this->m_oStats;
+}
+
+int RenderCoordinator::GetWorkerCount() const
+{
+    std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+    return this->m_iWorkers;
+}
+
+void RenderCoordinator::AcceptLoop()
+{
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+            if (this->m_bStop)
+            {
+                return;
+            }
+        }
+
+        std::shared_ptr<Socket> _client(new Socket());
+
+        if (!this->m_oListener.Accept(*_client, s_ciAcceptPollMs))
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> _lock(this->m_oMutex);
+
+        if (this->m_bStop)
+        {
+            return;
+        }
+
+        this->m_oWorkerThreads.push_back(std::thread(&RenderCoordinator::ServeWorker, this, _client));
+    }
+}
+
+void RenderCoordinator::ServeWorker(std::shared_ptr<Socket> a_pSocket)
+{
+    Socket& _socket = *a_pSocket;
+
+    _socket.SetReceiveTimeout(this->m_dTimeout);
+
+    WorkerHello _hello;
+
+    bool _ok = _socket.Receive(&_hello, sizeof(_hello))
+            && memcmp(_hello.m_cMagic, s_ccHelloMagic, sizeof(s_ccHelloMagic)) == 0
+            && _hello.m_iVersion == s_ciProtocolVersion
+            && _hello.m_uByteOrder == s_cuByteOrder
+            && _hello.m_iThreads > 0;
+
+    if (_ok)
+    {
+        const RenderSettings& _settings = this->m_oSession.m_oSettings;
+
+        SessionMessage _session;
+
+        memset(&_session, 0, sizeof(_session));
+        memcpy(_session.m_cMagic, s_ccSessionMagic, sizeof(s_ccSessionMagic));
+
+        _session.m_iVersion = s_ciProtocolVersion;
+        _session.m_uSceneKey = this->m_oSession.m_uSceneKey;
+        _session.m_dTileTimeLimitMs = _settings.m_dTileTimeLimitMs;
+        _session.m_iWidth = _settings.m_iWidth;
+        _session.m_iHeight = _settings.m_iHeight;
+        _session.m_iSamples = _settings.m_iSamples;
+        _session.m_iFirstSample = _settings.m_iFirstSample;
+        _session.m_iTileSize = _settings.m_iTileSize;
+        _session.m_iMaxDepth = _settings.m_iMaxDepth;
+        _session.m_iRouletteDepth = _settings.m_iRouletteDepth;
+        _session.m_iNextEvent = _settings.m_bNextEvent;
+        _session.m_iSampler = _settings.m_eSampler;
+        _session.m_iAdaptive = _settings.m_bAdaptive;
+        _session.m_iMinSamples = _settings.m_iMinSamples;
+        _session.m_fNoiseThreshold = _settings.m_fNoiseThreshold;
+        _session.m_iWavefront = this->m_oSession.m_bWavefront;
+        _session.m_fAperture = this->m_oSession.m_fAperture;
+
+        _ok = _socket.Send(&_session, sizeof(_session));
+    }
+
+    std::unique_lock<std::mutex> _lock(this->m_oMutex);
+
+    if (!_ok)
+    {
+        if (this->m_oLog)
+        {
+            this->m_oLog("Rejected a worker from " + _socket.GetPeerName() + ": no valid handshake");
+        }
+
+        return;
+    }
+
+    ++this->m_iWorkers;
+    ++this->m_oStats.m_iWorkersJoined;
+
+    if (this->m_oLog)
+    {
+        this->m_oLog("Worker " + _socket.GetPeerName() + " joined with " + std::to_string(_hello.m_iThreads) + " threads");
+    }
+
+    // Up to two batches per worker: the one it renders and the one behind it.
+    std::deque<std::vector<Unit> > _inFlight;
+
+    std::vector<Unit> _batch;
+    std::vector<WireUnit> _units;
+    std::vector<UnitResult> _results;
+
+    bool _failed = false;
+
+    while (!_failed)
+    {
+        if (_inFlight.empty())
+        {
+            this->m_oChanged.wait(_lock, [this]()
+            {
+                return this->m_bStop || !this->m_oQueue.empty();
+            });
+
+            if (this->m_oQueue.empty())
+            {
+                break;
+            }
+        }
+
+        int _frame = this->m_iFrame;
+
+        bool _aovs = this->m_bAovs;
+
+        size_t _sent = _inFlight.size();
+
+        while (_inFlight.size() < 2 && !this->m_oQueue.empty())
+        {
+            this->TakeBatch(_hello.m_iThreads, _batch);
+
+            _inFlight.push_back(_batch);
+        }
+
+        _lock.unlock();
+
+        for (size_t b = _sent; b < _inFlight.size() && !_failed; ++b)
+        {
+            const std::vector<Unit>& _job = _inFlight[b];
+
+            _units.resize(_job.size());
+
+            for (size_t u = 0; u < _job.size(); ++u)
+            {
+                const Unit& _unit = _job[u];
+
+                WireUnit _wire = { _unit.m_oTile.m_iX0, _unit.m_oTile.m_iY0, _unit.m_oTile.m_iX1, _unit.m_oTile.m_iY1, _unit.m_iFirstSample, _unit.m_iSampleCount };
+
+                _units[u] = _wire;
+            }
+
+            _failed = !SendJob(_socket, JOB_RENDER, _frame, _aovs, _units);
+        }
+
+        if (!_failed)
+        {
+            const std::vector<Unit>& _job = _inFlight.front();
+
+            ResultHeader _header;
+
+            _failed = !_socket.Receive(&_header, sizeof(_header))
+                   || memcmp(_header.m_cMagic, s_ccResultMagic, sizeof(s_ccResultMagic)) != 0
+                   || _header.m_iUnitCount != static_cast<int32_t>(_job.size());
+
+            _results.resize(_job.size());
+
+            for (size_t u = 0; u < _job.size() && !_failed; ++u)
+            {
+                _failed = !ReceiveTile(_socket, PixelCount(_job[u].m_oTile), _aovs, _results[u].m_oPixels, _results[u].m_oSampleCounts, _results[u].m_oAovs);
+            }
+        }
+
+        _lock.lock();
+
+        if (!_failed)
+        {
+            this->m_oStats.m_uRemoteUnits += _inFlight.front().size();
+
+            this->Complete(_inFlight.front(), _results);
+
+            _inFlight.pop_front();
+        }
+    }
+
+    --this->m_iWorkers;
+
+    if (_failed)
+    {
+        // Back to the front, in their original order, so they are the next handed out.
+        for (size_t b = _inFlight.size(); b-- > 0;)
+        {
+            const std::vector<Unit>& _job = _inFlight[b];
+
+            for (size_t u = _job.size(); u-- > 0;)
+            {
+                this->m_oQueue.push_front(_job[u]);
+            }
+
+            this->m_oStats.m_uReissuedUnits += _job.size();
+        }
+
+        ++this->m_oStats.m_iWorkersLost;
+
+        if (this->m_oLog)
+        {
+            this->m_oLog("Lost worker " + _socket.GetPeerName() + ", reissuing its tiles");
+        }
+
+        _lock.unlock();
+
+        this->m_oChanged.notify_all();
+
+        _socket.Close();
+
+        return;
+    }
+
+    _lock.unlock();
+
+    SendJob(_socket, JOB_STOP, 0, false, std::vector<WireUnit>());
+
+    _socket.Close();
+}
+
+void RenderCoordinator::TakeBatch(int a_iThreads, std::vector<Unit> &a_oBatch)
+{
+    a_oBatch.clear();
+
+    // Two tiles per thread keep a node busy through uneven tiles, and near the end of a
+    // frame no node takes more than its share of what is left.
+    size_t _nodes = size_t(this->m_iWorkers) + 1;
+
+    size_t _share = (this->m_oQueue.size() + _nodes - 1) / _nodes;
+
+    size_t _size = std::max<size_t>(std::min<size_t>(2 * size_t(std::max(a_iThreads, 1)), _share), 1);
+
+    while (a_oBatch.size() < _size && !this->m_oQueue.empty())
+    {
+        a_oBatch.push_back(this->m_oQueue.front());
+
+        this->m_oQueue.pop_front();
+    }
+}
+
+void RenderCoordinator::Complete(std::vector<Unit> &a_oUnits, std::vector<UnitResult> &a_oResults)
+{
+    for (size_t u = 0; u < a_oUnits.size(); ++u)
+    {
+        UnitResult& _result = this->m_oResults[a_oUnits[u].m_iIndex];
+
+        _result.m_oPixels.swap(a_oResults[u].m_oPixels);
+        _result.m_oSampleCounts.swap(a_oResults[u].m_oSampleCounts);
+        _result.m_oAovs.swap(a_oResults[u].m_oAovs);
+    }
+
+    this->m_iRemaining -= static_cast<int>(a_oUnits.size());
+
+    this->m_oChanged.notify_all();
+}
+
+RenderWorker::RenderWorker() : m_uUnits(0)
+{
+}
+
+bool RenderWorker::Connect(const std::string &a_sHost, int a_iPort, int a_iThreads, double a_dRetrySeconds, DistributedSession &a_oSession, std::string &a_sError)
+{
+    std::chrono::steady_clock::time_point _deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<int64_t>(a_dRetrySeconds * 1000.0));
+
+    while (!this->m_oSocket.Connect(a_sHost, a_iPort, a_sError))
+    {
+        if (std::chrono::steady_clock::now() >= _deadline)
+        {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(s_ciConnectRetryMs));
+    }
+
+    WorkerHello _hello;
+
+    memcpy(_hello.m_cMagic, s_ccHelloMagic, sizeof(s_ccHelloMagic));
+
+    _hello.m_iVersion = s_ciProtocolVersion;
+    _hello.m_uByteOrder = s_cuByteOrder;
+    _hello.m_iThreads = std::max(a_iThreads, 1);
+
+    SessionMessage _session;
+
+    bool _ok = this->m_oSocket.Send(&_hello, sizeof(_hello)) && this->m_oSocket.Receive(&_session, sizeof(_session));
+
+    if (!_ok || memcmp(_session.m_cMagic, s_ccSessionMagic, sizeof(s_ccSessionMagic)) != 0 || _session.m_iVersion != s_ciProtocolVersion)
+    {
+        a_sError = "the coordinator at " + this->m_oSocket.GetPeerName() + " closed the connection without sending its settings";
+
+        this->m_oSocket.Close();
+        return false;
+    }
+
+    RenderSettings& _settings = a_oSession.m_oSettings;
+
+    _settings.m_iWidth = _session.m_iWidth;
+    _settings.m_iHeight = _session.m_iHeight;
+    _settings.m_iSamples = _session.m_iSamples;
+    _settings.m_iFirstSample = _session.m_iFirstSample;
+    _settings.m_iTileSize = _session.m_iTileSize;
+    _settings.m_iMaxDepth = _session.m_iMaxDepth;
+    _settings.m_iRouletteDepth = _session.m_iRouletteDepth;
+    _settings.m_bNextEvent = _session.m_iNextEvent != 0;
+    _settings.m_eSampler = SamplerType(_session.m_iSampler);
+    _settings.m_bAdaptive = _session.m_iAdaptive != 0;
+    _settings.m_iMinSamples = _session.m_iMinSamples;
+    _settings.m_fNoiseThreshold = _session.m_fNoiseThreshold;
+    _settings.m_dTileTimeLimitMs = _session.m_dTileTimeLimitMs;
+
+    a_oSession.m_bWavefront = _session.m_iWavefront != 0;
+    a_oSession.m_fAperture = _session.m_fAperture;
+    a_oSession.m_uSceneKey = _session.m_uSceneKey;
+
+    this->m_oSettings = _settings;
+
+    return true;
+}
+
+bool RenderWorker::Serve(const TileBatchRenderer &a_oRender, std::string &a_sError)
+{
+    FrameBuffer _scratch(this->m_oSettings.m_iWidth, this->m_oSettings.m_iHeight);
+
+    std::vector<WireUnit> _units;
+
+    std::vector<Vec3> _pixels;
+    std::vector<int32_t> _sampleCounts;
+    std::vector<SampleAovs> _aovs;
+
+    while (true)
+    {
+        JobHeader _header;
+
+        if (!this->m_oSocket.Receive(&_header, sizeof(_header)) || memcmp(_header.m_cMagic, s_ccJobMagic, sizeof(s_ccJobMagic)) != 0)
+        {
+            a_sError = "lost the connection to the coordinator";
+            return false;
+        }
+
+        if (_header.m_iType == JOB_STOP)
+        {
+            this->m_oSocket.Close();
+            return true;
+        }
+
+        if (_header.m_iType != JOB_RENDER || _header.m_iUnitCount <= 0 || _header.m_iUnitCount > s_ciMaxBatch)
+        {
+            a_sError = "the coordinator sent a malformed job";
+            return false;
+        }
+
+        _units.resize(_header.m_iUnitCount);
+
+        if (!this->m_oSocket.Receive(&_units[0], _units.size() * sizeof(WireUnit)))
+        {
+            a_sError = "lost the connection to the coordinator";
+            return false;
+        }
+
+        for (size_t u = 0; u < _units.size(); ++u)
+        {
+            const WireUnit& _unit = _units[u];
+
+            if (_unit.m_iX0 < 0 || _unit.m_iY0 < 0 || _unit.m_iX1 > this->m_oSettings.m_iWidth || _unit.m_iY1 > this->m_oSettings.m_iHeight
+                || _unit.m_iX0 >= _unit.m_iX1 || _unit.m_iY0 >= _unit.m_iY1 || _unit.m_iSampleCount <= 0)
+            {
+                a_sError = "the coordinator sent a tile outside the image";
+                return false;
+            }
+        }
+
+        bool _withAovs = _header.m_iAovs != 0;
+
+        if (_withAovs && !_scratch.HasAovs())
+        {
+            _scratch.EnableAovs();
+        }
+
+        RT_TRACE_SPAN("worker batch");
+
+        RenderBatch(a_oRender, _header.m_iFrame, _units, _scratch);
+
+        ResultHeader _result;
+
+        memcpy(_result.m_cMagic, s_ccResultMagic, sizeof(s_ccResultMagic));
+
+        _result.m_iUnitCount = _header.m_iUnitCount;
+
+        bool _ok = this->m_oSocket.Send(&_result, sizeof(_result));
+
+        for (size_t u = 0; u < _units.size() && _ok; ++u)
+        {
+            PackTile(_scratch, UnitTile(_units[u]), _withAovs, _pixels, _sampleCounts, _aovs);
+
+            _ok = SendTile(this->m_oSocket, _pixels, _sampleCounts, _aovs);
+        }
+
+        if (!_ok)
+        {
+            a_sError = "lost the connection to the coordinator";
+            return false;
+        }
+
+        this->m_uUnits += _units.size();
+    }
+}
+
+uint64_t RenderWorker::GetUnitCount() const
+{
+    return this->m_uUnits;
+}
@@ -0,0 +1,133 @@
+#include "appsrc/include/Render/framebuffer.h"
+#include <algorithm>
+
+SampleAovs::SampleAovs() : m_oAlbedo(0.0f, 0.0f, 0.0f),
+                           m_oNormal(0.0f, 0.0f, 0.0f),
+                           m_fDepth(0.0f)
+{
+}
+
+void SampleAovs::Add(const SampleAovs &a_oOther)
+{
+    this->m_oAlbedo += a_oOther.m_oAlbedo;
+    this->m_oNormal += a_oOther.m_oNormal;
+    this->m_fDepth += a_oOther.m_fDepth;
+}
+
+void SampleAovs::Scale(float a_fFactor)
+{
+    this->m_oAlbedo *= a_fFactor;
+    this->m_oNormal *= a_fFactor;
+    this->m_fDepth *= a_fFactor;
+}
+
+FrameBuffer::FrameBuffer(int a_iWidth, int a_iHeight) : m_iWidth(a_iWidth),
+                                                         m_iHeight(a_iHeight),
+                                                         m_oPixels(a_iWidth * a_iHeight, Vec3(0.0f, 0.0f, 0.0f)),
+                                                         m_oSampleCounts(a_iWidth * a_iHeight, 0)
+{
+}
+
+void FrameBuffer::EnableAovs()
+{
+    this->m_oAovs.resize(this->m_oPixels.size());
+}
+
+bool FrameBuffer::HasAovs() const
+{
+    return !this->m_oAovs.empty();
+}
+
+void FrameBuffer::SetAovs(int a_iX, int a_iY, const SampleAovs &a_oAovs)
+{
+    this->m_oAovs[a_iY * this->m_iWidth + a_iX] = a_oAovs;
+}
+
+const SampleAovs& FrameBuffer::GetAovs(int a_iX, int a_iY) const
+{
+    return this->m_oAovs[a_iY * this->m_iWidth + a_iX];
+}
+
+void FrameBuffer::CopyAov(AovChannel a_eChannel, FrameBuffer &a_oTarget) const
+{
+    for (int j = 0; j < this->m_iHeight; ++j)
+    {
+        for (int i = 0; i < this->m_iWidth; ++i)
+        {
+            const SampleAovs& _aovs = this->GetAovs(i, j);
+
+            Vec3 _value = a_eChannel == AOV_ALBEDO ? _aovs.m_oAlbedo
+                        : a_eChannel == AOV_NORMAL ? _aovs.m_oNormal
+                        : Vec3(_aovs.m_fDepth, _aovs.m_fDepth, _aovs.m_fDepth);
+
+            a_oTarget.SetPixel(i, j, _value);
+            a_oTarget.SetSampleCount(i, j, this->GetSampleCount(i, j));
+        }
+    }
+}
+
+void FrameBuffer::SetPixel(int a_iX, int a_iY, const Vec3 &a_oColor)
+{
+    this->m_oPixels[a_iY * this->m_iWidth + a_iX] = a_oColor;
+}
+
+const Vec3& FrameBuffer::GetPixel(int a_iX, int a_iY) const
+{
+    return this->m_oPixels[a_iY * this->m_iWidth + a_iX];
+}
+
+void FrameBuffer::SetSampleCount(int a_iX, int a_iY, int a_iCount)
+{
+    this->m_oSampleCounts[a_iY * this->m_iWidth + a_iX] = a_iCount;
+}
+
+int FrameBuffer::GetSampleCount(int a_iX, int a_iY) const
+{
+    return this->m_oSampleCounts[a_iY * this->m_iWidth + a_iX];
+}
+
+int FrameBuffer::GetWidth() const
+{
+    return this->m_iWidth;
+}
+
+int FrameBuffer::GetHeight() const
+{
+    return this->m_iHeight;
+}
+
+const Vec3* FrameBuffer::GetData() const
+{
+    return this->m_oPixels.empty() ? nullptr : &this->m_oPixels[0];
+}
+
+void FrameBuffer::SampleHeatmapToRgb8(std::vector<unsigned char> &a_oRgb) const
+{
+    a_oRgb.resize(3 * this->m_oSampleCounts.size());
+
+    int _min = 0;
+    int _max = 0;
+
+    if (!this->m_oSampleCounts.empty())
+    {
+        _min = *std::min_element(this->m_oSampleCounts.begin(), this->m_oSampleCounts.end());
+        _max = *std::max_element(this->m_oSampleCounts.begin(), this->m_oSampleCounts.end());
+    }
+
+    float _range = _max > _min ? float(_max - _min) : 1.0f;
+
+    unsigned char* _out = a_oRgb.empty() ? nullptr : &a_oRgb[0];
+
+    for (int j = this->m_iHeight - 1; j >= 0; --j)
+    {
+        for (int i = 0; i < this->m_iWidth; ++i)
+        {
+            float _t = (this->GetSampleCount(i, j) - _min) / _range;
+
+            // Blue -> green -> red.
+            *_out++ = static_cast<unsigned char>(int(255.99f * std::max(0.0f, 2.0f * _t - 1.0f)));
+            *_out++ = static_cast<unsigned char>(int(255.99f * (1.0f - fabsf(2.0f * _t - 1.0f))));
+            *_out++ = static_cast<unsigned char>(int(255.99f * std::max(0.0f, 1.0f - 2.0f * _t)));
+        }
+    }
+}
@@ -0,0 +1,382 @@
+#include "appsrc/include/Render/gpudevice.h"
+#include <cuda_runtime.h>
+#include <algorithm>
+
+namespace
+{
+    const int s_ciBlockSize = 128;
+
+    // Paths in flight per wave, which bounds the path and queue buffers.
+    const int s_ciMaxWavePaths = 1 << 19;
+
+    bool Check(cudaError_t a_eError, const char* a_sWhat, std::string& a_sError)
+    {
+        if (a_eError == cudaSuccess)
+        {
+            return true;
+        }
+
+        a_sError = std::string(a_sWhat) + ": " + cudaGetErrorString(a_eError);
+        return false;
+    }
+
+    int BlockCount(int a_iCount)
+    {
+        return (a_iCount + s_ciBlockSize - 1) / s_ciBlockSize;
+    }
+
+    // Device storage that only ever grows.
+    template <typename T>
+    struct DeviceArray
+    {
+        DeviceArray() : m_pData(nullptr),
+                        m_uCapacity(0)
+        {
+        }
+
+        ~DeviceArray()
+        {
+            cudaFree(this->m_pData);
+        }
+
+        bool Reserve(size_t a_uCount, std::string& a_sError)
+        {
+            if (a_uCount <= this->m_uCapacity)
+            {
+                return true;
+            }
+
+            cudaFree(this->m_pData);
+
+            this->m_pData = nullptr;
+            this->m_uCapacity = 0;
+
+            if (!Check(cudaMalloc(reinterpret_cast<void**>(&this->m_pData), a_uCount * sizeof(T)), "cudaMalloc", a_sError))
+            {
+                return false;
+            }
+
+            this->m_uCapacity = a_uCount;
+
+            return true;
+        }
+
+        // Leaves the array alone and returns null for empty input.
+        const T* Upload(const std::vector<T>& a_oHost, std::string& a_sError, bool& a_bOk)
+        {
+            if (a_oHost.empty() || !a_bOk)
+            {
+                return nullptr;
+            }
+
+            a_bOk = this->Reserve(a_oHost.size(), a_sError) && Check(cudaMemcpy(this->m_pData, &a_oHost[0], a_oHost.size() * sizeof(T), cudaMemcpyHostToDevice), "cudaMemcpy", a_sError);
+
+            return this->m_pData;
+        }
+
+        void Swap(DeviceArray& a_oOther)
+        {
+            std::swap(this->m_pData, a_oOther.m_pData);
+            std::swap(this->m_uCapacity, a_oOther.m_uCapacity);
+        }
+
+        T* m_pData;
+
+        size_t m_uCapacity;
+
+    private:
+        DeviceArray(const DeviceArray&);
+        DeviceArray& operator=(const DeviceArray&);
+    };
+
+    // Path i of a wave is sample a_iFirstSample + i / a_iPixelCount of pixel i % a_iPixelCount.
+    __global__ void StartKernel(GpuFrame a_oFrame, const GpuPixel* a_pPixels, int a_iPixelCount, int a_iFirstSample, int a_iPathCount, GpuPath* a_pPaths, int* a_pActive)
+    {
+        int i = blockIdx.x * blockDim.x + threadIdx.x;
+
+        if (i >= a_iPathCount)
+        {
+            return;
+        }
+
+        const GpuPixel& _pixel = a_pPixels[i % a_iPixelCount];
+
+        GpuStartPath(a_oFrame, _pixel.m_iX, _pixel.m_iY, a_iFirstSample + i / a_iPixelCount, a_pPaths[i]);
+
+        a_pActive[i] = i;
+    }
+
+    // Sorts the surviving paths into one queue per material type, a_iQueueStride apart.
+    __global__ void ExtendKernel(GpuScene a_oScene, GpuFrame a_oFrame, GpuPath* a_pPaths, const int* a_pActive, int a_iActiveCount, int* a_pQueues, int a_iQueueStride, int* a_pQueueCounts)
+    {
+        int k = blockIdx.x * blockDim.x + threadIdx.x;
+
+        if (k >= a_iActiveCount)
+        {
+            return;
+        }
+
+        int _index = a_pActive[k];
+
+        int _type = GpuExtend(a_oScene, a_oFrame, a_pPaths[_index]);
+
+        if (_type < 0)
+        {
+            return;
+        }
+
+        a_pQueues[_type * a_iQueueStride + atomicAdd(&a_pQueueCounts[_type], 1)] = _index;
+    }
+
+    // Every thread of a launch shades the same material type, so warps do not diverge on it.
+    __global__ void ShadeKernel(GpuScene a_oScene, GpuFrame a_oFrame, GpuPath* a_pPaths, const int* a_pQueue, int a_iQueueCount, int* a_pNextActive, int* a_pNextCount)
+    {
+        int k = blockIdx.x * blockDim.x + threadIdx.x;
+
+        if (k >= a_iQueueCount)
+        {
+            return;
+        }
+
+        int _index = a_pQueue[k];
+
+        if (GpuShade(a_oScene, a_oFrame, a_pPaths[_index]))
+        {
+            a_pNextActive[atomicAdd(a_pNextCount, 1)] = _index;
+        }
+    }
+
+    // One thread per pixel, adding its samples in index order so the sums do not depend on
+    // the order paths finished in.
+    __global__ void AccumulateKernel(GpuFrame a_oFrame, const GpuPath* a_pPaths, int a_iPixelCount, int a_iWaveSamples, GpuPixelSum* a_pSums)
+    {
+        int p = blockIdx.x * blockDim.x + threadIdx.x;
+
+        if (p >= a_iPixelCount)
+        {
+            return;
+        }
+
+        GpuPixelSum _sum = a_pSums[p];
+
+        for (int s = 0; s < a_iWaveSamples; ++s)
+        {
+            GpuAccumulate(a_oFrame, a_pPaths[s * a_iPixelCount + p], _sum);
+        }
+
+        a_pSums[p] = _sum;
+    }
+}
+
+struct GpuDevice::Buffers
+{
+    GpuScene m_oScene;
+
+    DeviceArray<GpuBvhNode> m_oNodes;
+    DeviceArray<float> m_oCenterX;
+    DeviceArray<float> m_oCenterY;
+    DeviceArray<float> m_oCenterZ;
+    DeviceArray<float> m_oRadius;
+    DeviceArray<uint32_t> m_oMaterialIds;
+    DeviceArray<float> m_oVelocityX;
+    DeviceArray<float> m_oVelocityY;
+    DeviceArray<float> m_oVelocityZ;
+    DeviceArray<GpuMaterial> m_oMaterials;
+    DeviceArray<GpuLight> m_oLights;
+    DeviceArray<int32_t> m_oSpheresByMaterial;
+    DeviceArray<float> m_oMask;
+
+    DeviceArray<GpuPixel> m_oPixels;
+    DeviceArray<GpuPixelSum> m_oSums;
+    DeviceArray<GpuPath> m_oPaths;
+
+    // The active list and the one the shade kernels fill, swapped every bounce.
+    DeviceArray<int> m_oActive;
+    DeviceArray<int> m_oNextActive;
+
+    DeviceArray<int> m_oQueues;
+
+    // GPU_MATERIAL_TYPE_COUNT queue sizes, then the size of the next active list.
+    DeviceArray<int> m_oCounts;
+};
+
+GpuDevice::GpuDevice() : m_pBuffers(new Buffers())
+{
+    this->m_pBuffers->m_oScene = GpuScene();
+}
+
+GpuDevice::~GpuDevice()
+{
+}
+
+bool GpuDevice::Open(std::string &a_sError)
+{
+    int _count = 0;
+
+    if (!Check(cudaGetDeviceCount(&_count), "cudaGetDeviceCount", a_sError))
+    {
+        return false;
+    }
+
+    if (_count == 0)
+    {
+        a_sError = "no CUDA device present";
+        return false;
+    }
+
+    int _device = 0;
+
+    cudaDeviceProp _properties;
+
+    if (!Check(cudaGetDevice(&_device), "cudaGetDevice", a_sError) || !Check(cudaGetDeviceProperties(&_properties, _device), "cudaGetDeviceProperties", a_sError))
+    {
+        return false;
+    }
+
+    this->m_sName = _properties.name;
+
+    return true;
+}
+
+const std::string& GpuDevice::GetName() const
+{
+    return this->m_sName;
+}
+
+bool GpuDevice::UploadScene(const GpuSceneData &a_oData, std::string &a_sError)
+{
+    Buffers& _buffers = *this->m_pBuffers;
+
+    GpuScene& _scene = _buffers.m_oScene;
+
+    bool _ok = true;
+
+    _scene.m_pNodes = _buffers.m_oNodes.Upload(a_oData.m_oNodes, a_sError, _ok);
+    _scene.m_iNodeCount = static_cast<int32_t>(a_oData.m_oNodes.size());
+
+    _scene.m_pCenterX = _buffers.m_oCenterX.Upload(a_oData.m_oCenterX, a_sError, _ok);
+    _scene.m_pCenterY = _buffers.m_oCenterY.Upload(a_oData.m_oCenterY, a_sError, _ok);
+    _scene.m_pCenterZ = _buffers.m_oCenterZ.Upload(a_oData.m_oCenterZ, a_sError, _ok);
+    _scene.m_pRadius = _buffers.m_oRadius.Upload(a_oData.m_oRadius, a_sError, _ok);
+    _scene.m_pMaterialId = _buffers.m_oMaterialIds.Upload(a_oData.m_oMaterialIds, a_sError, _ok);
+
+    _scene.m_pVelocityX = _buffers.m_oVelocityX.Upload(a_oData.m_oVelocityX, a_sError, _ok);
+    _scene.m_pVelocityY = _buffers.m_oVelocityY.Upload(a_oData.m_oVelocityY, a_sError, _ok);
+    _scene.m_pVelocityZ = _buffers.m_oVelocityZ.Upload(a_oData.m_oVelocityZ, a_sError, _ok);
+
+    _scene.m_pMaterials = _buffers.m_oMaterials.Upload(a_oData.m_oMaterials, a_sError, _ok);
+
+    _scene.m_pLights = _buffers.m_oLights.Upload(a_oData.m_oLights, a_sError, _ok);
+    _scene.m_iLightCount = static_cast<int32_t>(a_oData.m_oLights.size());
+    _scene.m_fTotalPower = a_oData.m_fTotalPower;
+
+    _scene.m_pSpheresByMaterial = _buffers.m_oSpheresByMaterial.Upload(a_oData.m_oSpheresByMaterial, a_sError, _ok);
+    _scene.m_iSphereLightCount = static_cast<int32_t>(a_oData.m_oSpheresByMaterial.size());
+
+    _scene.m_oBackground = a_oData.m_oBackground;
+    _scene.m_bBackground = a_oData.m_bBackground;
+
+    if (!_ok)
+    {
+        // Nothing may trace a half-uploaded scene.
+        _scene.m_iNodeCount = 0;
+    }
+
+    return _ok;
+}
+
+bool GpuDevice::Render(const GpuFrame &a_oFrame, const std::vector<float> &a_oMask, const std::vector<GpuPixel> &a_oPixels, int a_iFirstSample, int a_iSampleCount, const std::atomic<bool> *a_pCancel, std::vector<GpuPixelSum> &a_oSums, std::string &a_sError)
+{
+    Buffers& _buffers = *this->m_pBuffers;
+
+    const int _pixelCount = static_cast<int>(a_oPixels.size());
+
+    if (_pixelCount == 0 || a_iSampleCount <= 0)
+    {
+        a_oSums.assign(a_oPixels.size(), GpuPixelSum());
+        return true;
+    }
+
+    // Whole samples of every pixel per wave, as many as fit.
+    const int _waveSamples = std::max(1, std::min(a_iSampleCount, s_ciMaxWavePaths / _pixelCount));
+    const int _maxPaths = _pixelCount * _waveSamples;
+
+    bool _ok = true;
+
+    GpuFrame _frame = a_oFrame;
+
+    _frame.m_oSampler.m_pMask = _buffers.m_oMask.Upload(a_oMask, a_sError, _ok);
+
+    const GpuPixel* _pixels = _buffers.m_oPixels.Upload(a_oPixels, a_sError, _ok);
+
+    if (!_ok
+        || !_buffers.m_oSums.Reserve(_pixelCount, a_sError)
+        || !_buffers.m_oPaths.Reserve(_maxPaths, a_sError)
+        || !_buffers.m_oActive.Reserve(_maxPaths, a_sError)
+        || !_buffers.m_oNextActive.Reserve(_maxPaths, a_sError)
+        || !_buffers.m_oQueues.Reserve(size_t(_maxPaths) * GPU_MATERIAL_TYPE_COUNT, a_sError)
+        || !_buffers.m_oCounts.Reserve(GPU_MATERIAL_TYPE_COUNT + 1, a_sError))
+    {
+        return false;
+    }
+
+    if (!Check(cudaMemset(_buffers.m_oSums.m_pData, 0, _pixelCount * sizeof(GpuPixelSum)), "cudaMemset", a_sError))
+    {
+        return false;
+    }
+
+    const GpuScene& _scene = _buffers.m_oScene;
+
+    int* _counts = _buffers.m_oCounts.m_pData;
+
+    int _hostCounts[GPU_MATERIAL_TYPE_COUNT + 1];
+
+    for (int _first = 0; _first < a_iSampleCount; _first += _waveSamples)
+    {
+        if (a_pCancel != nullptr && a_pCancel->load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+
+        int _samples = std::min(_waveSamples, a_iSampleCount - _first);
+        int _active = _pixelCount * _samples;
+
+        StartKernel<<<BlockCount(_active), s_ciBlockSize>>>(_frame, _pixels, _pixelCount, a_iFirstSample + _first, _active, _buffers.m_oPaths.m_pData, _buffers.m_oActive.m_pData);
+
+        while (_active > 0)
+        {
+            if (!Check(cudaMemset(_counts, 0, sizeof(_hostCounts)), "cudaMemset", a_sError))
+            {
+                return false;
+            }
+
+            ExtendKernel<<<BlockCount(_active), s_ciBlockSize>>>(_scene, _frame, _buffers.m_oPaths.m_pData, _buffers.m_oActive.m_pData, _active, _buffers.m_oQueues.m_pData, _maxPaths, _counts);
+
+            if (!Check(cudaMemcpy(_hostCounts, _counts, sizeof(_hostCounts), cudaMemcpyDeviceToHost), "extend", a_sError))
+            {
+                return false;
+            }
+
+            for (int t = 0; t < GPU_MATERIAL_TYPE_COUNT; ++t)
+            {
+                if (_hostCounts[t] > 0)
+                {
+                    ShadeKernel<<<BlockCount(_hostCounts[t]), s_ciBlockSize>>>(_scene, _frame, _buffers.m_oPaths.m_pData, _buffers.m_oQueues.m_pData + size_t(t) * _maxPaths, _hostCounts[t], _buffers.m_oNextActive.m_pData, _counts + GPU_MATERIAL_TYPE_COUNT);
+                }
+            }
+
+            if (!Check(cudaMemcpy(&_active, _counts + GPU_MATERIAL_TYPE_COUNT, sizeof(int), cudaMemcpyDeviceToHost), "shade", a_sError))
+            {
+                return false;
+            }
+
+            _buffers.m_oActive.Swap(_buffers.m_oNextActive);
+        }
+
+        AccumulateKernel<<<BlockCount(_pixelCount), s_ciBlockSize>>>(_frame, _buffers.m_oPaths.m_pData, _pixelCount, _samples, _buffers.m_oSums.m_pData);
+    }
+
+    a_oSums.resize(_pixelCount);
+
+    return Check(cudaMemcpy(&a_oSums[0], _buffers.m_oSums.m_pData, _pixelCount * sizeof(GpuPixelSum), cudaMemcpyDeviceToHost), "accumulate", a_sError);
+}
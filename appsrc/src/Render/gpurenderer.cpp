@@ -0,0 +1,383 @@
+#include "appsrc/include/Render/gpurenderer.h"
+#include "appsrc/include/Math/trace.h"
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+// Off unless the CMake build compiled gpudevice.cu (RT_USE_CUDA).
+#ifndef RT_HAVE_CUDA
+#define RT_HAVE_CUDA 0
+#endif
+
+namespace
+{
+    static_assert(sizeof(GpuBvhNode) == sizeof(BvhNode) && offsetof(GpuBvhNode, m_uOffset) == offsetof(BvhNode, m_uOffset) && offsetof(GpuBvhNode, m_uCount) == offsetof(BvhNode, m_uCount) && offsetof(GpuBvhNode, m_uAxis) == offsetof(BvhNode, m_uAxis), "GpuBvhNode mirrors BvhNode");
+
+    static_assert(int(GPU_MATERIAL_LAMBERTIAN) == MATERIAL_LAMBERTIAN && int(GPU_MATERIAL_METAL) == MATERIAL_METAL && int(GPU_MATERIAL_DIELECTRIC) == MATERIAL_DIELECTRIC && int(GPU_MATERIAL_EMISSIVE) == MATERIAL_EMISSIVE && int(GPU_MATERIAL_TYPE_COUNT) == MATERIAL_TYPE_COUNT, "GpuMaterialType follows MaterialType");
+
+    static_assert(int(GPU_SAMPLER_INDEPENDENT) == SAMPLER_INDEPENDENT && int(GPU_SAMPLER_STRATIFIED) == SAMPLER_STRATIFIED && int(GPU_SAMPLER_SOBOL) == SAMPLER_SOBOL && int(GPU_SAMPLER_BLUE_NOISE) == SAMPLER_BLUE_NOISE, "GpuSamplerType follows SamplerType");
+
+    static_assert(int(GPU_DIMENSION_FIRST_BOUNCE) == SAMPLE_DIMENSION_FIRST_BOUNCE && int(GPU_SLOT_ROULETTE) == SAMPLE_SLOT_ROULETTE && int(GPU_SLOT_LIGHT) == SAMPLE_SLOT_LIGHT && int(GPU_SLOT_LIGHT_SELECT) == SAMPLE_SLOT_LIGHT_SELECT && int(GPU_SLOTS_PER_BOUNCE) == SAMPLE_SLOTS_PER_BOUNCE, "the GPU sample layout follows SampleStream's");
+
+    static_assert(GpuLimits::BLUE_NOISE_MASK_SIZE == BlueNoiseSampler::MASK_SIZE, "the GPU reads the blue-noise mask at its size");
+
+    static_assert(GpuLimits::STACK_SIZE >= BvhBuilder::MAX_DEPTH - 1, "every tree the builder makes fits the GPU traversal stack");
+
+    inline GpuVec3 ToGpu(const Vec3& a_oVector)
+    {
+        return MakeGpuVec3(a_oVector[0], a_oVector[1], a_oVector[2]);
+    }
+
+    inline Vec3 FromGpu(const GpuVec3& a_oVector)
+    {
+        return Vec3(a_oVector.m_fX, a_oVector.m_fY, a_oVector.m_fZ);
+    }
+
+    void CopyArray(const float* a_pSource, int a_iCount, std::vector<float>& a_oTarget)
+    {
+        a_oTarget.assign(a_pSource, a_pSource + a_iCount);
+    }
+
+    // Entries GpuIntersect() pushes at most: one per interior node on the deepest path.
+    // Nodes are in depth-first order, so every child follows its parent.
+    int GetStackDepth(const BvhNode* a_pNodes, int a_iNodeCount)
+    {
+        std::vector<int> _depth(a_iNodeCount, 0);
+
+        int _deepest = 0;
+
+        for (int n = 0; n < a_iNodeCount; ++n)
+        {
+            const BvhNode& _node = a_pNodes[n];
+
+            if (_node.m_uCount > 0)
+            {
+                continue;
+            }
+
+            int _child = _depth[n] + 1;
+
+            _deepest = _child > _deepest ? _child : _deepest;
+
+            if (n + 1 < a_iNodeCount && _depth[n + 1] < _child)
+            {
+                _depth[n + 1] = _child;
+            }
+
+            if (_node.m_uOffset < uint32_t(a_iNodeCount) && _depth[_node.m_uOffset] < _child)
+            {
+                _depth[_node.m_uOffset] = _child;
+            }
+        }
+
+        return _deepest;
+    }
+}
+
+GpuSceneData::GpuSceneData() : m_fTotalPower(0.0f),
+                               m_bBackground(false)
+{
+    this->m_oBackground = MakeGpuVec3(0.0f, 0.0f, 0.0f);
+}
+
+GpuRenderer::GpuRenderer() : m_pDevice(nullptr),
+                             m_bLights(false),
+                             m_bOpened(false),
+                             m_bOpen(false)
+{
+}
+
+GpuRenderer::~GpuRenderer()
+{
+#if RT_HAVE_CUDA
+    delete this->m_pDevice;
+#endif
+}
+
+bool GpuRenderer::Open(std::string &a_sError)
+{
+    if (!this->m_bOpened)
+    {
+        this->m_bOpened = true;
+
+#if RT_HAVE_CUDA
+        GpuDevice* _device = new GpuDevice();
+
+        if (_device->Open(this->m_sOpenError))
+        {
+            this->m_pDevice = _device;
+            this->m_sDeviceName = _device->GetName();
+            this->m_bOpen = true;
+        }
+        else
+        {
+            delete _device;
+        }
+#else
+        this->m_sOpenError = "built without the CUDA backend (RT_USE_CUDA)";
+#endif
+    }
+
+    if (!this->m_bOpen)
+    {
+        a_sError = this->m_sOpenError;
+    }
+
+    return this->m_bOpen;
+}
+
+const std::string& GpuRenderer::GetDeviceName() const
+{
+    return this->m_sDeviceName;
+}
+
+bool GpuRenderer::Supports(const Bvh &a_oWorld, const RenderSettings &a_oSettings, std::string &a_sReason)
+{
+    if (a_oWorld.GetSpheres() == nullptr)
+    {
+        a_sReason = "the GPU backend only traces sphere BVHs, not instances or meshes";
+        return false;
+    }
+
+    if (a_oSettings.m_bAdaptive)
+    {
+        a_sReason = "adaptive sampling is CPU only";
+        return false;
+    }
+
+    if (GetStackDepth(a_oWorld.GetNodes(), a_oWorld.GetNodeCount()) > GpuLimits::STACK_SIZE)
+    {
+        a_sReason = "the BVH is deeper than the GPU traversal stack";
+        return false;
+    }
+
+    return true;
+}
+
+void GpuRenderer::PackScene(const Bvh &a_oWorld, const MaterialTable &a_oMaterials, const LightList &a_oLights, GpuSceneData &a_oData)
+{
+    const BvhNode* _nodes = a_oWorld.GetNodes();
+
+    a_oData.m_oNodes.resize(a_oWorld.GetNodeCount());
+
+    if (!a_oData.m_oNodes.empty())
+    {
+        memcpy(&a_oData.m_oNodes[0], _nodes, a_oData.m_oNodes.size() * sizeof(BvhNode));
+    }
+
+    const SphereSoA& _spheres = *a_oWorld.GetSpheres();
+
+    int _count = _spheres.GetCount();
+
+    CopyArray(_spheres.m_pCenterX, _count, a_oData.m_oCenterX);
+    CopyArray(_spheres.m_pCenterY, _count, a_oData.m_oCenterY);
+    CopyArray(_spheres.m_pCenterZ, _count, a_oData.m_oCenterZ);
+    CopyArray(_spheres.m_pRadius, _count, a_oData.m_oRadius);
+
+    a_oData.m_oMaterialIds.assign(_spheres.m_pMaterialId, _spheres.m_pMaterialId + _count);
+
+    if (_spheres.HasMotion())
+    {
+        CopyArray(_spheres.m_pVelocityX, _count, a_oData.m_oVelocityX);
+        CopyArray(_spheres.m_pVelocityY, _count, a_oData.m_oVelocityY);
+        CopyArray(_spheres.m_pVelocityZ, _count, a_oData.m_oVelocityZ);
+    }
+    else
+    {
+        a_oData.m_oVelocityX.clear();
+        a_oData.m_oVelocityY.clear();
+        a_oData.m_oVelocityZ.clear();
+    }
+
+    a_oData.m_oMaterials.resize(a_oMaterials.GetCount());
+
+    for (int m = 0; m < a_oMaterials.GetCount(); ++m)
+    {
+        const Material& _material = a_oMaterials.Get(MaterialId(m));
+
+        GpuMaterial& _target = a_oData.m_oMaterials[m];
+
+        _target.m_oAlbedo = ToGpu(_material.m_oAlbedo);
+        _target.m_fParameter = _material.m_fParameter;
+        _target.m_iType = _material.m_eType;
+    }
+
+    a_oData.m_oLights.resize(a_oLights.GetCount());
+
+    for (int l = 0; l < a_oLights.GetCount(); ++l)
+    {
+        const LightList::Emitter& _emitter = a_oLights.GetEmitter(l);
+
+        GpuLight& _target = a_oData.m_oLights[l];
+
+        _target.m_oPoint = ToGpu(_emitter.m_oPoint);
+        _target.m_oEdgeA = ToGpu(_emitter.m_oEdgeA);
+        _target.m_oEdgeB = ToGpu(_emitter.m_oEdgeB);
+        _target.m_fRadius = _emitter.m_fRadius;
+        _target.m_oRadiance = ToGpu(_emitter.m_oRadiance);
+        _target.m_fCumulativePower = a_oLights.GetCumulativePower(l);
+        _target.m_uMaterialId = _emitter.m_uMaterialId;
+    }
+
+    a_oData.m_oSpheresByMaterial.assign(a_oLights.GetSpheresByMaterial().begin(), a_oLights.GetSpheresByMaterial().end());
+
+    a_oData.m_fTotalPower = a_oLights.GetTotalPower();
+
+    a_oData.m_oBackground = ToGpu(a_oLights.GetBackground());
+    a_oData.m_bBackground = a_oLights.HasBackground();
+}
+
+GpuFrame GpuRenderer::PackFrame(const RenderSettings &a_oSettings, const Camera &a_oCamera, const Sampler &a_oSampler, bool a_bNextEvent, bool a_bAovs)
+{
+    GpuFrame _frame;
+
+    _frame.m_oCamera.m_oOrigin = ToGpu(a_oCamera.m_oOrigin);
+    _frame.m_oCamera.m_oLowerLeftCorner = ToGpu(a_oCamera.m_oLowerLeftCorner);
+    _frame.m_oCamera.m_oHorizontal = ToGpu(a_oCamera.m_oHorizontal);
+    _frame.m_oCamera.m_oVertical = ToGpu(a_oCamera.m_oVertical);
+    _frame.m_oCamera.m_oU = ToGpu(a_oCamera.m_oU);
+    _frame.m_oCamera.m_oV = ToGpu(a_oCamera.m_oV);
+    _frame.m_oCamera.m_fLensRadius = a_oCamera.m_fLensRadius;
+    _frame.m_oCamera.m_fShutterOpen = a_oCamera.m_fShutterOpen;
+    _frame.m_oCamera.m_fShutterClose = a_oCamera.m_fShutterClose;
+
+    GpuSampler& _sampler = _frame.m_oSampler;
+
+    _sampler.m_iType = a_oSampler.GetType();
+    _sampler.m_uSeed = a_oSampler.GetSeed();
+    _sampler.m_iSamples = 1;
+    _sampler.m_iColumns = 1;
+    _sampler.m_iRows = 1;
+    _sampler.m_pMask = nullptr;
+
+    if (a_oSampler.GetType() == SAMPLER_STRATIFIED)
+    {
+        const StratifiedSampler& _stratified = static_cast<const StratifiedSampler&>(a_oSampler);
+
+        _sampler.m_iSamples = _stratified.GetSampleCount();
+        _sampler.m_iColumns = _stratified.GetColumns();
+        _sampler.m_iRows = _stratified.GetRows();
+    }
+    else if (a_oSampler.GetType() == SAMPLER_BLUE_NOISE)
+    {
+        // The host copy; GpuDevice swaps in its own.
+        _sampler.m_pMask = &static_cast<const BlueNoiseSampler&>(a_oSampler).GetMask()[0];
+    }
+
+    _frame.m_iWidth = a_oSettings.m_iWidth;
+    _frame.m_iHeight = a_oSettings.m_iHeight;
+    _frame.m_iMaxDepth = a_oSettings.m_iMaxDepth;
+    _frame.m_iRouletteDepth = a_oSettings.m_iRouletteDepth;
+    _frame.m_bNextEvent = a_oSettings.m_bNextEvent && a_bNextEvent;
+    _frame.m_bAovs = a_bAovs;
+
+    return _frame;
+}
+
+bool GpuRenderer::Upload(const Bvh &a_oWorld, const MaterialTable &a_oMaterials, const LightList &a_oLights, std::string &a_sError)
+{
+    RT_TRACE_SPAN("gpu upload");
+
+    if (this->m_pDevice == nullptr)
+    {
+        a_sError = "no GPU device is open";
+        return false;
+    }
+
+    PackScene(a_oWorld, a_oMaterials, a_oLights, this->m_oData);
+
+    this->m_bLights = !a_oLights.IsEmpty();
+
+#if RT_HAVE_CUDA
+    return this->m_pDevice->UploadScene(this->m_oData, a_sError);
+#else
+    return false;
+#endif
+}
+
+bool GpuRenderer::Render(const std::vector<Tile> &a_oTiles, const RenderSettings &a_oSettings, const Camera &a_oCamera, const Sampler &a_oSampler, const std::atomic<bool> *a_pCancel, FrameBuffer &a_oTarget, std::string &a_sError)
+{
+    RT_TRACE_SPAN("gpu render");
+
+    if (this->m_pDevice == nullptr)
+    {
+        a_sError = "no GPU device is open";
+        return false;
+    }
+
+    // Tile by tile and row by row, the order the CPU resolves pixels in.
+    this->m_oPixels.clear();
+
+    for (size_t t = 0; t < a_oTiles.size(); ++t)
+    {
+        const Tile& _tile = a_oTiles[t];
+
+        for (int j = _tile.m_iY0; j < _tile.m_iY1; ++j)
+        {
+            for (int i = _tile.m_iX0; i < _tile.m_iX1; ++i)
+            {
+                GpuPixel _pixel;
+
+                _pixel.m_iX = i;
+                _pixel.m_iY = j;
+
+                this->m_oPixels.push_back(_pixel);
+            }
+        }
+    }
+
+    GpuFrame _frame = PackFrame(a_oSettings, a_oCamera, a_oSampler, this->m_bLights, a_oTarget.HasAovs());
+
+    static const std::vector<float> s_oNoMask;
+
+    const std::vector<float>& _mask = a_oSampler.GetType() == SAMPLER_BLUE_NOISE ? static_cast<const BlueNoiseSampler&>(a_oSampler).GetMask() : s_oNoMask;
+
+#if RT_HAVE_CUDA
+    if (!this->m_pDevice->Render(_frame, _mask, this->m_oPixels, a_oSettings.m_iFirstSample, a_oSettings.m_iSamples, a_pCancel, this->m_oSums, a_sError))
+    {
+        return false;
+    }
+#else
+    (void)_frame;
+    (void)_mask;
+    return false;
+#endif
+
+    if (a_pCancel != nullptr && a_pCancel->load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    for (size_t p = 0; p < this->m_oPixels.size(); ++p)
+    {
+        const GpuPixel& _pixel = this->m_oPixels[p];
+        const GpuPixelSum& _sum = this->m_oSums[p];
+
+        float _scale = _sum.m_iCount > 0 ? 1.0f / _sum.m_iCount : 0.0f;
+
+        Vec3 _mean = FromGpu(_sum.m_oRadiance);
+
+        if (_sum.m_iCount > 0)
+        {
+            _mean /= float(_sum.m_iCount);
+        }
+
+        a_oTarget.SetPixel(_pixel.m_iX, _pixel.m_iY, _mean);
+        a_oTarget.SetSampleCount(_pixel.m_iX, _pixel.m_iY, _sum.m_iCount);
+
+        if (_frame.m_bAovs)
+        {
+            SampleAovs _aovs;
+
+            _aovs.m_oAlbedo = FromGpu(_sum.m_oAlbedo);
+            _aovs.m_oNormal = FromGpu(_sum.m_oNormal);
+            _aovs.m_fDepth = _sum.m_fDepth;
+
+            _aovs.Scale(_scale);
+
+            a_oTarget.SetAovs(_pixel.m_iX, _pixel.m_iY, _aovs);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,516 @@
+#include "appsrc/include/Render/integrator.h"
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/counters.h"
+#include "appsrc/include/Render/tilesampler.h"
+#include <algorithm>
+#include <float.h>
+
+namespace
+{
+    const float s_cfRayEpsilon = 0.001f;
+
+    // Caps the survival probability so even bright paths eventually terminate.
+    const float s_cfMaxSurvival = 0.95f;
+
+    static_assert(COUNTER_HITS_METAL == COUNTER_HITS_LAMBERTIAN + MATERIAL_METAL && COUNTER_HITS_DIELECTRIC == COUNTER_HITS_LAMBERTIAN + MATERIAL_DIELECTRIC && COUNTER_HITS_EMISSIVE == COUNTER_HITS_LAMBERTIAN + MATERIAL_EMISSIVE, "hit counters follow MaterialType");
+
+    // Russian roulette on a path that has just completed a_iBounces scattering events.
+    // Returns false when the path is terminated; otherwise reweights the throughput.
+    inline bool SurviveRoulette(Vec3& a_oThroughput, int a_iBounces, int a_iRouletteDepth, SampleStream& a_oStream)
+    {
+        if (a_iRouletteDepth < 0 || a_iBounces < a_iRouletteDepth)
+        {
+            return true;
+        }
+
+        float _p = fmaxf(a_oThroughput[0], fmaxf(a_oThroughput[1], a_oThroughput[2]));
+
+        _p = _p < s_cfMaxSurvival ? _p : s_cfMaxSurvival;
+
+        a_oStream.SetDimension(SampleStream::BounceDimension(a_iBounces - 1) + SAMPLE_SLOT_ROULETTE);
+
+        if (a_oStream.Next1D() >= _p)
+        {
+            return false;
+        }
+
+        a_oThroughput /= _p;
+
+        return true;
+    }
+
+    inline Vec3 ClampUnit(const Vec3& a_oColor)
+    {
+        return Vec3(fminf(fmaxf(a_oColor[0], 0.0f), 1.0f), fminf(fmaxf(a_oColor[1], 0.0f), 1.0f), fminf(fmaxf(a_oColor[2], 0.0f), 1.0f));
+    }
+
+    // AOVs of a camera ray that hit a_oMaterial. Glass counts as white, and lights as
+    // their emission clamped to one, as image denoisers expect.
+    inline void HitAovs(const Ray& a_oRay, const HitRecord& a_oRecord, const Material& a_oMaterial, SampleAovs& a_oAovs)
+    {
+        a_oAovs.m_oAlbedo = a_oMaterial.m_eType == MATERIAL_DIELECTRIC ? Vec3(1.0f, 1.0f, 1.0f) : ClampUnit(a_oMaterial.m_oAlbedo);
+        a_oAovs.m_oNormal = a_oRecord.m_oNormal;
+        a_oAovs.m_fDepth = a_oRecord.m_fT * a_oRay.m_oDirection.Length();
+    }
+
+    inline void MissAovs(const Ray& a_oRay, const LightList& a_oLights, SampleAovs& a_oAovs)
+    {
+        a_oAovs.m_oAlbedo = ClampUnit(a_oLights.Background(a_oRay));
+        a_oAovs.m_oNormal = Vec3(0.0f, 0.0f, 0.0f);
+        a_oAovs.m_fDepth = 0.0f;
+    }
+
+    // Veach's power heuristic: the weight of the strategy that sampled with a_fPdf against
+    // one that could have produced the same path with a_fOtherPdf.
+    inline float PowerHeuristic(float a_fPdf, float a_fOtherPdf)
+    {
+        if (!(a_fPdf > 0.0f))
+        {
+            return 0.0f;
+        }
+
+        float _ratio = a_fOtherPdf / a_fPdf;
+
+        return 1.0f / (1.0f + _ratio * _ratio);
+    }
+
+    // Solid-angle density of a cosine-weighted bounce in a_oScatter's direction.
+    inline float LambertianPdf(const HitRecord& a_oRecord, const Ray& a_oScatter)
+    {
+        return fmaxf(0.0f, Dot(a_oRecord.m_oNormal, Unit_Vector(a_oScatter.m_oDirection))) * float(1.0 / M_PI);
+    }
+
+    // Next event estimation at a Lambertian hit: a point on a light, a shadow ray towards it,
+    // and the diffuse response, weighted against the bounce having found the same point.
+    // Returns the radiance it contributes before the path throughput.
+    inline Vec3 SampleDirect(const Hittable& a_oWorld, const LightList& a_oLights, const Material& a_oMaterial, const Ray& a_oRay, const HitRecord& a_oRecord, int a_iDepth, SampleStream& a_oStream)
+    {
+        float _u;
+        float _v;
+
+        a_oStream.SetDimension(SampleStream::BounceDimension(a_iDepth) + SAMPLE_SLOT_LIGHT);
+        a_oStream.Next2D(_u, _v);
+
+        a_oStream.SetDimension(SampleStream::BounceDimension(a_iDepth) + SAMPLE_SLOT_LIGHT_SELECT);
+
+        float _select = a_oStream.Next1D();
+
+        LightSample _sample;
+
+        if (!a_oLights.Sample(a_oRecord.m_oPoint, a_oRay.m_fTime, _select, _u, _v, _sample))
+        {
+            return Vec3(0.0f, 0.0f, 0.0f);
+        }
+
+        float _cosine = Dot(a_oRecord.m_oNormal, _sample.m_oDirection);
+
+        if (!(_cosine > 0.0f))
+        {
+            return Vec3(0.0f, 0.0f, 0.0f);
+        }
+
+        RT_COUNTERS(_counters);
+
+        RT_COUNTER_ADD(_counters, COUNTER_SHADOW_RAYS, 1);
+
+        if (a_oWorld.Occluded(Ray(a_oRecord.m_oPoint, _sample.m_oDirection, a_oRay.m_fTime), s_cfRayEpsilon, _sample.m_fDistance - s_cfRayEpsilon))
+        {
+            RT_COUNTER_ADD(_counters, COUNTER_SHADOW_RAYS_OCCLUDED, 1);
+            return Vec3(0.0f, 0.0f, 0.0f);
+        }
+
+        float _bouncePdf = _cosine * float(1.0 / M_PI);
+
+        // albedo / pi * cos / pdf, and a / pi * cos is the albedo times the bounce pdf.
+        return (_bouncePdf * PowerHeuristic(_sample.m_fPdf, _bouncePdf) / _sample.m_fPdf) * (a_oMaterial.m_oAlbedo * _sample.m_oRadiance);
+    }
+}
+
+PathStats::PathStats() : m_uPaths(0),
+                         m_uSegments(0),
+                         m_uRouletteKills(0),
+                         m_uShadowRays(0),
+                         m_uShadowRaysOccluded(0)
+{
+}
+
+PathStats GetPathStats()
+{
+    CounterBlock _counters = Counters::Sum();
+
+    PathStats _total;
+
+    _total.m_uPaths = _counters.m_uValues[COUNTER_PATHS];
+    _total.m_uSegments = _counters.m_uValues[COUNTER_PATH_SEGMENTS];
+    _total.m_uRouletteKills = _counters.m_uValues[COUNTER_ROULETTE_KILLS];
+    _total.m_uShadowRays = _counters.m_uValues[COUNTER_SHADOW_RAYS];
+    _total.m_uShadowRaysOccluded = _counters.m_uValues[COUNTER_SHADOW_RAYS_OCCLUDED];
+
+    return _total;
+}
+
+Vec3 SkyColor(const Ray &a_oRay)
+{
+    Vec3 _unitDir = Unit_Vector(a_oRay.Direction());
+
+    float _t = 0.5f * (_unitDir.GetY() + 1.0f);
+
+    return (1.0f - _t) * Vec3(1.0f, 1.0f, 1.0f) + _t * Vec3(0.5f, 0.7f, 1.0f);
+}
+
+Vec3 TracePath(const Ray &a_oRay, const Hittable &a_oWorld, const MaterialTable &a_oMaterials, const LightList &a_oLights, SampleStream &a_oStream, const RenderSettings &a_oSettings, SampleAovs *a_pAovs)
+{
+    RT_COUNTERS(_counters);
+
+    RT_COUNTER_ADD(_counters, COUNTER_PATHS, 1);
+
+    Ray _ray = a_oRay;
+
+    Vec3 _throughput(1.0f, 1.0f, 1.0f);
+
+    Vec3 _radiance(0.0f, 0.0f, 0.0f);
+
+    bool _nextEvent = a_oSettings.m_bNextEvent && !a_oLights.IsEmpty();
+
+    // Density of the last bounce direction, zero when no light sample competed with it.
+    float _bouncePdf = 0.0f;
+
+    for (int _depth = 0; ; ++_depth)
+    {
+        RT_COUNTER_ADD(_counters, COUNTER_PATH_SEGMENTS, 1);
+
+        HitRecord _record;
+
+        if (!a_oWorld.Hit(_ray, s_cfRayEpsilon, FLT_MAX, _record))
+        {
+            if (_depth == 0 && a_pAovs != nullptr)
+            {
+                MissAovs(_ray, a_oLights, *a_pAovs);
+            }
+
+            return _radiance + _throughput * a_oLights.Background(_ray);
+        }
+
+        const Material& _material = a_oMaterials.Get(_record.m_uMaterialId);
+
+        if (_depth == 0 && a_pAovs != nullptr)
+        {
+            HitAovs(_ray, _record, _material, *a_pAovs);
+        }
+
+        if (_material.m_eType == MATERIAL_EMISSIVE)
+        {
+            RT_COUNTER_ADD(_counters, COUNTER_HITS_EMISSIVE, 1);
+
+            float _weight = _bouncePdf > 0.0f ? PowerHeuristic(_bouncePdf, a_oLights.Pdf(_ray, _record, _material.m_oAlbedo)) : 1.0f;
+
+            return _radiance + _weight * (_throughput * _material.m_oAlbedo);
+        }
+
+        Ray _scatter;
+        Vec3 _attenuation;
+
+        if (_depth >= a_oSettings.m_iMaxDepth)
+        {
+            return _radiance;
+        }
+
+        RT_COUNTER_ADD(_counters, COUNTER_HITS_LAMBERTIAN + _material.m_eType, 1);
+
+        bool _sampleLight = _nextEvent && _material.m_eType == MATERIAL_LAMBERTIAN;
+
+        if (_sampleLight)
+        {
+            _radiance += _throughput * SampleDirect(a_oWorld, a_oLights, _material, _ray, _record, _depth, a_oStream);
+        }
+
+        a_oStream.SetDimension(SampleStream::BounceDimension(_depth));
+
+        if (!Scatter(_material, _ray, _record, _attenuation, _scatter, a_oStream))
+        {
+            return _radiance;
+        }
+
+        _bouncePdf = _sampleLight ? LambertianPdf(_record, _scatter) : 0.0f;
+
+        _throughput *= _attenuation;
+        _ray = _scatter;
+
+        if (!SurviveRoulette(_throughput, _depth + 1, a_oSettings.m_iRouletteDepth, a_oStream))
+        {
+            RT_COUNTER_ADD(_counters, COUNTER_ROULETTE_KILLS, 1);
+            return _radiance;
+        }
+    }
+}
+
+WavefrontIntegrator::WavefrontIntegrator(const Hittable &a_oWorld, const MaterialTable &a_oMaterials, const LightList &a_oLights, const RenderSettings &a_oSettings) : m_oWorld(a_oWorld),
+                                                                                                                                                                     m_oBvh(dynamic_cast<const Bvh*>(&a_oWorld)),
+                                                                                                                                                                     m_oMaterials(a_oMaterials),
+                                                                                                                                                                     m_oLights(a_oLights),
+                                                                                                                                                                     m_iMaxDepth(a_oSettings.m_iMaxDepth),
+                                                                                                                                                                     m_iRouletteDepth(a_oSettings.m_iRouletteDepth),
+                                                                                                                                                                     m_bNextEvent(a_oSettings.m_bNextEvent && !a_oLights.IsEmpty()),
+                                                                                                                                                                     m_oRadiance(nullptr),
+                                                                                                                                                                     m_oAovs(nullptr)
+{
+}
+
+void WavefrontIntegrator::Trace(const Ray *a_oRays, SampleStream *a_oStreams, int a_iCount, Vec3 *a_oRadiance, SampleAovs *a_oAovs)
+{
+    this->m_oRadiance = a_oRadiance;
+    this->m_oAovs = a_oAovs;
+
+    this->m_oPaths.resize(a_iCount);
+    this->m_oActive.resize(a_iCount);
+
+    for (int i = 0; i < a_iCount; ++i)
+    {
+        PathState& _path = this->m_oPaths[i];
+
+        _path.m_oRay = a_oRays[i];
+        _path.m_oThroughput = Vec3(1.0f, 1.0f, 1.0f);
+        _path.m_fBouncePdf = 0.0f;
+        _path.m_iDepth = 0;
+
+        a_oRadiance[i] = Vec3(0.0f, 0.0f, 0.0f);
+
+        this->m_oActive[i] = i;
+    }
+
+    RT_COUNT(COUNTER_PATHS, a_iCount);
+
+    bool _coherent = true;
+
+    while (!this->m_oActive.empty())
+    {
+        this->Extend(_coherent);
+
+        _coherent = false;
+
+        this->m_oActive.clear();
+
+        this->Shade<Lambertian>(MATERIAL_LAMBERTIAN, a_oStreams);
+        this->Shade<Metal>(MATERIAL_METAL, a_oStreams);
+        this->Shade<Dielectric>(MATERIAL_DIELECTRIC, a_oStreams);
+    }
+}
+
+void WavefrontIntegrator::Extend(bool a_bCoherent)
+{
+    int _count = static_cast<int>(this->m_oActive.size());
+
+    RT_COUNT(COUNTER_PATH_SEGMENTS, _count);
+
+    for (int t = 0; t < MATERIAL_TYPE_COUNT; ++t)
+    {
+        this->m_oShadeQueues[t].clear();
+    }
+
+    this->m_oRecordBuffer.resize(_count);
+    this->m_oHitBuffer.resize(_count);
+
+    if (this->m_oBvh != nullptr)
+    {
+        if (a_bCoherent)
+        {
+            // Camera rays arrive in pixel order and are already coherent, so no sort is needed.
+            RayPacket _packet;
+
+            for (int k = 0; k < _count; k += RayPacket::SIZE)
+            {
+                _packet.Clear();
+
+                for (int l = k; l < k + RayPacket::SIZE && l < _count; ++l)
+                {
+                    _packet.Add(this->m_oPaths[this->m_oActive[l]].m_oRay);
+                }
+
+                uint32_t _mask = this->m_oBvh->HitPacket(_packet, s_cfRayEpsilon, FLT_MAX, &this->m_oRecordBuffer[k]);
+
+                for (int l = 0; l < _packet.m_iCount; ++l)
+                {
+                    this->m_oHitBuffer[k + l] = (_mask >> l) & 1u;
+                }
+            }
+        }
+        else
+        {
+            this->m_oRayBuffer.resize(_count);
+
+            for (int k = 0; k < _count; ++k)
+            {
+                this->m_oRayBuffer[k] = this->m_oPaths[this->m_oActive[k]].m_oRay;
+            }
+
+            this->m_oBvh->HitStream(&this->m_oRayBuffer[0], _count, s_cfRayEpsilon, FLT_MAX, &this->m_oRecordBuffer[0], &this->m_oHitBuffer[0]);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < _count; ++k)
+        {
+            this->m_oHitBuffer[k] = this->m_oWorld.Hit(this->m_oPaths[this->m_oActive[k]].m_oRay, s_cfRayEpsilon, FLT_MAX, this->m_oRecordBuffer[k]);
+        }
+    }
+
+    for (int k = 0; k < _count; ++k)
+    {
+        int _index = this->m_oActive[k];
+
+        PathState& _path = this->m_oPaths[_index];
+
+        bool _firstHit = _path.m_iDepth == 0 && this->m_oAovs != nullptr;
+
+        if (!this->m_oHitBuffer[k])
+        {
+            if (_firstHit)
+            {
+                MissAovs(_path.m_oRay, this->m_oLights, this->m_oAovs[_index]);
+            }
+
+            this->m_oRadiance[_index] += _path.m_oThroughput * this->m_oLights.Background(_path.m_oRay);
+            continue;
+        }
+
+        _path.m_oRecord = this->m_oRecordBuffer[k];
+
+        const Material& _material = this->m_oMaterials.Get(_path.m_oRecord.m_uMaterialId);
+
+        if (_firstHit)
+        {
+            HitAovs(_path.m_oRay, _path.m_oRecord, _material, this->m_oAovs[_index]);
+        }
+
+        // Emitters end the path here rather than in a shading queue of their own.
+        if (_material.m_eType == MATERIAL_EMISSIVE)
+        {
+            RT_COUNT(COUNTER_HITS_EMISSIVE, 1);
+
+            float _weight = _path.m_fBouncePdf > 0.0f ? PowerHeuristic(_path.m_fBouncePdf, this->m_oLights.Pdf(_path.m_oRay, _path.m_oRecord, _material.m_oAlbedo)) : 1.0f;
+
+            this->m_oRadiance[_index] += _weight * (_path.m_oThroughput * _material.m_oAlbedo);
+            continue;
+        }
+
+        if (_path.m_iDepth >= this->m_iMaxDepth)
+        {
+            continue;
+        }
+
+        this->m_oShadeQueues[_material.m_eType].push_back(_index);
+    }
+}
+
+template <typename MaterialClass>
+void WavefrontIntegrator::Shade(MaterialType a_eType, SampleStream *a_oStreams)
+{
+    const std::vector<int>& _queue = this->m_oShadeQueues[a_eType];
+
+    RT_COUNTERS(_counters);
+
+    RT_COUNTER_ADD(_counters, COUNTER_HITS_LAMBERTIAN + a_eType, _queue.size());
+
+    bool _sampleLight = this->m_bNextEvent && a_eType == MATERIAL_LAMBERTIAN;
+
+    for (size_t k = 0; k < _queue.size(); ++k)
+    {
+        int _index = _queue[k];
+
+        PathState& _path = this->m_oPaths[_index];
+
+        // The queue only holds this type, so the call is direct and can be inlined.
+        const Material& _material = this->m_oMaterials.Get(_path.m_oRecord.m_uMaterialId);
+
+        Ray _scatter;
+        Vec3 _attenuation;
+
+        if (_sampleLight)
+        {
+            this->m_oRadiance[_index] += _path.m_oThroughput * SampleDirect(this->m_oWorld, this->m_oLights, _material, _path.m_oRay, _path.m_oRecord, _path.m_iDepth, a_oStreams[_index]);
+        }
+
+        a_oStreams[_index].SetDimension(SampleStream::BounceDimension(_path.m_iDepth));
+
+        if (MaterialClass::Scatter(_material, _path.m_oRay, _path.m_oRecord, _attenuation, _scatter, a_oStreams[_index]))
+        {
+            _path.m_fBouncePdf = _sampleLight ? LambertianPdf(_path.m_oRecord, _scatter) : 0.0f;
+            _path.m_oThroughput *= _attenuation;
+            _path.m_oRay = _scatter;
+            _path.m_iDepth++;
+
+            if (!SurviveRoulette(_path.m_oThroughput, _path.m_iDepth, this->m_iRouletteDepth, a_oStreams[_index]))
+            {
+                RT_COUNTER_ADD(_counters, COUNTER_ROULETTE_KILLS, 1);
+                continue;
+            }
+
+            this->m_oActive.push_back(_index);
+        }
+    }
+}
+
+void RenderTileWavefront(const Tile &a_oTile, const RenderSettings &a_oSettings, const Camera &a_oCamera, const Hittable &a_oWorld, const MaterialTable &a_oMaterials, const LightList &a_oLights, const Sampler &a_oSampler, FrameBuffer &a_oFrameBuffer)
+{
+    int nx = a_oSettings.m_iWidth;
+    int ny = a_oSettings.m_iHeight;
+
+    TileSampler _sampler(a_oTile, a_oSettings, a_oFrameBuffer.HasAovs());
+
+    WavefrontIntegrator _integrator(a_oWorld, a_oMaterials, a_oLights, a_oSettings);
+
+    std::vector<SampleRequest> _requests;
+    std::vector<CameraSample> _samples;
+    std::vector<Ray> _rays;
+    std::vector<SampleStream> _streams;
+    std::vector<Vec3> _radiance;
+    std::vector<SampleAovs> _aovs;
+
+    // Later adaptive rounds can still exceed the first round's slices on large tiles, so
+    // every round is traced in chunks and the integrator's buffers stay the same size.
+    while (_sampler.NextRound(_requests))
+    {
+        int _total = static_cast<int>(_requests.size());
+
+        for (int _first = 0; _first < _total; _first += TileSampler::MAX_ROUND_SIZE)
+        {
+            int _count = std::min(_total - _first, int(TileSampler::MAX_ROUND_SIZE));
+
+            _samples.resize(_count);
+            _rays.resize(_count);
+            _streams.resize(_count);
+            _radiance.resize(_count);
+
+            if (_sampler.HasAovs())
+            {
+                _aovs.resize(_count);
+            }
+
+            for (int k = 0; k < _count; ++k)
+            {
+                const SampleRequest& _request = _requests[_first + k];
+
+                _streams[k] = SampleStream(&a_oSampler, _request.m_iX, _request.m_iY, _request.m_iSample);
+
+                // Pixel jitter, lens, then time, as SAMPLE_DIMENSION_* lays them out.
+                CameraSample& _sample = _samples[k];
+                _sample.m_iX = _request.m_iX;
+                _sample.m_iY = _request.m_iY;
+                _streams[k].Next2D(_sample.m_fJitterX, _sample.m_fJitterY);
+                _streams[k].Next2D(_sample.m_fLensX, _sample.m_fLensY);
+                _sample.m_fTime = a_oCamera.HasShutter() ? _streams[k].Next1D() : 0.0f;
+            }
+
+            a_oCamera.GetRays(&_samples[0], _count, nx, ny, &_rays[0]);
+
+            _integrator.Trace(&_rays[0], &_streams[0], _count, &_radiance[0], _sampler.HasAovs() ? &_aovs[0] : nullptr);
+
+            for (int k = 0; k < _count; ++k)
+            {
+                _sampler.AddSample(_requests[_first + k], _radiance[k], _sampler.HasAovs() ? &_aovs[k] : nullptr);
+            }
+        }
+    }
+
+    _sampler.Resolve(a_oFrameBuffer);
+}
@@ -0,0 +1,315 @@
+#include "appsrc/include/Render/lightlist.h"
+#include "appsrc/include/Render/integrator.h"
+#include "appsrc/include/Math/sampling.h"
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+    // A hit this close to a sphere's surface, relative to its radius, lies on that sphere.
+    const float s_cfSurfaceTolerance = 1e-2f;
+
+    // 1 - cos of the half-angle of the cone a sphere subtends, from its squared sine. The
+    // rearranged form keeps its precision for small and distant spheres.
+    inline float ConeOneMinusCos(float a_fSinSquared)
+    {
+        return a_fSinSquared / (1.0f + sqrtf(1.0f - a_fSinSquared));
+    }
+}
+
+LightList::LightList() : m_fTotalPower(0.0f),
+                         m_oBackground(0.0f, 0.0f, 0.0f),
+                         m_bBackground(false)
+{
+}
+
+void LightList::Clear()
+{
+    this->m_oEmitters.clear();
+    this->m_oCdf.clear();
+    this->m_oSpheresByMaterial.clear();
+
+    this->m_fTotalPower = 0.0f;
+}
+
+void LightList::AddSphere(const Vec3 &a_oCenter, const Vec3 &a_oVelocity, float a_fRadius, const Vec3 &a_oRadiance, MaterialId a_uMaterialId)
+{
+    Emitter _emitter;
+
+    _emitter.m_oPoint = a_oCenter;
+    _emitter.m_oEdgeA = a_oVelocity;
+    _emitter.m_oEdgeB = Vec3(0.0f, 0.0f, 0.0f);
+    _emitter.m_fRadius = fabsf(a_fRadius);
+    _emitter.m_oRadiance = a_oRadiance;
+    _emitter.m_uMaterialId = a_uMaterialId;
+
+    if (!this->Append(_emitter, float(4.0 * M_PI) * a_fRadius * a_fRadius))
+    {
+        return;
+    }
+
+    const std::vector<Emitter>& _emitters = this->m_oEmitters;
+
+    std::vector<int>::iterator _position = std::upper_bound(this->m_oSpheresByMaterial.begin(), this->m_oSpheresByMaterial.end(), a_uMaterialId, [&](MaterialId a_uId, int a_iIndex)
+    {
+        return a_uId < _emitters[a_iIndex].m_uMaterialId;
+    });
+
+    this->m_oSpheresByMaterial.insert(_position, static_cast<int>(_emitters.size()) - 1);
+}
+
+void LightList::AddTriangle(const Vec3 &a_oA, const Vec3 &a_oB, const Vec3 &a_oC, const Vec3 &a_oRadiance)
+{
+    Emitter _emitter;
+
+    _emitter.m_oPoint = a_oA;
+    _emitter.m_oEdgeA = a_oB - a_oA;
+    _emitter.m_oEdgeB = a_oC - a_oA;
+    _emitter.m_fRadius = 0.0f;
+    _emitter.m_oRadiance = a_oRadiance;
+    _emitter.m_uMaterialId = 0;
+
+    this->Append(_emitter, 0.5f * Cross(_emitter.m_oEdgeA, _emitter.m_oEdgeB).Length());
+}
+
+bool LightList::Append(const Emitter &a_oEmitter, float a_fArea)
+{
+    float _power = Weight(a_oEmitter.m_oRadiance) * a_fArea;
+
+    // Black or degenerate emitters could never be picked, and Pdf() assumes every emitter can.
+    if (!(_power > 0.0f))
+    {
+        return false;
+    }
+
+    this->m_fTotalPower += _power;
+
+    this->m_oEmitters.push_back(a_oEmitter);
+    this->m_oCdf.push_back(this->m_fTotalPower);
+
+    return true;
+}
+
+bool LightList::IsEmpty() const
+{
+    return this->m_oEmitters.empty();
+}
+
+int LightList::GetCount() const
+{
+    return static_cast<int>(this->m_oEmitters.size());
+}
+
+float LightList::GetTotalPower() const
+{
+    return this->m_fTotalPower;
+}
+
+const LightList::Emitter& LightList::GetEmitter(int a_iIndex) const
+{
+    return this->m_oEmitters[a_iIndex];
+}
+
+float LightList::GetCumulativePower(int a_iIndex) const
+{
+    return this->m_oCdf[a_iIndex];
+}
+
+const std::vector<int>& LightList::GetSpheresByMaterial() const
+{
+    return this->m_oSpheresByMaterial;
+}
+
+bool LightList::Sample(const Vec3 &a_oFrom, float a_fTime, float a_fSelect, float a_fU, float a_fV, LightSample &a_oSample) const
+{
+    if (this->m_oEmitters.empty())
+    {
+        return false;
+    }
+
+    size_t _index = std::upper_bound(this->m_oCdf.begin(), this->m_oCdf.end(), a_fSelect * this->m_fTotalPower) - this->m_oCdf.begin();
+
+    if (_index >= this->m_oEmitters.size())
+    {
+        _index = this->m_oEmitters.size() - 1;
+    }
+
+    const Emitter& _emitter = this->m_oEmitters[_index];
+
+    if (_emitter.m_fRadius > 0.0f)
+    {
+        Vec3 _toCenter = _emitter.m_oPoint + a_fTime * _emitter.m_oEdgeA - a_oFrom;
+
+        float _radius2 = _emitter.m_fRadius * _emitter.m_fRadius;
+
+        float _sin2 = _radius2 / Dot(_toCenter, _toCenter);
+
+        // Inside or on the sphere there is no cone to sample.
+        if (!(_sin2 < 1.0f))
+        {
+            return false;
+        }
+
+        float _oneMinusCos = ConeOneMinusCos(_sin2);
+
+        Vec3 _direction = SampleUniformCone(Unit_Vector(_toCenter), _oneMinusCos, a_fU, a_fV);
+
+        // The near intersection along the direction. Past the rim only by rounding, so the
+        // discriminant is clamped rather than the sample dropped.
+        float _along = Dot(_direction, _toCenter);
+
+        Vec3 _across = _toCenter - _along * _direction;
+
+        float _distance = _along - sqrtf(fmaxf(0.0f, _radius2 - Dot(_across, _across)));
+
+        if (!(_distance > 0.0f))
+        {
+            return false;
+        }
+
+        a_oSample.m_oPoint = a_oFrom + _distance * _direction;
+        a_oSample.m_oDirection = _direction;
+        a_oSample.m_fDistance = _distance;
+        a_oSample.m_oRadiance = _emitter.m_oRadiance;
+        a_oSample.m_fPdf = Weight(_emitter.m_oRadiance) * 2.0f * _radius2 / (this->m_fTotalPower * _oneMinusCos);
+
+        return true;
+    }
+
+    // Square-root warp onto the barycentric triangle, uniform by area.
+    float _s = sqrtf(a_fU);
+
+    a_oSample.m_oPoint = _emitter.m_oPoint + (_s * (1.0f - a_fV)) * _emitter.m_oEdgeA + (_s * a_fV) * _emitter.m_oEdgeB;
+
+    Vec3 _normal = Unit_Vector(Cross(_emitter.m_oEdgeA, _emitter.m_oEdgeB));
+
+    Vec3 _toLight = a_oSample.m_oPoint - a_oFrom;
+
+    float _distance = _toLight.Length();
+
+    if (!(_distance > 0.0f))
+    {
+        return false;
+    }
+
+    a_oSample.m_oDirection = _toLight / _distance;
+    a_oSample.m_fDistance = _distance;
+
+    // Triangles emit from both faces.
+    float _cosine = fabsf(Dot(_normal, a_oSample.m_oDirection));
+
+    if (!(_cosine > 0.0f))
+    {
+        return false;
+    }
+
+    a_oSample.m_oRadiance = _emitter.m_oRadiance;
+    a_oSample.m_fPdf = Weight(_emitter.m_oRadiance) * _distance * _distance / (this->m_fTotalPower * _cosine);
+
+    return true;
+}
+
+float LightList::Pdf(const Ray &a_oRay, const HitRecord &a_oRecord, const Vec3 &a_oRadiance) const
+{
+    if (!(this->m_fTotalPower > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    int _sphere = this->FindSphere(a_oRay, a_oRecord);
+
+    if (_sphere >= 0)
+    {
+        const Emitter& _emitter = this->m_oEmitters[_sphere];
+
+        Vec3 _toCenter = _emitter.m_oPoint + a_oRay.m_fTime * _emitter.m_oEdgeA - a_oRay.m_oOrigin;
+
+        float _radius2 = _emitter.m_fRadius * _emitter.m_fRadius;
+
+        float _sin2 = _radius2 / Dot(_toCenter, _toCenter);
+
+        if (!(_sin2 < 1.0f))
+        {
+            return 0.0f;
+        }
+
+        return Weight(a_oRadiance) * 2.0f * _radius2 / (this->m_fTotalPower * ConeOneMinusCos(_sin2));
+    }
+
+    float _length = a_oRay.m_oDirection.Length();
+
+    float _distance = a_oRecord.m_fT * _length;
+
+    float _cosine = fabsf(Dot(a_oRecord.m_oNormal, a_oRay.m_oDirection)) / _length;
+
+    if (!(_cosine > 0.0f))
+    {
+        return 0.0f;
+    }
+
+    return Weight(a_oRadiance) * _distance * _distance / (this->m_fTotalPower * _cosine);
+}
+
+int LightList::FindSphere(const Ray &a_oRay, const HitRecord &a_oRecord) const
+{
+    const std::vector<Emitter>& _emitters = this->m_oEmitters;
+
+    std::vector<int>::const_iterator _it = std::lower_bound(this->m_oSpheresByMaterial.begin(), this->m_oSpheresByMaterial.end(), a_oRecord.m_uMaterialId, [&](int a_iIndex, MaterialId a_uId)
+    {
+        return _emitters[a_iIndex].m_uMaterialId < a_uId;
+    });
+
+    int _best = -1;
+
+    float _bestError = s_cfSurfaceTolerance;
+
+    // Spheres sharing a material are told apart by which surface the hit lies on.
+    for (; _it != this->m_oSpheresByMaterial.end() && _emitters[*_it].m_uMaterialId == a_oRecord.m_uMaterialId; ++_it)
+    {
+        const Emitter& _emitter = _emitters[*_it];
+
+        Vec3 _center = _emitter.m_oPoint + a_oRay.m_fTime * _emitter.m_oEdgeA;
+
+        float _error = fabsf((a_oRecord.m_oPoint - _center).Length() - _emitter.m_fRadius) / _emitter.m_fRadius;
+
+        if (_error < _bestError)
+        {
+            _best = *_it;
+            _bestError = _error;
+        }
+    }
+
+    return _best;
+}
+
+Vec3 LightList::Background(const Ray &a_oRay) const
+{
+    return this->m_bBackground ? this->m_oBackground : SkyColor(a_oRay);
+}
+
+void LightList::SetBackground(const Vec3 &a_oRadiance)
+{
+    this->m_oBackground = a_oRadiance;
+    this->m_bBackground = true;
+}
+
+void LightList::ClearBackground()
+{
+    this->m_oBackground = Vec3(0.0f, 0.0f, 0.0f);
+    this->m_bBackground = false;
+}
+
+bool LightList::HasBackground() const
+{
+    return this->m_bBackground;
+}
+
+const Vec3& LightList::GetBackground() const
+{
+    return this->m_oBackground;
+}
+
+float LightList::Weight(const Vec3 &a_oRadiance)
+{
+    return (a_oRadiance[0] + a_oRadiance[1] + a_oRadiance[2]) * (1.0f / 3.0f);
+}
@@ -0,0 +1,360 @@
+#include "appsrc/include/Render/renderer.h"
+#include "appsrc/include/Render/integrator.h"
+#include "appsrc/include/Math/random.h"
+#include "appsrc/include/Math/scenearena.h"
+#include "appsrc/include/Math/trace.h"
+#include "appsrc/include/Scene/randomscene.h"
+
+namespace
+{
+    RenderSettings PoolSettings(int a_iThreadCount)
+    {
+        RenderSettings _settings;
+
+        _settings.m_iThreadCount = a_iThreadCount;
+
+        return _settings;
+    }
+}
+
+RenderRequest::RenderRequest() : m_bWavefront(false),
+                                 m_bGpu(false),
+                                 m_iFrame(0),
+                                 m_bCamera(false),
+                                 m_bAovs(false)
+{
+}
+
+Renderer::Renderer(int a_iThreadCount) : m_oTiles(PoolSettings(a_iThreadCount)),
+                                         m_oCamera(SceneCamera().Build(1.0f)),
+                                         m_pWorld(nullptr),
+                                         m_iSamplerSamples(0),
+                                         m_bCancel(false),
+                                         m_uTickets(0),
+                                         m_uCancelledTickets(0),
+                                         m_uActiveTicket(0),
+                                         m_bGpuActive(false),
+                                         m_bGpuDirty(true)
+{
+    this->m_oTiles.SetCancelFlag(&this->m_bCancel);
+}
+
+bool Renderer::LoadScene(const std::string &a_sPath, std::string &a_sError)
+{
+    this->m_pWorld = nullptr;
+    this->m_bGpuDirty = true;
+
+    return this->m_oScene.Load(a_sPath, a_sError);
+}
+
+void Renderer::BuildDefaultScene()
+{
+    RT_TRACE_SPAN("scene build");
+
+    this->m_pWorld = nullptr;
+    this->m_bGpuDirty = true;
+
+    Rng _rng;
+
+    SceneArena _arena;
+
+    HittableList* _list = RandomScene(_arena, _rng);
+
+    this->m_oScene.SetSpheres(*_list, _arena.GetMaterials());
+}
+
+Scene& Renderer::GetScene()
+{
+    this->m_bGpuDirty = true;
+
+    return this->m_oScene;
+}
+
+void Renderer::Prepare(const RenderRequest &a_oRequest)
+{
+    this->m_oRequest = a_oRequest;
+
+    if (!this->m_oRequest.m_bCamera)
+    {
+        this->m_oRequest.m_oCamera = this->m_oScene.GetCamera();
+    }
+
+    this->m_oTiles.SetSettings(a_oRequest.m_oSettings);
+
+    const RenderSettings& _settings = this->m_oTiles.GetSettings();
+
+    // Stratification is sized for the whole per-pixel budget, not one progressive pass.
+    if (!this->m_pSampler || this->m_pSampler->GetType() != _settings.m_eSampler || this->m_iSamplerSamples != _settings.m_iSamples)
+    {
+        this->m_pSampler = Sampler::Create(_settings.m_eSampler, _settings.m_iSamples);
+        this->m_iSamplerSamples = _settings.m_iSamples;
+    }
+
+    this->SetFrame(a_oRequest.m_iFrame);
+
+    this->m_bGpuActive = false;
+
+    if (a_oRequest.m_bGpu)
+    {
+        this->PrepareGpu();
+    }
+}
+
+void Renderer::PrepareGpu()
+{
+    std::string _reason;
+
+    if (!this->m_oGpu.Open(_reason) || !GpuRenderer::Supports(*this->m_pWorld, this->m_oTiles.GetSettings(), _reason))
+    {
+        this->m_sGpuStatus = _reason;
+        return;
+    }
+
+    this->m_bGpuActive = true;
+    this->m_sGpuStatus = this->m_oGpu.GetDeviceName();
+}
+
+void Renderer::SetFrame(int a_iFrame)
+{
+    this->m_oRequest.m_iFrame = a_iFrame;
+
+    if (a_iFrame != this->m_oScene.GetFrame() && this->m_oScene.HasMotion())
+    {
+        this->m_bGpuDirty = true;
+    }
+
+    this->m_pWorld = &this->m_oScene.SetFrame(a_iFrame);
+
+    const RenderSettings& _settings = this->m_oRequest.m_oSettings;
+
+    this->m_oCamera = this->m_oRequest.m_oCamera.Build(float(_settings.m_iWidth) / float(_settings.m_iHeight), a_iFrame);
+}
+
+void Renderer::SetSampleRange(int a_iFirst, int a_iCount)
+{
+    this->m_oTiles.SetSampleRange(a_iFirst, a_iCount);
+}
+
+std::vector<Tile> Renderer::BuildTiles() const
+{
+    return this->m_oTiles.BuildTiles();
+}
+
+void Renderer::RenderTiles(const std::vector<Tile> &a_oTiles, FrameBuffer &a_oTarget)
+{
+    if (this->m_bGpuActive && this->RenderTilesGpu(a_oTiles, a_oTarget))
+    {
+        return;
+    }
+
+    const RenderSettings& _settings = this->m_oRequest.m_oSettings;
+
+    const Camera& _camera = this->m_oCamera;
+
+    const Hittable& _world = *this->m_pWorld;
+
+    const MaterialTable& _materials = this->m_oScene.GetMaterials();
+
+    const LightList& _lights = this->m_oScene.GetLights();
+
+    const Sampler* _sampler = this->m_pSampler.get();
+
+    if (this->m_oRequest.m_bWavefront)
+    {
+        // The tile renderer's settings carry the sample range of the current pass.
+        const RenderSettings& _range = this->m_oTiles.GetSettings();
+
+        this->m_oTiles.RenderTiles([&](const Tile& a_oTile, FrameBuffer& a_oTileTarget)
+        {
+            RenderTileWavefront(a_oTile, _range, _camera, _world, _materials, _lights, *_sampler, a_oTileTarget);
+        }, a_oTiles, a_oTarget);
+
+        return;
+    }
+
+    int nx = _settings.m_iWidth;
+    int ny = _settings.m_iHeight;
+
+    this->m_oTiles.Render([&](int i, int j, int s, SampleAovs* a_pAovs) -> Vec3
+    {
+        SampleStream _stream(_sampler, i, j, s);
+
+        // Pixel jitter, lens, then time, drawn and turned into a ray as the wavefront does.
+        CameraSample _sample;
+        _sample.m_iX = i;
+        _sample.m_iY = j;
+        _stream.Next2D(_sample.m_fJitterX, _sample.m_fJitterY);
+        _stream.Next2D(_sample.m_fLensX, _sample.m_fLensY);
+        _sample.m_fTime = _camera.HasShutter() ? _stream.Next1D() : 0.0f;
+
+        Ray _ray = _camera.GetRay(_sample, nx, ny);
+
+        return TracePath(_ray, _world, _materials, _lights, _stream, _settings, a_pAovs);
+    }, a_oTiles, a_oTarget);
+}
+
+bool Renderer::RenderTilesGpu(const std::vector<Tile> &a_oTiles, FrameBuffer &a_oTarget)
+{
+    std::string _error;
+
+    if (this->m_bGpuDirty)
+    {
+        if (!this->m_oGpu.Upload(*this->m_pWorld, this->m_oScene.GetMaterials(), this->m_oScene.GetLights(), _error))
+        {
+            this->m_bGpuActive = false;
+            this->m_sGpuStatus = "GPU upload failed: " + _error;
+            return false;
+        }
+
+        this->m_bGpuDirty = false;
+    }
+
+    if (!this->m_oGpu.Render(a_oTiles, this->m_oTiles.GetSettings(), this->m_oCamera, *this->m_pSampler, &this->m_bCancel, a_oTarget, _error))
+    {
+        this->m_bGpuActive = false;
+        this->m_sGpuStatus = "GPU render failed: " + _error;
+        return false;
+    }
+
+    const TileCallback& _onTile = this->m_oTiles.GetTileCallback();
+
+    // The device finishes every tile at once; callbacks still see them one by one.
+    for (size_t t = 0; t < a_oTiles.size() && _onTile && !this->m_bCancel; ++t)
+    {
+        _onTile(a_oTiles[t], a_oTarget);
+    }
+
+    return true;
+}
+
+bool Renderer::Render(const RenderRequest &a_oRequest, FrameBuffer &a_oTarget, const TileCallback &a_oOnTile, std::string &a_sError)
+{
+    uint64_t _ticket = ++this->m_uTickets;
+
+    std::lock_guard<std::mutex> _lock(this->m_oRenderMutex);
+
+    {
+        std::lock_guard<std::mutex> _cancelLock(this->m_oCancelMutex);
+
+        this->m_uActiveTicket = _ticket;
+        this->m_bCancel = _ticket <= this->m_uCancelledTickets;
+    }
+
+    bool _rendered = this->RenderHeld(a_oRequest, a_oTarget, a_oOnTile, a_sError);
+
+    std::lock_guard<std::mutex> _cancelLock(this->m_oCancelMutex);
+
+    this->m_uActiveTicket = 0;
+
+    // A Cancel() after the last check came too late to stop anything, so it is dropped
+    // rather than reported against a finished image.
+    if (_rendered)
+    {
+        this->m_bCancel = false;
+    }
+
+    return _rendered;
+}
+
+bool Renderer::RenderHeld(const RenderRequest &a_oRequest, FrameBuffer &a_oTarget, const TileCallback &a_oOnTile, std::string &a_sError)
+{
+    if (this->m_bCancel)
+    {
+        a_sError = "cancelled";
+        return false;
+    }
+
+    if (a_oTarget.GetWidth() != a_oRequest.m_oSettings.m_iWidth || a_oTarget.GetHeight() != a_oRequest.m_oSettings.m_iHeight)
+    {
+        a_sError = "the framebuffer is not the size of the request";
+        return false;
+    }
+
+    if ((a_oRequest.m_bAovs || a_oRequest.m_oDenoise.m_eType != DENOISER_NONE) && !a_oTarget.HasAovs())
+    {
+        a_oTarget.EnableAovs();
+    }
+
+    this->Prepare(a_oRequest);
+
+    this->m_oTiles.SetTileCallback(a_oOnTile);
+
+    this->RenderTiles(this->BuildTiles(), a_oTarget);
+
+    this->m_oTiles.SetTileCallback(TileCallback());
+
+    if (this->m_bCancel)
+    {
+        a_sError = "cancelled";
+        return false;
+    }
+
+    if (a_oRequest.m_oDenoise.m_eType != DENOISER_NONE)
+    {
+        if (!Denoiser::Denoise(a_oTarget, a_oTarget, a_oRequest.m_oDenoise, this->m_oTiles.GetPool(), a_sError))
+        {
+            return false;
+        }
+
+        // The denoiser runs to the end, so a Cancel() during it is honoured here.
+        if (this->m_bCancel)
+        {
+            a_sError = "cancelled";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Renderer::Cancel()
+{
+    std::lock_guard<std::mutex> _cancelLock(this->m_oCancelMutex);
+
+    this->m_uCancelledTickets = this->m_uTickets;
+
+    if (this->m_uActiveTicket != 0)
+    {
+        this->m_bCancel = true;
+    }
+}
+
+bool Renderer::IsCancelled() const
+{
+    return this->m_bCancel;
+}
+
+const RenderSettings& Renderer::GetSettings() const
+{
+    return this->m_oTiles.GetSettings();
+}
+
+const Camera& Renderer::GetCamera() const
+{
+    return this->m_oCamera;
+}
+
+const Bvh& Renderer::GetWorld() const
+{
+    return *this->m_pWorld;
+}
+
+int Renderer::GetThreadCount() const
+{
+    return this->m_oTiles.GetThreadCount();
+}
+
+ThreadPool& Renderer::GetPool()
+{
+    return this->m_oTiles.GetPool();
+}
+
+bool Renderer::IsUsingGpu() const
+{
+    return this->m_bGpuActive;
+}
+
+const std::string& Renderer::GetGpuStatus() const
+{
+    return this->m_sGpuStatus;
+}
@@ -0,0 +1,154 @@
+#include "appsrc/include/Render/threadpool.h"
+
+namespace
+{
+    thread_local int s_iWorkerIndex = -1;
+}
+
+ThreadPool::ThreadPool(int a_iThreadCount) : m_iQueued(0),
+                                             m_iPending(0),
+                                             m_uNextQueue(0),
+                                             m_bStop(false)
+{
+    if (a_iThreadCount <= 0)
+    {
+        a_iThreadCount = static_cast<int>(std::thread::hardware_concurrency());
+
+        if (a_iThreadCount <= 0)
+        {
+            a_iThreadCount = 1;
+        }
+    }
+
+    for (int i = 0; i < a_iThreadCount; ++i)
+    {
+        this->m_oQueues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+
+    for (int i = 0; i < a_iThreadCount; ++i)
+    {
+        this->m_oThreads.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> _lock(this->m_oStateMutex);
+        this->m_bStop = true;
+    }
+
+    this->m_oWorkAvailable.notify_all();
+
+    for (size_t i = 0; i < this->m_oThreads.size(); ++i)
+    {
+        this->m_oThreads[i].join();
+    }
+}
+
+void ThreadPool::Submit(const Task& a_oTask)
+{
+    int _queueIndex = s_iWorkerIndex;
+
+    // Tasks spawned by a worker stay local; external submissions are spread round robin.
+    if (_queueIndex < 0)
+    {
+        _queueIndex = static_cast<int>(this->m_uNextQueue++ % this->m_oQueues.size());
+    }
+
+    ++this->m_iPending;
+
+    {
+        WorkQueue& _queue = *this->m_oQueues[_queueIndex];
+        std::lock_guard<std::mutex> _lock(_queue.m_oMutex);
+        _queue.m_oTasks.push_back(a_oTask);
+    }
+
+    {
+        std::lock_guard<std::mutex> _lock(this->m_oStateMutex);
+        ++this->m_iQueued;
+    }
+
+    this->m_oWorkAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> _lock(this->m_oStateMutex);
+
+    this->m_oWorkDone.wait(_lock, [this]() { return this->m_iPending == 0; });
+}
+
+int ThreadPool::GetThreadCount() const
+{
+    return static_cast<int>(this->m_oThreads.size());
+}
+
+bool ThreadPool::PopTask(int a_iIndex, Task& a_oTask)
+{
+    {
+        WorkQueue& _own = *this->m_oQueues[a_iIndex];
+        std::lock_guard<std::mutex> _lock(_own.m_oMutex);
+
+        if (!_own.m_oTasks.empty())
+        {
+            a_oTask = _own.m_oTasks.front();
+            _own.m_oTasks.pop_front();
+            return true;
+        }
+    }
+
+    int _count = static_cast<int>(this->m_oQueues.size());
+
+    for (int i = 1; i < _count; ++i)
+    {
+        WorkQueue& _victim = *this->m_oQueues[(a_iIndex + i) % _count];
+        std::lock_guard<std::mutex> _lock(_victim.m_oMutex);
+
+        if (!_victim.m_oTasks.empty())
+        {
+            a_oTask = _victim.m_oTasks.back();
+            _victim.m_oTasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::WorkerLoop(int a_iIndex)
+{
+    s_iWorkerIndex = a_iIndex;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> _lock(this->m_oStateMutex);
+
+            this->m_oWorkAvailable.wait(_lock, [this]() { return this->m_bStop || this->m_iQueued > 0; });
+
+            if (this->m_bStop && this->m_iQueued == 0)
+            {
+                return;
+            }
+        }
+
+        Task _task;
+
+        if (!this->PopTask(a_iIndex, _task))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        --this->m_iQueued;
+
+        _task();
+
+        if (--this->m_iPending == 0)
+        {
+            std::lock_guard<std::mutex> _lock(this->m_oStateMutex);
+            this->m_oWorkDone.notify_all();
+        }
+    }
+}
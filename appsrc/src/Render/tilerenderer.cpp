@@ -0,0 +1,179 @@
+#include "appsrc/include/Render/tilerenderer.h"
+#include "appsrc/include/Render/tilesampler.h"
+#include "appsrc/include/Math/trace.h"
+#include "appsrc/include/Math/counters.h"
+#include <algorithm>
+#include <chrono>
+
+RenderSettings::RenderSettings() : m_iWidth(1200),
+                                   m_iHeight(800),
+                                   m_iSamples(10),
+                                   m_iFirstSample(0),
+                                   m_iTileSize(32),
+                                   m_iThreadCount(0),
+                                   m_iMaxDepth(50),
+                                   m_iRouletteDepth(3),
+                                   m_bNextEvent(true),
+                                   m_eSampler(SAMPLER_SOBOL),
+                                   m_bAdaptive(false),
+                                   m_iMinSamples(8),
+                                   m_fNoiseThreshold(0.02f),
+                                   m_dTileTimeLimitMs(0.0)
+{
+}
+
+TileRenderer::TileRenderer(const RenderSettings &a_oSettings) : m_oSettings(a_oSettings),
+                                                                m_pCancel(nullptr),
+                                                                m_oPool(a_oSettings.m_iThreadCount)
+{
+    this->SetSettings(a_oSettings);
+}
+
+void TileRenderer::SetSettings(const RenderSettings &a_oSettings)
+{
+    this->m_oSettings = a_oSettings;
+
+    if (this->m_oSettings.m_iTileSize <= 0)
+    {
+        this->m_oSettings.m_iTileSize = 32;
+    }
+}
+
+void TileRenderer::SetCancelFlag(const std::atomic<bool> *a_pCancel)
+{
+    this->m_pCancel = a_pCancel;
+}
+
+void TileRenderer::SetTileCallback(const TileCallback &a_oCallback)
+{
+    this->m_oTileCallback = a_oCallback;
+}
+
+const TileRenderer::TileCallback& TileRenderer::GetTileCallback() const
+{
+    return this->m_oTileCallback;
+}
+
+std::vector<Tile> TileRenderer::BuildTiles() const
+{
+    std::vector<Tile> _tiles;
+
+    int _size = this->m_oSettings.m_iTileSize;
+
+    for (int y = 0; y < this->m_oSettings.m_iHeight; y += _size)
+    {
+        for (int x = 0; x < this->m_oSettings.m_iWidth; x += _size)
+        {
+            Tile _tile;
+            _tile.m_iX0 = x;
+            _tile.m_iY0 = y;
+            _tile.m_iX1 = std::min(x + _size, this->m_oSettings.m_iWidth);
+            _tile.m_iY1 = std::min(y + _size, this->m_oSettings.m_iHeight);
+            _tiles.push_back(_tile);
+        }
+    }
+
+    return _tiles;
+}
+
+void TileRenderer::SetSampleRange(int a_iFirst, int a_iCount)
+{
+    this->m_oSettings.m_iFirstSample = a_iFirst;
+    this->m_oSettings.m_iSamples = a_iCount;
+}
+
+void TileRenderer::Render(const SampleShader &a_oShader, FrameBuffer &a_oFrameBuffer)
+{
+    this->Render(a_oShader, this->BuildTiles(), a_oFrameBuffer);
+}
+
+void TileRenderer::RenderTiles(const TileShader &a_oShader, FrameBuffer &a_oFrameBuffer)
+{
+    this->RenderTiles(a_oShader, this->BuildTiles(), a_oFrameBuffer);
+}
+
+void TileRenderer::Render(const SampleShader &a_oShader, const std::vector<Tile> &a_oTiles, FrameBuffer &a_oFrameBuffer)
+{
+    this->RenderTiles([this, &a_oShader](const Tile& a_oTile, FrameBuffer& a_oTarget)
+    {
+        this->RenderTile(a_oTile, a_oShader, a_oTarget);
+    }, a_oTiles, a_oFrameBuffer);
+}
+
+void TileRenderer::RenderTiles(const TileShader &a_oShader, const std::vector<Tile> &a_oTiles, FrameBuffer &a_oFrameBuffer)
+{
+    for (size_t t = 0; t < a_oTiles.size(); ++t)
+    {
+        Tile _tile = a_oTiles[t];
+
+        this->m_oPool.Submit([this, _tile, &a_oShader, &a_oFrameBuffer]()
+        {
+            if (this->m_pCancel != nullptr && this->m_pCancel->load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            RT_TRACE_SPAN("tile", _tile.m_iX0, _tile.m_iY0);
+
+#if RT_ENABLE_COUNTERS
+            std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+#endif
+
+            a_oShader(_tile, a_oFrameBuffer);
+
+#if RT_ENABLE_COUNTERS
+            RT_COUNTERS(_counters);
+
+            RT_COUNTER_ADD(_counters, COUNTER_TILES, 1);
+            RT_COUNTER_ADD(_counters, COUNTER_TILE_NANOSECONDS, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+#endif
+
+            if (this->m_oTileCallback)
+            {
+                this->m_oTileCallback(_tile, a_oFrameBuffer);
+            }
+        });
+    }
+
+    this->m_oPool.Wait();
+}
+
+void TileRenderer::RenderTile(const Tile &a_oTile, const SampleShader &a_oShader, FrameBuffer &a_oFrameBuffer) const
+{
+    TileSampler _sampler(a_oTile, this->m_oSettings, a_oFrameBuffer.HasAovs());
+
+    std::vector<SampleRequest> _requests;
+
+    SampleAovs _aovs;
+
+    SampleAovs* _target = _sampler.HasAovs() ? &_aovs : nullptr;
+
+    while (_sampler.NextRound(_requests))
+    {
+        for (size_t r = 0; r < _requests.size(); ++r)
+        {
+            const SampleRequest& _request = _requests[r];
+
+            Vec3 _radiance = a_oShader(_request.m_iX, _request.m_iY, _request.m_iSample, _target);
+
+            _sampler.AddSample(_request, _radiance, _target);
+        }
+    }
+
+    _sampler.Resolve(a_oFrameBuffer);
+}
+
+const RenderSettings& TileRenderer::GetSettings() const
+{
+    return this->m_oSettings;
+}
+
+ThreadPool& TileRenderer::GetPool()
+{
+    return this->m_oPool;
+}
+
+int TileRenderer::GetThreadCount() const
+{
+    return this->m_oPool.GetThreadCount();
+}
@@ -0,0 +1,226 @@
+#include "appsrc/include/Render/tilesampler.h"
+#include <algorithm>
+#include <float.h>
+
+namespace
+{
+    // Samples added per adaptive round once the minimum has been taken.
+    const int s_ciAdaptiveStep = 4;
+
+    // Keeps the relative error finite on black pixels.
+    const double s_cdLuminanceFloor = 1e-3;
+
+    inline double Luminance(const Vec3& a_oColor)
+    {
+        return 0.2126 * a_oColor[0] + 0.7152 * a_oColor[1] + 0.0722 * a_oColor[2];
+    }
+}
+
+PixelEstimate::PixelEstimate() : m_oSum(0.0f, 0.0f, 0.0f),
+                                 m_dMean(0.0),
+                                 m_dM2(0.0),
+                                 m_iCount(0)
+{
+}
+
+void PixelEstimate::Add(const Vec3 &a_oSample)
+{
+    this->m_oSum += a_oSample;
+
+    ++this->m_iCount;
+
+    double _y = Luminance(a_oSample);
+    double _delta = _y - this->m_dMean;
+
+    this->m_dMean += _delta / this->m_iCount;
+    this->m_dM2 += _delta * (_y - this->m_dMean);
+}
+
+Vec3 PixelEstimate::GetMean() const
+{
+    if (this->m_iCount == 0)
+    {
+        return Vec3(0.0f, 0.0f, 0.0f);
+    }
+
+    Vec3 _mean = this->m_oSum;
+
+    _mean /= float(this->m_iCount);
+
+    return _mean;
+}
+
+float PixelEstimate::GetRelativeError() const
+{
+    if (this->m_iCount < 2)
+    {
+        return FLT_MAX;
+    }
+
+    double _variance = this->m_dM2 / (this->m_iCount - 1);
+
+    return static_cast<float>(sqrt(_variance / this->m_iCount) / std::max(this->m_dMean, s_cdLuminanceFloor));
+}
+
+TileSampler::TileSampler(const Tile &a_oTile, const RenderSettings &a_oSettings, bool a_bAovs) : m_oTile(a_oTile),
+                                                                                                  m_oSettings(a_oSettings),
+                                                                                                  m_oPixels((a_oTile.m_iX1 - a_oTile.m_iX0) * (a_oTile.m_iY1 - a_oTile.m_iY0)),
+                                                                                                  m_oAovSums(a_bAovs ? m_oPixels.size() : 0),
+                                                                                                  m_iRound(0),
+                                                                                                  m_iFixedTarget(0),
+                                                                                                  m_uCursorPixel(m_oPixels.size()),
+                                                                                                  m_iCursorSample(0),
+                                                                                                  m_oStart(std::chrono::steady_clock::now())
+{
+}
+
+bool TileSampler::IsPending(const PixelEstimate &a_oEstimate) const
+{
+    if (a_oEstimate.m_iCount >= this->m_oSettings.m_iSamples)
+    {
+        return false;
+    }
+
+    return a_oEstimate.GetRelativeError() > this->m_oSettings.m_fNoiseThreshold;
+}
+
+void TileSampler::ContinueFixedRound(std::vector<SampleRequest> &a_oRequests)
+{
+    int _width = this->m_oTile.m_iX1 - this->m_oTile.m_iX0;
+
+    while (this->m_uCursorPixel < this->m_oPixels.size() && a_oRequests.size() < size_t(MAX_ROUND_SIZE))
+    {
+        int p = static_cast<int>(this->m_uCursorPixel);
+
+        SampleRequest _request;
+        _request.m_iX = this->m_oTile.m_iX0 + p % _width;
+        _request.m_iY = this->m_oTile.m_iY0 + p / _width;
+        _request.m_iPixel = p;
+
+        int s = this->m_iCursorSample;
+
+        for (; s < this->m_iFixedTarget && a_oRequests.size() < size_t(MAX_ROUND_SIZE); ++s)
+        {
+            _request.m_iSample = this->m_oSettings.m_iFirstSample + s;
+            a_oRequests.push_back(_request);
+        }
+
+        this->m_iCursorSample = s;
+
+        if (s >= this->m_iFixedTarget)
+        {
+            ++this->m_uCursorPixel;
+            this->m_iCursorSample = 0;
+        }
+    }
+}
+
+bool TileSampler::NextRound(std::vector<SampleRequest> &a_oRequests)
+{
+    a_oRequests.clear();
+
+    // The rest of a fixed round cut short by MAX_ROUND_SIZE comes first.
+    if (this->m_uCursorPixel < this->m_oPixels.size())
+    {
+        this->ContinueFixedRound(a_oRequests);
+
+        return true;
+    }
+
+    int _round = this->m_iRound++;
+
+    if (_round > 0)
+    {
+        if (!this->m_oSettings.m_bAdaptive)
+        {
+            return false;
+        }
+
+        if (this->m_oSettings.m_dTileTimeLimitMs > 0.0)
+        {
+            std::chrono::duration<double, std::milli> _elapsed = std::chrono::steady_clock::now() - this->m_oStart;
+
+            if (_elapsed.count() >= this->m_oSettings.m_dTileTimeLimitMs)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Every pixel starts from zero samples, so the first round takes each to the same count.
+    if (_round == 0)
+    {
+        this->m_iFixedTarget = this->m_oSettings.m_bAdaptive ? std::min(std::max(this->m_oSettings.m_iMinSamples, 2), this->m_oSettings.m_iSamples) : this->m_oSettings.m_iSamples;
+        this->m_uCursorPixel = 0;
+        this->m_iCursorSample = 0;
+
+        this->ContinueFixedRound(a_oRequests);
+
+        return !a_oRequests.empty();
+    }
+
+    int _width = this->m_oTile.m_iX1 - this->m_oTile.m_iX0;
+
+    for (size_t p = 0; p < this->m_oPixels.size(); ++p)
+    {
+        const PixelEstimate& _estimate = this->m_oPixels[p];
+
+        if (!this->IsPending(_estimate))
+        {
+            continue;
+        }
+
+        int _end = std::min(_estimate.m_iCount + s_ciAdaptiveStep, this->m_oSettings.m_iSamples);
+
+        SampleRequest _request;
+        _request.m_iX = this->m_oTile.m_iX0 + static_cast<int>(p) % _width;
+        _request.m_iY = this->m_oTile.m_iY0 + static_cast<int>(p) / _width;
+        _request.m_iPixel = static_cast<int>(p);
+
+        for (int s = _estimate.m_iCount; s < _end; ++s)
+        {
+            _request.m_iSample = this->m_oSettings.m_iFirstSample + s;
+            a_oRequests.push_back(_request);
+        }
+    }
+
+    return !a_oRequests.empty();
+}
+
+void TileSampler::AddSample(const SampleRequest &a_oRequest, const Vec3 &a_oRadiance, const SampleAovs *a_pAovs)
+{
+    this->m_oPixels[a_oRequest.m_iPixel].Add(a_oRadiance);
+
+    if (a_pAovs != nullptr && !this->m_oAovSums.empty())
+    {
+        this->m_oAovSums[a_oRequest.m_iPixel].Add(*a_pAovs);
+    }
+}
+
+bool TileSampler::HasAovs() const
+{
+    return !this->m_oAovSums.empty();
+}
+
+void TileSampler::Resolve(FrameBuffer &a_oFrameBuffer) const
+{
+    int _width = this->m_oTile.m_iX1 - this->m_oTile.m_iX0;
+
+    for (size_t p = 0; p < this->m_oPixels.size(); ++p)
+    {
+        int i = this->m_oTile.m_iX0 + static_cast<int>(p) % _width;
+        int j = this->m_oTile.m_iY0 + static_cast<int>(p) / _width;
+
+        a_oFrameBuffer.SetPixel(i, j, this->m_oPixels[p].GetMean());
+        a_oFrameBuffer.SetSampleCount(i, j, this->m_oPixels[p].m_iCount);
+
+        if (!this->m_oAovSums.empty() && a_oFrameBuffer.HasAovs())
+        {
+            SampleAovs _mean = this->m_oAovSums[p];
+
+            _mean.Scale(this->m_oPixels[p].m_iCount > 0 ? 1.0f / this->m_oPixels[p].m_iCount : 0.0f);
+
+            a_oFrameBuffer.SetAovs(i, j, _mean);
+        }
+    }
+}
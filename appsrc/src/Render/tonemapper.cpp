@@ -0,0 +1,336 @@
+#include "appsrc/include/Render/tonemapper.h"
+#include "appsrc/include/Math/hash.h"
+#include "appsrc/include/Math/trace.h"
+#include <math.h>
+
+#if defined(RT_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    static_assert(sizeof(Vec3) == 3 * sizeof(float), "the curve reads Vec3 pixels as packed floats");
+
+    // Narkowicz's fit of the ACES reference rendering and output transforms. His 0.6
+    // pre-exposure is folded into the scale so exposure 0 keeps mid grey where it was.
+    const float s_cfAcesExposure = 0.6f;
+    const float s_cfAcesA = 2.51f;
+    const float s_cfAcesB = 0.03f;
+    const float s_cfAcesC = 2.43f;
+    const float s_cfAcesD = 0.59f;
+    const float s_cfAcesE = 0.14f;
+
+    // Linear interpolation in 4096 steps stays within 0.01 of an 8-bit step of the exact curve.
+    const int s_ciSrgbTableSize = 4096;
+
+    const uint32_t s_cuDitherSeed = 0x6d2b79f5u;
+
+    typedef void (*CurveKernel)(const float* a_pIn, int a_iCount, float a_fScale, float* a_pOut);
+
+    template <ToneCurve CURVE>
+    inline float Curve(float a_fValue)
+    {
+        if (CURVE == TONE_CURVE_REINHARD)
+        {
+            return a_fValue / (1.0f + a_fValue);
+        }
+
+        if (CURVE == TONE_CURVE_ACES)
+        {
+            return (a_fValue * (s_cfAcesA * a_fValue + s_cfAcesB)) / (a_fValue * (s_cfAcesC * a_fValue + s_cfAcesD) + s_cfAcesE);
+        }
+
+        return a_fValue;
+    }
+
+    // The comparisons send NaN to 0 before the curve and to 1 after it, like the vector
+    // max and min with the constant second.
+    template <ToneCurve CURVE>
+    void CurveScalar(const float* a_pIn, int a_iCount, float a_fScale, float* a_pOut)
+    {
+        for (int i = 0; i < a_iCount; ++i)
+        {
+            float _x = a_pIn[i] * a_fScale;
+
+            _x = _x > 0.0f ? _x : 0.0f;
+
+            float _y = Curve<CURVE>(_x);
+
+            a_pOut[i] = _y < 1.0f ? _y : 1.0f;
+        }
+    }
+
+#if defined(RT_SIMD_X86)
+    template <ToneCurve CURVE>
+    inline __m128 CurveSse2Lanes(__m128 a_oValue)
+    {
+        if (CURVE == TONE_CURVE_REINHARD)
+        {
+            return _mm_div_ps(a_oValue, _mm_add_ps(_mm_set1_ps(1.0f), a_oValue));
+        }
+
+        if (CURVE == TONE_CURVE_ACES)
+        {
+            __m128 _numerator = _mm_mul_ps(a_oValue, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s_cfAcesA), a_oValue), _mm_set1_ps(s_cfAcesB)));
+            __m128 _denominator = _mm_add_ps(_mm_mul_ps(a_oValue, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s_cfAcesC), a_oValue), _mm_set1_ps(s_cfAcesD))), _mm_set1_ps(s_cfAcesE));
+
+            return _mm_div_ps(_numerator, _denominator);
+        }
+
+        return a_oValue;
+    }
+
+    template <ToneCurve CURVE>
+    void CurveSse2(const float* a_pIn, int a_iCount, float a_fScale, float* a_pOut)
+    {
+        const __m128 _scale = _mm_set1_ps(a_fScale);
+        const __m128 _zero = _mm_setzero_ps();
+        const __m128 _one = _mm_set1_ps(1.0f);
+
+        int i = 0;
+
+        for (; i + 4 <= a_iCount; i += 4)
+        {
+            __m128 _x = _mm_max_ps(_mm_mul_ps(_mm_loadu_ps(a_pIn + i), _scale), _zero);
+
+            _mm_storeu_ps(a_pOut + i, _mm_min_ps(CurveSse2Lanes<CURVE>(_x), _one));
+        }
+
+        CurveScalar<CURVE>(a_pIn + i, a_iCount - i, a_fScale, a_pOut + i);
+    }
+
+    template <ToneCurve CURVE>
+    RT_TARGET_AVX2 inline __m256 CurveAvx2Lanes(__m256 a_oValue)
+    {
+        if (CURVE == TONE_CURVE_REINHARD)
+        {
+            return _mm256_div_ps(a_oValue, _mm256_add_ps(_mm256_set1_ps(1.0f), a_oValue));
+        }
+
+        if (CURVE == TONE_CURVE_ACES)
+        {
+            __m256 _numerator = _mm256_mul_ps(a_oValue, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s_cfAcesA), a_oValue), _mm256_set1_ps(s_cfAcesB)));
+            __m256 _denominator = _mm256_add_ps(_mm256_mul_ps(a_oValue, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(s_cfAcesC), a_oValue), _mm256_set1_ps(s_cfAcesD))), _mm256_set1_ps(s_cfAcesE));
+
+            return _mm256_div_ps(_numerator, _denominator);
+        }
+
+        return a_oValue;
+    }
+
+    template <ToneCurve CURVE>
+    RT_TARGET_AVX2 void CurveAvx2(const float* a_pIn, int a_iCount, float a_fScale, float* a_pOut)
+    {
+        const __m256 _scale = _mm256_set1_ps(a_fScale);
+        const __m256 _zero = _mm256_setzero_ps();
+        const __m256 _one = _mm256_set1_ps(1.0f);
+
+        int i = 0;
+
+        for (; i + 8 <= a_iCount; i += 8)
+        {
+            __m256 _x = _mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(a_pIn + i), _scale), _zero);
+
+            _mm256_storeu_ps(a_pOut + i, _mm256_min_ps(CurveAvx2Lanes<CURVE>(_x), _one));
+        }
+
+        CurveScalar<CURVE>(a_pIn + i, a_iCount - i, a_fScale, a_pOut + i);
+    }
+#endif
+
+    template <ToneCurve CURVE>
+    CurveKernel SelectKernel()
+    {
+        switch (ToneMapper::GetIsa())
+        {
+#if defined(RT_SIMD_X86)
+        case SIMD_ISA_AVX2:
+            return &CurveAvx2<CURVE>;
+        case SIMD_ISA_SSE2:
+            return &CurveSse2<CURVE>;
+#endif
+        default:
+            return &CurveScalar<CURVE>;
+        }
+    }
+
+    const CurveKernel s_pCurves[TONE_CURVE_COUNT] = { SelectKernel<TONE_CURVE_CLAMP>(), SelectKernel<TONE_CURVE_REINHARD>(), SelectKernel<TONE_CURVE_ACES>() };
+
+    float SrgbFromLinear(float a_fValue)
+    {
+        return a_fValue <= 0.0031308f ? 12.92f * a_fValue : 1.055f * powf(a_fValue, 1.0f / 2.4f) - 0.055f;
+    }
+
+    struct SrgbTable
+    {
+        SrgbTable()
+        {
+            for (int i = 0; i <= s_ciSrgbTableSize; ++i)
+            {
+                this->m_fValues[i] = SrgbFromLinear(float(i) / s_ciSrgbTableSize);
+            }
+        }
+
+        // One past the end, so the last step interpolates to exactly 1.
+        float m_fValues[s_ciSrgbTableSize + 1];
+    };
+
+    const SrgbTable s_oSrgbTable;
+
+    // Rounds to the nearest step. The dither leaves exact black and white alone, so
+    // backgrounds and clipped highlights stay flat.
+    unsigned char Quantize(float a_fValue, bool a_bDither, uint32_t a_uSeed)
+    {
+        float _level = 255.0f * a_fValue + 0.5f;
+
+        if (a_bDither && a_fValue > 0.0f && a_fValue < 1.0f)
+        {
+            _level += ToUnitFloat(Hash(a_uSeed)) + ToUnitFloat(Hash(a_uSeed ^ s_cuDitherSeed)) - 1.0f;
+        }
+
+        int _step = int(floorf(_level));
+
+        return static_cast<unsigned char>(_step < 0 ? 0 : _step > 255 ? 255 : _step);
+    }
+}
+
+ToneMapSettings::ToneMapSettings() : m_fExposure(0.0f),
+                                     m_eCurve(TONE_CURVE_CLAMP),
+                                     m_eEncoding(DISPLAY_SRGB),
+                                     m_bDither(true)
+{
+}
+
+void ToneMapper::ToRgb8(const FrameBuffer &a_oFrameBuffer, const ToneMapSettings &a_oSettings, std::vector<unsigned char> &a_oRgb)
+{
+    RT_TRACE_SPAN("tone map");
+
+    int _width = a_oFrameBuffer.GetWidth();
+    int _height = a_oFrameBuffer.GetHeight();
+
+    a_oRgb.resize(3 * static_cast<size_t>(_width) * _height);
+
+    if (a_oRgb.empty())
+    {
+        return;
+    }
+
+    const float* _data = reinterpret_cast<const float*>(a_oFrameBuffer.GetData());
+
+    // One scanline at a time, so the curve's output is still in cache for the encoding.
+    std::vector<float> _row(3 * _width);
+
+    unsigned char* _out = &a_oRgb[0];
+
+    for (int j = _height - 1; j >= 0; --j)
+    {
+        ApplyCurve(_data + 3 * static_cast<size_t>(j) * _width, 3 * _width, a_oSettings, &_row[0]);
+
+        for (int i = 0; i < _width; ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                float _encoded = Encode(_row[3 * i + c], a_oSettings.m_eEncoding);
+
+                *_out++ = Quantize(_encoded, a_oSettings.m_bDither, PixelSeed(i, j, c, s_cuDitherSeed));
+            }
+        }
+    }
+}
+
+void ToneMapper::ApplyCurve(const float *a_pIn, int a_iCount, const ToneMapSettings &a_oSettings, float *a_pOut)
+{
+    float _scale = exp2f(a_oSettings.m_fExposure);
+
+    if (a_oSettings.m_eCurve == TONE_CURVE_ACES)
+    {
+        _scale *= s_cfAcesExposure;
+    }
+
+    s_pCurves[a_oSettings.m_eCurve](a_pIn, a_iCount, _scale, a_pOut);
+}
+
+float ToneMapper::Encode(float a_fValue, DisplayEncoding a_eEncoding)
+{
+    if (a_eEncoding == DISPLAY_GAMMA2)
+    {
+        return sqrtf(a_fValue);
+    }
+
+    float _position = a_fValue * s_ciSrgbTableSize;
+
+    int _index = int(_position);
+
+    if (_index >= s_ciSrgbTableSize)
+    {
+        return 1.0f;
+    }
+
+    float _fraction = _position - float(_index);
+
+    return s_oSrgbTable.m_fValues[_index] + _fraction * (s_oSrgbTable.m_fValues[_index + 1] - s_oSrgbTable.m_fValues[_index]);
+}
+
+bool ToneMapper::ParseCurve(const std::string &a_sName, ToneCurve &a_eCurve)
+{
+    for (int t = 0; t < TONE_CURVE_COUNT; ++t)
+    {
+        if (a_sName == GetCurveName(ToneCurve(t)))
+        {
+            a_eCurve = ToneCurve(t);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* ToneMapper::GetCurveName(ToneCurve a_eCurve)
+{
+    switch (a_eCurve)
+    {
+    case TONE_CURVE_CLAMP:
+        return "clamp";
+    case TONE_CURVE_REINHARD:
+        return "reinhard";
+    case TONE_CURVE_ACES:
+        return "aces";
+    default:
+        return "unknown";
+    }
+}
+
+bool ToneMapper::ParseEncoding(const std::string &a_sName, DisplayEncoding &a_eEncoding)
+{
+    for (int e = 0; e < DISPLAY_ENCODING_COUNT; ++e)
+    {
+        if (a_sName == GetEncodingName(DisplayEncoding(e)))
+        {
+            a_eEncoding = DisplayEncoding(e);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char* ToneMapper::GetEncodingName(DisplayEncoding a_eEncoding)
+{
+    switch (a_eEncoding)
+    {
+    case DISPLAY_SRGB:
+        return "srgb";
+    case DISPLAY_GAMMA2:
+        return "gamma2";
+    default:
+        return "unknown";
+    }
+}
+
+SimdIsa ToneMapper::GetIsa()
+{
+    // The curve is bound by memory well before AVX-512 would pay off.
+    SimdIsa _isa = GetActiveSimdIsa();
+
+    return _isa > SIMD_ISA_AVX2 ? SIMD_ISA_AVX2 : _isa;
+}
@@ -0,0 +1,73 @@
+#include "appsrc/include/Scene/randomscene.h"
+#include "appsrc/include/Math/sphere.h"
+#include "appsrc/include/Scene/scene.h"
+
+RandomSceneOptions::RandomSceneOptions() : m_iGridHalfExtent(11),
+                                           m_fDiffuseFraction(0.8f),
+                                           m_fMetalFraction(0.15f)
+{
+}
+
+int RandomSceneCapacity(const RandomSceneOptions &a_oOptions)
+{
+    int _side = 2 * a_oOptions.m_iGridHalfExtent;
+
+    // Ground plus the three large spheres.
+    return _side * _side + 4;
+}
+
+HittableList* RandomScene(SceneArena &a_oArena, Rng &a_oRng, const RandomSceneOptions &a_oOptions)
+{
+    int n = a_oOptions.m_iGridHalfExtent;
+
+    float _metalLimit = a_oOptions.m_fDiffuseFraction + a_oOptions.m_fMetalFraction;
+
+    Hittable** _list = a_oArena.CreateArray<Hittable*>(RandomSceneCapacity(a_oOptions));
+
+    _list[0] = a_oArena.Create<Sphere>(Vec3(0.0f, -1000.0f, 0.0f), 1000.0f, a_oArena.Create<Lambertian>(Vec3(0.5f, 0.5f, 0.5f)));
+
+    int i = 1;
+
+    for (int a = -n; a < n; ++a)
+    {
+        for (int b = -n; b < n; ++b)
+        {
+            float _chooseMat = a_oRng.NextFloat();
+
+            Vec3 _center(a + 0.9f * a_oRng.NextFloat(), 0.2f, b + 0.9f * a_oRng.NextFloat());
+
+            if ((_center - Vec3(4.0f, 0.2f, 0.0f)).Length() > 0.9f)
+            {
+                if (_chooseMat < a_oOptions.m_fDiffuseFraction)
+                {
+                    _list[i++] = a_oArena.Create<Sphere>(_center, 0.2f, a_oArena.Create<Lambertian>(Vec3(a_oRng.NextFloat() * a_oRng.NextFloat(), a_oRng.NextFloat() * a_oRng.NextFloat(), a_oRng.NextFloat() * a_oRng.NextFloat())));
+                }
+                else if (_chooseMat < _metalLimit)
+                {
+                    _list[i++] = a_oArena.Create<Sphere>(_center, 0.2f,
+                                                         a_oArena.Create<Metal>(Vec3(0.5f * (1.0f + a_oRng.NextFloat()), 0.5f * (1.0f + a_oRng.NextFloat()), 0.5f * (1.0f + a_oRng.NextFloat())), 0.5f * a_oRng.NextFloat()));
+                }
+                else
+                {
+                    _list[i++] = a_oArena.Create<Sphere>(_center, 0.2f, a_oArena.Create<Dielectric>(1.5f));
+                }
+            }
+        }
+    }
+
+    _list[i++] = a_oArena.Create<Sphere>(Vec3(0.0f, 1.0f, 0.0f), 1.0f , a_oArena.Create<Dielectric>(1.5f));
+    _list[i++] = a_oArena.Create<Sphere>(Vec3(-4.0f, 1.0f, 0.0f), 1.0f, a_oArena.Create<Lambertian>(Vec3(0.4f, 0.2f, 0.1f)));
+    _list[i++] = a_oArena.Create<Sphere>(Vec3(4.0f, 1.0f, 0.0f), 1.0f, a_oArena.Create<Metal>(Vec3(0.7f, 0.6f, 0.5f), 0.0f));
+
+    return a_oArena.Create<HittableList>(_list, i);
+}
+
+Camera RandomSceneCamera(float a_fAspect, float a_fAperture)
+{
+    // SceneCamera defaults to the cover shot.
+    SceneCamera _camera;
+
+    _camera.m_fAperture = a_fAperture;
+
+    return _camera.Build(a_fAspect);
+}
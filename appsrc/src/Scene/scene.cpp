@@ -0,0 +1,1739 @@
+#include "appsrc/include/Scene/scene.h"
+#include "appsrc/include/Math/sphere.h"
+#include "appsrc/include/Math/trace.h"
+#include "appsrc/include/IO/json.h"
+#include "appsrc/include/IO/meshloader.h"
+#include <algorithm>
+#include <chrono>
+#include <ctype.h>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <math.h>
+#include <sstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+    const char s_ccMagic[4] = { 'R', 'T', 'S', 'C' };
+
+    const int32_t s_ciVersion = 3;
+
+    // Matches SphereSoA's allocation alignment, so mapped arrays behave like owned ones.
+    const uint64_t s_cuSectionAlignment = 64;
+
+    const char* const s_cpMaterialNames[MATERIAL_TYPE_COUNT] = { "lambertian", "metal", "dielectric", "emissive" };
+
+    enum CacheSection
+    {
+        CACHE_SECTION_CENTER_X = 0,
+        CACHE_SECTION_CENTER_Y,
+        CACHE_SECTION_CENTER_Z,
+        CACHE_SECTION_RADIUS,
+        CACHE_SECTION_MATERIAL_ID,
+        CACHE_SECTION_MATERIALS,
+        CACHE_SECTION_NODES,
+        CACHE_SECTION_COUNT
+    };
+
+    struct CacheCamera
+    {
+        float m_fLookFrom[3];
+        float m_fLookAt[3];
+        float m_fUp[3];
+        float m_fFov;
+        float m_fAperture;
+        float m_fFocusDist;
+        float m_fShutter;
+        float m_fOrbit;
+    };
+
+    struct CacheMaterial
+    {
+        int32_t m_iType;
+        float m_fAlbedo[3];
+        float m_fParameter;
+    };
+
+    // Native byte order. Sphere sections hold m_iSphereCount values followed by
+    // m_iPadding NaN lanes (zero ids); a node count of zero means no BVH was stored.
+    struct CacheHeader
+    {
+        char m_cMagic[4];
+
+        int32_t m_iVersion;
+        int32_t m_iSphereCount;
+        int32_t m_iMaterialCount;
+        int32_t m_iNodeCount;
+        int32_t m_iPadding;
+
+        CacheCamera m_oCamera;
+
+        // Non-zero when m_fBackground replaces the sky gradient.
+        int32_t m_iBackground;
+        float m_fBackground[3];
+
+        uint64_t m_uOffsets[CACHE_SECTION_COUNT];
+    };
+
+    static_assert(sizeof(MaterialId) == sizeof(float), "material ids share the sphere section layout");
+
+    uint64_t AlignSection(uint64_t a_uOffset)
+    {
+        return (a_uOffset + s_cuSectionAlignment - 1) / s_cuSectionAlignment * s_cuSectionAlignment;
+    }
+
+    bool ReadText(const std::string& a_sPath, std::string& a_sText)
+    {
+        std::ifstream _file(a_sPath.c_str(), std::ios::in | std::ios::binary);
+
+        if (!_file)
+        {
+            return false;
+        }
+
+        std::ostringstream _contents;
+
+        _contents << _file.rdbuf();
+
+        a_sText = _contents.str();
+
+        return true;
+    }
+
+    bool ReadVec3(const JsonValue* a_pValue, Vec3& a_oOut)
+    {
+        if (a_pValue == nullptr || a_pValue->GetType() != JSON_ARRAY || a_pValue->GetSize() != 3)
+        {
+            return false;
+        }
+
+        for (int a = 0; a < 3; ++a)
+        {
+            if (a_pValue->GetItem(a).GetType() != JSON_NUMBER)
+            {
+                return false;
+            }
+
+            a_oOut[a] = float(a_pValue->GetItem(a).GetNumber());
+        }
+
+        return true;
+    }
+
+    bool ReadFloat(const JsonValue* a_pValue, float& a_fOut)
+    {
+        if (a_pValue == nullptr || a_pValue->GetType() != JSON_NUMBER)
+        {
+            return false;
+        }
+
+        a_fOut = float(a_pValue->GetNumber());
+
+        return true;
+    }
+
+    // Optional members keep a_fOut/a_oOut unchanged when absent, but must be well formed when present.
+    bool ReadOptionalVec3(const JsonValue& a_oObject, const char* a_pKey, Vec3& a_oOut)
+    {
+        const JsonValue* _value = a_oObject.Find(a_pKey);
+
+        return _value == nullptr || ReadVec3(_value, a_oOut);
+    }
+
+    bool ReadOptionalFloat(const JsonValue& a_oObject, const char* a_pKey, float& a_fOut)
+    {
+        const JsonValue* _value = a_oObject.Find(a_pKey);
+
+        return _value == nullptr || ReadFloat(_value, a_fOut);
+    }
+
+    // Adds the emissive spheres among a_oSpheres, placed by a_oObjectToWorld. The transform
+    // must keep spheres round: a uniform scale, rotations and translations.
+    void AddSphereLights(const SphereSoA& a_oSpheres, const Transform& a_oObjectToWorld, const MaterialTable& a_oMaterials, LightList& a_oLights)
+    {
+        float _scale = cbrtf(a_oObjectToWorld.Vector(Vec3(1.0f, 0.0f, 0.0f)).Length() * a_oObjectToWorld.Vector(Vec3(0.0f, 1.0f, 0.0f)).Length() * a_oObjectToWorld.Vector(Vec3(0.0f, 0.0f, 1.0f)).Length());
+
+        for (int i = 0; i < a_oSpheres.GetCount(); ++i)
+        {
+            const Material& _material = a_oMaterials.Get(a_oSpheres.m_pMaterialId[i]);
+
+            if (_material.m_eType == MATERIAL_EMISSIVE)
+            {
+                a_oLights.AddSphere(a_oObjectToWorld.Point(a_oSpheres.GetCenter(i)), a_oObjectToWorld.Vector(a_oSpheres.GetVelocity(i)), _scale * a_oSpheres.m_pRadius[i], _material.m_oAlbedo, a_oSpheres.m_pMaterialId[i]);
+            }
+        }
+    }
+
+    std::string Located(const char* a_pArray, int a_iIndex, const std::string& a_sMessage)
+    {
+        std::ostringstream _out;
+
+        _out << a_pArray << "[" << a_iIndex << "]: " << a_sMessage;
+
+        return _out.str();
+    }
+
+    // A material name or index; INVALID_MATERIAL_ID when it is neither.
+    MaterialId ReadMaterial(const JsonValue* a_pValue, const std::map<std::string, MaterialId>& a_oNames, int a_iMaterialCount)
+    {
+        if (a_pValue != nullptr && a_pValue->GetType() == JSON_STRING)
+        {
+            std::map<std::string, MaterialId>::const_iterator _found = a_oNames.find(a_pValue->GetString());
+
+            return _found != a_oNames.end() ? _found->second : INVALID_MATERIAL_ID;
+        }
+
+        if (a_pValue != nullptr && a_pValue->GetType() == JSON_NUMBER && a_pValue->GetNumber() >= 0.0 && a_pValue->GetNumber() < a_iMaterialCount)
+        {
+            return MaterialId(a_pValue->GetNumber());
+        }
+
+        return INVALID_MATERIAL_ID;
+    }
+
+    // Fills a_oSpheres from a JSON array; a_pContext prefixes error messages.
+    bool ReadSpheres(const JsonValue& a_oArray, const char* a_pContext, const std::map<std::string, MaterialId>& a_oNames, int a_iMaterialCount, SphereSoA& a_oSpheres, std::string& a_sError)
+    {
+        if (a_oArray.GetType() != JSON_ARRAY)
+        {
+            a_sError = std::string(a_pContext) + " must be an array";
+            return false;
+        }
+
+        a_oSpheres.Reserve(a_oArray.GetSize());
+
+        for (int s = 0; s < a_oArray.GetSize(); ++s)
+        {
+            const JsonValue& _entry = a_oArray.GetItem(s);
+
+            Vec3 _center;
+            float _radius;
+
+            if (!ReadVec3(_entry.Find("center"), _center) || !ReadFloat(_entry.Find("radius"), _radius))
+            {
+                a_sError = Located(a_pContext, s, "needs a center of three numbers and a radius");
+                return false;
+            }
+
+            MaterialId _id = ReadMaterial(_entry.Find("material"), a_oNames, a_iMaterialCount);
+
+            if (_id == INVALID_MATERIAL_ID)
+            {
+                a_sError = Located(a_pContext, s, "\"material\" must be a material name or index");
+                return false;
+            }
+
+            a_oSpheres.Add(_center, _radius, _id);
+
+            const JsonValue* _velocity = _entry.Find("velocity");
+
+            if (_velocity != nullptr)
+            {
+                Vec3 _perFrame;
+
+                if (!ReadVec3(_velocity, _perFrame))
+                {
+                    a_sError = Located(a_pContext, s, "\"velocity\" takes three numbers");
+                    return false;
+                }
+
+                a_oSpheres.SetVelocity(a_oSpheres.GetCount() - 1, _perFrame);
+            }
+        }
+
+        return true;
+    }
+
+    // Either a full "matrix", or optional "scale", "rotate" and "translate" applied in that order.
+    bool ReadTransform(const JsonValue& a_oEntry, Transform& a_oTransform)
+    {
+        const JsonValue* _matrix = a_oEntry.Find("matrix");
+
+        if (_matrix != nullptr)
+        {
+            if (_matrix->GetType() != JSON_ARRAY || _matrix->GetSize() != 12)
+            {
+                return false;
+            }
+
+            for (int k = 0; k < 12; ++k)
+            {
+                if (!ReadFloat(&_matrix->GetItem(k), a_oTransform.m_fM[k / 4][k % 4]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        Vec3 _scale(1.0f, 1.0f, 1.0f);
+        Vec3 _translate(0.0f, 0.0f, 0.0f);
+
+        const JsonValue* _uniform = a_oEntry.Find("scale");
+
+        if (_uniform != nullptr && _uniform->GetType() == JSON_NUMBER)
+        {
+            _scale = Vec3(1.0f, 1.0f, 1.0f) * float(_uniform->GetNumber());
+        }
+        else if (!ReadOptionalVec3(a_oEntry, "scale", _scale))
+        {
+            return false;
+        }
+
+        if (!ReadOptionalVec3(a_oEntry, "translate", _translate))
+        {
+            return false;
+        }
+
+        Transform _rotation;
+
+        const JsonValue* _rotate = a_oEntry.Find("rotate");
+
+        if (_rotate != nullptr)
+        {
+            float _axisAngle[4];
+
+            if (_rotate->GetType() != JSON_ARRAY || _rotate->GetSize() != 4)
+            {
+                return false;
+            }
+
+            for (int k = 0; k < 4; ++k)
+            {
+                if (!ReadFloat(&_rotate->GetItem(k), _axisAngle[k]))
+                {
+                    return false;
+                }
+            }
+
+            _rotation = Transform::Rotate(Vec3(_axisAngle[0], _axisAngle[1], _axisAngle[2]), _axisAngle[3]);
+        }
+
+        a_oTransform = Transform::Translate(_translate) * _rotation * Transform::Scale(_scale);
+
+        return true;
+    }
+
+    // Relative mesh paths are taken from the directory of the scene file that names them.
+    std::string ResolvePath(const std::string& a_sScenePath, const std::string& a_sPath)
+    {
+        bool _absolute = (!a_sPath.empty() && (a_sPath[0] == '/' || a_sPath[0] == '\\')) || (a_sPath.size() > 1 && a_sPath[1] == ':');
+
+        size_t _slash = a_sScenePath.find_last_of("/\\");
+
+        if (_absolute || _slash == std::string::npos)
+        {
+            return a_sPath;
+        }
+
+        return a_sScenePath.substr(0, _slash + 1) + a_sPath;
+    }
+
+    // Inline geometry: "vertices" as flat x, y, z triples and "triangles" as flat index triples.
+    bool ReadInlineMesh(const JsonValue& a_oEntry, TriangleMesh& a_oMesh, std::string& a_sError)
+    {
+        const JsonValue* _vertices = a_oEntry.Find("vertices");
+        const JsonValue* _triangles = a_oEntry.Find("triangles");
+
+        if (_vertices == nullptr || _vertices->GetType() != JSON_ARRAY || _vertices->GetSize() % 3 != 0
+            || _triangles == nullptr || _triangles->GetType() != JSON_ARRAY || _triangles->GetSize() % 3 != 0)
+        {
+            a_sError = "\"vertices\" and \"triangles\" must be arrays of number triples";
+            return false;
+        }
+
+        int _vertexCount = _vertices->GetSize() / 3;
+
+        a_oMesh.ReserveVertices(_vertexCount);
+        a_oMesh.ReserveTriangles(_triangles->GetSize() / 3);
+
+        for (int v = 0; v < _vertexCount; ++v)
+        {
+            Vec3 _position;
+
+            for (int a = 0; a < 3; ++a)
+            {
+                if (!ReadFloat(&_vertices->GetItem(3 * v + a), _position[a]))
+                {
+                    a_sError = Located("vertices", 3 * v + a, "not a number");
+                    return false;
+                }
+            }
+
+            a_oMesh.AddVertex(_position);
+        }
+
+        for (int t = 0; t < _triangles->GetSize(); t += 3)
+        {
+            uint32_t _corners[3];
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const JsonValue& _index = _triangles->GetItem(t + k);
+
+                if (_index.GetType() != JSON_NUMBER || _index.GetNumber() < 0.0 || _index.GetNumber() >= _vertexCount || _index.GetNumber() != floor(_index.GetNumber()))
+                {
+                    a_sError = Located("triangles", t + k, "must be a vertex index");
+                    return false;
+                }
+
+                _corners[k] = uint32_t(_index.GetNumber());
+            }
+
+            a_oMesh.AddTriangle(_corners[0], _corners[1], _corners[2]);
+        }
+
+        return true;
+    }
+
+    void WriteSpheres(std::ostream& a_oOut, const SphereSoA& a_oSpheres, const char* a_pIndent)
+    {
+        for (int s = 0; s < a_oSpheres.GetCount(); ++s)
+        {
+            a_oOut << a_pIndent << "{ \"center\": [" << a_oSpheres.m_pCenterX[s] << ", " << a_oSpheres.m_pCenterY[s] << ", " << a_oSpheres.m_pCenterZ[s] << "], "
+                   << "\"radius\": " << a_oSpheres.m_pRadius[s] << ", \"material\": " << a_oSpheres.m_pMaterialId[s];
+
+            Vec3 _velocity = a_oSpheres.GetVelocity(s);
+
+            if (_velocity[0] != 0.0f || _velocity[1] != 0.0f || _velocity[2] != 0.0f)
+            {
+                a_oOut << ", \"velocity\": [" << _velocity[0] << ", " << _velocity[1] << ", " << _velocity[2] << "]";
+            }
+
+            a_oOut << " }" << (s + 1 < a_oSpheres.GetCount() ? "," : "") << "\n";
+        }
+    }
+
+    // The members after "name"; file-backed meshes are written as their file name again.
+    void WriteMesh(std::ostream& a_oOut, const TriangleMesh& a_oMesh, const std::string& a_sMeshPath)
+    {
+        a_oOut << "\"material\": " << a_oMesh.GetMaterialId();
+
+        if (a_oMesh.IsQuantized())
+        {
+            a_oOut << ", \"quantize\": true";
+        }
+
+        if (!a_sMeshPath.empty())
+        {
+            a_oOut << ", \"mesh\": \"" << a_sMeshPath << "\"";
+            return;
+        }
+
+        a_oOut << ",\n      \"vertices\": [";
+
+        for (int v = 0; v < a_oMesh.GetVertexCount(); ++v)
+        {
+            Vec3 _position = a_oMesh.GetVertex(v);
+
+            a_oOut << (v > 0 ? ", " : "") << _position[0] << ", " << _position[1] << ", " << _position[2];
+        }
+
+        a_oOut << "],\n      \"triangles\": [";
+
+        for (int t = 0; t < a_oMesh.GetTriangleCount(); ++t)
+        {
+            const uint32_t* _corners = a_oMesh.GetTriangle(t);
+
+            a_oOut << (t > 0 ? ", " : "") << _corners[0] << ", " << _corners[1] << ", " << _corners[2];
+        }
+
+        a_oOut << "]";
+    }
+
+    bool WriteSection(FILE* a_pFile, uint64_t& a_uPosition, uint64_t a_uOffset, const void* a_pData, size_t a_uBytes)
+    {
+        static const char s_cZeros[s_cuSectionAlignment] = {};
+
+        while (a_uPosition < a_uOffset)
+        {
+            size_t _gap = static_cast<size_t>(std::min<uint64_t>(a_uOffset - a_uPosition, s_cuSectionAlignment));
+
+            if (fwrite(s_cZeros, 1, _gap, a_pFile) != _gap)
+            {
+                return false;
+            }
+
+            a_uPosition += _gap;
+        }
+
+        if (a_uBytes > 0 && fwrite(a_pData, 1, a_uBytes, a_pFile) != a_uBytes)
+        {
+            return false;
+        }
+
+        a_uPosition += a_uBytes;
+
+        return true;
+    }
+}
+
+SceneCamera::SceneCamera() : m_oLookFrom(13.0f, 2.0f, 3.0f),
+                             m_oLookAt(0.0f, 0.0f, 0.0f),
+                             m_oUp(0.0f, 1.0f, 0.0f),
+                             m_fFov(20.0f),
+                             m_fAperture(0.1f),
+                             m_fFocusDist(10.0f),
+                             m_fShutter(0.0f),
+                             m_fOrbit(0.0f)
+{
+}
+
+Camera SceneCamera::Build(float a_fAspect, int a_iFrame) const
+{
+    Vec3 _lookFrom = this->m_oLookFrom;
+
+    if (this->m_fOrbit != 0.0f && a_iFrame != 0)
+    {
+        Transform _orbit = Transform::Rotate(this->m_oUp, this->m_fOrbit * float(a_iFrame));
+
+        _lookFrom = this->m_oLookAt + _orbit.Vector(this->m_oLookFrom - this->m_oLookAt);
+    }
+
+    Camera _camera(_lookFrom, this->m_oLookAt, this->m_oUp, this->m_fFov, a_fAspect, this->m_fAperture, this->m_fFocusDist);
+
+    _camera.SetShutter(float(a_iFrame), float(a_iFrame) + this->m_fShutter);
+
+    return _camera;
+}
+
+Scene::Scene() : m_bLightsBuilt(false),
+                 m_iFrame(0),
+                 m_dLoadTimeMs(0.0),
+                 m_dTopLevelBuildTimeMs(0.0),
+                 m_dRefitTimeMs(0.0),
+                 m_iRebuildCount(0)
+{
+}
+
+void Scene::Reset()
+{
+    // The top level points into the instances and BVHs, and those into the cache.
+    this->m_pTopLevel.reset();
+    this->m_oInstances.clear();
+    this->m_oInstanceDescs.clear();
+    this->m_oObjects.clear();
+
+    this->m_pBvh.reset();
+    this->m_oSpheres.Clear();
+    this->m_oCache.Close();
+
+    this->m_oMaterials.Clear();
+    this->m_oCamera = SceneCamera();
+
+    this->m_oLights.Clear();
+    this->m_oLights.ClearBackground();
+    this->m_bLightsBuilt = false;
+
+    this->m_iFrame = 0;
+
+    this->m_dLoadTimeMs = 0.0;
+    this->m_dTopLevelBuildTimeMs = 0.0;
+    this->m_dRefitTimeMs = 0.0;
+    this->m_iRebuildCount = 0;
+}
+
+int Scene::SetSpheres(const HittableList &a_oList, const MaterialTable &a_oMaterials)
+{
+    this->Reset();
+
+    this->m_oMaterials = a_oMaterials;
+
+    this->m_oSpheres.Reserve(a_oList.m_iListSize);
+
+    for (int i = 0; i < a_oList.m_iListSize; ++i)
+    {
+        const Sphere* _sphere = dynamic_cast<const Sphere*>(a_oList.m_oList[i]);
+
+        if (_sphere != nullptr)
+        {
+            this->m_oSpheres.Add(_sphere->m_oCenter, _sphere->m_fRadius, _sphere->m_uMaterialId);
+        }
+    }
+
+    return this->m_oSpheres.GetCount();
+}
+
+bool Scene::IsJsonPath(const std::string &a_sPath)
+{
+    size_t _dot = a_sPath.find_last_of('.');
+
+    if (_dot == std::string::npos)
+    {
+        return false;
+    }
+
+    std::string _extension = a_sPath.substr(_dot + 1);
+
+    for (size_t i = 0; i < _extension.size(); ++i)
+    {
+        _extension[i] = static_cast<char>(tolower(static_cast<unsigned char>(_extension[i])));
+    }
+
+    return _extension == "json";
+}
+
+bool Scene::Load(const std::string &a_sPath, std::string &a_sError)
+{
+    return IsJsonPath(a_sPath) ? this->LoadJson(a_sPath, a_sError) : this->LoadCache(a_sPath, a_sError);
+}
+
+bool Scene::Save(const std::string &a_sPath)
+{
+    return IsJsonPath(a_sPath) ? this->SaveJson(a_sPath) : this->SaveCache(a_sPath);
+}
+
+bool Scene::LoadJson(const std::string &a_sPath, std::string &a_sError)
+{
+    RT_TRACE_SPAN("scene parse");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    this->Reset();
+
+    std::string _text;
+
+    if (!ReadText(a_sPath, _text))
+    {
+        a_sError = "cannot read " + a_sPath;
+        return false;
+    }
+
+    JsonValue _root;
+
+    if (!JsonValue::Parse(_text, _root, a_sError))
+    {
+        return false;
+    }
+
+    if (_root.GetType() != JSON_OBJECT)
+    {
+        a_sError = "the document must be an object";
+        return false;
+    }
+
+    const JsonValue* _camera = _root.Find("camera");
+
+    if (_camera != nullptr)
+    {
+        bool _ok = _camera->GetType() == JSON_OBJECT
+                   && ReadOptionalVec3(*_camera, "look_from", this->m_oCamera.m_oLookFrom)
+                   && ReadOptionalVec3(*_camera, "look_at", this->m_oCamera.m_oLookAt)
+                   && ReadOptionalVec3(*_camera, "up", this->m_oCamera.m_oUp)
+                   && ReadOptionalFloat(*_camera, "fov", this->m_oCamera.m_fFov)
+                   && ReadOptionalFloat(*_camera, "aperture", this->m_oCamera.m_fAperture)
+                   && ReadOptionalFloat(*_camera, "focus_distance", this->m_oCamera.m_fFocusDist)
+                   && ReadOptionalFloat(*_camera, "shutter", this->m_oCamera.m_fShutter)
+                   && ReadOptionalFloat(*_camera, "orbit", this->m_oCamera.m_fOrbit);
+
+        if (!_ok)
+        {
+            a_sError = "camera: look_from, look_at and up take three numbers; fov, aperture, focus_distance, shutter and orbit one";
+            return false;
+        }
+    }
+
+    if (_root.Find("background") != nullptr)
+    {
+        Vec3 _background;
+
+        if (!ReadOptionalVec3(_root, "background", _background))
+        {
+            a_sError = "\"background\" takes three numbers";
+            return false;
+        }
+
+        this->m_oLights.SetBackground(_background);
+    }
+
+    const JsonValue* _materials = _root.Find("materials");
+
+    if (_materials == nullptr || _materials->GetType() != JSON_ARRAY)
+    {
+        a_sError = "missing the \"materials\" array";
+        return false;
+    }
+
+    std::map<std::string, MaterialId> _names;
+
+    for (int m = 0; m < _materials->GetSize(); ++m)
+    {
+        const JsonValue& _entry = _materials->GetItem(m);
+
+        const JsonValue* _type = _entry.Find("type");
+
+        if (_type == nullptr || _type->GetType() != JSON_STRING)
+        {
+            a_sError = Located("materials", m, "missing \"type\"");
+            return false;
+        }
+
+        Vec3 _albedo(0.5f, 0.5f, 0.5f);
+        Vec3 _emission(1.0f, 1.0f, 1.0f);
+        float _fuzz = 0.0f;
+        float _ior = 1.5f;
+
+        if (!ReadOptionalVec3(_entry, "albedo", _albedo) || !ReadOptionalVec3(_entry, "emission", _emission) || !ReadOptionalFloat(_entry, "fuzz", _fuzz) || !ReadOptionalFloat(_entry, "ior", _ior))
+        {
+            a_sError = Located("materials", m, "albedo and emission take three numbers, fuzz and ior one");
+            return false;
+        }
+
+        const std::string& _typeName = _type->GetString();
+
+        if (_typeName == s_cpMaterialNames[MATERIAL_LAMBERTIAN])
+        {
+            Lambertian _material(_albedo);
+            this->m_oMaterials.Add(_material);
+        }
+        else if (_typeName == s_cpMaterialNames[MATERIAL_METAL])
+        {
+            Metal _material(_albedo, _fuzz);
+            this->m_oMaterials.Add(_material);
+        }
+        else if (_typeName == s_cpMaterialNames[MATERIAL_DIELECTRIC])
+        {
+            Dielectric _material(_ior);
+            this->m_oMaterials.Add(_material);
+        }
+        else if (_typeName == s_cpMaterialNames[MATERIAL_EMISSIVE])
+        {
+            Emissive _material(_emission);
+            this->m_oMaterials.Add(_material);
+        }
+        else
+        {
+            a_sError = Located("materials", m, "unknown type '" + _typeName + "', expected lambertian, metal, dielectric or emissive");
+            return false;
+        }
+
+        const JsonValue* _name = _entry.Find("name");
+
+        if (_name != nullptr && _name->GetType() == JSON_STRING)
+        {
+            _names.insert(std::make_pair(_name->GetString(), MaterialId(m)));
+        }
+    }
+
+    const JsonValue* _spheres = _root.Find("spheres");
+    const JsonValue* _objects = _root.Find("objects");
+    const JsonValue* _instances = _root.Find("instances");
+
+    if (_spheres == nullptr && _instances == nullptr)
+    {
+        a_sError = "missing the \"spheres\" or \"instances\" array";
+        return false;
+    }
+
+    if (_spheres != nullptr && !ReadSpheres(*_spheres, "spheres", _names, this->m_oMaterials.GetCount(), this->m_oSpheres, a_sError))
+    {
+        return false;
+    }
+
+    if (_objects != nullptr && _objects->GetType() != JSON_ARRAY)
+    {
+        a_sError = "\"objects\" must be an array";
+        return false;
+    }
+
+    std::map<std::string, int> _objectNames;
+
+    for (int o = 0; _objects != nullptr && o < _objects->GetSize(); ++o)
+    {
+        const JsonValue& _entry = _objects->GetItem(o);
+
+        const JsonValue* _objectSpheres = _entry.Find("spheres");
+        const JsonValue* _meshPath = _entry.Find("mesh");
+
+        const JsonValue* _name = _entry.Find("name");
+
+        std::string _objectName = (_name != nullptr && _name->GetType() == JSON_STRING) ? _name->GetString() : std::string();
+
+        int _index = -1;
+
+        if (_objectSpheres != nullptr)
+        {
+            SphereSoA _shape;
+
+            if (!ReadSpheres(*_objectSpheres, Located("objects", o, "spheres").c_str(), _names, this->m_oMaterials.GetCount(), _shape, a_sError))
+            {
+                return false;
+            }
+
+            _index = this->AddObject(_objectName, _shape);
+        }
+        else if (_meshPath != nullptr || _entry.Find("vertices") != nullptr)
+        {
+            MaterialId _material = ReadMaterial(_entry.Find("material"), _names, this->m_oMaterials.GetCount());
+
+            const JsonValue* _quantize = _entry.Find("quantize");
+
+            if (_material == INVALID_MATERIAL_ID)
+            {
+                a_sError = Located("objects", o, "\"material\" must be a material name or index");
+                return false;
+            }
+
+            if (_quantize != nullptr && _quantize->GetType() != JSON_BOOL)
+            {
+                a_sError = Located("objects", o, "\"quantize\" must be true or false");
+                return false;
+            }
+
+            // Built in place, since a loaded mesh may be far too big to copy.
+            std::unique_ptr<SceneObject> _object(new SceneObject());
+
+            _object->m_sName = _objectName;
+            _object->m_pMesh.reset(new TriangleMesh(_material));
+
+            std::string _error;
+
+            if (_meshPath != nullptr)
+            {
+                if (_meshPath->GetType() != JSON_STRING)
+                {
+                    a_sError = Located("objects", o, "\"mesh\" must be a file name");
+                    return false;
+                }
+
+                _object->m_sMeshPath = _meshPath->GetString();
+
+                if (!MeshLoader::Load(ResolvePath(a_sPath, _object->m_sMeshPath), *_object->m_pMesh, _error))
+                {
+                    a_sError = Located("objects", o, _error);
+                    return false;
+                }
+
+                _object->m_pMesh->SetMaterialId(_material);
+            }
+            else if (!ReadInlineMesh(_entry, *_object->m_pMesh, _error))
+            {
+                a_sError = Located("objects", o, _error);
+                return false;
+            }
+
+            if (_quantize != nullptr && _quantize->GetBool())
+            {
+                _object->m_pMesh->Quantize();
+            }
+
+            this->m_oObjects.push_back(std::move(_object));
+
+            _index = this->GetObjectCount() - 1;
+        }
+        else
+        {
+            a_sError = Located("objects", o, "needs \"spheres\", a \"mesh\" file or \"vertices\" and \"triangles\"");
+            return false;
+        }
+
+        if (!_objectName.empty())
+        {
+            _objectNames.insert(std::make_pair(_objectName, _index));
+        }
+    }
+
+    if (_instances != nullptr && _instances->GetType() != JSON_ARRAY)
+    {
+        a_sError = "\"instances\" must be an array";
+        return false;
+    }
+
+    for (int i = 0; _instances != nullptr && i < _instances->GetSize(); ++i)
+    {
+        const JsonValue& _entry = _instances->GetItem(i);
+
+        const JsonValue* _object = _entry.Find("object");
+
+        int _index = -1;
+
+        if (_object != nullptr && _object->GetType() == JSON_STRING)
+        {
+            std::map<std::string, int>::const_iterator _found = _objectNames.find(_object->GetString());
+
+            if (_found != _objectNames.end())
+            {
+                _index = _found->second;
+            }
+        }
+        else if (_object != nullptr && _object->GetType() == JSON_NUMBER && _object->GetNumber() >= 0.0 && _object->GetNumber() < this->GetObjectCount())
+        {
+            _index = int(_object->GetNumber());
+        }
+
+        if (_index < 0)
+        {
+            a_sError = Located("instances", i, "\"object\" must be an object name or index");
+            return false;
+        }
+
+        Transform _transform;
+
+        if (!ReadTransform(_entry, _transform))
+        {
+            a_sError = Located("instances", i, "matrix takes 12 numbers, translate three, rotate an axis and degrees, scale one or three");
+            return false;
+        }
+
+        this->AddInstance(_index, _transform);
+    }
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dLoadTimeMs = _elapsed.count();
+
+    return true;
+}
+
+bool Scene::SaveJson(const std::string &a_sPath) const
+{
+    std::ofstream _file(a_sPath.c_str(), std::ios::out | std::ios::binary);
+
+    if (!_file)
+    {
+        return false;
+    }
+
+    // Nine significant digits round-trip every float exactly.
+    _file.precision(9);
+
+    const SceneCamera& _c = this->m_oCamera;
+
+    _file << "{\n"
+          << "  \"camera\": { \"look_from\": [" << _c.m_oLookFrom[0] << ", " << _c.m_oLookFrom[1] << ", " << _c.m_oLookFrom[2] << "], "
+          << "\"look_at\": [" << _c.m_oLookAt[0] << ", " << _c.m_oLookAt[1] << ", " << _c.m_oLookAt[2] << "], "
+          << "\"up\": [" << _c.m_oUp[0] << ", " << _c.m_oUp[1] << ", " << _c.m_oUp[2] << "], "
+          << "\"fov\": " << _c.m_fFov << ", \"aperture\": " << _c.m_fAperture << ", \"focus_distance\": " << _c.m_fFocusDist;
+
+    if (_c.m_fShutter != 0.0f)
+    {
+        _file << ", \"shutter\": " << _c.m_fShutter;
+    }
+
+    if (_c.m_fOrbit != 0.0f)
+    {
+        _file << ", \"orbit\": " << _c.m_fOrbit;
+    }
+
+    _file << " },\n";
+
+    if (this->m_oLights.HasBackground())
+    {
+        const Vec3& _background = this->m_oLights.GetBackground();
+
+        _file << "  \"background\": [" << _background[0] << ", " << _background[1] << ", " << _background[2] << "],\n";
+    }
+
+    _file << "  \"materials\": [\n";
+
+    for (int m = 0; m < this->m_oMaterials.GetCount(); ++m)
+    {
+        const Material& _material = this->m_oMaterials.Get(MaterialId(m));
+
+        _file << "    { \"type\": \"" << s_cpMaterialNames[_material.m_eType] << "\"";
+
+        if (_material.m_eType == MATERIAL_DIELECTRIC)
+        {
+            _file << ", \"ior\": " << _material.m_fParameter;
+        }
+        else if (_material.m_eType == MATERIAL_EMISSIVE)
+        {
+            _file << ", \"emission\": [" << _material.m_oAlbedo[0] << ", " << _material.m_oAlbedo[1] << ", " << _material.m_oAlbedo[2] << "]";
+        }
+        else
+        {
+            _file << ", \"albedo\": [" << _material.m_oAlbedo[0] << ", " << _material.m_oAlbedo[1] << ", " << _material.m_oAlbedo[2] << "]";
+
+            if (_material.m_eType == MATERIAL_METAL)
+            {
+                _file << ", \"fuzz\": " << _material.m_fParameter;
+            }
+        }
+
+        _file << " }" << (m + 1 < this->m_oMaterials.GetCount() ? "," : "") << "\n";
+    }
+
+    _file << "  ],\n"
+          << "  \"spheres\": [\n";
+
+    WriteSpheres(_file, this->m_oSpheres, "    ");
+
+    _file << "  ]";
+
+    if (!this->m_oObjects.empty())
+    {
+        _file << ",\n  \"objects\": [\n";
+
+        for (size_t o = 0; o < this->m_oObjects.size(); ++o)
+        {
+            const SceneObject& _object = *this->m_oObjects[o];
+
+            _file << "    { \"name\": \"" << _object.m_sName << "\", ";
+
+            if (_object.m_pMesh)
+            {
+                WriteMesh(_file, *_object.m_pMesh, _object.m_sMeshPath);
+
+                _file << " }";
+            }
+            else
+            {
+                _file << "\"spheres\": [\n";
+
+                WriteSpheres(_file, _object.m_oSpheres, "      ");
+
+                _file << "    ] }";
+            }
+
+            _file << (o + 1 < this->m_oObjects.size() ? "," : "") << "\n";
+        }
+
+        _file << "  ]";
+    }
+
+    if (!this->m_oInstanceDescs.empty())
+    {
+        _file << ",\n  \"instances\": [\n";
+
+        for (size_t i = 0; i < this->m_oInstanceDescs.size(); ++i)
+        {
+            const float (&m)[3][4] = this->m_oInstanceDescs[i].m_oObjectToWorld.m_fM;
+
+            _file << "    { \"object\": " << this->m_oInstanceDescs[i].m_iObject << ", \"matrix\": [";
+
+            for (int k = 0; k < 12; ++k)
+            {
+                _file << (k > 0 ? ", " : "") << m[k / 4][k % 4];
+            }
+
+            _file << "] }" << (i + 1 < this->m_oInstanceDescs.size() ? "," : "") << "\n";
+        }
+
+        _file << "  ]";
+    }
+
+    _file << "\n}\n";
+
+    return static_cast<bool>(_file.flush());
+}
+
+bool Scene::LoadCache(const std::string &a_sPath, std::string &a_sError)
+{
+    RT_TRACE_SPAN("scene cache load");
+
+    std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+    this->Reset();
+
+    if (!this->m_oCache.Open(a_sPath))
+    {
+        a_sError = "cannot map " + a_sPath;
+        return false;
+    }
+
+    char* _data = this->m_oCache.GetData();
+    uint64_t _size = this->m_oCache.GetSize();
+
+    CacheHeader _header;
+
+    memset(&_header, 0, sizeof(_header));
+
+    bool _ok = _size >= sizeof(_header);
+
+    if (_ok)
+    {
+        memcpy(&_header, _data, sizeof(_header));
+    }
+
+    _ok = _ok && memcmp(_header.m_cMagic, s_ccMagic, sizeof(s_ccMagic)) == 0
+              && _header.m_iVersion == s_ciVersion
+              && _header.m_iSphereCount >= 0
+              && _header.m_iMaterialCount >= 0
+              && _header.m_iNodeCount >= 0
+              && _header.m_iPadding >= SphereSoA::PADDING;
+
+    if (!_ok)
+    {
+        this->m_oCache.Close();
+        a_sError = a_sPath + " is not a version " + std::to_string(s_ciVersion) + " scene cache";
+        return false;
+    }
+
+    uint64_t _lanes = uint64_t(_header.m_iSphereCount) + _header.m_iPadding;
+
+    uint64_t _bytes[CACHE_SECTION_COUNT];
+
+    _bytes[CACHE_SECTION_CENTER_X] = _lanes * sizeof(float);
+    _bytes[CACHE_SECTION_CENTER_Y] = _lanes * sizeof(float);
+    _bytes[CACHE_SECTION_CENTER_Z] = _lanes * sizeof(float);
+    _bytes[CACHE_SECTION_RADIUS] = _lanes * sizeof(float);
+    _bytes[CACHE_SECTION_MATERIAL_ID] = _lanes * sizeof(MaterialId);
+    _bytes[CACHE_SECTION_MATERIALS] = uint64_t(_header.m_iMaterialCount) * sizeof(CacheMaterial);
+    _bytes[CACHE_SECTION_NODES] = uint64_t(_header.m_iNodeCount) * sizeof(BvhNode);
+
+    for (int k = 0; k < CACHE_SECTION_COUNT; ++k)
+    {
+        uint64_t _offset = _header.m_uOffsets[k];
+
+        _ok = _ok && _offset % s_cuSectionAlignment == 0 && _offset <= _size && _bytes[k] <= _size - _offset;
+    }
+
+    const MaterialId* _ids = reinterpret_cast<const MaterialId*>(_data + _header.m_uOffsets[CACHE_SECTION_MATERIAL_ID]);
+
+    for (int s = 0; _ok && s < _header.m_iSphereCount; ++s)
+    {
+        _ok = _ids[s] < MaterialId(_header.m_iMaterialCount);
+    }
+
+    const CacheMaterial* _materials = reinterpret_cast<const CacheMaterial*>(_data + _header.m_uOffsets[CACHE_SECTION_MATERIALS]);
+
+    for (int m = 0; _ok && m < _header.m_iMaterialCount; ++m)
+    {
+        _ok = _materials[m].m_iType >= 0 && _materials[m].m_iType < MATERIAL_TYPE_COUNT;
+    }
+
+    // Children must follow their parent and leaves must stay inside the sphere arrays, so
+    // a damaged file cannot send the traversal out of bounds or overflow its stack.
+    const BvhNode* _nodes = reinterpret_cast<const BvhNode*>(_data + _header.m_uOffsets[CACHE_SECTION_NODES]);
+
+    std::vector<uint8_t> _depth(_ok ? _header.m_iNodeCount : 0, 0);
+
+    for (int n = 0; _ok && n < _header.m_iNodeCount; ++n)
+    {
+        const BvhNode& _node = _nodes[n];
+
+        if (_node.m_uCount > 0)
+        {
+            _ok = uint64_t(_node.m_uOffset) + _node.m_uCount <= uint64_t(_header.m_iSphereCount);
+            continue;
+        }
+
+        _ok = _depth[n] + 1 < BvhBuilder::MAX_DEPTH && n + 1 < _header.m_iNodeCount && _node.m_uOffset > uint32_t(n + 1) && _node.m_uOffset < uint32_t(_header.m_iNodeCount) && _node.m_uAxis < 3;
+
+        if (_ok)
+        {
+            _depth[n + 1] = std::max<uint8_t>(_depth[n + 1], _depth[n] + 1);
+            _depth[_node.m_uOffset] = std::max<uint8_t>(_depth[_node.m_uOffset], _depth[n] + 1);
+        }
+    }
+
+    if (!_ok)
+    {
+        this->m_oCache.Close();
+        a_sError = a_sPath + " is truncated or damaged";
+        return false;
+    }
+
+    for (int m = 0; m < _header.m_iMaterialCount; ++m)
+    {
+        Material _material(MaterialType(_materials[m].m_iType), Vec3(_materials[m].m_fAlbedo[0], _materials[m].m_fAlbedo[1], _materials[m].m_fAlbedo[2]), _materials[m].m_fParameter);
+
+        this->m_oMaterials.Add(_material);
+    }
+
+    const CacheCamera& _camera = _header.m_oCamera;
+
+    this->m_oCamera.m_oLookFrom = Vec3(_camera.m_fLookFrom[0], _camera.m_fLookFrom[1], _camera.m_fLookFrom[2]);
+    this->m_oCamera.m_oLookAt = Vec3(_camera.m_fLookAt[0], _camera.m_fLookAt[1], _camera.m_fLookAt[2]);
+    this->m_oCamera.m_oUp = Vec3(_camera.m_fUp[0], _camera.m_fUp[1], _camera.m_fUp[2]);
+    this->m_oCamera.m_fFov = _camera.m_fFov;
+    this->m_oCamera.m_fAperture = _camera.m_fAperture;
+    this->m_oCamera.m_fFocusDist = _camera.m_fFocusDist;
+    this->m_oCamera.m_fShutter = _camera.m_fShutter;
+    this->m_oCamera.m_fOrbit = _camera.m_fOrbit;
+
+    if (_header.m_iBackground != 0)
+    {
+        this->m_oLights.SetBackground(Vec3(_header.m_fBackground[0], _header.m_fBackground[1], _header.m_fBackground[2]));
+    }
+
+    this->m_oSpheres.Attach(reinterpret_cast<float*>(_data + _header.m_uOffsets[CACHE_SECTION_CENTER_X]),
+                            reinterpret_cast<float*>(_data + _header.m_uOffsets[CACHE_SECTION_CENTER_Y]),
+                            reinterpret_cast<float*>(_data + _header.m_uOffsets[CACHE_SECTION_CENTER_Z]),
+                            reinterpret_cast<float*>(_data + _header.m_uOffsets[CACHE_SECTION_RADIUS]),
+                            reinterpret_cast<MaterialId*>(_data + _header.m_uOffsets[CACHE_SECTION_MATERIAL_ID]),
+                            _header.m_iSphereCount);
+
+    if (_header.m_iNodeCount > 0)
+    {
+        this->m_pBvh.reset(new Bvh(_nodes, _header.m_iNodeCount, this->m_oSpheres));
+    }
+
+    std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+    this->m_dLoadTimeMs = _elapsed.count();
+
+    return true;
+}
+
+bool Scene::SaveCache(const std::string &a_sPath, bool a_bWithBvh)
+{
+    if (!this->m_oObjects.empty() || !this->m_oInstanceDescs.empty() || this->HasMotion())
+    {
+        return false;
+    }
+
+    const SphereSoA* _spheres = &this->m_oSpheres;
+
+    const BvhNode* _nodes = nullptr;
+
+    int _nodeCount = 0;
+
+    if (a_bWithBvh && this->m_oSpheres.GetCount() > 0)
+    {
+        const Bvh& _bvh = this->PrepareBvh();
+
+        _spheres = _bvh.GetSpheres();
+        _nodes = _bvh.GetNodes();
+        _nodeCount = _bvh.GetNodeCount();
+    }
+
+    int _count = _spheres->GetCount();
+
+    CacheHeader _header;
+
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.m_cMagic, s_ccMagic, sizeof(s_ccMagic));
+
+    _header.m_iVersion = s_ciVersion;
+    _header.m_iSphereCount = _count;
+    _header.m_iMaterialCount = this->m_oMaterials.GetCount();
+    _header.m_iNodeCount = _nodeCount;
+    _header.m_iPadding = SphereSoA::PADDING;
+
+    const SceneCamera& _camera = this->m_oCamera;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        _header.m_oCamera.m_fLookFrom[a] = _camera.m_oLookFrom[a];
+        _header.m_oCamera.m_fLookAt[a] = _camera.m_oLookAt[a];
+        _header.m_oCamera.m_fUp[a] = _camera.m_oUp[a];
+    }
+
+    _header.m_oCamera.m_fFov = _camera.m_fFov;
+    _header.m_oCamera.m_fAperture = _camera.m_fAperture;
+    _header.m_oCamera.m_fFocusDist = _camera.m_fFocusDist;
+    _header.m_oCamera.m_fShutter = _camera.m_fShutter;
+    _header.m_oCamera.m_fOrbit = _camera.m_fOrbit;
+
+    _header.m_iBackground = this->m_oLights.HasBackground();
+
+    for (int a = 0; a < 3; ++a)
+    {
+        _header.m_fBackground[a] = this->m_oLights.GetBackground()[a];
+    }
+
+    std::vector<CacheMaterial> _materials(this->m_oMaterials.GetCount());
+
+    for (int m = 0; m < this->m_oMaterials.GetCount(); ++m)
+    {
+        const Material& _material = this->m_oMaterials.Get(MaterialId(m));
+
+        _materials[m].m_iType = _material.m_eType;
+        _materials[m].m_fAlbedo[0] = _material.m_oAlbedo[0];
+        _materials[m].m_fAlbedo[1] = _material.m_oAlbedo[1];
+        _materials[m].m_fAlbedo[2] = _material.m_oAlbedo[2];
+        _materials[m].m_fParameter = _material.m_fParameter;
+    }
+
+    // Written explicitly, since an empty SoA may have no arrays at all.
+    std::vector<float> _nanPadding(SphereSoA::PADDING, std::numeric_limits<float>::quiet_NaN());
+    std::vector<MaterialId> _idPadding(SphereSoA::PADDING, 0u);
+
+    const void* _sections[CACHE_SECTION_COUNT] = { _spheres->m_pCenterX, _spheres->m_pCenterY, _spheres->m_pCenterZ, _spheres->m_pRadius, _spheres->m_pMaterialId, _materials.empty() ? nullptr : &_materials[0], _nodes };
+
+    size_t _bytes[CACHE_SECTION_COUNT] = { _count * sizeof(float), _count * sizeof(float), _count * sizeof(float), _count * sizeof(float), _count * sizeof(MaterialId), _materials.size() * sizeof(CacheMaterial), _nodeCount * sizeof(BvhNode) };
+
+    uint64_t _offset = sizeof(_header);
+
+    for (int k = 0; k < CACHE_SECTION_COUNT; ++k)
+    {
+        _offset = AlignSection(_offset);
+
+        _header.m_uOffsets[k] = _offset;
+
+        _offset += _bytes[k] + (k <= CACHE_SECTION_MATERIAL_ID ? SphereSoA::PADDING * sizeof(float) : 0);
+    }
+
+    std::string _temporary = a_sPath + ".tmp";
+
+    FILE* _file = fopen(_temporary.c_str(), "wb");
+
+    if (_file == nullptr)
+    {
+        return false;
+    }
+
+    uint64_t _position = 0;
+
+    bool _ok = WriteSection(_file, _position, 0, &_header, sizeof(_header));
+
+    for (int k = 0; _ok && k < CACHE_SECTION_COUNT; ++k)
+    {
+        _ok = WriteSection(_file, _position, _header.m_uOffsets[k], _sections[k], _bytes[k]);
+
+        if (k < CACHE_SECTION_MATERIAL_ID)
+        {
+            _ok = _ok && WriteSection(_file, _position, _position, &_nanPadding[0], _nanPadding.size() * sizeof(float));
+        }
+        else if (k == CACHE_SECTION_MATERIAL_ID)
+        {
+            _ok = _ok && WriteSection(_file, _position, _position, &_idPadding[0], _idPadding.size() * sizeof(MaterialId));
+        }
+    }
+
+    _ok = (fclose(_file) == 0) && _ok;
+
+    if (!_ok)
+    {
+        remove(_temporary.c_str());
+        return false;
+    }
+
+    // rename() does not replace an existing file on Windows.
+    if (rename(_temporary.c_str(), a_sPath.c_str()) != 0)
+    {
+        remove(a_sPath.c_str());
+
+        return rename(_temporary.c_str(), a_sPath.c_str()) == 0;
+    }
+
+    return true;
+}
+
+const Bvh& Scene::PrepareBvh(int a_iMaxLeafSize)
+{
+    if (!this->m_pBvh)
+    {
+        float _begin;
+        float _end;
+
+        this->GetShutterInterval(_begin, _end);
+
+        this->m_pBvh.reset(new Bvh(this->m_oSpheres, a_iMaxLeafSize, _begin, _end));
+    }
+
+    return *this->m_pBvh;
+}
+
+const Bvh* Scene::GetBvh() const
+{
+    return this->m_pBvh.get();
+}
+
+int Scene::AddObject(const std::string &a_sName, const SphereSoA &a_oSpheres)
+{
+    std::unique_ptr<SceneObject> _object(new SceneObject());
+
+    _object->m_sName = a_sName;
+    _object->m_oSpheres = a_oSpheres;
+
+    this->m_oObjects.push_back(std::move(_object));
+
+    return static_cast<int>(this->m_oObjects.size()) - 1;
+}
+
+int Scene::AddObject(const std::string &a_sName, const TriangleMesh &a_oMesh)
+{
+    std::unique_ptr<SceneObject> _object(new SceneObject());
+
+    _object->m_sName = a_sName;
+    _object->m_pMesh.reset(new TriangleMesh(a_oMesh));
+
+    this->m_oObjects.push_back(std::move(_object));
+
+    return static_cast<int>(this->m_oObjects.size()) - 1;
+}
+
+void Scene::AddInstance(int a_iObject, const Transform &a_oObjectToWorld)
+{
+    SceneInstance _instance;
+
+    _instance.m_iObject = a_iObject;
+    _instance.m_oObjectToWorld = a_oObjectToWorld;
+
+    this->m_oInstanceDescs.push_back(_instance);
+
+    // Instances are built as a whole, so a new one invalidates the world.
+    this->m_pTopLevel.reset();
+    this->m_oInstances.clear();
+}
+
+void Scene::SetInstanceTransform(int a_iInstance, const Transform &a_oObjectToWorld)
+{
+    this->m_oInstanceDescs[a_iInstance].m_oObjectToWorld = a_oObjectToWorld;
+
+    if (a_iInstance < static_cast<int>(this->m_oInstances.size()))
+    {
+        this->m_oInstances[a_iInstance].SetTransform(a_oObjectToWorld);
+    }
+}
+
+const Bvh& Scene::PrepareWorld()
+{
+    if (this->m_oInstanceDescs.empty())
+    {
+        // Built over the current frame's shutter, so moving spheres need no refit yet.
+        const Bvh& _bvh = this->PrepareBvh();
+
+        if (!this->m_bLightsBuilt)
+        {
+            this->BuildLights();
+        }
+
+        return _bvh;
+    }
+
+    if (this->m_pTopLevel)
+    {
+        return *this->m_pTopLevel;
+    }
+
+    {
+        RT_TRACE_SPAN("blas build");
+
+        float _begin;
+        float _end;
+
+        this->GetShutterInterval(_begin, _end);
+
+        for (size_t o = 0; o < this->m_oObjects.size(); ++o)
+        {
+            SceneObject& _object = *this->m_oObjects[o];
+
+            if (!_object.m_pBvh)
+            {
+                _object.m_pBvh.reset(_object.m_pMesh ? new Bvh(*_object.m_pMesh) : new Bvh(_object.m_oSpheres, 0, _begin, _end));
+            }
+        }
+
+        if (this->m_oSpheres.GetCount() > 0)
+        {
+            this->PrepareBvh();
+        }
+    }
+
+    this->m_oInstances.clear();
+    this->m_oInstances.reserve(this->m_oInstanceDescs.size());
+
+    for (size_t i = 0; i < this->m_oInstanceDescs.size(); ++i)
+    {
+        const SceneInstance& _desc = this->m_oInstanceDescs[i];
+
+        this->m_oInstances.push_back(Instance(this->m_oObjects[_desc.m_iObject]->m_pBvh.get(), _desc.m_oObjectToWorld));
+    }
+
+    this->RebuildTopLevel();
+
+    return *this->m_pTopLevel;
+}
+
+const Bvh& Scene::SetFrame(int a_iFrame)
+{
+    bool _changed = a_iFrame != this->m_iFrame;
+
+    this->m_iFrame = a_iFrame;
+
+    bool _built = this->m_pTopLevel || (this->m_oInstanceDescs.empty() && this->m_pBvh);
+
+    const Bvh& _world = this->PrepareWorld();
+
+    // A fresh build is already bounded for this frame.
+    if (_built && _changed && this->HasMotion())
+    {
+        this->RefitWorld();
+    }
+
+    return _world;
+}
+
+int Scene::GetFrame() const
+{
+    return this->m_iFrame;
+}
+
+bool Scene::HasMotion() const
+{
+    if (this->m_oSpheres.HasMotion())
+    {
+        return true;
+    }
+
+    for (size_t o = 0; o < this->m_oObjects.size(); ++o)
+    {
+        if (this->m_oObjects[o]->m_oSpheres.HasMotion())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+double Scene::GetRefitTimeMs() const
+{
+    return this->m_dRefitTimeMs;
+}
+
+int Scene::GetRebuildCount() const
+{
+    return this->m_iRebuildCount;
+}
+
+void Scene::GetShutterInterval(float &a_fBegin, float &a_fEnd) const
+{
+    a_fBegin = float(this->m_iFrame);
+    a_fEnd = a_fBegin + this->m_oCamera.m_fShutter;
+}
+
+void Scene::RefitWorld()
+{
+    RT_TRACE_SPAN("world refit");
+
+    float _begin;
+    float _end;
+
+    this->GetShutterInterval(_begin, _end);
+
+    double _ms = 0.0;
+
+    int _rebuilt = 0;
+
+    // Every BVH keeps its topology while that stays cheap to trace and is rebuilt once
+    // the motion has spoiled it; a rebuild's time counts towards the frame's refit.
+    if (this->m_pBvh && this->m_oSpheres.HasMotion())
+    {
+        if (this->m_pBvh->RefitOrRebuild(_begin, _end))
+        {
+            _ms += this->m_pBvh->GetBuildTimeMs();
+            ++_rebuilt;
+        }
+
+        _ms += this->m_pBvh->GetRefitTimeMs();
+    }
+
+    if (this->m_pTopLevel)
+    {
+        for (size_t o = 0; o < this->m_oObjects.size(); ++o)
+        {
+            SceneObject& _object = *this->m_oObjects[o];
+
+            if (_object.m_oSpheres.HasMotion())
+            {
+                if (_object.m_pBvh->RefitOrRebuild(_begin, _end))
+                {
+                    _ms += _object.m_pBvh->GetBuildTimeMs();
+                    ++_rebuilt;
+                }
+
+                _ms += _object.m_pBvh->GetRefitTimeMs();
+            }
+        }
+
+        std::chrono::high_resolution_clock::time_point _start = std::chrono::high_resolution_clock::now();
+
+        for (size_t i = 0; i < this->m_oInstances.size(); ++i)
+        {
+            if (this->m_oObjects[this->m_oInstanceDescs[i].m_iObject]->m_oSpheres.HasMotion())
+            {
+                this->m_oInstances[i].UpdateBounds();
+            }
+        }
+
+        std::chrono::duration<double, std::milli> _elapsed = std::chrono::high_resolution_clock::now() - _start;
+
+        if (this->m_pTopLevel->RefitOrRebuild())
+        {
+            _ms += this->m_pTopLevel->GetBuildTimeMs();
+            ++_rebuilt;
+        }
+
+        _ms += _elapsed.count() + this->m_pTopLevel->GetRefitTimeMs();
+    }
+
+    this->m_dRefitTimeMs = _ms;
+    this->m_iRebuildCount = _rebuilt;
+}
+
+const Bvh& Scene::RebuildTopLevel()
+{
+    RT_TRACE_SPAN("tlas build");
+
+    // The loose spheres enter the top level as one more leaf, untransformed.
+    std::vector<Hittable*> _entries;
+
+    _entries.reserve(this->m_oInstances.size() + 1);
+
+    if (this->m_pBvh)
+    {
+        _entries.push_back(this->m_pBvh.get());
+    }
+
+    for (size_t i = 0; i < this->m_oInstances.size(); ++i)
+    {
+        _entries.push_back(&this->m_oInstances[i]);
+    }
+
+    HittableList _list(_entries.empty() ? nullptr : &_entries[0], static_cast<int>(_entries.size()));
+
+    this->m_pTopLevel.reset(new Bvh(_list));
+
+    this->m_dTopLevelBuildTimeMs = this->m_pTopLevel->GetBuildTimeMs();
+
+    this->BuildLights();
+
+    return *this->m_pTopLevel;
+}
+
+const LightList& Scene::GetLights() const
+{
+    return this->m_oLights;
+}
+
+void Scene::BuildLights()
+{
+    RT_TRACE_SPAN("light build");
+
+    this->m_oLights.Clear();
+
+    AddSphereLights(this->m_oSpheres, Transform(), this->m_oMaterials, this->m_oLights);
+
+    for (size_t i = 0; i < this->m_oInstanceDescs.size(); ++i)
+    {
+        const SceneInstance& _desc = this->m_oInstanceDescs[i];
+
+        const SceneObject& _object = *this->m_oObjects[_desc.m_iObject];
+
+        if (!_object.m_pMesh)
+        {
+            AddSphereLights(_object.m_oSpheres, _desc.m_oObjectToWorld, this->m_oMaterials, this->m_oLights);
+            continue;
+        }
+
+        const TriangleMesh& _mesh = *_object.m_pMesh;
+
+        const Material& _material = this->m_oMaterials.Get(_mesh.GetMaterialId());
+
+        if (_material.m_eType != MATERIAL_EMISSIVE)
+        {
+            continue;
+        }
+
+        const Transform& _transform = _desc.m_oObjectToWorld;
+
+        for (int t = 0; t < _mesh.GetTriangleCount(); ++t)
+        {
+            const uint32_t* _triangle = _mesh.GetTriangle(t);
+
+            this->m_oLights.AddTriangle(_transform.Point(_mesh.GetVertex(_triangle[0])), _transform.Point(_mesh.GetVertex(_triangle[1])), _transform.Point(_mesh.GetVertex(_triangle[2])), _material.m_oAlbedo);
+        }
+    }
+
+    this->m_bLightsBuilt = true;
+}
+
+int Scene::GetObjectCount() const
+{
+    return static_cast<int>(this->m_oObjects.size());
+}
+
+int Scene::GetInstanceCount() const
+{
+    return static_cast<int>(this->m_oInstanceDescs.size());
+}
+
+int64_t Scene::GetVisibleSphereCount() const
+{
+    int64_t _count = this->m_oSpheres.GetCount();
+
+    for (size_t i = 0; i < this->m_oInstanceDescs.size(); ++i)
+    {
+        _count += this->m_oObjects[this->m_oInstanceDescs[i].m_iObject]->m_oSpheres.GetCount();
+    }
+
+    return _count;
+}
+
+int64_t Scene::GetStoredSphereCount() const
+{
+    int64_t _count = this->m_oSpheres.GetCount();
+
+    for (size_t i = 0; i < this->m_oObjects.size(); ++i)
+    {
+        _count += this->m_oObjects[i]->m_oSpheres.GetCount();
+    }
+
+    return _count;
+}
+
+int64_t Scene::GetVisibleTriangleCount() const
+{
+    int64_t _count = 0;
+
+    for (size_t i = 0; i < this->m_oInstanceDescs.size(); ++i)
+    {
+        const SceneObject& _object = *this->m_oObjects[this->m_oInstanceDescs[i].m_iObject];
+
+        _count += _object.m_pMesh ? _object.m_pMesh->GetTriangleCount() : 0;
+    }
+
+    return _count;
+}
+
+int64_t Scene::GetStoredTriangleCount() const
+{
+    int64_t _count = 0;
+
+    for (size_t i = 0; i < this->m_oObjects.size(); ++i)
+    {
+        _count += this->m_oObjects[i]->m_pMesh ? this->m_oObjects[i]->m_pMesh->GetTriangleCount() : 0;
+    }
+
+    return _count;
+}
+
+size_t Scene::GetMeshMemoryBytes() const
+{
+    size_t _bytes = 0;
+
+    for (size_t i = 0; i < this->m_oObjects.size(); ++i)
+    {
+        _bytes += this->m_oObjects[i]->m_pMesh ? this->m_oObjects[i]->m_pMesh->GetMemoryBytes() : 0;
+    }
+
+    return _bytes;
+}
+
+double Scene::GetTopLevelBuildTimeMs() const
+{
+    return this->m_dTopLevelBuildTimeMs;
+}
+
+const SphereSoA& Scene::GetSpheres() const
+{
+    return this->m_oSpheres;
+}
+
+const MaterialTable& Scene::GetMaterials() const
+{
+    return this->m_oMaterials;
+}
+
+SceneCamera& Scene::GetCamera()
+{
+    return this->m_oCamera;
+}
+
+const SceneCamera& Scene::GetCamera() const
+{
+    return this->m_oCamera;
+}
+
+double Scene::GetLoadTimeMs() const
+{
+    return this->m_dLoadTimeMs;
+}
@@ -0,0 +1,572 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdlib.h>
+#include "appsrc/include/IO/commandline.h"
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/counters.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Math/vec3a.h"
+#include "appsrc/include/Render/tilerenderer.h"
+#include "appsrc/include/Render/integrator.h"
+#include "appsrc/include/Scene/randomscene.h"
+#include "bench/microbench.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Renders a fixed set of scenes with fixed seeds and prints one JSON document, so runs can
+// be diffed across commits, machines and thread counts. Progress goes to stderr. --math
+// and --primary-rays print the microbenchmarks of microbench.h as text instead.
+namespace
+{
+    struct BenchmarkScene
+    {
+        const char* m_pName;
+
+        int m_iGridHalfExtent;
+
+        float m_fDiffuseFraction;
+        float m_fMetalFraction;
+
+        float m_fAperture;
+    };
+
+    const BenchmarkScene s_oScenes[] =
+    {
+        { "random-100", 5, 0.8f, 0.15f, 0.1f },
+        { "random-500", 11, 0.8f, 0.15f, 0.1f },
+        { "random-2000", 22, 0.8f, 0.15f, 0.1f },
+        { "random-8000", 44, 0.8f, 0.15f, 0.1f },
+        { "glass-500", 11, 0.1f, 0.1f, 0.1f },
+        { "dof-500", 11, 0.8f, 0.15f, 1.5f }
+    };
+
+    const int s_ciSceneCount = sizeof(s_oScenes) / sizeof(s_oScenes[0]);
+
+    struct BenchmarkResult
+    {
+        const BenchmarkScene* m_pScene;
+
+        int m_iThreads;
+        int m_iPrimitives;
+
+        double m_dSceneBuildMs;
+        double m_dBvhBuildMs;
+        int m_iBvhNodes;
+
+        // Render wall time of every repeat, in seconds.
+        std::vector<double> m_oTimes;
+
+        uint64_t m_uPrimaryRays;
+        uint64_t m_uSecondaryRays;
+
+        double m_dNodesPerRay;
+        double m_dPrimitiveTestsPerRay;
+
+        long m_lPeakMemoryKb;
+
+        // Whether m_lPeakMemoryKb is this scene's alone rather than the process's so far.
+        bool m_bScenePeak;
+
+        CounterBlock m_oCounters;
+    };
+
+    const CommandOption s_oOptions[] =
+    {
+        { "--help", nullptr, "print this text" },
+        { "--list", nullptr, "print the scene names" },
+        { "--scenes", "A,B,...", "scenes to render, all by default" },
+        { "--threads", "N,M,...", "thread counts to render each scene with, zero for one per core" },
+        { "--width", "N", "image width in pixels" },
+        { "--height", "N", "image height in pixels" },
+        { "--samples", "N", "samples per pixel" },
+        { "--max-depth", "N", "bounces per path" },
+        { "--sampler", "NAME", "independent, stratified, sobol or bluenoise" },
+        { "--integrator", "NAME", "wavefront or path" },
+        { "--repeat", "N", "renders per scene, of which the median time is reported" },
+        { "--output", "PATH", "write the JSON to PATH instead of stdout" },
+        { "--math", nullptr, "time the math layer instead" },
+        { "--primary-rays", nullptr, "time primary rays through the scenes instead" }
+    };
+
+    const CommandLine s_oCommandLine(s_oOptions);
+
+    // Restarts the peak PeakMemoryKb() reads at the current resident set, so a scene reports
+    // its own footprint rather than the largest one before it. Only Linux can do this;
+    // returns false where the peak stays that of the whole process.
+    bool ResetPeakMemory()
+    {
+#if defined(__linux__)
+        std::ofstream _file("/proc/self/clear_refs");
+
+        _file << "5";
+        _file.flush();
+
+        return bool(_file);
+#else
+        return false;
+#endif
+    }
+
+    // Peak resident set since ResetPeakMemory(), or of the whole process where that failed.
+    long PeakMemoryKb()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS _counters;
+
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &_counters, sizeof(_counters)))
+        {
+            return static_cast<long>(_counters.PeakWorkingSetSize / 1024);
+        }
+
+        return 0;
+#else
+#if defined(__linux__)
+        // VmHWM follows clear_refs; ru_maxrss does not.
+        std::ifstream _status("/proc/self/status");
+
+        std::string _line;
+
+        while (std::getline(_status, _line))
+        {
+            if (_line.compare(0, 6, "VmHWM:") == 0)
+            {
+                return strtol(_line.c_str() + 6, nullptr, 10);
+            }
+        }
+#endif
+        struct rusage _usage;
+
+        if (getrusage(RUSAGE_SELF, &_usage) != 0)
+        {
+            return 0;
+        }
+
+#if defined(__APPLE__)
+        return _usage.ru_maxrss / 1024;
+#else
+        return _usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    std::vector<std::string> SplitList(const std::string& a_sList)
+    {
+        std::vector<std::string> _items;
+
+        std::stringstream _stream(a_sList);
+
+        std::string _item;
+
+        while (std::getline(_stream, _item, ','))
+        {
+            if (!_item.empty())
+            {
+                _items.push_back(_item);
+            }
+        }
+
+        return _items;
+    }
+
+    double Median(std::vector<double> a_oValues)
+    {
+        std::sort(a_oValues.begin(), a_oValues.end());
+
+        size_t _half = a_oValues.size() / 2;
+
+        return a_oValues.size() % 2 ? a_oValues[_half] : 0.5 * (a_oValues[_half - 1] + a_oValues[_half]);
+    }
+
+    BenchmarkResult RunScene(const BenchmarkScene& a_oScene, const RenderSettings& a_oSettings, bool a_bWavefront, int a_iRepeat)
+    {
+        typedef std::chrono::high_resolution_clock Clock;
+
+        BenchmarkResult _result;
+
+        _result.m_pScene = &a_oScene;
+
+        // The previous scene is gone by now, so its peak is not carried into this one.
+        _result.m_bScenePeak = ResetPeakMemory();
+
+        RandomSceneOptions _options;
+        _options.m_iGridHalfExtent = a_oScene.m_iGridHalfExtent;
+        _options.m_fDiffuseFraction = a_oScene.m_fDiffuseFraction;
+        _options.m_fMetalFraction = a_oScene.m_fMetalFraction;
+
+        Clock::time_point _start = Clock::now();
+
+        Rng _sceneRng;
+
+        SceneArena _arena;
+
+        HittableList* _scene = RandomScene(_arena, _sceneRng, _options);
+
+        _result.m_dSceneBuildMs = std::chrono::duration<double, std::milli>(Clock::now() - _start).count();
+
+        Bvh _bvh(*_scene);
+
+        _result.m_iPrimitives = _scene->m_iListSize;
+        _result.m_dBvhBuildMs = _bvh.GetBuildTimeMs();
+        _result.m_iBvhNodes = _bvh.GetNodeCount();
+
+        int nx = a_oSettings.m_iWidth;
+        int ny = a_oSettings.m_iHeight;
+
+        Camera _camera = RandomSceneCamera(float(nx) / float(ny), a_oScene.m_fAperture);
+
+        // The random scenes hold no emitters and are lit by the sky alone.
+        LightList _lights;
+
+        std::unique_ptr<Sampler> _sampler = Sampler::Create(a_oSettings.m_eSampler, a_oSettings.m_iSamples);
+
+        TileRenderer _renderer(a_oSettings);
+
+        _result.m_iThreads = _renderer.GetThreadCount();
+
+        FrameBuffer _frameBuffer(nx, ny);
+
+        for (int r = 0; r < a_iRepeat; ++r)
+        {
+            Counters::Reset();
+
+            _start = Clock::now();
+
+            if (a_bWavefront)
+            {
+                _renderer.RenderTiles([&](const Tile& a_oTile, FrameBuffer& a_oTarget)
+                {
+                    RenderTileWavefront(a_oTile, a_oSettings, _camera, _bvh, _arena.GetMaterials(), _lights, *_sampler, a_oTarget);
+                }, _frameBuffer);
+            }
+            else
+            {
+                _renderer.Render([&](int i, int j, int s, SampleAovs* a_pAovs) -> Vec3
+                {
+                    SampleStream _stream(_sampler.get(), i, j, s);
+
+                    CameraSample _sample;
+                    _sample.m_iX = i;
+                    _sample.m_iY = j;
+                    _stream.Next2D(_sample.m_fJitterX, _sample.m_fJitterY);
+                    _stream.Next2D(_sample.m_fLensX, _sample.m_fLensY);
+                    _sample.m_fTime = 0.0f;
+
+                    Ray _ray = _camera.GetRay(_sample, nx, ny);
+
+                    return TracePath(_ray, _bvh, _arena.GetMaterials(), _lights, _stream, a_oSettings, a_pAovs);
+                }, _frameBuffer);
+            }
+
+            _result.m_oTimes.push_back(std::chrono::duration<double>(Clock::now() - _start).count());
+        }
+
+        // Every repeat traces the same paths, so the counters of the last one stand for all.
+        PathStats _paths = GetPathStats();
+        BvhTraversalStats _traversal = Bvh::GetTraversalStats();
+
+        _result.m_uPrimaryRays = _paths.m_uPaths;
+        _result.m_uSecondaryRays = _paths.m_uSegments - _paths.m_uPaths;
+
+        _result.m_dNodesPerRay = _traversal.m_uRays > 0 ? double(_traversal.m_uNodesVisited) / _traversal.m_uRays : 0.0;
+        _result.m_dPrimitiveTestsPerRay = _traversal.m_uRays > 0 ? double(_traversal.m_uPrimitiveTests) / _traversal.m_uRays : 0.0;
+
+        _result.m_lPeakMemoryKb = PeakMemoryKb();
+
+        _result.m_oCounters = Counters::Sum();
+
+        return _result;
+    }
+
+    void RunPrimaryRays(const BenchmarkScene& a_oScene, const RenderSettings& a_oSettings)
+    {
+        RandomSceneOptions _options;
+        _options.m_iGridHalfExtent = a_oScene.m_iGridHalfExtent;
+        _options.m_fDiffuseFraction = a_oScene.m_fDiffuseFraction;
+        _options.m_fMetalFraction = a_oScene.m_fMetalFraction;
+
+        Rng _sceneRng;
+
+        SceneArena _arena;
+
+        HittableList* _scene = RandomScene(_arena, _sceneRng, _options);
+
+        Bvh _bvh(*_scene);
+
+        int nx = a_oSettings.m_iWidth;
+        int ny = a_oSettings.m_iHeight;
+
+        std::cout << a_oScene.m_pName << "\n";
+
+        BenchmarkPrimaryRays(_bvh, RandomSceneCamera(float(nx) / float(ny), a_oScene.m_fAperture), nx, ny);
+    }
+
+    void WriteJson(std::ostream& a_oOut, const RenderSettings& a_oSettings, bool a_bWavefront, int a_iRepeat, const std::vector<BenchmarkResult>& a_oResults)
+    {
+        a_oOut << "{\n"
+               << "  \"schema\": 1,\n"
+               << "  \"build\": {\n"
+#if defined(__VERSION__)
+               << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+               << "    \"sphere_kernel\": \"" << SimdIsaName(SphereSoA::GetIsa()) << "\",\n"
+               << "    \"vec3a\": " << (RT_USE_VEC3A ? "true" : "false") << ",\n"
+               << "    \"counters\": " << (RT_ENABLE_COUNTERS ? "true" : "false") << "\n"
+               << "  },\n"
+               << "  \"settings\": {\n"
+               << "    \"width\": " << a_oSettings.m_iWidth << ",\n"
+               << "    \"height\": " << a_oSettings.m_iHeight << ",\n"
+               << "    \"samples\": " << a_oSettings.m_iSamples << ",\n"
+               << "    \"max_depth\": " << a_oSettings.m_iMaxDepth << ",\n"
+               << "    \"roulette_depth\": " << a_oSettings.m_iRouletteDepth << ",\n"
+               << "    \"tile_size\": " << a_oSettings.m_iTileSize << ",\n"
+               << "    \"sampler\": \"" << Sampler::GetTypeName(a_oSettings.m_eSampler) << "\",\n"
+               << "    \"integrator\": \"" << (a_bWavefront ? "wavefront" : "path") << "\",\n"
+               << "    \"repeat\": " << a_iRepeat << "\n"
+               << "  },\n"
+               << "  \"results\": [";
+
+        for (size_t r = 0; r < a_oResults.size(); ++r)
+        {
+            const BenchmarkResult& _result = a_oResults[r];
+
+            double _median = Median(_result.m_oTimes);
+            double _min = *std::min_element(_result.m_oTimes.begin(), _result.m_oTimes.end());
+
+            uint64_t _rays = _result.m_uPrimaryRays + _result.m_uSecondaryRays;
+
+            a_oOut << (r == 0 ? "\n" : ",\n")
+                   << "    {\n"
+                   << "      \"scene\": \"" << _result.m_pScene->m_pName << "\",\n"
+                   << "      \"threads\": " << _result.m_iThreads << ",\n"
+                   << "      \"primitives\": " << _result.m_iPrimitives << ",\n"
+                   << "      \"aperture\": " << _result.m_pScene->m_fAperture << ",\n"
+                   << "      \"scene_build_ms\": " << _result.m_dSceneBuildMs << ",\n"
+                   << "      \"bvh_build_ms\": " << _result.m_dBvhBuildMs << ",\n"
+                   << "      \"bvh_nodes\": " << _result.m_iBvhNodes << ",\n"
+                   << "      \"wall_time_s\": " << _median << ",\n"
+                   << "      \"wall_time_min_s\": " << _min << ",\n"
+                   << "      \"rays_per_second\": " << (_median > 0.0 ? double(_rays) / _median : 0.0) << ",\n"
+                   << "      \"primary_rays\": " << _result.m_uPrimaryRays << ",\n"
+                   << "      \"secondary_rays\": " << _result.m_uSecondaryRays << ",\n"
+                   << "      \"nodes_per_ray\": " << _result.m_dNodesPerRay << ",\n"
+                   << "      \"primitive_tests_per_ray\": " << _result.m_dPrimitiveTestsPerRay << ",\n"
+                   << "      \"peak_memory_kb\": " << _result.m_lPeakMemoryKb << ",\n"
+                   << "      \"peak_memory_scope\": \"" << (_result.m_bScenePeak ? "scene" : "process") << "\",\n"
+                   << "      \"counters\": {";
+
+            for (int c = 0; c < COUNTER_COUNT; ++c)
+            {
+                a_oOut << (c == 0 ? "\n" : ",\n") << "        \"" << Counters::GetName(RenderCounter(c)) << "\": " << _result.m_oCounters.m_uValues[c];
+            }
+
+            a_oOut << "\n      }\n"
+                   << "    }";
+        }
+
+        a_oOut << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    RenderSettings _settings;
+
+    _settings.m_iWidth = 400;
+    _settings.m_iHeight = 266;
+    _settings.m_iSamples = 16;
+
+    std::vector<std::string> _sceneNames;
+    std::vector<std::string> _threadCounts(1, "0");
+
+    std::string _outputPath;
+    std::string _samplerName;
+
+    bool _wavefront = true;
+
+    int _repeat = 3;
+
+    // Text reports of single operations in place of the JSON of whole renders.
+    bool _math = false;
+    bool _primaryRays = false;
+
+    for (int a = 1; a < argc; ++a)
+    {
+        std::string _arg = argv[a];
+
+        const CommandOption* _option = s_oCommandLine.Find(_arg);
+
+        if (!_option || (_option->m_pValue && a + 1 >= argc))
+        {
+            std::cerr << (_option ? "Missing value for " : "Unknown option ") << _arg << "\n";
+            s_oCommandLine.PrintUsage(std::cerr, argv[0]);
+            return 1;
+        }
+
+        if (_arg == "--help")
+        {
+            s_oCommandLine.PrintUsage(std::cout, argv[0]);
+            return 0;
+        }
+
+        if (_arg == "--list")
+        {
+            for (int s = 0; s < s_ciSceneCount; ++s)
+            {
+                std::cout << s_oScenes[s].m_pName << "\n";
+            }
+
+            return 0;
+        }
+
+        if (_arg == "--math")
+        {
+            _math = true;
+            continue;
+        }
+
+        if (_arg == "--primary-rays")
+        {
+            _primaryRays = true;
+            continue;
+        }
+
+        bool _valid = true;
+
+        if (_arg == "--scenes")
+        {
+            _sceneNames = SplitList(argv[++a]);
+        }
+        else if (_arg == "--threads")
+        {
+            _threadCounts = SplitList(argv[++a]);
+
+            int _threads = 0;
+
+            for (size_t t = 0; t < _threadCounts.size() && _valid; ++t)
+            {
+                _valid = CommandLine::ParseInt(_threadCounts[t].c_str(), 0, _threads);
+            }
+        }
+        else if (_arg == "--width")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iWidth);
+        }
+        else if (_arg == "--height")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iHeight);
+        }
+        else if (_arg == "--samples")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iSamples);
+        }
+        else if (_arg == "--max-depth")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iMaxDepth);
+        }
+        else if (_arg == "--sampler")
+        {
+            _samplerName = argv[++a];
+        }
+        else if (_arg == "--integrator")
+        {
+            _wavefront = std::string(argv[++a]) != "path";
+        }
+        else if (_arg == "--repeat")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _repeat);
+        }
+        else if (_arg == "--output")
+        {
+            _outputPath = argv[++a];
+        }
+
+        if (!_valid)
+        {
+            std::cerr << "Invalid value '" << argv[a] << "' for " << _arg << "\n";
+            s_oCommandLine.PrintUsage(std::cerr, argv[0]);
+            return 1;
+        }
+    }
+
+    if (!_samplerName.empty() && !Sampler::ParseType(_samplerName, _settings.m_eSampler))
+    {
+        std::cerr << "Unknown sampler '" << _samplerName << "'\n";
+        return 1;
+    }
+
+    if (_math)
+    {
+        BenchmarkMath();
+        return 0;
+    }
+
+    std::vector<const BenchmarkScene*> _scenes;
+
+    for (int s = 0; s < s_ciSceneCount; ++s)
+    {
+        if (_sceneNames.empty() || std::find(_sceneNames.begin(), _sceneNames.end(), s_oScenes[s].m_pName) != _sceneNames.end())
+        {
+            _scenes.push_back(&s_oScenes[s]);
+        }
+    }
+
+    if (_scenes.empty())
+    {
+        std::cerr << "No matching scenes; --list prints the available ones\n";
+        return 1;
+    }
+
+    if (_primaryRays)
+    {
+        for (size_t s = 0; s < _scenes.size(); ++s)
+        {
+            RunPrimaryRays(*_scenes[s], _settings);
+        }
+
+        return 0;
+    }
+
+    std::vector<BenchmarkResult> _results;
+
+    for (size_t t = 0; t < _threadCounts.size(); ++t)
+    {
+        // Each entry was checked as it was read.
+        CommandLine::ParseInt(_threadCounts[t].c_str(), 0, _settings.m_iThreadCount);
+
+        for (size_t s = 0; s < _scenes.size(); ++s)
+        {
+            std::cerr << "Rendering " << _scenes[s]->m_pName << " with " << _threadCounts[t] << " threads\n";
+
+            _results.push_back(RunScene(*_scenes[s], _settings, _wavefront, _repeat));
+        }
+    }
+
+    if (_outputPath.empty())
+    {
+        WriteJson(std::cout, _settings, _wavefront, _repeat, _results);
+        return 0;
+    }
+
+    std::ofstream _file(_outputPath.c_str());
+
+    WriteJson(_file, _settings, _wavefront, _repeat, _results);
+
+    if (!_file)
+    {
+        std::cerr << "Could not write " << _outputPath << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+#include "bench/microbench.h"
+#include <chrono>
+#include <float.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/random.h"
+#include "appsrc/include/Math/raypacket.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Math/vec3a.h"
+
+void BenchmarkPrimaryRays(const Bvh& a_oBvh, const Camera& a_oCamera, int a_iWidth, int a_iHeight)
+{
+    std::vector<CameraSample> _samples;
+
+    _samples.reserve(a_iWidth * a_iHeight);
+
+    // 4x2 pixel blocks, so consecutive groups of eight rays form coherent packets.
+    for (int j = 0; j < a_iHeight; j += 2)
+    {
+        for (int i = 0; i < a_iWidth; i += 4)
+        {
+            for (int y = j; y < j + 2 && y < a_iHeight; ++y)
+            {
+                for (int x = i; x < i + 4 && x < a_iWidth; ++x)
+                {
+                    CameraSample _sample;
+                    _sample.m_iX = x;
+                    _sample.m_iY = y;
+                    _sample.m_fTime = 0.0f;
+
+                    _samples.push_back(_sample);
+                }
+            }
+        }
+    }
+
+    int _count = static_cast<int>(_samples.size());
+
+    std::vector<Ray> _rays(_count);
+    std::vector<HitRecord> _records(_count);
+    std::vector<uint8_t> _hits(_count);
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    Clock::time_point _start = Clock::now();
+
+    for (int k = 0; k < _count; ++k)
+    {
+        Rng _rng = Rng::ForPixel(_samples[k].m_iX, _samples[k].m_iY, 0);
+
+        float _u = float(_samples[k].m_iX + _rng.NextFloat()) / float(a_iWidth);
+        float _v = float(_samples[k].m_iY + _rng.NextFloat()) / float(a_iHeight);
+
+        float _lensX = _rng.NextFloat();
+        float _lensY = _rng.NextFloat();
+
+        _rays[k] = a_oCamera.GetRay(_u, _v, _lensX, _lensY);
+    }
+
+    double _single = std::chrono::duration<double>(Clock::now() - _start).count();
+
+    _start = Clock::now();
+
+    for (int k = 0; k < _count; ++k)
+    {
+        Rng _rng = Rng::ForPixel(_samples[k].m_iX, _samples[k].m_iY, 0);
+
+        _samples[k].m_fJitterX = _rng.NextFloat();
+        _samples[k].m_fJitterY = _rng.NextFloat();
+        _samples[k].m_fLensX = _rng.NextFloat();
+        _samples[k].m_fLensY = _rng.NextFloat();
+    }
+
+    a_oCamera.GetRays(&_samples[0], _count, a_iWidth, a_iHeight, &_rays[0]);
+
+    double _batched = std::chrono::duration<double>(Clock::now() - _start).count();
+
+    _start = Clock::now();
+
+    for (int k = 0; k < _count; ++k)
+    {
+        _hits[k] = a_oBvh.Hit(_rays[k], 0.001f, FLT_MAX, _records[k]);
+    }
+
+    double _scalar = std::chrono::duration<double>(Clock::now() - _start).count();
+
+    _start = Clock::now();
+
+    RayPacket _packet;
+
+    for (int k = 0; k < _count; k += RayPacket::SIZE)
+    {
+        _packet.Clear();
+
+        for (int l = k; l < k + RayPacket::SIZE && l < _count; ++l)
+        {
+            _packet.Add(_rays[l]);
+        }
+
+        a_oBvh.HitPacket(_packet, 0.001f, FLT_MAX, &_records[k]);
+    }
+
+    double _packetTime = std::chrono::duration<double>(Clock::now() - _start).count();
+
+    _start = Clock::now();
+
+    a_oBvh.HitStream(&_rays[0], _count, 0.001f, FLT_MAX, &_records[0], &_hits[0]);
+
+    double _stream = std::chrono::duration<double>(Clock::now() - _start).count();
+
+    std::cout << "Primary rays: " << _count << "\n"
+              << "  GetRay:  " << _count / _single * 1e-6 << " Mrays/s generated\n"
+              << "  GetRays: " << _count / _batched * 1e-6 << " Mrays/s generated (" << _single / _batched << "x, "
+              << (a_oCamera.m_fLensRadius == 0.0f ? "pinhole" : "thin lens") << ")\n"
+              << "  scalar: " << _count / _scalar * 1e-6 << " Mrays/s\n"
+              << "  packet: " << _count / _packetTime * 1e-6 << " Mrays/s (" << _scalar / _packetTime << "x)\n"
+              << "  stream: " << _count / _stream * 1e-6 << " Mrays/s (" << _scalar / _stream << "x, including sort)\n";
+}
+
+void BenchmarkMath()
+{
+    const int _iterations = 1 << 22;
+
+    typedef std::chrono::high_resolution_clock Clock;
+
+    Rng _rng = Rng::ForPixel(0, 0, 0);
+
+    Vec3 _a(0.3f, 0.5f, 0.8f);
+    Vec3 _b(-0.7f, 0.2f, 0.1f);
+    Vec3 _sum(0.0f, 0.0f, 0.0f);
+
+    Clock::time_point _start = Clock::now();
+
+    for (int i = 0; i < _iterations; ++i)
+    {
+        _a = Unit_Vector(_a + 0.01f * Cross(_a, _b));
+        _sum += _a * Dot(_a, _b) - _b / (1.0f + _a.SquaredLength());
+    }
+
+    double _vector = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / _iterations;
+
+    _start = Clock::now();
+
+    for (int i = 0; i < _iterations; ++i)
+    {
+        Ray _ray(_sum * 1e-7f, _b);
+
+        _sum += _ray.PointAtParamenter(0.5f) - _ray.Origin();
+    }
+
+    double _rayTime = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / _iterations;
+
+    Material _materials[MATERIAL_TYPE_COUNT] =
+    {
+        Lambertian(Vec3(0.5f, 0.5f, 0.5f)),
+        Metal(Vec3(0.7f, 0.6f, 0.5f), 0.3f),
+        Dielectric(1.5f),
+        Emissive(Vec3(1.0f, 1.0f, 1.0f))
+    };
+
+    HitRecord _record;
+    _record.m_fT = 1.0f;
+    _record.m_oPoint = Vec3(0.0f, 0.0f, -1.0f);
+    _record.m_oNormal = Vec3(0.0f, 0.0f, 1.0f);
+    _record.m_uMaterialId = 0;
+
+    std::unique_ptr<Sampler> _independent = Sampler::Create(SAMPLER_INDEPENDENT, 1);
+
+    double _scatter[MATERIAL_TYPE_COUNT];
+
+    for (int t = 0; t < MATERIAL_TYPE_COUNT; ++t)
+    {
+        Ray _in(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.1f, 0.2f, -1.0f));
+        Ray _out;
+        Vec3 _attenuation;
+
+        _start = Clock::now();
+
+        for (int i = 0; i < _iterations; ++i)
+        {
+            SampleStream _stream(_independent.get(), 0, 0, i);
+
+            Scatter(_materials[t], _in, _record, _attenuation, _out, _stream);
+
+            _sum += _out.Direction();
+        }
+
+        _scatter[t] = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / _iterations;
+    }
+
+    std::cout << "Math layer (" << _iterations << " iterations, checksum " << _sum.Length() << ")\n"
+              << "  vector ops: " << _vector << " ns\n"
+              << "  ray eval:   " << _rayTime << " ns\n"
+              << "  lambertian: " << _scatter[MATERIAL_LAMBERTIAN] << " ns\n"
+              << "  metal:      " << _scatter[MATERIAL_METAL] << " ns\n"
+              << "  dielectric: " << _scatter[MATERIAL_DIELECTRIC] << " ns\n";
+
+    std::cout << "Samplers (2D point)\n";
+
+    for (int t = 0; t < SAMPLER_TYPE_COUNT; ++t)
+    {
+        std::unique_ptr<Sampler> _sampler = Sampler::Create(SamplerType(t), 16);
+
+        float _u = 0.0f;
+        float _v = 0.0f;
+
+        _start = Clock::now();
+
+        for (int i = 0; i < _iterations; ++i)
+        {
+            float _du;
+            float _dv;
+
+            _sampler->Get2D(i & 63, (i >> 6) & 63, i >> 12, i & 7, _du, _dv);
+
+            _u += _du;
+            _v += _dv;
+        }
+
+        double _time = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / _iterations;
+
+        // Every sampler is uniform, so both means should sit at 0.5.
+        std::cout << "  " << Sampler::GetTypeName(SamplerType(t)) << ": " << _time << " ns (mean " << _u / _iterations << ", " << _v / _iterations << ")\n";
+    }
+
+    // Vec3 against Vec3A over independent vectors, so throughput rather than latency is measured.
+    const int _count = 4096;
+    const int _passes = _iterations / _count;
+
+    std::vector<Vec3> _scalar(_count);
+    std::vector<Vec3A> _simd(_count);
+
+    for (int i = 0; i < _count; ++i)
+    {
+        _scalar[i] = RandomInUnitSphere(_rng) + Vec3(0.0f, 0.0f, 2.0f);
+        _simd[i] = Vec3A(_scalar[i]);
+    }
+
+    std::vector<Vec3> _scalarOut(_count);
+    std::vector<Vec3A> _simdOut(_count);
+
+    Vec3 _scalarSum(0.0f, 0.0f, 0.0f);
+    Vec3A _simdSum;
+
+    double _times[2][3];
+
+    for (int k = 0; k < 3; ++k)
+    {
+        _start = Clock::now();
+
+        for (int p = 0; p < _passes; ++p)
+        {
+            for (int i = 0; i < _count; ++i)
+            {
+                const Vec3& _v = _scalar[i];
+                const Vec3& _w = _scalar[(i + 1) & (_count - 1)];
+
+                if (k == 0)
+                {
+                    _scalarOut[i] = Unit_Vector(_v);
+                }
+                else if (k == 1)
+                {
+                    _scalarOut[i] = Cross(_v, _w) * Dot(_v, _w);
+                }
+                else
+                {
+                    _scalarOut[i] = _v * 0.5f + _w;
+                }
+            }
+
+            _scalarSum += _scalarOut[p & (_count - 1)];
+        }
+
+        _times[0][k] = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / (double(_passes) * _count);
+
+        _start = Clock::now();
+
+        for (int p = 0; p < _passes; ++p)
+        {
+            for (int i = 0; i < _count; ++i)
+            {
+                const Vec3A& _v = _simd[i];
+                const Vec3A& _w = _simd[(i + 1) & (_count - 1)];
+
+                if (k == 0)
+                {
+                    _simdOut[i] = NormalizeFast(_v);
+                }
+                else if (k == 1)
+                {
+                    _simdOut[i] = Cross(_v, _w) * Dot(_v, _w);
+                }
+                else
+                {
+                    _simdOut[i] = MulAdd(_v, Vec3A::Splat(0.5f), _w);
+                }
+            }
+
+            _simdSum += _simdOut[p & (_count - 1)];
+        }
+
+        _times[1][k] = std::chrono::duration<double, std::nano>(Clock::now() - _start).count() / (double(_passes) * _count);
+    }
+
+    std::cout << "Vec3 / Vec3A (checksums " << _scalarSum.Length() << " / " << Length(_simdSum) << ", Vec3A on hot paths: " << (RT_USE_VEC3A ? "on" : "off") << ")\n"
+              << "  normalize:   " << _times[0][0] << " / " << _times[1][0] << " ns\n"
+              << "  cross * dot: " << _times[0][1] << " / " << _times[1][1] << " ns\n"
+              << "  mul-add:     " << _times[0][2] << " / " << _times[1][2] << " ns\n";
+}
@@ -0,0 +1,14 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include "appsrc/include/Math/bvh.h"
+#include "appsrc/include/Math/camera.h"
+
+// Primary-ray generation cost, then the throughput of the scalar, packet and sorted-stream
+// traversal paths on the same ray set.
+void BenchmarkPrimaryRays(const Bvh& a_oBvh, const Camera& a_oCamera, int a_iWidth, int a_iHeight);
+
+// Cost of the math layer's innermost operations, in nanoseconds per call.
+void BenchmarkMath();
+
+#endif // MICROBENCH_H
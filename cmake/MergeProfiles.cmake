@@ -0,0 +1,16 @@
+# Merges the raw Clang profiles written by a pgo-train run into DIR/merged.profdata.
+#
+#   cmake -DPROFDATA=<llvm-profdata> -DDIR=<profile dir> -P MergeProfiles.cmake
+
+file(GLOB _raw "${DIR}/*.profraw")
+
+if (NOT _raw)
+    message(FATAL_ERROR "No .profraw files in ${DIR}; did the training run finish?")
+endif ()
+
+execute_process(COMMAND ${PROFDATA} merge -output=${DIR}/merged.profdata ${_raw}
+                RESULT_VARIABLE _result)
+
+if (NOT _result EQUAL 0)
+    message(FATAL_ERROR "llvm-profdata merge failed")
+endif ()
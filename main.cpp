@@ -1,147 +1,1041 @@
 #include <iostream>
-#include <fstream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <memory>
 #include <float.h>
+#include <limits.h>
 #include <stdlib.h>
 #include "appsrc/include/Math/sphere.h"
 #include "appsrc/include/Math/hittablelist.h"
+#include "appsrc/include/Math/bvh.h"
 #include "appsrc/include/Math/camera.h"
 #include "appsrc/include/Math/material.h"
+#include "appsrc/include/Math/scenearena.h"
+#include "appsrc/include/Math/sampler.h"
+#include "appsrc/include/Math/counters.h"
+#include "appsrc/include/Math/trace.h"
+#include "appsrc/include/Render/tilerenderer.h"
+#include "appsrc/include/Render/integrator.h"
+#include "appsrc/include/Render/accumulationbuffer.h"
+#include "appsrc/include/Render/denoiser.h"
+#include "appsrc/include/Render/distributed.h"
+#include "appsrc/include/Render/renderer.h"
+#include "appsrc/include/IO/commandline.h"
+#include "appsrc/include/IO/mappedfile.h"
+#include "appsrc/include/IO/imagereader.h"
+#include "appsrc/include/IO/imagewriter.h"
+#include "appsrc/include/Scene/randomscene.h"
+#include "appsrc/include/Scene/scene.h"
 
-
-Vec3 Color(const Ray& a_oRay, Hittable* a_oWorld, int a_iDepth)
+// Path of frame a_iFrame in a sequence: a run of '#' in a_sPath becomes the zero-padded
+// frame number, otherwise ".NNNN" goes in front of the extension.
+std::string FramePath(const std::string& a_sPath, int a_iFrame)
 {
-    HitRecord _record;
+    size_t _hash = a_sPath.find('#');
+
+    size_t _width = 4;
 
-    if (a_oWorld->Hit(a_oRay, 0.001f, FLT_MAX, _record))
+    std::string _prefix;
+    std::string _suffix;
+
+    if (_hash != std::string::npos)
+    {
+        size_t _end = a_sPath.find_first_not_of('#', _hash);
+
+        _end = _end == std::string::npos ? a_sPath.size() : _end;
+
+        _width = _end - _hash;
+        _prefix = a_sPath.substr(0, _hash);
+        _suffix = a_sPath.substr(_end);
+    }
+    else
     {
-        Ray _scatter;
-        Vec3 _attenuation;
+        size_t _dot = a_sPath.find_last_of('.');
+        size_t _slash = a_sPath.find_last_of("/\\");
 
-        if (a_iDepth < 50 && _record.m_oMaterial->Scatter(a_oRay, _record, _attenuation, _scatter))
+        if (_dot == std::string::npos || (_slash != std::string::npos && _dot < _slash))
         {
-            return _attenuation * Color(_scatter, a_oWorld, a_iDepth + 1);
+            _dot = a_sPath.size();
         }
-        else
+
+        _prefix = a_sPath.substr(0, _dot) + ".";
+        _suffix = a_sPath.substr(_dot);
+    }
+
+    std::string _number = std::to_string(a_iFrame);
+
+    if (_number.size() < _width)
+    {
+        _number.insert(0, _width - _number.size(), '0');
+    }
+
+    return _prefix + _number + _suffix;
+}
+
+// Writes the albedo, normal and depth AOVs of a_oFrameBuffer next to each other as
+// <stem>_albedo.pfm, <stem>_normal.pfm and <stem>_depth.pfm.
+bool WriteAovs(const FrameBuffer& a_oFrameBuffer, const std::string& a_sStem, bool a_bSequence, int a_iFrame)
+{
+    static const char* s_ccNames[AOV_CHANNEL_COUNT] = { "_albedo.pfm", "_normal.pfm", "_depth.pfm" };
+
+    FrameBuffer _image(a_oFrameBuffer.GetWidth(), a_oFrameBuffer.GetHeight());
+
+    bool _ok = true;
+
+    for (int c = 0; c < AOV_CHANNEL_COUNT; ++c)
+    {
+        std::string _path = a_sStem + s_ccNames[c];
+
+        _path = a_bSequence ? FramePath(_path, a_iFrame) : _path;
+
+        a_oFrameBuffer.CopyAov(AovChannel(c), _image);
+
+        if (!ImageWriter::Write(_image, _path, IMAGE_FORMAT_PFM))
         {
-            return Vec3(0.0f, 0.0f, 0.0f);
+            std::cerr << "Could not write AOV to " << _path << "\n";
+            _ok = false;
         }
     }
-    else
+
+    return _ok;
+}
+
+// FNV-1a of a file's bytes, which tells a worker whether it loaded the coordinator's scene.
+uint64_t HashFile(const std::string& a_sPath)
+{
+    MappedFile _file;
+
+    uint64_t _hash = 14695981039346656037ull;
+
+    if (!_file.Open(a_sPath))
     {
-        Vec3 _unitDir = Unit_Vector(a_oRay.Direction());
+        return _hash;
+    }
 
-        float _t = 0.5f * (_unitDir.GetY() + 1.0f);
+    const unsigned char* _data = reinterpret_cast<const unsigned char*>(_file.GetData());
 
-        return (1.0f - _t) * Vec3(1.0f, 1.0f, 1.0f) + _t * Vec3(0.5f, 0.7f, 1.0f);
+    for (size_t b = 0; b < _file.GetSize(); ++b)
+    {
+        _hash = (_hash ^ _data[b]) * 1099511628211ull;
     }
+
+    return _hash;
 }
 
-Hittable* RandomScene()
+const CommandOption s_oOptions[] =
 {
-    int n = 500;
+    { "--help", nullptr, "print this text" },
+    { "--width", "N", "image width in pixels" },
+    { "--height", "N", "image height in pixels" },
+    { "--samples", "N", "samples per pixel" },
+    { "--integrator", "NAME", "wavefront or path" },
+    { "--sampler", "NAME", "independent, stratified, sobol or bluenoise" },
+    { "--max-depth", "N", "bounces per path" },
+    { "--rr-depth", "N", "bounce from which Russian roulette may end paths, negative for never" },
+    { "--no-nee", nullptr, "leave emitters to the bounces instead of sampling them directly" },
+    { "--adaptive", nullptr, "stop sampling pixels once they are below the noise threshold" },
+    { "--min-samples", "N", "adaptive sampling: samples before the noise is measured" },
+    { "--noise-threshold", "X", "adaptive sampling: relative standard error to stop at" },
+    { "--tile-time-ms", "X", "adaptive sampling: time budget per tile, zero for none" },
+    { "--threads", "N", "render threads, zero for one per core" },
+    { "--tile", "N", "tile size in pixels" },
+    { "--gpu", nullptr, "render on the GPU where the build, the device and the scene allow" },
+    { "--scene", "PATH", "scene file to load instead of the random scene" },
+    { "--write-scene", "PATH", "save the scene as JSON or, by other extensions, a binary cache" },
+    { "--frames", "N", "frames of the sequence to render" },
+    { "--first-frame", "N", "frame the sequence starts at" },
+    { "--aperture", "X", "lens aperture, zero for a pinhole" },
+    { "--output", "PATH", "display image; '#' in a sequence becomes the frame number" },
+    { "--format", "NAME", "ppm, ppm-ascii, png or pfm, instead of the one of the extension" },
+    { "--hdr", "PATH", "also write the linear frame as PFM" },
+    { "--retone", "PATH", "tone map a stored PFM to --output instead of rendering" },
+    { "--exposure", "X", "stops of exposure before the tone curve" },
+    { "--tonemap", "NAME", "clamp, reinhard or aces" },
+    { "--display", "NAME", "srgb or gamma2" },
+    { "--no-dither", nullptr, "round to 8 bits without dither" },
+    { "--denoise", "NAME", "none, bilateral, atrous or oidn" },
+    { "--denoise-sigma", "X", "colour sigma of the denoiser" },
+    { "--aovs", "STEM", "write albedo, normal and depth PFMs named after STEM" },
+    { "--progressive", nullptr, "render one sample per pixel at a time" },
+    { "--preview-every", "N", "progressive: write the image every N samples" },
+    { "--checkpoint", "PATH", "progressive: save the accumulation to PATH" },
+    { "--checkpoint-every", "N", "progressive: samples between checkpoints" },
+    { "--resume", nullptr, "progressive: continue from --checkpoint" },
+    { "--heatmap", "PATH", "write the cost per pixel as an image" },
+    { "--trace", "PATH", "write a trace of the render stages" },
+    { "--coordinator", "PORT", "hand the frame out to workers connecting on PORT" },
+    { "--worker", "HOST:PORT", "render for the coordinator at HOST:PORT" },
+    { "--unit-samples", "N", "coordinator: samples per unit of work, zero for whole tiles" },
+    { "--worker-timeout", "X", "coordinator: seconds before a silent worker counts as dead" }
+};
+
+const CommandLine s_oCommandLine(s_oOptions);
+
+int main(int argc, char const *argv[])
+{
+    RenderSettings _settings;
+
+    bool _wavefront = true;
+
+    bool _gpu = false;
+
+    std::string _heatmapPath;
+
+    std::string _tracePath;
+
+    std::string _outputPath = "raw-texture.ppm";
+
+    std::string _formatName;
+
+    std::string _samplerName;
+
+    std::string _denoiserName;
+
+    DenoiseSettings _denoise;
+
+    ToneMapSettings _toneMap;
+
+    std::string _curveName;
+
+    std::string _encodingName;
+
+    // The linear frame next to the display image, to tone map again later.
+    std::string _hdrPath;
+
+    // Tone maps a stored PFM to --output instead of rendering.
+    std::string _retonePath;
 
-    Hittable** _list = new Hittable*[n + 1];
+    std::string _aovStem;
 
-    _list[0] = new Sphere(Vec3(0.0f, -1000.0f, 0.0f), 1000.0f, new Lambertian(Vec3(0.5f, 0.5f, 0.5f)));
+    int _coordinatorPort = 0;
 
-    int i = 1;
+    std::string _workerAddress;
 
-    for (int a = -11; a < 11; ++a)
+    int _unitSamples = 0;
+
+    double _workerTimeout = 300.0;
+
+    bool _progressive = false;
+
+    bool _resume = false;
+
+    int _previewInterval = 0;
+
+    int _checkpointInterval = 8;
+
+    std::string _checkpointPath;
+
+    std::string _scenePath;
+
+    std::string _writeScenePath;
+
+    // Zero gives a pinhole camera; negative keeps the scene's own aperture.
+    float _aperture = -1.0f;
+
+    int _firstFrame = 0;
+
+    int _frameCount = 1;
+
+    _settings.m_iWidth = 1200;
+    _settings.m_iHeight = 800;
+    _settings.m_iSamples = 10;
+
+    for (int a = 1; a < argc; ++a)
     {
-        for (int b = -11; b < 11; ++b)
+        std::string _arg = argv[a];
+
+        const CommandOption* _option = s_oCommandLine.Find(_arg);
+
+        if (!_option || (_option->m_pValue && a + 1 >= argc))
+        {
+            std::cerr << (_option ? "Missing value for " : "Unknown option ") << _arg << "\n";
+            s_oCommandLine.PrintUsage(std::cerr, argv[0]);
+            return 1;
+        }
+
+        if (_arg == "--help")
+        {
+            s_oCommandLine.PrintUsage(std::cout, argv[0]);
+            return 0;
+        }
+
+        if (_arg == "--adaptive")
+        {
+            _settings.m_bAdaptive = true;
+            continue;
+        }
+
+        // Falls back to the CPU when there is no CUDA backend or device, or the scene needs one.
+        if (_arg == "--gpu")
+        {
+            _gpu = true;
+            continue;
+        }
+
+        if (_arg == "--progressive")
         {
-            float _chooseMat = (std::rand() / (RAND_MAX + 1.0));
+            _progressive = true;
+            continue;
+        }
+
+        if (_arg == "--resume")
+        {
+            _resume = true;
+            continue;
+        }
+
+        // Leaves emitters to be found by the bounces alone, for comparison.
+        if (_arg == "--no-nee")
+        {
+            _settings.m_bNextEvent = false;
+            continue;
+        }
 
-            Vec3 _center(a + 0.9f * (std::rand() / (RAND_MAX + 1.0)), 0.2f, b + 0.9f * (std::rand() / (RAND_MAX + 1.0)));
+        if (_arg == "--no-dither")
+        {
+            _toneMap.m_bDither = false;
+            continue;
+        }
 
-            if ((_center - Vec3(4.0f, 0.2f, 0.0f)).Length() > 0.9f)
+        // Numbers must be whole and in range; every other value is checked once all are read.
+        bool _valid = true;
+
+        if (_arg == "--width")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iWidth);
+        }
+        else if (_arg == "--height")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iHeight);
+        }
+        else if (_arg == "--samples")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iSamples);
+        }
+        else if (_arg == "--integrator")
+        {
+            _wavefront = std::string(argv[++a]) != "path";
+        }
+        else if (_arg == "--sampler")
+        {
+            _samplerName = argv[++a];
+        }
+        else if (_arg == "--max-depth")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iMaxDepth);
+        }
+        else if (_arg == "--rr-depth")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], INT_MIN, _settings.m_iRouletteDepth);
+        }
+        else if (_arg == "--min-samples")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iMinSamples);
+        }
+        else if (_arg == "--noise-threshold")
+        {
+            _valid = CommandLine::ParseFloat(argv[++a], 0.0f, _settings.m_fNoiseThreshold);
+        }
+        else if (_arg == "--tile-time-ms")
+        {
+            _valid = CommandLine::ParseDouble(argv[++a], 0.0, _settings.m_dTileTimeLimitMs);
+        }
+        else if (_arg == "--trace")
+        {
+            _tracePath = argv[++a];
+        }
+        else if (_arg == "--heatmap")
+        {
+            _heatmapPath = argv[++a];
+        }
+        else if (_arg == "--output")
+        {
+            _outputPath = argv[++a];
+        }
+        else if (_arg == "--format")
+        {
+            _formatName = argv[++a];
+        }
+        else if (_arg == "--preview-every")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 0, _previewInterval);
+        }
+        else if (_arg == "--checkpoint")
+        {
+            _checkpointPath = argv[++a];
+        }
+        else if (_arg == "--checkpoint-every")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 0, _checkpointInterval);
+        }
+        else if (_arg == "--scene")
+        {
+            _scenePath = argv[++a];
+        }
+        else if (_arg == "--write-scene")
+        {
+            _writeScenePath = argv[++a];
+        }
+        else if (_arg == "--frames")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _frameCount);
+        }
+        else if (_arg == "--first-frame")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 0, _firstFrame);
+        }
+        else if (_arg == "--aperture")
+        {
+            _valid = CommandLine::ParseFloat(argv[++a], 0.0f, _aperture);
+        }
+        else if (_arg == "--threads")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 0, _settings.m_iThreadCount);
+        }
+        else if (_arg == "--tile")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _settings.m_iTileSize);
+        }
+        else if (_arg == "--denoise")
+        {
+            _denoiserName = argv[++a];
+        }
+        else if (_arg == "--denoise-sigma")
+        {
+            _valid = CommandLine::ParseFloat(argv[++a], 0.0f, _denoise.m_fColorSigma);
+        }
+        else if (_arg == "--aovs")
+        {
+            _aovStem = argv[++a];
+        }
+        else if (_arg == "--exposure")
+        {
+            _valid = CommandLine::ParseFloat(argv[++a], -FLT_MAX, _toneMap.m_fExposure);
+        }
+        else if (_arg == "--tonemap")
+        {
+            _curveName = argv[++a];
+        }
+        else if (_arg == "--display")
+        {
+            _encodingName = argv[++a];
+        }
+        else if (_arg == "--hdr")
+        {
+            _hdrPath = argv[++a];
+        }
+        else if (_arg == "--retone")
+        {
+            _retonePath = argv[++a];
+        }
+        else if (_arg == "--coordinator")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 1, _coordinatorPort);
+        }
+        else if (_arg == "--worker")
+        {
+            _workerAddress = argv[++a];
+        }
+        else if (_arg == "--unit-samples")
+        {
+            _valid = CommandLine::ParseInt(argv[++a], 0, _unitSamples);
+        }
+        else if (_arg == "--worker-timeout")
+        {
+            _valid = CommandLine::ParseDouble(argv[++a], 0.0, _workerTimeout);
+        }
+
+        if (!_valid)
+        {
+            std::cerr << "Invalid value '" << argv[a] << "' for " << _arg << "\n";
+            s_oCommandLine.PrintUsage(std::cerr, argv[0]);
+            return 1;
+        }
+    }
+
+    ImageFormat _format = ImageWriter::FormatFromPath(_outputPath);
+
+    if (!_formatName.empty() && !ImageWriter::ParseFormat(_formatName, _format))
+    {
+        std::cerr << "Unknown image format '" << _formatName << "', expected ppm, ppm-ascii, png or pfm\n";
+        return 1;
+    }
+
+    if (!_curveName.empty() && !ToneMapper::ParseCurve(_curveName, _toneMap.m_eCurve))
+    {
+        std::cerr << "Unknown tone curve '" << _curveName << "', expected clamp, reinhard or aces\n";
+        return 1;
+    }
+
+    if (!_encodingName.empty() && !ToneMapper::ParseEncoding(_encodingName, _toneMap.m_eEncoding))
+    {
+        std::cerr << "Unknown display encoding '" << _encodingName << "', expected srgb or gamma2\n";
+        return 1;
+    }
+
+    // A new look for a finished render: only the post pipeline runs.
+    if (!_retonePath.empty())
+    {
+        FrameBuffer _stored(0, 0);
+
+        std::string _error;
+
+        if (!ImageReader::ReadPfm(_retonePath, _stored, _error))
+        {
+            std::cerr << "Could not read image: " << _error << "\n";
+            return 1;
+        }
+
+        if (!ImageWriter::Write(_stored, _outputPath, _format, _toneMap))
+        {
+            std::cerr << "Could not write image to " << _outputPath << "\n";
+            return 1;
+        }
+
+        std::cout << "Tone mapped " << _retonePath << " (" << ToneMapper::GetCurveName(_toneMap.m_eCurve) << ", " << _toneMap.m_fExposure << " stops, "
+                  << ToneMapper::GetEncodingName(_toneMap.m_eEncoding) << ") to " << _outputPath << "\n";
+        return 0;
+    }
+
+    if (!_samplerName.empty() && !Sampler::ParseType(_samplerName, _settings.m_eSampler))
+    {
+        std::cerr << "Unknown sampler '" << _samplerName << "', expected independent, stratified, sobol or bluenoise\n";
+        return 1;
+    }
+
+    if (!_denoiserName.empty() && !Denoiser::ParseType(_denoiserName, _denoise.m_eType))
+    {
+        std::cerr << "Unknown denoiser '" << _denoiserName << "', expected none, bilateral, atrous or oidn\n";
+        return 1;
+    }
+
+    if (!Denoiser::IsAvailable(_denoise.m_eType))
+    {
+        std::cerr << "This build has no Open Image Denoise; configure with -DRT_USE_OIDN=ON\n";
+        return 1;
+    }
+
+    bool _worker = !_workerAddress.empty();
+
+    bool _coordinator = _coordinatorPort > 0;
+
+    if (_worker && _coordinator)
+    {
+        std::cerr << "A node is either --coordinator or --worker\n";
+        return 1;
+    }
+
+    if (_coordinator && (_progressive || _resume || !_checkpointPath.empty()))
+    {
+        std::cerr << "Distributed renders cannot be progressive or checkpointed\n";
+        return 1;
+    }
+
+    if (_coordinator && _unitSamples > 0 && _settings.m_bAdaptive)
+    {
+        std::cerr << "Adaptive sampling is per tile and cannot be split into --unit-samples\n";
+        return 1;
+    }
+
+    RenderWorker _workerLink;
+
+    uint64_t _workerSceneKey = 0;
+
+    // A worker renders at the coordinator's settings; only its thread count is its own.
+    if (_worker)
+    {
+        size_t _colon = _workerAddress.find_last_of(':');
+
+        int _port = 0;
+
+        if (_colon == std::string::npos || _colon == 0 || !CommandLine::ParseInt(_workerAddress.c_str() + _colon + 1, 1, _port))
+        {
+            std::cerr << "--worker expects host:port\n";
+            return 1;
+        }
+
+        std::string _host = _workerAddress.substr(0, _colon);
+
+        int _threads = _settings.m_iThreadCount > 0 ? _settings.m_iThreadCount : std::max(int(std::thread::hardware_concurrency()), 1);
+
+        DistributedSession _session;
+
+        std::string _error;
+
+        if (!_workerLink.Connect(_host, _port, _threads, 30.0, _session, _error))
+        {
+            std::cerr << "Could not join the coordinator: " << _error << "\n";
+            return 1;
+        }
+
+        _session.m_oSettings.m_iThreadCount = _settings.m_iThreadCount;
+
+        _settings = _session.m_oSettings;
+        _wavefront = _session.m_bWavefront;
+        _aperture = _session.m_fAperture;
+        _workerSceneKey = _session.m_uSceneKey;
+
+        _progressive = false;
+        _frameCount = 1;
+        _firstFrame = 0;
+
+        std::cout << "Worker: joined " << _workerAddress << ", " << _settings.m_iWidth << "x" << _settings.m_iHeight << " at " << _settings.m_iSamples << " spp\n";
+    }
+
+    if (_progressive && _settings.m_bAdaptive)
+    {
+        std::cerr << "Adaptive sampling is per tile and cannot be split into passes; rendering progressively without it\n";
+        _settings.m_bAdaptive = false;
+    }
+
+    bool _sequence = _frameCount > 1;
+
+    if (_frameCount < 1)
+    {
+        std::cerr << "--frames needs at least one frame\n";
+        return 1;
+    }
+
+    if (_sequence && (_resume || !_checkpointPath.empty()))
+    {
+        std::cerr << "Checkpoints hold a single frame and cannot be used with --frames\n";
+        return 1;
+    }
+
+    int nx = _settings.m_iWidth;
+    int ny = _settings.m_iHeight;
+
+    if (!_tracePath.empty())
+    {
+        Tracer::Start();
+    }
+
+    // The pool, sampler and BVHs persist across frames and passes.
+    Renderer _renderer(_settings.m_iThreadCount);
+
+    Scene& _scene = _renderer.GetScene();
+
+    if (!_scenePath.empty())
+    {
+        std::string _error;
+
+        if (!_renderer.LoadScene(_scenePath, _error))
+        {
+            std::cerr << "Could not load scene: " << _error << "\n";
+            return 1;
+        }
+
+        std::cout << "Scene: " << _scene.GetSpheres().GetCount() << " spheres, " << _scene.GetMaterials().GetCount() << " materials, loaded in " << _scene.GetLoadTimeMs() << " ms"
+                  << (_scene.GetBvh() != nullptr ? " with a prebuilt BVH" : "") << "\n";
+    }
+    else
+    {
+        _renderer.BuildDefaultScene();
+    }
+
+    if (_aperture >= 0.0f)
+    {
+        _scene.GetCamera().m_fAperture = _aperture;
+    }
+
+    uint64_t _sceneKey = _scenePath.empty() ? 0 : HashFile(_scenePath);
+
+    if (_worker && _sceneKey != _workerSceneKey)
+    {
+        std::cerr << "This worker's scene is not the coordinator's; pass the same --scene file\n";
+        return 1;
+    }
+
+    if (!_writeScenePath.empty())
+    {
+        if ((_scene.GetInstanceCount() > 0 || _scene.HasMotion()) && !Scene::IsJsonPath(_writeScenePath))
+        {
+            std::cerr << "The scene cache cannot hold instances or moving spheres; write a .json file instead\n";
+            return 1;
+        }
+
+        if (!_scene.Save(_writeScenePath))
+        {
+            std::cerr << "Could not write scene to " << _writeScenePath << "\n";
+            return 1;
+        }
+
+        std::cout << "Wrote " << _writeScenePath << "\n";
+        return 0;
+    }
+
+    bool _prebuilt = _scene.GetBvh() != nullptr;
+
+    // The denoisers are guided by the AOVs, which are only kept when something uses them.
+    bool _aovs = _denoise.m_eType != DENOISER_NONE || !_aovStem.empty();
+
+    // Denoising is left to the frame loop, which writes the AOVs and previews first.
+    RenderRequest _request;
+
+    _request.m_oSettings = _settings;
+    _request.m_bWavefront = _wavefront;
+    _request.m_bGpu = _gpu;
+    _request.m_iFrame = _firstFrame;
+    _request.m_bAovs = _aovs;
+
+    _renderer.Prepare(_request);
+
+    const Bvh& _bvh = _renderer.GetWorld();
+
+    const LightList& _lights = _scene.GetLights();
+
+    if (_scene.GetInstanceCount() > 0)
+    {
+        std::cout << "Instances: " << _scene.GetInstanceCount() << " of " << _scene.GetObjectCount() << " objects, "
+                  << _scene.GetVisibleSphereCount() << " visible spheres from " << _scene.GetStoredSphereCount() << " stored, top level built in "
+                  << _scene.GetTopLevelBuildTimeMs() << " ms\n";
+    }
+
+    if (_scene.GetStoredTriangleCount() > 0)
+    {
+        std::cout << "Meshes: " << _scene.GetVisibleTriangleCount() << " visible triangles from " << _scene.GetStoredTriangleCount() << " stored in "
+                  << _scene.GetMeshMemoryBytes() / (1024.0 * 1024.0) << " MB, " << SimdIsaName(TriangleMesh::GetIsa()) << " triangle kernel\n";
+    }
+
+    if (!_lights.IsEmpty())
+    {
+        std::cout << "Lights: " << _lights.GetCount() << " emitters, " << (_settings.m_bNextEvent ? "sampled directly with MIS" : "found by bounces only") << "\n";
+    }
+
+    std::cout << "BVH: " << _bvh.GetNodeCount() << " nodes over " << (_scene.GetInstanceCount() > 0 ? "instances" : "spheres") << ", ";
+
+    if (_prebuilt)
+    {
+        std::cout << "prebuilt, ";
+    }
+    else
+    {
+        std::cout << "built in " << _bvh.GetBuildTimeMs() << " ms, ";
+    }
+
+    std::cout << SimdIsaName(SphereSoA::GetIsa()) << " sphere kernel\n";
+
+    if (_gpu)
+    {
+        std::cout << "GPU: " << (_renderer.IsUsingGpu() ? "rendering on " : "rendering on the CPU, ") << _renderer.GetGpuStatus() << "\n";
+    }
+
+    FrameBuffer _frameBuffer(nx, ny);
+
+    if (_aovs)
+    {
+        _frameBuffer.EnableAovs();
+    }
+
+    std::function<void(FrameBuffer&)> _renderPass = [&](FrameBuffer& a_oTarget)
+    {
+        RT_TRACE_SPAN("render pass");
+
+        _renderer.RenderTiles(_renderer.BuildTiles(), a_oTarget);
+    };
+
+    // What this node renders of a distributed frame; a worker follows the coordinator's frames.
+    TileBatchRenderer _renderBatch = [&](int a_iFrame, int a_iFirstSample, int a_iSampleCount, const std::vector<Tile>& a_oTiles, FrameBuffer& a_oTarget)
+    {
+        _renderer.SetFrame(a_iFrame);
+
+        _renderer.SetSampleRange(a_iFirstSample, a_iSampleCount);
+
+        _renderer.RenderTiles(a_oTiles, a_oTarget);
+    };
+
+    bool _written = true;
+
+    std::unique_ptr<RenderCoordinator> _distributed;
+
+    if (_coordinator)
+    {
+        DistributedSession _session;
+
+        _session.m_oSettings = _settings;
+        _session.m_bWavefront = _wavefront;
+        _session.m_fAperture = _aperture;
+        _session.m_uSceneKey = _sceneKey;
+
+        _distributed.reset(new RenderCoordinator(_session, _renderer.GetThreadCount()));
+
+        _distributed->SetUnitSamples(_unitSamples);
+        _distributed->SetTimeout(_workerTimeout);
+
+        _distributed->SetLog([](const std::string& a_sMessage)
+        {
+            std::cout << a_sMessage << "\n";
+        });
+
+        std::string _error;
+
+        if (!_distributed->Listen(_coordinatorPort, _error))
+        {
+            std::cerr << "Could not start the coordinator: " << _error << "\n";
+            return 1;
+        }
+
+        std::cout << "Coordinator: listening on port " << _coordinatorPort << "\n";
+    }
+
+    if (_worker)
+    {
+        std::string _error;
+
+        bool _served = _workerLink.Serve(_renderBatch, _error);
+
+        std::cout << "Worker: rendered " << _workerLink.GetUnitCount() << " tiles\n";
+
+        if (!_served)
+        {
+            std::cerr << "Worker stopped: " << _error << "\n";
+            _written = false;
+        }
+    }
+
+    // Only used progressively, but kept across frames like everything else.
+    std::unique_ptr<AccumulationBuffer> _accumulation;
+    std::unique_ptr<FrameBuffer> _pass;
+
+    if (_progressive)
+    {
+        _accumulation.reset(new AccumulationBuffer(nx, ny));
+        _pass.reset(new FrameBuffer(nx, ny));
+
+        if (_aovs)
+        {
+            _pass->EnableAovs();
+        }
+    }
+
+    // Filters _frameBuffer in place; the accumulated sums stay noisy for the next pass.
+    std::function<void()> _denoiseFrame = [&]()
+    {
+        std::string _error;
+
+        if (_denoise.m_eType != DENOISER_NONE && !Denoiser::Denoise(_frameBuffer, _frameBuffer, _denoise, _renderer.GetPool(), _error))
+        {
+            std::cerr << _error << "\n";
+        }
+    };
+
+    std::string _framePath = _outputPath;
+
+    // A worker has already rendered everything it was sent.
+    int _endFrame = _worker ? _firstFrame : _firstFrame + _frameCount;
+
+    // The buffers persist like the renderer's state; each frame only refits what moves.
+    for (int f = _firstFrame; f < _endFrame; ++f)
+    {
+        typedef std::chrono::high_resolution_clock Clock;
+
+        Clock::time_point _frameStart = Clock::now();
+
+        if (_sequence)
+        {
+            _renderer.SetFrame(f);
+
+            _request.m_iFrame = f;
+
+            _framePath = FramePath(_outputPath, f);
+        }
+
+        if (_distributed)
+        {
+            _distributed->RenderFrame(f, _renderer.BuildTiles(), _renderBatch, _frameBuffer);
+        }
+        else if (!_progressive)
+        {
+            std::string _error;
+
+            if (!_renderer.Render(_request, _frameBuffer, Renderer::TileCallback(), _error))
             {
-                if (_chooseMat < 0.8f)
+                std::cerr << "Could not render frame " << f << ": " << _error << "\n";
+                _written = false;
+            }
+        }
+        else
+        {
+            _accumulation->Clear();
+
+            if (_resume && !_checkpointPath.empty())
+            {
+                if (_accumulation->Load(_checkpointPath, _settings))
                 {
-                    _list[i++] = new Sphere(_center, 0.2f, new Lambertian(Vec3((std::rand() / (RAND_MAX + 1.0)) * (std::rand() / (RAND_MAX + 1.0)), (std::rand() / (RAND_MAX + 1.0)) * (std::rand() / (RAND_MAX + 1.0)), (std::rand() / (RAND_MAX + 1.0)) * (std::rand() / (RAND_MAX + 1.0)))));
+                    std::cout << "Resumed " << _checkpointPath << " after " << _accumulation->GetPassCount() << " passes\n";
                 }
-                else if (_chooseMat < 0.95f)
+                else
                 {
-                    _list[i++] = new Sphere(_center, 0.2f,
-                                            new Metal(Vec3(0.5f * (1.0f + (std::rand() / (RAND_MAX + 1.0))), 0.5f * (1.0f + (std::rand() / (RAND_MAX + 1.0))), 0.5f * (1.0f + (std::rand() / (RAND_MAX + 1.0)))), 0.5f * (std::rand() / (RAND_MAX + 1.0))));
+                    std::cout << "No usable checkpoint at " << _checkpointPath << ", starting from the first pass\n";
                 }
-                else
+            }
+
+            for (int p = _accumulation->GetPassCount(); p < _settings.m_iSamples; ++p)
+            {
+                _renderer.SetSampleRange(p, 1);
+
+                _renderPass(*_pass);
+
+                _accumulation->Add(*_pass);
+
+                int _done = p + 1;
+
+                bool _last = _done == _settings.m_iSamples;
+
+                if (_previewInterval > 0 && _done % _previewInterval == 0 && !_last)
                 {
-                    _list[i++] = new Sphere(_center, 0.2f, new Dielectric(1.5f));
+                    _accumulation->Resolve(_frameBuffer);
+
+                    _denoiseFrame();
+
+                    ImageWriter::Write(_frameBuffer, _framePath, _format, _toneMap);
+                }
+
+                if (!_checkpointPath.empty() && ((_checkpointInterval > 0 && _done % _checkpointInterval == 0) || _last))
+                {
+                    if (!_accumulation->Save(_checkpointPath, _settings))
+                    {
+                        std::cerr << "Could not write checkpoint to " << _checkpointPath << "\n";
+                    }
                 }
             }
+
+            _accumulation->Resolve(_frameBuffer);
         }
-    }
 
-    _list[i++] = new Sphere(Vec3(0.0f, 1.0f, 0.0f), 1.0f , new Dielectric(1.5f));
-    _list[i++] = new Sphere(Vec3(-4.0f, 1.0f, 0.0f), 1.0f, new Lambertian(Vec3(0.4f, 0.2f, 0.1f)));
-    _list[i++] = new Sphere(Vec3(4.0f, 1.0f, 0.0f), 1.0f, new Metal(Vec3(0.7f, 0.6f, 0.5f), 0.0f));
+        if (!_aovStem.empty() && !WriteAovs(_frameBuffer, _aovStem, _sequence, f))
+        {
+            _written = false;
+        }
 
-    return new HittableList(_list, i);
-}
+        _denoiseFrame();
 
-int main(int argc, char const *argv[])
-{
-    int nx = 1200;
-    int ny = 800;
-    int ns = 10;
+        if (!_heatmapPath.empty())
+        {
+            std::string _heatmapFramePath = _sequence ? FramePath(_heatmapPath, f) : _heatmapPath;
 
-    std::fstream _outputFile;
+            std::vector<unsigned char> _heatmap;
 
-    _outputFile.open("C:\\Raycasting\\Ray-Casting\\raw-texture.ppm");
+            _frameBuffer.SampleHeatmapToRgb8(_heatmap);
 
-    std::string _head = "P3\n" + std::to_string(nx) + " " + std::to_string(ny) + "\n255\n";
+            ImageFormat _heatmapFormat = ImageWriter::FormatFromPath(_heatmapFramePath);
 
-    _outputFile << _head;
+            if (_heatmapFormat == IMAGE_FORMAT_PFM || !ImageWriter::WriteRgb8(&_heatmap[0], nx, ny, _heatmapFramePath, _heatmapFormat))
+            {
+                std::cerr << "Could not write heatmap to " << _heatmapFramePath << "\n";
+            }
+        }
 
-    Hittable* _list[5];
+        bool _frameWritten = ImageWriter::Write(_frameBuffer, _framePath, _format, _toneMap);
 
-    float _r = cos(M_PI / 4);
+        if (!_hdrPath.empty())
+        {
+            std::string _hdrFramePath = _sequence ? FramePath(_hdrPath, f) : _hdrPath;
 
-    _list[0] = new Sphere(Vec3(0.0f, 0.0f, -1.0f), 0.5f, new Lambertian(Vec3(0.1f, 0.2f, 0.5f)));
-    _list[1] = new Sphere(Vec3(0.0f, -100.5f, -1.0f), 100, new Lambertian(Vec3(0.8f, 0.8f, 0.0f)));
-    _list[2] = new Sphere(Vec3(1.0f, 0.0f, -1.0f), 0.5f, new Metal(Vec3(0.8f, 0.6f, 0.2f), 0.0));
-    _list[3] = new Sphere(Vec3(-1.0f, 0.0f, -1.0f), 0.5f, new Dielectric(1.5f));
-    _list[3] = new Sphere(Vec3(-1.0f, 0.0f, -1.0f), -0.45f, new Dielectric(1.5f));
+            if (!ImageWriter::Write(_frameBuffer, _hdrFramePath, IMAGE_FORMAT_PFM))
+            {
+                std::cerr << "Could not write HDR image to " << _hdrFramePath << "\n";
+                _written = false;
+            }
+        }
 
-    Hittable* _world = RandomScene();
+        if (!_frameWritten)
+        {
+            std::cerr << "Could not write image to " << _framePath << "\n";
+            _written = false;
+        }
 
-    Vec3 _lookFrom(13.0f, 2.0f, 3.0f);
-    Vec3 _lookAt(0.0f, 0.0f, 0.0f);
-    float _distToFocus = 10.0f;
-    float _aperture = 0.1f;
+        if (_sequence && _frameWritten)
+        {
+            std::chrono::duration<double, std::milli> _frameTime = Clock::now() - _frameStart;
 
-    Camera _camera(_lookFrom, _lookAt, Vec3(0.0f, 1.0f, 0.0f), 20.0f, float(nx) / float(ny), _aperture, _distToFocus);
+            std::cout << "Frame " << f << ": refit in " << _scene.GetRefitTimeMs() << " ms" << (_scene.GetRebuildCount() > 0 ? " with a rebuild" : "") << ", "
+                      << _frameTime.count() << " ms in total, wrote " << _framePath << "\n";
+        }
+    }
 
-    for (int j = ny - 1; j >= 0; --j)
+    if (_distributed)
     {
-        for (int i = 0; i < nx; ++i)
+        _distributed->Stop();
+
+        DistributedStats _distributedStats = _distributed->GetStats();
+
+        std::cout << "Distributed: " << _distributedStats.m_iWorkersJoined << " workers joined, " << _distributedStats.m_iWorkersLost << " lost, "
+                  << _distributedStats.m_uRemoteUnits << " units rendered remotely and " << _distributedStats.m_uLocalUnits << " locally, "
+                  << _distributedStats.m_uReissuedUnits << " reissued\n";
+    }
+
+    PathStats _pathStats = GetPathStats();
+
+    if (_pathStats.m_uPaths > 0)
+    {
+        std::cout << "Paths: " << _pathStats.m_uPaths << ", "
+                  << double(_pathStats.m_uSegments) / _pathStats.m_uPaths << " rays per sample on average, "
+                  << _pathStats.m_uRouletteKills << " ended by Russian roulette\n";
+
+        if (_pathStats.m_uShadowRays > 0)
         {
-            Vec3 _col(0.0f, 0.0f, 0.0f);
+            std::cout << "Shadow rays: " << _pathStats.m_uShadowRays << ", "
+                      << 100.0 * _pathStats.m_uShadowRaysOccluded / _pathStats.m_uShadowRays << "% occluded\n";
+        }
+    }
 
-            for (int s = 0; s < ns; ++s)
-            {
-                float _u = float(i + (std::rand() / (RAND_MAX + 1.0))) / float(nx);
-                float _v = float(j + (std::rand() / (RAND_MAX + 1.0))) / float(ny);
+    BvhTraversalStats _stats = Bvh::GetTraversalStats();
 
-                Ray _ray = _camera.GetRay(_u, _v);
+    if (_stats.m_uRays > 0)
+    {
+        std::cout << "BVH traversal: " << _stats.m_uRays << " rays, "
+                  << double(_stats.m_uNodesVisited) / _stats.m_uRays << " nodes/ray, "
+                  << double(_stats.m_uPrimitiveTests) / _stats.m_uRays << " primitive tests/ray\n";
+    }
+
+    CounterBlock _counters = Counters::Sum();
+
+    const uint64_t* _count = _counters.m_uValues;
+
+    if (_count[COUNTER_TILES] > 0)
+    {
+        std::cout << "Shading: " << _count[COUNTER_HITS_LAMBERTIAN] << " lambertian, "
+                  << _count[COUNTER_HITS_METAL] << " metal, "
+                  << _count[COUNTER_HITS_DIELECTRIC] << " dielectric, "
+                  << _count[COUNTER_HITS_EMISSIVE] << " emissive hits, "
+                  << 100.0 * _count[COUNTER_DIELECTRIC_TOTAL_INTERNAL_REFLECTIONS] / std::max<uint64_t>(_count[COUNTER_HITS_DIELECTRIC], 1) << "% of dielectric hits totally internally reflected\n"
+                  << "Tiles: " << _count[COUNTER_TILES] << ", "
+                  << 1e-6 * _count[COUNTER_TILE_NANOSECONDS] / _count[COUNTER_TILES] << " ms per tile on average\n";
+    }
 
-                Vec3 _p = _ray.PointAtParamenter(2.0f);
+    if (_settings.m_bAdaptive)
+    {
+        double _totalSamples = 0.0;
 
-                _col += Color(_ray, _world, 0);
+        for (int j = 0; j < ny; ++j)
+        {
+            for (int i = 0; i < nx; ++i)
+            {
+                _totalSamples += _frameBuffer.GetSampleCount(i, j);
             }
-            _col /= float(ns);
-            _col = Vec3(sqrtf(_col[0]), sqrtf(_col[1]), sqrtf(_col[2]));
+        }
+
+        std::cout << "Adaptive sampling: " << _totalSamples / (double(nx) * ny) << " samples per pixel on average (cap " << _settings.m_iSamples << ")\n";
+    }
 
-            int ir = int(255.99 * _col[0]);
-            int ig = int(255.99 * _col[1]);
-            int ib = int(255.99 * _col[2]);
 
-            //std::cout << ir << " " << ig << " " << ib << "\n";
-            std::string _row = std::to_string(ir) + " " + std::to_string(ig) + " " + std::to_string(ib) + "\n";
-            _outputFile << _row;
+    if (!_tracePath.empty())
+    {
+        Tracer::Stop();
+
+        if (!Tracer::Write(_tracePath))
+        {
+            std::cerr << "Could not write trace to " << _tracePath << "\n";
         }
     }
-    _outputFile.close();
+
+    if (!_written)
+    {
+        return 1;
+    }
+
     return 0;
 }
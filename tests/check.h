@@ -0,0 +1,28 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+// Shared by the test programs under ctest: RT_CHECK reports a failed condition and carries
+// on, so one run lists every failure, and main() returns CheckFailures() as its status.
+inline int& CheckFailures()
+{
+    static int s_iFailures = 0;
+
+    return s_iFailures;
+}
+
+#define RT_CHECK(a_bCondition)                                                                  \
+    do                                                                                          \
+    {                                                                                           \
+        if (!(a_bCondition))                                                                    \
+        {                                                                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #a_bCondition "\n";  \
+            ++CheckFailures();                                                                  \
+        }                                                                                       \
+    } while (0)
+
+// ctest counts a test that exits with this as skipped, e.g. for an ISA the CPU lacks.
+const int s_ciSkipped = 77;
+
+#endif // CHECK_H
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/accumulationbuffer.h"
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+
+// A progressive render saved partway and resumed in a fresh process state must finish with
+// the image of an uninterrupted one, and a checkpoint that does not fit must be refused.
+namespace
+{
+    const int s_ciWidth = 48;
+    const int s_ciHeight = 32;
+
+    const int s_ciPasses = 8;
+    const int s_ciSavedPasses = 3;
+
+    RenderRequest Request()
+    {
+        RenderRequest _request;
+
+        _request.m_oSettings.m_iWidth = s_ciWidth;
+        _request.m_oSettings.m_iHeight = s_ciHeight;
+        _request.m_oSettings.m_iSamples = s_ciPasses;
+        _request.m_oSettings.m_eSampler = SAMPLER_SOBOL;
+        _request.m_bWavefront = true;
+
+        return _request;
+    }
+
+    // Passes [a_iFirst, a_iEnd), one sample per pixel each, as --progressive renders them.
+    void RenderPasses(Renderer& a_oRenderer, int a_iFirst, int a_iEnd, AccumulationBuffer& a_oAccumulation)
+    {
+        FrameBuffer _pass(s_ciWidth, s_ciHeight);
+
+        for (int p = a_iFirst; p < a_iEnd; ++p)
+        {
+            a_oRenderer.SetSampleRange(p, 1);
+
+            a_oRenderer.RenderTiles(a_oRenderer.BuildTiles(), _pass);
+
+            a_oAccumulation.Add(_pass);
+        }
+    }
+}
+
+int main()
+{
+    const std::string _path = "checkpoint.bin";
+
+    const RenderRequest _request = Request();
+
+    FrameBuffer _uninterrupted(s_ciWidth, s_ciHeight);
+
+    {
+        Renderer _renderer;
+
+        _renderer.BuildDefaultScene();
+        _renderer.Prepare(_request);
+
+        AccumulationBuffer _accumulation(s_ciWidth, s_ciHeight);
+
+        RenderPasses(_renderer, 0, s_ciPasses, _accumulation);
+
+        _accumulation.Resolve(_uninterrupted);
+    }
+
+    {
+        Renderer _renderer;
+
+        _renderer.BuildDefaultScene();
+        _renderer.Prepare(_request);
+
+        AccumulationBuffer _accumulation(s_ciWidth, s_ciHeight);
+
+        RenderPasses(_renderer, 0, s_ciSavedPasses, _accumulation);
+
+        RT_CHECK(_accumulation.Save(_path, _request.m_oSettings));
+    }
+
+    FrameBuffer _resumed(s_ciWidth, s_ciHeight);
+
+    {
+        Renderer _renderer;
+
+        _renderer.BuildDefaultScene();
+        _renderer.Prepare(_request);
+
+        AccumulationBuffer _accumulation(s_ciWidth, s_ciHeight);
+
+        RT_CHECK(_accumulation.Load(_path, _request.m_oSettings));
+        RT_CHECK(_accumulation.GetPassCount() == s_ciSavedPasses);
+
+        RenderPasses(_renderer, _accumulation.GetPassCount(), s_ciPasses, _accumulation);
+
+        _accumulation.Resolve(_resumed);
+    }
+
+    int _differing = 0;
+
+    for (int j = 0; j < s_ciHeight; ++j)
+    {
+        for (int i = 0; i < s_ciWidth; ++i)
+        {
+            const Vec3& _a = _uninterrupted.GetPixel(i, j);
+            const Vec3& _b = _resumed.GetPixel(i, j);
+
+            bool _same = _a[0] == _b[0] && _a[1] == _b[1] && _a[2] == _b[2] && _uninterrupted.GetSampleCount(i, j) == _resumed.GetSampleCount(i, j);
+
+            _differing += _same ? 0 : 1;
+        }
+    }
+
+    if (_differing > 0)
+    {
+        std::cerr << _differing << " pixels of the resumed render differ from the uninterrupted one\n";
+        ++CheckFailures();
+    }
+
+    // Settings that change what a sample is.
+    RenderSettings _deeper = _request.m_oSettings;
+
+    _deeper.m_iMaxDepth += 1;
+
+    RenderSettings _sampler = _request.m_oSettings;
+
+    _sampler.m_eSampler = SAMPLER_INDEPENDENT;
+
+    AccumulationBuffer _other(s_ciWidth, s_ciHeight);
+
+    RT_CHECK(!_other.Load(_path, _deeper));
+    RT_CHECK(!_other.Load(_path, _sampler));
+
+    AccumulationBuffer _smaller(s_ciWidth - 1, s_ciHeight);
+
+    RT_CHECK(!_smaller.Load(_path, _request.m_oSettings));
+
+    RT_CHECK(!_other.Load("missing-checkpoint.bin", _request.m_oSettings));
+
+    // Cut short, as by a crash outside Save()'s rename.
+    std::vector<char> _bytes;
+
+    {
+        std::ifstream _in(_path.c_str(), std::ios::binary);
+
+        _bytes.assign(std::istreambuf_iterator<char>(_in), std::istreambuf_iterator<char>());
+    }
+
+    RT_CHECK(!_bytes.empty());
+
+    const std::string _cutPath = "checkpoint-cut.bin";
+
+    {
+        std::ofstream _out(_cutPath.c_str(), std::ios::binary);
+
+        _out.write(&_bytes[0], std::streamsize(_bytes.size() / 2));
+    }
+
+    RT_CHECK(!_other.Load(_cutPath, _request.m_oSettings));
+    RT_CHECK(_other.GetPassCount() == 0);
+
+    remove(_path.c_str());
+    remove(_cutPath.c_str());
+
+    return CheckFailures();
+}
@@ -0,0 +1,58 @@
+#include <limits.h>
+#include <sstream>
+#include <string>
+#include "appsrc/include/IO/commandline.h"
+#include "tests/check.h"
+
+// Option values are whole numbers in range or refused, and a refused one leaves the
+// setting as it was.
+int main()
+{
+    int _int = 7;
+
+    RT_CHECK(CommandLine::ParseInt("120", 1, _int) && _int == 120);
+    RT_CHECK(CommandLine::ParseInt("-4", INT_MIN, _int) && _int == -4);
+    RT_CHECK(CommandLine::ParseInt("0", 0, _int) && _int == 0);
+
+    const char* _badInts[] = { "", "abc", "12x", "1.5", "0", "-3", " ", "99999999999" };
+
+    for (int b = 0; b < int(sizeof(_badInts) / sizeof(_badInts[0])); ++b)
+    {
+        _int = 7;
+
+        RT_CHECK(!CommandLine::ParseInt(_badInts[b], 1, _int) && _int == 7);
+    }
+
+    float _float = 2.0f;
+
+    RT_CHECK(CommandLine::ParseFloat("0.25", 0.0f, _float) && _float == 0.25f);
+    RT_CHECK(CommandLine::ParseFloat("-1.5", -10.0f, _float) && _float == -1.5f);
+
+    const char* _badFloats[] = { "", "x", "0.5s", "-0.1", "nan", "inf", "1e60" };
+
+    for (int b = 0; b < int(sizeof(_badFloats) / sizeof(_badFloats[0])); ++b)
+    {
+        _float = 2.0f;
+
+        RT_CHECK(!CommandLine::ParseFloat(_badFloats[b], 0.0f, _float) && _float == 2.0f);
+    }
+
+    const CommandOption _options[] =
+    {
+        { "--help", nullptr, "print this text" },
+        { "--width", "N", "image width in pixels" }
+    };
+
+    CommandLine _line(_options);
+
+    RT_CHECK(_line.Find("--width") == &_options[1]);
+    RT_CHECK(_line.Find("--widht") == nullptr);
+
+    std::ostringstream _usage;
+
+    _line.PrintUsage(_usage, "prog");
+
+    RT_CHECK(_usage.str() == "Usage: prog [options]\n  --help     print this text\n  --width N  image width in pixels\n");
+
+    return CheckFailures();
+}
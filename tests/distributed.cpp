@@ -0,0 +1,167 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include "appsrc/include/Render/distributed.h"
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+
+// A frame shared between the coordinator and a worker on the loopback, each tile taken as
+// one range of samples, must be bit-identical to the same frame rendered locally.
+namespace
+{
+    const int s_ciWidth = 96;
+    const int s_ciHeight = 64;
+
+    // Tried in turn, so a port left in use by another run does not fail the test.
+    const int s_ciFirstPort = 47310;
+    const int s_ciPortAttempts = 20;
+
+    RenderSettings Settings()
+    {
+        RenderSettings _settings;
+
+        _settings.m_iWidth = s_ciWidth;
+        _settings.m_iHeight = s_ciHeight;
+        _settings.m_iSamples = 4;
+        _settings.m_iTileSize = 16;
+        _settings.m_iThreadCount = 1;
+
+        return _settings;
+    }
+
+    // What main.cpp renders a distributed batch with, on either end.
+    TileBatchRenderer BatchRenderer(Renderer& a_oRenderer)
+    {
+        return [&a_oRenderer](int a_iFrame, int a_iFirstSample, int a_iSampleCount, const std::vector<Tile>& a_oTiles, FrameBuffer& a_oTarget)
+        {
+            a_oRenderer.SetFrame(a_iFrame);
+
+            a_oRenderer.SetSampleRange(a_iFirstSample, a_iSampleCount);
+
+            a_oRenderer.RenderTiles(a_oTiles, a_oTarget);
+        };
+    }
+}
+
+int main()
+{
+    RenderRequest _request;
+
+    _request.m_oSettings = Settings();
+    _request.m_bWavefront = true;
+
+    std::string _error;
+
+    FrameBuffer _local(s_ciWidth, s_ciHeight);
+
+    {
+        Renderer _renderer(1);
+
+        _renderer.BuildDefaultScene();
+
+        RT_CHECK(_renderer.Render(_request, _local, Renderer::TileCallback(), _error));
+    }
+
+    DistributedSession _session;
+
+    _session.m_oSettings = _request.m_oSettings;
+    _session.m_bWavefront = true;
+
+    RenderCoordinator _coordinator(_session, 1);
+
+    int _port = 0;
+
+    for (int p = 0; p < s_ciPortAttempts && _port == 0; ++p)
+    {
+        if (_coordinator.Listen(s_ciFirstPort + p, _error))
+        {
+            _port = s_ciFirstPort + p;
+        }
+    }
+
+    RT_CHECK(_port != 0);
+
+    if (_port == 0)
+    {
+        std::cerr << "no port to listen on: " << _error << "\n";
+        return CheckFailures();
+    }
+
+    bool _served = false;
+
+    std::thread _worker([&]()
+    {
+        RenderWorker _link;
+
+        DistributedSession _joined;
+
+        std::string _workerError;
+
+        if (!_link.Connect("127.0.0.1", _port, 2, 10.0, _joined, _workerError))
+        {
+            std::cerr << "the worker could not join: " << _workerError << "\n";
+            return;
+        }
+
+        Renderer _renderer(2);
+
+        _renderer.BuildDefaultScene();
+
+        RenderRequest _workerRequest;
+
+        _workerRequest.m_oSettings = _joined.m_oSettings;
+        _workerRequest.m_bWavefront = _joined.m_bWavefront;
+
+        _renderer.Prepare(_workerRequest);
+
+        _served = _link.Serve(BatchRenderer(_renderer), _workerError);
+    });
+
+    // Otherwise the coordinator could finish the frame alone.
+    for (int w = 0; w < 1000 && _coordinator.GetWorkerCount() == 0; ++w)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    RT_CHECK(_coordinator.GetWorkerCount() == 1);
+
+    Renderer _renderer(1);
+
+    _renderer.BuildDefaultScene();
+    _renderer.Prepare(_request);
+
+    FrameBuffer _shared(s_ciWidth, s_ciHeight);
+
+    _coordinator.RenderFrame(0, _renderer.BuildTiles(), BatchRenderer(_renderer), _shared);
+
+    DistributedStats _stats = _coordinator.GetStats();
+
+    _coordinator.Stop();
+
+    _worker.join();
+
+    RT_CHECK(_served);
+    RT_CHECK(_stats.m_uRemoteUnits > 0);
+
+    int _differing = 0;
+
+    for (int j = 0; j < s_ciHeight; ++j)
+    {
+        for (int i = 0; i < s_ciWidth; ++i)
+        {
+            const Vec3& _a = _local.GetPixel(i, j);
+            const Vec3& _b = _shared.GetPixel(i, j);
+
+            _differing += _a[0] == _b[0] && _a[1] == _b[1] && _a[2] == _b[2] && _local.GetSampleCount(i, j) == _shared.GetSampleCount(i, j) ? 0 : 1;
+        }
+    }
+
+    if (_differing > 0)
+    {
+        std::cerr << _differing << " pixels of the distributed frame differ from the local render (" << _stats.m_uLocalUnits << " local, "
+                  << _stats.m_uRemoteUnits << " remote units)\n";
+        ++CheckFailures();
+    }
+
+    return CheckFailures();
+}
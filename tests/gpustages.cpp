@@ -0,0 +1,232 @@
+#include <math.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/gpukernel.h"
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+
+// Runs the path stages of gpukernel.h on the host over the scene GpuRenderer packs for the
+// device, and compares every pixel and AOV with the CPU wavefront render of the same
+// request. Builds without the CUDA backend check the kernels this way too, and trees too
+// deep for the kernels' stack must be left to the CPU.
+namespace
+{
+    const int s_ciWidth = 80;
+    const int s_ciHeight = 50;
+
+    const float s_cfTolerance = 1e-4f;
+
+    // A sphere lamp and a small lit sphere over a floor, for next event estimation.
+    bool WriteLampScene(const std::string& a_sPath)
+    {
+        std::ofstream _file(a_sPath.c_str());
+
+        _file << "{\"camera\": {\"look_from\": [0, 3, 10], \"look_at\": [0, 1, 0], \"fov\": 35},\n"
+              << " \"background\": [0.05, 0.05, 0.08],\n"
+              << " \"materials\": [{\"name\": \"floor\", \"type\": \"lambertian\", \"albedo\": [0.6, 0.6, 0.6]},\n"
+              << "               {\"name\": \"glass\", \"type\": \"dielectric\", \"ior\": 1.5},\n"
+              << "               {\"name\": \"lamp\", \"type\": \"emissive\", \"emission\": [6, 5, 4]}],\n"
+              << " \"spheres\": [{\"center\": [0, -1000, 0], \"radius\": 1000, \"material\": \"floor\"},\n"
+              << "             {\"center\": [0, 1, 0], \"radius\": 1, \"material\": \"glass\"},\n"
+              << "             {\"center\": [-1.5, 0.5, 1.5], \"radius\": 0.5, \"material\": \"floor\"},\n"
+              << "             {\"center\": [2, 4, 1], \"radius\": 1.2, \"material\": \"lamp\"}]}\n";
+
+        return bool(_file);
+    }
+
+    GpuScene View(const GpuSceneData& a_oData)
+    {
+        GpuScene _scene = GpuScene();
+
+        _scene.m_pNodes = a_oData.m_oNodes.data();
+        _scene.m_iNodeCount = int32_t(a_oData.m_oNodes.size());
+
+        _scene.m_pCenterX = a_oData.m_oCenterX.data();
+        _scene.m_pCenterY = a_oData.m_oCenterY.data();
+        _scene.m_pCenterZ = a_oData.m_oCenterZ.data();
+        _scene.m_pRadius = a_oData.m_oRadius.data();
+        _scene.m_pMaterialId = a_oData.m_oMaterialIds.data();
+
+        if (!a_oData.m_oVelocityX.empty())
+        {
+            _scene.m_pVelocityX = a_oData.m_oVelocityX.data();
+            _scene.m_pVelocityY = a_oData.m_oVelocityY.data();
+            _scene.m_pVelocityZ = a_oData.m_oVelocityZ.data();
+        }
+
+        _scene.m_pMaterials = a_oData.m_oMaterials.data();
+
+        _scene.m_pLights = a_oData.m_oLights.data();
+        _scene.m_iLightCount = int32_t(a_oData.m_oLights.size());
+        _scene.m_fTotalPower = a_oData.m_fTotalPower;
+
+        _scene.m_pSpheresByMaterial = a_oData.m_oSpheresByMaterial.data();
+        _scene.m_iSphereLightCount = int32_t(a_oData.m_oSpheresByMaterial.size());
+
+        _scene.m_oBackground = a_oData.m_oBackground;
+        _scene.m_bBackground = a_oData.m_bBackground;
+
+        return _scene;
+    }
+
+    float Difference(const Vec3& a_oA, const GpuVec3& a_oB)
+    {
+        return fabsf(a_oA[0] - a_oB.m_fX) + fabsf(a_oA[1] - a_oB.m_fY) + fabsf(a_oA[2] - a_oB.m_fZ);
+    }
+
+    void Compare(const char* a_pName, Renderer& a_oRenderer, SamplerType a_eSampler)
+    {
+        RenderRequest _request;
+
+        _request.m_oSettings.m_iWidth = s_ciWidth;
+        _request.m_oSettings.m_iHeight = s_ciHeight;
+        _request.m_oSettings.m_iSamples = 4;
+        _request.m_oSettings.m_eSampler = a_eSampler;
+        _request.m_bWavefront = true;
+        _request.m_bAovs = true;
+
+        std::string _error;
+
+        FrameBuffer _cpu(s_ciWidth, s_ciHeight);
+
+        RT_CHECK(a_oRenderer.Render(_request, _cpu, Renderer::TileCallback(), _error));
+
+        std::string _reason;
+
+        if (!GpuRenderer::Supports(a_oRenderer.GetWorld(), a_oRenderer.GetSettings(), _reason))
+        {
+            std::cerr << a_pName << ": the GPU path turns the scene down: " << _reason << "\n";
+            ++CheckFailures();
+            return;
+        }
+
+        const Scene& _scene = a_oRenderer.GetScene();
+
+        GpuSceneData _data;
+
+        GpuRenderer::PackScene(a_oRenderer.GetWorld(), _scene.GetMaterials(), _scene.GetLights(), _data);
+
+        GpuScene _view = View(_data);
+
+        std::unique_ptr<Sampler> _sampler = Sampler::Create(a_eSampler, _request.m_oSettings.m_iSamples);
+
+        GpuFrame _frame = GpuRenderer::PackFrame(a_oRenderer.GetSettings(), a_oRenderer.GetCamera(), *_sampler, !_scene.GetLights().IsEmpty(), true);
+
+        int _differing = 0;
+        float _worst = 0.0f;
+
+        for (int y = 0; y < s_ciHeight; ++y)
+        {
+            for (int x = 0; x < s_ciWidth; ++x)
+            {
+                GpuPixelSum _sum = GpuPixelSum();
+
+                for (int s = 0; s < _request.m_oSettings.m_iSamples; ++s)
+                {
+                    GpuPath _path;
+
+                    GpuStartPath(_frame, x, y, s, _path);
+
+                    while (GpuExtend(_view, _frame, _path) >= 0 && GpuShade(_view, _frame, _path))
+                    {
+                    }
+
+                    GpuAccumulate(_frame, _path, _sum);
+                }
+
+                float _scale = 1.0f / float(_sum.m_iCount);
+
+                GpuVec3 _color = MakeGpuVec3(_sum.m_oRadiance.m_fX * _scale, _sum.m_oRadiance.m_fY * _scale, _sum.m_oRadiance.m_fZ * _scale);
+                GpuVec3 _albedo = MakeGpuVec3(_sum.m_oAlbedo.m_fX * _scale, _sum.m_oAlbedo.m_fY * _scale, _sum.m_oAlbedo.m_fZ * _scale);
+                GpuVec3 _normal = MakeGpuVec3(_sum.m_oNormal.m_fX * _scale, _sum.m_oNormal.m_fY * _scale, _sum.m_oNormal.m_fZ * _scale);
+
+                const SampleAovs& _aovs = _cpu.GetAovs(x, y);
+
+                float _gap = Difference(_cpu.GetPixel(x, y), _color) + Difference(_aovs.m_oAlbedo, _albedo) + Difference(_aovs.m_oNormal, _normal)
+                             + fabsf(_aovs.m_fDepth - _sum.m_fDepth * _scale);
+
+                _differing += _gap > s_cfTolerance ? 1 : 0;
+                _worst = _gap > _worst ? _gap : _worst;
+            }
+        }
+
+        if (_differing > 0)
+        {
+            std::cerr << a_pName << " with " << Sampler::GetTypeName(a_eSampler) << ": " << _differing << " pixels differ, by up to " << _worst << "\n";
+            ++CheckFailures();
+        }
+    }
+
+    // Supports() for a comb of a_iLevels interior nodes, each with a leaf on its left, which
+    // GpuIntersect() needs a_iLevels stack entries for.
+    bool SupportsComb(int a_iLevels)
+    {
+        SphereSoA _spheres;
+
+        for (int s = 0; s <= a_iLevels; ++s)
+        {
+            _spheres.Add(Vec3(float(s), 0.0f, 0.0f), 0.4f, 0);
+        }
+
+        std::vector<BvhNode> _nodes(2 * a_iLevels + 1);
+
+        for (size_t n = 0; n < _nodes.size(); ++n)
+        {
+            BvhNode& _node = _nodes[n];
+
+            int _first = int(n / 2);
+
+            _node.m_fMin[0] = float(_first) - 0.4f;
+            _node.m_fMax[0] = n % 2 ? float(_first) + 0.4f : float(a_iLevels) + 0.4f;
+
+            for (int a = 1; a < 3; ++a)
+            {
+                _node.m_fMin[a] = -0.4f;
+                _node.m_fMax[a] = 0.4f;
+            }
+
+            bool _leaf = n % 2 || int(n) == 2 * a_iLevels;
+
+            _node.m_uOffset = _leaf ? uint32_t(_first) : uint32_t(n + 2);
+            _node.m_uCount = _leaf ? 1 : 0;
+            _node.m_uAxis = 0;
+            _node.m_uPad = 0;
+        }
+
+        Bvh _world(&_nodes[0], int(_nodes.size()), _spheres);
+
+        std::string _reason;
+
+        return GpuRenderer::Supports(_world, RenderSettings(), _reason);
+    }
+}
+
+int main()
+{
+    RT_CHECK(SupportsComb(GpuLimits::STACK_SIZE));
+    RT_CHECK(!SupportsComb(GpuLimits::STACK_SIZE + 1));
+
+    const std::string _lampPath = "gpustages.json";
+
+    RT_CHECK(WriteLampScene(_lampPath));
+
+    Renderer _cover;
+
+    _cover.BuildDefaultScene();
+
+    Renderer _lamp;
+
+    std::string _error;
+
+    RT_CHECK(_lamp.LoadScene(_lampPath, _error));
+
+    for (int t = 0; t < SAMPLER_TYPE_COUNT; ++t)
+    {
+        Compare("cover scene", _cover, SamplerType(t));
+        Compare("lamp scene", _lamp, SamplerType(t));
+    }
+
+    return CheckFailures();
+}
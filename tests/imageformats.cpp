@@ -0,0 +1,551 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "appsrc/include/IO/imagereader.h"
+#include "appsrc/include/IO/imagewriter.h"
+#include "tests/check.h"
+
+// Every 8-bit format must hold the same pixels for one framebuffer and tone map, and PFM
+// must read back exactly what was written. The PNG is decoded here, for the stored and
+// fixed-Huffman deflate blocks the writer can produce.
+namespace
+{
+    const int s_ciWidth = 37;
+    const int s_ciHeight = 23;
+
+    std::vector<unsigned char> ReadBytes(const std::string& a_sPath)
+    {
+        std::ifstream _in(a_sPath.c_str(), std::ios::binary);
+
+        return std::vector<unsigned char>(std::istreambuf_iterator<char>(_in), std::istreambuf_iterator<char>());
+    }
+
+    uint32_t ReadBigEndian(const unsigned char* a_pBytes)
+    {
+        return uint32_t(a_pBytes[0]) << 24 | uint32_t(a_pBytes[1]) << 16 | uint32_t(a_pBytes[2]) << 8 | uint32_t(a_pBytes[3]);
+    }
+
+    class BitReader
+    {
+    public:
+        BitReader(const std::vector<unsigned char>& a_oData, size_t a_uStart) : m_oData(a_oData),
+                                                                               m_uBit(a_uStart * 8)
+        {
+        }
+
+        // False past the end, which no valid stream reaches.
+        bool Read(int a_iCount, uint32_t& a_uValue)
+        {
+            a_uValue = 0;
+
+            for (int b = 0; b < a_iCount; ++b, ++this->m_uBit)
+            {
+                if (this->m_uBit / 8 >= this->m_oData.size())
+                {
+                    return false;
+                }
+
+                a_uValue |= uint32_t(this->m_oData[this->m_uBit / 8] >> (this->m_uBit % 8) & 1) << b;
+            }
+
+            return true;
+        }
+
+        // Huffman codes are packed from their most significant bit.
+        bool ReadCodeBit(uint32_t& a_uCode)
+        {
+            uint32_t _bit;
+
+            if (!this->Read(1, _bit))
+            {
+                return false;
+            }
+
+            a_uCode = a_uCode << 1 | _bit;
+
+            return true;
+        }
+
+        void AlignToByte()
+        {
+            this->m_uBit = (this->m_uBit + 7) / 8 * 8;
+        }
+
+        size_t GetByte() const
+        {
+            return this->m_uBit / 8;
+        }
+
+        void SkipBytes(size_t a_uCount)
+        {
+            this->m_uBit += a_uCount * 8;
+        }
+
+    private:
+        const std::vector<unsigned char>& m_oData;
+
+        size_t m_uBit;
+    };
+
+    // One literal/length symbol of the fixed code of RFC 1951, section 3.2.6.
+    bool ReadFixedSymbol(BitReader& a_oBits, int& a_iSymbol)
+    {
+        uint32_t _code = 0;
+
+        for (int b = 0; b < 7; ++b)
+        {
+            if (!a_oBits.ReadCodeBit(_code))
+            {
+                return false;
+            }
+        }
+
+        if (_code <= 0x17)
+        {
+            a_iSymbol = 256 + int(_code);
+            return true;
+        }
+
+        if (!a_oBits.ReadCodeBit(_code))
+        {
+            return false;
+        }
+
+        if (_code >= 0x30 && _code <= 0xbf)
+        {
+            a_iSymbol = int(_code) - 0x30;
+            return true;
+        }
+
+        if (_code >= 0xc0 && _code <= 0xc7)
+        {
+            a_iSymbol = 280 + int(_code) - 0xc0;
+            return true;
+        }
+
+        if (!a_oBits.ReadCodeBit(_code) || _code < 0x190)
+        {
+            return false;
+        }
+
+        a_iSymbol = 144 + int(_code) - 0x190;
+
+        return true;
+    }
+
+    bool Inflate(const std::vector<unsigned char>& a_oZlib, std::vector<unsigned char>& a_oOut)
+    {
+        static const int s_ciLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int s_ciLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const int s_ciDistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const int s_ciDistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        if (a_oZlib.size() < 6 || (a_oZlib[0] & 0x0f) != 8 || (a_oZlib[0] << 8 | a_oZlib[1]) % 31 != 0)
+        {
+            return false;
+        }
+
+        BitReader _bits(a_oZlib, 2);
+
+        uint32_t _final = 0;
+
+        while (!_final)
+        {
+            uint32_t _type;
+
+            if (!_bits.Read(1, _final) || !_bits.Read(2, _type))
+            {
+                return false;
+            }
+
+            if (_type == 0)
+            {
+                _bits.AlignToByte();
+
+                size_t _at = _bits.GetByte();
+
+                if (_at + 4 > a_oZlib.size())
+                {
+                    return false;
+                }
+
+                size_t _length = a_oZlib[_at] | a_oZlib[_at + 1] << 8;
+
+                if (_at + 4 + _length > a_oZlib.size())
+                {
+                    return false;
+                }
+
+                a_oOut.insert(a_oOut.end(), a_oZlib.begin() + _at + 4, a_oZlib.begin() + _at + 4 + _length);
+
+                _bits.SkipBytes(4 + _length);
+
+                continue;
+            }
+
+            if (_type != 1)
+            {
+                return false;
+            }
+
+            for (;;)
+            {
+                int _symbol;
+
+                if (!ReadFixedSymbol(_bits, _symbol) || _symbol > 285)
+                {
+                    return false;
+                }
+
+                if (_symbol < 256)
+                {
+                    a_oOut.push_back(static_cast<unsigned char>(_symbol));
+                    continue;
+                }
+
+                if (_symbol == 256)
+                {
+                    break;
+                }
+
+                uint32_t _extra;
+                uint32_t _distanceCode = 0;
+
+                if (!_bits.Read(s_ciLengthExtra[_symbol - 257], _extra))
+                {
+                    return false;
+                }
+
+                size_t _length = s_ciLengthBase[_symbol - 257] + _extra;
+
+                for (int b = 0; b < 5; ++b)
+                {
+                    if (!_bits.ReadCodeBit(_distanceCode))
+                    {
+                        return false;
+                    }
+                }
+
+                if (_distanceCode >= 30 || !_bits.Read(s_ciDistExtra[_distanceCode], _extra))
+                {
+                    return false;
+                }
+
+                size_t _distance = s_ciDistBase[_distanceCode] + _extra;
+
+                if (_distance > a_oOut.size())
+                {
+                    return false;
+                }
+
+                for (size_t k = 0; k < _length; ++k)
+                {
+                    a_oOut.push_back(a_oOut[a_oOut.size() - _distance]);
+                }
+            }
+        }
+
+        _bits.AlignToByte();
+
+        size_t _at = _bits.GetByte();
+
+        if (_at + 4 > a_oZlib.size())
+        {
+            return false;
+        }
+
+        uint32_t _a = 1;
+        uint32_t _b = 0;
+
+        for (size_t i = 0; i < a_oOut.size(); ++i)
+        {
+            _a = (_a + a_oOut[i]) % 65521;
+            _b = (_b + _a) % 65521;
+        }
+
+        return ReadBigEndian(&a_oZlib[_at]) == (_b << 16 | _a);
+    }
+
+    int Paeth(int a_iA, int a_iB, int a_iC)
+    {
+        int _p = a_iA + a_iB - a_iC;
+        int _pa = _p > a_iA ? _p - a_iA : a_iA - _p;
+        int _pb = _p > a_iB ? _p - a_iB : a_iB - _p;
+        int _pc = _p > a_iC ? _p - a_iC : a_iC - _p;
+
+        return _pa <= _pb && _pa <= _pc ? a_iA : _pb <= _pc ? a_iB : a_iC;
+    }
+
+    // 8-bit RGB, top scanline first, from a non-interlaced 8-bit RGB PNG.
+    bool DecodePng(const std::vector<unsigned char>& a_oFile, int& a_iWidth, int& a_iHeight, std::vector<unsigned char>& a_oRgb)
+    {
+        static const unsigned char s_cuSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+        if (a_oFile.size() < 8 || !std::equal(s_cuSignature, s_cuSignature + 8, a_oFile.begin()))
+        {
+            return false;
+        }
+
+        std::vector<unsigned char> _zlib;
+
+        a_iWidth = 0;
+        a_iHeight = 0;
+
+        bool _end = false;
+
+        for (size_t _at = 8; !_end; )
+        {
+            if (_at + 12 > a_oFile.size())
+            {
+                return false;
+            }
+
+            size_t _length = ReadBigEndian(&a_oFile[_at]);
+
+            std::string _type(a_oFile.begin() + _at + 4, a_oFile.begin() + _at + 8);
+
+            if (_at + 12 + _length > a_oFile.size())
+            {
+                return false;
+            }
+
+            const unsigned char* _data = &a_oFile[_at + 8];
+
+            if (_type == "IHDR")
+            {
+                if (_length != 13 || _data[8] != 8 || _data[9] != 2 || _data[12] != 0)
+                {
+                    return false;
+                }
+
+                a_iWidth = int(ReadBigEndian(_data));
+                a_iHeight = int(ReadBigEndian(_data + 4));
+            }
+            else if (_type == "IDAT")
+            {
+                _zlib.insert(_zlib.end(), _data, _data + _length);
+            }
+            else if (_type == "IEND")
+            {
+                _end = true;
+            }
+
+            _at += 12 + _length;
+        }
+
+        std::vector<unsigned char> _filtered;
+
+        size_t _stride = size_t(a_iWidth) * 3;
+
+        if (a_iWidth <= 0 || a_iHeight <= 0 || !Inflate(_zlib, _filtered) || _filtered.size() != (_stride + 1) * a_iHeight)
+        {
+            return false;
+        }
+
+        a_oRgb.assign(_stride * a_iHeight, 0);
+
+        for (int y = 0; y < a_iHeight; ++y)
+        {
+            const unsigned char* _in = &_filtered[y * (_stride + 1)];
+
+            unsigned char* _row = &a_oRgb[y * _stride];
+
+            const unsigned char* _prev = y > 0 ? _row - _stride : nullptr;
+
+            for (size_t x = 0; x < _stride; ++x)
+            {
+                int _a = x >= 3 ? _row[x - 3] : 0;
+                int _b = _prev ? _prev[x] : 0;
+                int _c = _prev && x >= 3 ? _prev[x - 3] : 0;
+
+                int _predictor;
+
+                switch (_in[0])
+                {
+                case 0: _predictor = 0; break;
+                case 1: _predictor = _a; break;
+                case 2: _predictor = _b; break;
+                case 3: _predictor = (_a + _b) / 2; break;
+                case 4: _predictor = Paeth(_a, _b, _c); break;
+                default: return false;
+                }
+
+                _row[x] = static_cast<unsigned char>(_in[1 + x] + _predictor);
+            }
+        }
+
+        return true;
+    }
+
+    // The pixels of a binary or ASCII PPM with a maximum of 255.
+    bool DecodePpm(const std::vector<unsigned char>& a_oFile, int& a_iWidth, int& a_iHeight, std::vector<unsigned char>& a_oRgb)
+    {
+        std::string _text(a_oFile.begin(), a_oFile.end());
+
+        char _magic[3] = { 0, 0, 0 };
+
+        int _max = 0;
+        int _read = 0;
+
+        if (sscanf(_text.c_str(), "%2s %d %d %d%n", _magic, &a_iWidth, &a_iHeight, &_max, &_read) != 4 || _max != 255 || a_iWidth <= 0 || a_iHeight <= 0)
+        {
+            return false;
+        }
+
+        size_t _bytes = size_t(a_iWidth) * a_iHeight * 3;
+
+        // One whitespace character ends the header.
+        size_t _at = size_t(_read) + 1;
+
+        if (std::string(_magic) == "P6")
+        {
+            if (_at + _bytes != a_oFile.size())
+            {
+                return false;
+            }
+
+            a_oRgb.assign(a_oFile.begin() + _at, a_oFile.end());
+
+            return true;
+        }
+
+        if (std::string(_magic) != "P3")
+        {
+            return false;
+        }
+
+        a_oRgb.clear();
+
+        const char* _position = _text.c_str() + _at;
+
+        for (size_t i = 0; i < _bytes; ++i)
+        {
+            int _value;
+            int _used;
+
+            if (sscanf(_position, "%d%n", &_value, &_used) != 1 || _value < 0 || _value > 255)
+            {
+                return false;
+            }
+
+            a_oRgb.push_back(static_cast<unsigned char>(_value));
+
+            _position += _used;
+        }
+
+        return true;
+    }
+
+    // Gradients for the PNG filters and matches, flat runs, and values past both clamps.
+    FrameBuffer TestImage()
+    {
+        FrameBuffer _image(s_ciWidth, s_ciHeight);
+
+        for (int j = 0; j < s_ciHeight; ++j)
+        {
+            for (int i = 0; i < s_ciWidth; ++i)
+            {
+                float _u = float(i) / (s_ciWidth - 1);
+                float _v = float(j) / (s_ciHeight - 1);
+
+                Vec3 _color = i < 8 ? Vec3(0.25f, 0.25f, 0.25f) : Vec3(2.0f * _u, _v, (i * 7 + j * 13) % 5 * 0.3f - 0.2f);
+
+                _image.SetPixel(i, j, _color);
+                _image.SetSampleCount(i, j, 1);
+            }
+        }
+
+        return _image;
+    }
+}
+
+int main()
+{
+    const FrameBuffer _image = TestImage();
+
+    ToneMapSettings _toneMap;
+
+    _toneMap.m_eCurve = TONE_CURVE_ACES;
+    _toneMap.m_fExposure = 0.5f;
+
+    RT_CHECK(ImageWriter::Write(_image, "formats.ppm", IMAGE_FORMAT_PPM, _toneMap));
+    RT_CHECK(ImageWriter::Write(_image, "formats-ascii.ppm", IMAGE_FORMAT_PPM_ASCII, _toneMap));
+    RT_CHECK(ImageWriter::Write(_image, "formats.png", IMAGE_FORMAT_PNG, _toneMap));
+    RT_CHECK(ImageWriter::Write(_image, "formats.pfm", IMAGE_FORMAT_PFM, _toneMap));
+
+    std::vector<unsigned char> _expected;
+
+    ToneMapper::ToRgb8(_image, _toneMap, _expected);
+
+    int _width = 0;
+    int _height = 0;
+
+    std::vector<unsigned char> _ppm;
+    std::vector<unsigned char> _ascii;
+    std::vector<unsigned char> _png;
+
+    RT_CHECK(DecodePpm(ReadBytes("formats.ppm"), _width, _height, _ppm));
+    RT_CHECK(_width == s_ciWidth && _height == s_ciHeight);
+
+    RT_CHECK(DecodePpm(ReadBytes("formats-ascii.ppm"), _width, _height, _ascii));
+    RT_CHECK(_width == s_ciWidth && _height == s_ciHeight);
+
+    RT_CHECK(DecodePng(ReadBytes("formats.png"), _width, _height, _png));
+    RT_CHECK(_width == s_ciWidth && _height == s_ciHeight);
+
+    RT_CHECK(_ppm == _expected);
+    RT_CHECK(_ascii == _expected);
+    RT_CHECK(_png == _expected);
+
+    // A single flat colour compresses to long matches, the other end of the encoder.
+    FrameBuffer _flat(300, 40);
+
+    for (int j = 0; j < 40; ++j)
+    {
+        for (int i = 0; i < 300; ++i)
+        {
+            _flat.SetPixel(i, j, Vec3(0.5f, 0.5f, 0.5f));
+        }
+    }
+
+    RT_CHECK(ImageWriter::Write(_flat, "formats-flat.png", IMAGE_FORMAT_PNG));
+
+    std::vector<unsigned char> _flatExpected;
+    std::vector<unsigned char> _flatPng;
+
+    ToneMapper::ToRgb8(_flat, ToneMapSettings(), _flatExpected);
+
+    RT_CHECK(DecodePng(ReadBytes("formats-flat.png"), _width, _height, _flatPng));
+    RT_CHECK(_flatPng == _flatExpected);
+
+    FrameBuffer _linear(0, 0);
+
+    std::string _error;
+
+    RT_CHECK(ImageReader::ReadPfm("formats.pfm", _linear, _error));
+    RT_CHECK(_linear.GetWidth() == s_ciWidth && _linear.GetHeight() == s_ciHeight);
+
+    for (int j = 0; j < _linear.GetHeight() && j < s_ciHeight; ++j)
+    {
+        for (int i = 0; i < _linear.GetWidth() && i < s_ciWidth; ++i)
+        {
+            const Vec3& _a = _image.GetPixel(i, j);
+            const Vec3& _b = _linear.GetPixel(i, j);
+
+            RT_CHECK(_a[0] == _b[0] && _a[1] == _b[1] && _a[2] == _b[2]);
+        }
+    }
+
+    const char* _files[] = { "formats.ppm", "formats-ascii.ppm", "formats.png", "formats.pfm", "formats-flat.png" };
+
+    for (size_t f = 0; f < sizeof(_files) / sizeof(_files[0]); ++f)
+    {
+        remove(_files[f]);
+    }
+
+    return CheckFailures();
+}
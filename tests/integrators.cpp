@@ -0,0 +1,107 @@
+#include <fstream>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/renderer.h"
+#include "appsrc/include/Render/tonemapper.h"
+#include "tests/check.h"
+
+// The path and wavefront integrators draw the same sample dimensions and, through
+// Camera::GetRays(), the same primary rays, so with the scalar kernels on both sides they
+// must write the same image byte for byte.
+namespace
+{
+    const int s_ciWidth = 120;
+    const int s_ciHeight = 80;
+
+    // A sphere lamp over a floor and a glass ball, so both sides take the light paths too.
+    bool WriteLampScene(const std::string& a_sPath)
+    {
+        std::ofstream _file(a_sPath.c_str());
+
+        _file << "{\"camera\": {\"look_from\": [0, 3, 10], \"look_at\": [0, 1, 0], \"fov\": 35, \"aperture\": 0.1},\n"
+              << " \"background\": [0.05, 0.05, 0.08],\n"
+              << " \"materials\": [{\"name\": \"floor\", \"type\": \"lambertian\", \"albedo\": [0.6, 0.6, 0.6]},\n"
+              << "               {\"name\": \"glass\", \"type\": \"dielectric\", \"ior\": 1.5},\n"
+              << "               {\"name\": \"lamp\", \"type\": \"emissive\", \"emission\": [6, 5, 4]}],\n"
+              << " \"spheres\": [{\"center\": [0, -1000, 0], \"radius\": 1000, \"material\": \"floor\"},\n"
+              << "             {\"center\": [0, 1, 0], \"radius\": 1, \"material\": \"glass\"},\n"
+              << "             {\"center\": [-1.5, 0.5, 1.5], \"radius\": 0.5, \"material\": \"floor\"},\n"
+              << "             {\"center\": [2, 4, 1], \"radius\": 1.2, \"material\": \"lamp\"}]}\n";
+
+        return bool(_file);
+    }
+
+    std::vector<unsigned char> Render(Renderer& a_oRenderer, SamplerType a_eSampler, bool a_bWavefront)
+    {
+        RenderRequest _request;
+
+        _request.m_oSettings.m_iWidth = s_ciWidth;
+        _request.m_oSettings.m_iHeight = s_ciHeight;
+        _request.m_oSettings.m_iSamples = 8;
+        _request.m_oSettings.m_eSampler = a_eSampler;
+        _request.m_bWavefront = a_bWavefront;
+
+        FrameBuffer _image(s_ciWidth, s_ciHeight);
+
+        std::string _error;
+
+        RT_CHECK(a_oRenderer.Render(_request, _image, Renderer::TileCallback(), _error));
+
+        std::vector<unsigned char> _rgb;
+
+        ToneMapper::ToRgb8(_image, ToneMapSettings(), _rgb);
+
+        return _rgb;
+    }
+
+    void Compare(const char* a_pName, Renderer& a_oRenderer, SamplerType a_eSampler)
+    {
+        std::vector<unsigned char> _path = Render(a_oRenderer, a_eSampler, false);
+        std::vector<unsigned char> _wavefront = Render(a_oRenderer, a_eSampler, true);
+
+        int _differing = 0;
+
+        for (size_t b = 0; b < _path.size(); ++b)
+        {
+            _differing += _path[b] == _wavefront[b] ? 0 : 1;
+        }
+
+        if (_path.size() != _wavefront.size() || _differing > 0)
+        {
+            std::cerr << a_pName << " with " << Sampler::GetTypeName(a_eSampler) << ": " << _differing << " of " << _path.size()
+                      << " bytes differ between the path and wavefront integrators\n";
+            ++CheckFailures();
+        }
+    }
+}
+
+int main()
+{
+    if (SimdIsaName(ToneMapper::GetIsa()) != std::string("scalar"))
+    {
+        std::cerr << "needs RT_SIMD_ISA=scalar\n";
+        return s_ciSkipped;
+    }
+
+    const std::string _lampPath = "integrators.json";
+
+    RT_CHECK(WriteLampScene(_lampPath));
+
+    Renderer _cover;
+
+    _cover.BuildDefaultScene();
+
+    Renderer _lamp;
+
+    std::string _error;
+
+    RT_CHECK(_lamp.LoadScene(_lampPath, _error));
+
+    for (int t = 0; t < SAMPLER_TYPE_COUNT; ++t)
+    {
+        Compare("cover scene", _cover, SamplerType(t));
+        Compare("lamp scene", _lamp, SamplerType(t));
+    }
+
+    return CheckFailures();
+}
@@ -0,0 +1,161 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "appsrc/include/IO/meshloader.h"
+#include "tests/check.h"
+#include "tests/truncation.h"
+
+// The OBJ and PLY loaders get every prefix of a valid file and must refuse it or load
+// something consistent; never read past the end or hand out indices past the vertices.
+namespace
+{
+    bool IndicesInRange(const TriangleMesh& a_oMesh)
+    {
+        for (int t = 0; t < a_oMesh.GetTriangleCount(); ++t)
+        {
+            const uint32_t* _corners = a_oMesh.GetTriangle(t);
+
+            for (int c = 0; c < 3; ++c)
+            {
+                if (_corners[c] >= uint32_t(a_oMesh.GetVertexCount()))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // A quad fan and a triangle, with relative indices.
+    const char s_ccObj[] =
+        "# test mesh\n"
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "v 0.5 0.5 1\n"
+        "f 1 2 3 4\n"
+        "f -5 -4 -1\n";
+
+    const char s_ccPlyAscii[] =
+        "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 5\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n"
+        "0 0 0\n"
+        "1 0 0\n"
+        "1 1 0\n"
+        "0 1 0\n"
+        "0.5 0.5 1\n"
+        "4 0 1 2 3\n"
+        "3 0 1 4\n";
+
+    std::vector<char> BinaryPly()
+    {
+        const char _header[] =
+            "ply\n"
+            "format binary_little_endian 1.0\n"
+            "element vertex 5\n"
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "element face 2\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n";
+
+        std::vector<char> _bytes(_header, _header + sizeof(_header) - 1);
+
+        const float _positions[15] = { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 0.5f, 0.5f, 1 };
+
+        // Little-endian bytes whatever the host.
+        for (int i = 0; i < 15; ++i)
+        {
+            uint32_t _bits;
+
+            memcpy(&_bits, &_positions[i], sizeof(_bits));
+
+            for (int b = 0; b < 4; ++b)
+            {
+                _bytes.push_back(char(_bits >> (8 * b) & 0xff));
+            }
+        }
+
+        const int _faces[2][5] = { { 4, 0, 1, 2, 3 }, { 3, 0, 1, 4, 0 } };
+
+        for (int f = 0; f < 2; ++f)
+        {
+            _bytes.push_back(char(_faces[f][0]));
+
+            for (int c = 1; c <= _faces[f][0]; ++c)
+            {
+                for (int b = 0; b < 4; ++b)
+                {
+                    _bytes.push_back(char(uint32_t(_faces[f][c]) >> (8 * b) & 0xff));
+                }
+            }
+        }
+
+        return _bytes;
+    }
+
+    // a_bExact: the format declares its counts, so any prefix that loads holds all of it.
+    void CheckMesh(const std::string& a_sPath, const std::vector<char>& a_oBytes, bool a_bExact, bool a_bBinary)
+    {
+        RT_CHECK(WriteBytes(a_sPath, a_oBytes, a_oBytes.size()));
+
+        std::string _error;
+
+        TriangleMesh _whole;
+
+        RT_CHECK(MeshLoader::Load(a_sPath, _whole, _error));
+        RT_CHECK(_whole.GetVertexCount() == 5);
+        RT_CHECK(_whole.GetTriangleCount() == 3);
+
+        std::vector<size_t> _lengths = CutLengths(a_oBytes.size(), a_oBytes.size());
+
+        for (size_t l = 0; l < _lengths.size(); ++l)
+        {
+            RT_CHECK(WriteBytes(a_sPath, a_oBytes, _lengths[l]));
+
+            TriangleMesh _mesh;
+
+            if (!MeshLoader::Load(a_sPath, _mesh, _error))
+            {
+                continue;
+            }
+
+            bool _consistent = IndicesInRange(_mesh) && _mesh.GetTriangleCount() <= 3 && !a_bBinary;
+
+            if (a_bExact)
+            {
+                _consistent = _consistent && _mesh.GetVertexCount() == 5 && _mesh.GetTriangleCount() == 3;
+            }
+
+            if (!_consistent)
+            {
+                std::cerr << a_sPath << " cut to " << _lengths[l] << " of " << a_oBytes.size() << " bytes loaded " << _mesh.GetVertexCount() << " vertices and "
+                          << _mesh.GetTriangleCount() << " triangles\n";
+                ++CheckFailures();
+            }
+        }
+
+        remove(a_sPath.c_str());
+    }
+}
+
+int main()
+{
+    CheckMesh("meshloader.obj", std::vector<char>(s_ccObj, s_ccObj + sizeof(s_ccObj) - 1), false, false);
+    CheckMesh("meshloader-ascii.ply", std::vector<char>(s_ccPlyAscii, s_ccPlyAscii + sizeof(s_ccPlyAscii) - 1), true, false);
+    CheckMesh("meshloader-binary.ply", BinaryPly(), true, true);
+
+    return CheckFailures();
+}
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <string>
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+
+// Cancellation of the library API: a Cancel() stops the request it reaches and no other,
+// and a cancelled request never reports success.
+namespace
+{
+    RenderRequest Request(bool a_bDenoise)
+    {
+        RenderRequest _request;
+
+        _request.m_oSettings.m_iWidth = 64;
+        _request.m_oSettings.m_iHeight = 48;
+        _request.m_oSettings.m_iSamples = 2;
+        _request.m_oSettings.m_iTileSize = 16;
+        _request.m_bWavefront = true;
+
+        if (a_bDenoise)
+        {
+            _request.m_oDenoise.m_eType = DENOISER_BILATERAL;
+        }
+
+        return _request;
+    }
+}
+
+int main()
+{
+    Renderer _renderer(1);
+
+    _renderer.BuildDefaultScene();
+
+    FrameBuffer _image(64, 48);
+
+    std::string _error;
+
+    // With nothing called yet there is nothing to stop.
+    _renderer.Cancel();
+
+    RT_CHECK(_renderer.Render(Request(false), _image, Renderer::TileCallback(), _error));
+    RT_CHECK(!_renderer.IsCancelled());
+
+    for (int d = 0; d < 2; ++d)
+    {
+        std::atomic<int> _tiles(0);
+
+        Renderer::TileCallback _cancelFirst = [&](const Tile&, const FrameBuffer&)
+        {
+            if (_tiles++ == 0)
+            {
+                _renderer.Cancel();
+            }
+        };
+
+        _error.clear();
+
+        RT_CHECK(!_renderer.Render(Request(d == 1), _image, _cancelFirst, _error));
+        RT_CHECK(_error == "cancelled");
+        RT_CHECK(_renderer.IsCancelled());
+
+        // One thread: the tile in hand finishes and the other eleven are skipped.
+        RT_CHECK(_tiles == 1);
+
+        RT_CHECK(_renderer.Render(Request(d == 1), _image, Renderer::TileCallback(), _error));
+        RT_CHECK(!_renderer.IsCancelled());
+    }
+
+    return CheckFailures();
+}
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+#include "tests/truncation.h"
+
+// A scene cache cut short anywhere must be refused rather than mapped, so a damaged file
+// never sends the traversal past the end of the mapping.
+int main()
+{
+    const std::string _path = "scenecache.cache";
+    const std::string _cutPath = "scenecache-cut.cache";
+
+    {
+        Renderer _renderer;
+
+        _renderer.BuildDefaultScene();
+
+        RT_CHECK(_renderer.GetScene().SaveCache(_path));
+    }
+
+    std::vector<char> _bytes = ReadBytes(_path);
+
+    std::string _error;
+
+    Scene _whole;
+
+    RT_CHECK(_whole.LoadCache(_path, _error));
+    RT_CHECK(_whole.GetBvh() != nullptr);
+
+    std::vector<size_t> _lengths = CutLengths(_bytes.size(), 512);
+
+    for (size_t l = 0; l < _lengths.size(); ++l)
+    {
+        RT_CHECK(WriteBytes(_cutPath, _bytes, _lengths[l]));
+
+        Scene _scene;
+
+        if (_scene.LoadCache(_cutPath, _error))
+        {
+            std::cerr << "a scene cache cut to " << _lengths[l] << " of " << _bytes.size() << " bytes loaded\n";
+            ++CheckFailures();
+        }
+    }
+
+    remove(_path.c_str());
+    remove(_cutPath.c_str());
+
+    return CheckFailures();
+}
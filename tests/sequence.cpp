@@ -0,0 +1,133 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "appsrc/include/Math/random.h"
+#include "appsrc/include/Render/renderer.h"
+#include "tests/check.h"
+
+// A frame reached by stepping a sequence through refits, and rebuilds once they degrade,
+// must match the same frame rendered on its own with --first-frame.
+namespace
+{
+    const int s_ciWidth = 64;
+    const int s_ciHeight = 48;
+
+    const int s_ciFrames = 8;
+
+    // Lanes further apart than a sphere is wide.
+    const int s_ciLayers = 5;
+    const int s_ciLanes = 20;
+    const float s_cfLaneSpacing = 0.7f;
+
+    // Loose moving spheres, fast enough for the refitted BVH to be rebuilt on the way. Each
+    // runs along x in a lane of its own, as two overlapping spheres can meet a ray at the
+    // same distance and then the hit goes to whichever one the tree reaches first.
+    bool WriteScene(const std::string& a_sPath)
+    {
+        std::ostringstream _json;
+
+        _json << "{\"camera\": {\"look_from\": [0, 6, 18], \"look_at\": [0, 1, 0], \"fov\": 40, \"shutter\": 0.5},\n"
+              << " \"materials\": [{\"name\": \"floor\", \"type\": \"lambertian\", \"albedo\": [0.5, 0.5, 0.5]},\n"
+              << "               {\"name\": \"red\", \"type\": \"lambertian\", \"albedo\": [0.7, 0.2, 0.2]},\n"
+              << "               {\"name\": \"metal\", \"type\": \"metal\", \"albedo\": [0.8, 0.8, 0.7], \"fuzz\": 0.1}],\n"
+              << " \"spheres\": [{\"center\": [0, -1000, 0], \"radius\": 1000, \"material\": \"floor\"}";
+
+        Rng _rng = Rng::ForPixel(1, 2, 3);
+
+        for (int s = 0; s < s_ciLayers * s_ciLanes; ++s)
+        {
+            float _x = 20.0f * _rng.NextFloat() - 10.0f;
+            float _y = 0.4f + s_cfLaneSpacing * float(s / s_ciLanes);
+            float _z = s_cfLaneSpacing * float(s % s_ciLanes - s_ciLanes / 2);
+
+            float _vx = 8.0f * _rng.NextFloat() - 4.0f;
+
+            _json << ",\n  {\"center\": [" << _x << ", " << _y << ", " << _z << "], \"radius\": 0.3, \"material\": \"" << (s % 3 ? "red" : "metal")
+                  << "\", \"velocity\": [" << _vx << ", 0, 0]}";
+        }
+
+        _json << "]}\n";
+
+        std::ofstream _file(a_sPath.c_str());
+
+        _file << _json.str();
+
+        return bool(_file);
+    }
+
+    RenderRequest Request(int a_iFrame)
+    {
+        RenderRequest _request;
+
+        _request.m_oSettings.m_iWidth = s_ciWidth;
+        _request.m_oSettings.m_iHeight = s_ciHeight;
+        _request.m_oSettings.m_iSamples = 4;
+        _request.m_bWavefront = true;
+        _request.m_iFrame = a_iFrame;
+
+        return _request;
+    }
+
+    bool SameImage(const FrameBuffer& a_oA, const FrameBuffer& a_oB)
+    {
+        for (int j = 0; j < s_ciHeight; ++j)
+        {
+            for (int i = 0; i < s_ciWidth; ++i)
+            {
+                const Vec3& _a = a_oA.GetPixel(i, j);
+                const Vec3& _b = a_oB.GetPixel(i, j);
+
+                if (_a[0] != _b[0] || _a[1] != _b[1] || _a[2] != _b[2])
+                {
+                    std::cerr << "pixel " << i << ", " << j << " differs\n";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+int main()
+{
+    const std::string _path = "sequence.json";
+
+    RT_CHECK(WriteScene(_path));
+
+    std::string _error;
+
+    Renderer _sequence;
+
+    RT_CHECK(_sequence.LoadScene(_path, _error));
+
+    int _rebuilds = 0;
+
+    for (int f = 0; f < s_ciFrames; ++f)
+    {
+        FrameBuffer _stepped(s_ciWidth, s_ciHeight);
+
+        RT_CHECK(_sequence.Render(Request(f), _stepped, Renderer::TileCallback(), _error));
+
+        _rebuilds += _sequence.GetScene().GetRebuildCount();
+
+        Renderer _alone;
+
+        RT_CHECK(_alone.LoadScene(_path, _error));
+
+        FrameBuffer _direct(s_ciWidth, s_ciHeight);
+
+        RT_CHECK(_alone.Render(Request(f), _direct, Renderer::TileCallback(), _error));
+
+        if (!SameImage(_stepped, _direct))
+        {
+            std::cerr << "frame " << f << " of the sequence differs from the frame rendered alone\n";
+            ++CheckFailures();
+        }
+    }
+
+    // Otherwise only the refit path was compared.
+    RT_CHECK(_rebuilds > 0);
+
+    return CheckFailures();
+}
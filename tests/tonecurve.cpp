@@ -0,0 +1,116 @@
+#include <math.h>
+#include <limits>
+#include <string>
+#include <vector>
+#include "appsrc/include/Render/tonemapper.h"
+#include "tests/check.h"
+
+// Runs once per ISA under RT_SIMD_ISA, named by the argument, and compares the curve
+// kernels the tone mapper picked against the curves written out one value at a time.
+namespace
+{
+    float Reference(float a_fValue, ToneCurve a_eCurve, float a_fExposure)
+    {
+        float _x = a_fValue * exp2f(a_fExposure) * (a_eCurve == TONE_CURVE_ACES ? 0.6f : 1.0f);
+
+        _x = _x > 0.0f ? _x : 0.0f;
+
+        float _y = _x;
+
+        if (a_eCurve == TONE_CURVE_REINHARD)
+        {
+            _y = _x / (1.0f + _x);
+        }
+        else if (a_eCurve == TONE_CURVE_ACES)
+        {
+            _y = (_x * (2.51f * _x + 0.03f)) / (_x * (2.43f * _x + 0.59f) + 0.14f);
+        }
+
+        return _y < 1.0f ? _y : 1.0f;
+    }
+
+    // Values spanning the curves' range, the clamps on both sides and the non-finite inputs.
+    std::vector<float> Inputs()
+    {
+        std::vector<float> _values;
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            _values.push_back(powf(2.0f, float(i) / 50.0f - 12.0f));
+        }
+
+        const float _special[] = { 0.0f, -0.0f, -1.0f, -1e30f, 1e30f, 1e-38f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                                   std::numeric_limits<float>::quiet_NaN() };
+
+        _values.insert(_values.end(), _special, _special + sizeof(_special) / sizeof(_special[0]));
+
+        return _values;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string _isa = SimdIsaName(ToneMapper::GetIsa());
+
+    if (argc > 1 && _isa != argv[1])
+    {
+        std::cerr << "the tone mapper runs " << _isa << " here, not " << argv[1] << "\n";
+        return s_ciSkipped;
+    }
+
+    const std::vector<float> _inputs = Inputs();
+
+    const float _exposures[] = { 0.0f, 1.5f, -3.0f };
+
+    for (int c = 0; c < TONE_CURVE_COUNT; ++c)
+    {
+        for (size_t e = 0; e < sizeof(_exposures) / sizeof(_exposures[0]); ++e)
+        {
+            ToneMapSettings _settings;
+
+            _settings.m_eCurve = ToneCurve(c);
+            _settings.m_fExposure = _exposures[e];
+
+            // Every count up to two AVX2 widths, so each kernel's tail runs too.
+            for (int n = 0; n <= 17; ++n)
+            {
+                int _count = int(_inputs.size()) - n;
+
+                std::vector<float> _out(_count);
+
+                ToneMapper::ApplyCurve(&_inputs[n], _count, _settings, &_out[0]);
+
+                int _wrong = 0;
+
+                for (int i = 0; i < _count; ++i)
+                {
+                    float _expected = Reference(_inputs[n + i], ToneCurve(c), _exposures[e]);
+
+                    // Within rounding of the one-value curve, and never outside [0, 1].
+                    if (!(fabsf(_out[i] - _expected) <= 1e-6f && _out[i] >= 0.0f && _out[i] <= 1.0f))
+                    {
+                        ++_wrong;
+                    }
+                }
+
+                if (_wrong > 0)
+                {
+                    std::cerr << ToneMapper::GetCurveName(ToneCurve(c)) << " at " << _exposures[e] << " stops from offset " << n << ": " << _wrong << " values off\n";
+                    ++CheckFailures();
+                }
+            }
+
+            // In place, as ApplyCurve() allows.
+            std::vector<float> _inPlace(_inputs);
+
+            ToneMapper::ApplyCurve(&_inPlace[0], int(_inPlace.size()), _settings, &_inPlace[0]);
+
+            for (size_t i = 0; i < _inPlace.size(); ++i)
+            {
+                RT_CHECK(fabsf(_inPlace[i] - Reference(_inputs[i], ToneCurve(c), _exposures[e])) <= 1e-6f);
+            }
+        }
+    }
+
+    return CheckFailures();
+}
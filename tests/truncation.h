@@ -0,0 +1,56 @@
+#ifndef TRUNCATION_H
+#define TRUNCATION_H
+
+#include <stddef.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// For the loader tests, which hand every prefix of a valid file to a loader, as a cut-off
+// download or a full disk leaves them.
+inline std::vector<char> ReadBytes(const std::string& a_sPath)
+{
+    std::ifstream _in(a_sPath.c_str(), std::ios::binary);
+
+    return std::vector<char>(std::istreambuf_iterator<char>(_in), std::istreambuf_iterator<char>());
+}
+
+inline bool WriteBytes(const std::string& a_sPath, const std::vector<char>& a_oBytes, size_t a_uCount)
+{
+    std::ofstream _out(a_sPath.c_str(), std::ios::binary | std::ios::trunc);
+
+    _out.write(a_oBytes.empty() ? "" : &a_oBytes[0], std::streamsize(a_uCount));
+
+    return bool(_out);
+}
+
+// Every length up to a_uDense, then a spread over the rest, and one short of whole.
+inline std::vector<size_t> CutLengths(size_t a_uSize, size_t a_uDense)
+{
+    std::vector<size_t> _lengths;
+
+    for (size_t n = 0; n < a_uSize && n <= a_uDense; ++n)
+    {
+        _lengths.push_back(n);
+    }
+
+    for (size_t k = 1; k < 64; ++k)
+    {
+        size_t _length = a_uDense + (a_uSize - a_uDense) * k / 64;
+
+        if (_length > a_uDense && _length < a_uSize)
+        {
+            _lengths.push_back(_length);
+        }
+    }
+
+    if (a_uSize > 0)
+    {
+        _lengths.push_back(a_uSize - 1);
+    }
+
+    return _lengths;
+}
+
+#endif // TRUNCATION_H